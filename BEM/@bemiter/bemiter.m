@@ -9,6 +9,7 @@ classdef bemiter
     restart = []        %  restart for GMRES solver
     precond = 'hmat'    %  preconditioner for iterative solver
     output  = 0         %  intermediate output for iterative solver
+    native  = true      %  iterative solver in C++ (if MEX file is available)
   end
   
   properties (Access = protected)
@@ -34,6 +35,7 @@ classdef bemiter
       %    'restart'    :  restart for GMRES solver
       %    'precond'    :  [] or 'hmat'
       %    'output'     :  intermediate output for iterative solver
+      %    'native'     :  iterative solver in C++
       obj = init( obj, varargin{ : } );
     end
     
@@ -15,4 +15,5 @@ if isfield( op, 'maxit'   ),  obj.maxit   = op.maxit;    end
 if isfield( op, 'restart' ),  obj.restart = op.restart;  end
 if isfield( op, 'precond' ),  obj.precond = op.precond;  end
 if isfield( op, 'output'  ),  obj.output  = op.output;   end
+if isfield( op, 'native'  ),  obj.native  = op.native;   end
 if isfield( op, 'hmode'   ),  obj.hmode   = op.hmode;    end
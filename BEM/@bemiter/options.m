@@ -10,8 +10,12 @@ function op = options( varargin )
 %    'restart'  :  restart for GMRES solver
 %    'precond'  :  [] or 'hmat'
 %    'output'   :  intermediate output for iterative solver
+%    'native'   :  iterative solver in C++
 %    'cleaf'    :  threshold parameter for bisection
-%    'fadmiss'  :  function for admissibility
+%    'admiss'   :  'min' or 'max' admissibility, eta * min( rad1, rad2 ) < dist
+%    'eta'      :  admissibility parameter
+%    'fadmiss'  :  user-defined function for admissibility @( rad1, rad2, dist ),
+%                    overrides admiss and eta and is evaluated in Matlab
 %    'htol'     :  tolerance for termination of aca loop
 %    'kmax'     :  maximum rank for low-rank matrices
 
@@ -23,10 +27,12 @@ op = struct(  ...
   'restart', [],            ...
   'precond', 'hmat',        ...
   'output',  0,             ...
+  'native',  true,          ...
   'cleaf',   200,           ...
   'htol',    1e-6,          ...
   'kmax',  [ 4, 100 ],      ...
-  'fadmiss', @( rad1, rad2, dist ) 2.5 * min( rad1, rad2 ) < dist );
+  'admiss',  'min',         ...
+  'eta',     2.5 );
 
 %  extract input
 in = getbemoptions( varargin{ : } );
@@ -37,8 +43,11 @@ if isfield( in, 'maxit'   ),  op.maxit   = in.maxit;    end
 if isfield( in, 'restart' ),  op.restart = in.restart;  end
 if isfield( in, 'precond' ),  op.precond = in.precond;  end
 if isfield( in, 'output'  ),  op.output  = in.output;   end
+if isfield( in, 'native'  ),  op.native  = in.native;   end
 %  options for H-matrices and aca
 if isfield( in, 'cleaf'   ),  op.cleaf   = in.cleaf;    end
+if isfield( in, 'admiss'  ),  op.admiss  = in.admiss;   end
+if isfield( in, 'eta'     ),  op.eta     = in.eta;      end
 if isfield( in, 'fadmiss' ),  op.fadmiss = in.fadmiss;  end
 if isfield( in, 'htol'    ),  op.htol    = in.htol;     end
 if isfield( in, 'kmax'    ),  op.kmax    = in.kmax;     end
@@ -6,8 +6,11 @@ function [ x, obj ] = solve( obj, x0, b, afun, mfun )
 %  Input
 %    x0     :  initial guess for solution vector
 %    b      :  inhomogeneity, A * x = b
-%    afun   :  evaluate A * x
-%    mfun   :  preconditioner, evaluate M * x
+%    afun   :  evaluate A * x, or structure with fields MAT (hmatrixhandle),
+%                DIAG and SCALE for A = SCALE * ( MAT + diag( DIAG ) ),
+%                the iterative solver then runs in C++
+%    mfun   :  preconditioner, evaluate M * x, or hmatrixhandle with LU
+%                decomposition for iterative solver in C++
 %  Output
 %    x      :  solution vector
 
@@ -20,22 +23,31 @@ if obj.maxit == 0 || isempty( obj.solver )
 
 %  iterative solution  
 else
-  %  iterative solution through builtin Matlab functions
-  switch obj.solver
-    case 'cgs'
-      %  conjugate gradient solver
-      [ x, flag, relres, iter ] =  ...
-            cgs( afun, b,              obj.tol, obj.maxit, mfun, [], x0 );
-    case 'bicgstab'
-      %  biconjugate gradients stabilized method
-      [ x, flag, relres, iter ] =  ...
-        bicgstab( afun, b,             obj.tol, obj.maxit, mfun, [], x0 );
-    case 'gmres'
-      %  generalized minimum residual method (with restarts)
-      [ x, flag, relres, iter ] =  ...
-          gmres( afun, b, obj.restart, obj.tol, obj.maxit, mfun, [], x0 );    
-    otherwise
-      error( 'iterative solver not known' );
+  if isstruct( afun )
+    %  iterative solution in C++, columns of b are solved simultaneously
+    op = struct( 'solver', obj.solver, 'tol', obj.tol, 'maxit', obj.maxit,  ...
+             'restart', obj.restart, 'diag', afun.diag, 'scale', afun.scale );
+    [ x, flag, relres, iter ] = itersolve( afun.mat, b, op, mfun, x0 );
+    %  statistics of column with slowest convergence
+    [ flag, relres, iter ] = deal( max( flag ), max( relres ), max( iter, [], 1 ) );
+  else
+    %  iterative solution through builtin Matlab functions
+    switch obj.solver
+      case 'cgs'
+        %  conjugate gradient solver
+        [ x, flag, relres, iter ] =  ...
+              cgs( afun, b,              obj.tol, obj.maxit, mfun, [], x0 );
+      case 'bicgstab'
+        %  biconjugate gradients stabilized method
+        [ x, flag, relres, iter ] =  ...
+          bicgstab( afun, b,             obj.tol, obj.maxit, mfun, [], x0 );
+      case 'gmres'
+        %  generalized minimum residual method (with restarts)
+        [ x, flag, relres, iter ] =  ...
+            gmres( afun, b, obj.restart, obj.tol, obj.maxit, mfun, [], x0 );    
+      otherwise
+        error( 'iterative solver not known' );
+    end
   end
 
   %  save statistics
@@ -28,6 +28,9 @@ classdef bemretiter < bembase & bemiter
     nvec        %  outer surface normal
     G1, H1      %  Green function and surface derivative inside  particle
     G2, H2      %  Green function and surface derivative outside particle
+    hmat        %  G1, G2, H1, H2 in C++ memory for native matrix multiplication,
+                %    Matlab copies of G1, G2, H1, H2 are then cleared
+    hop         %  wavenumber, normals and dielectric functions for HMATHANDLE
   end
   
   %%  Methods
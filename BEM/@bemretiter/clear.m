@@ -4,4 +4,4 @@ function obj = clear( obj )
 %  Usage for obj = bemretiter :
 %    obj = clear( obj )
 
-[ obj.G1, obj.H1, obj.G2, obj.H2, obj.sav ] = deal( [] );
+[ obj.G1, obj.H1, obj.G2, obj.H2, obj.sav, obj.hmat ] = deal( [] );
@@ -3,6 +3,9 @@ function vec = afun( obj, vec )
 %
 %  See, e.g. Garcia de Abajo and Howie, PRB  65, 115418 (2002).
 
+%  fused multiplication in C++, see HMATHANDLE
+if ~isempty( obj.hmat ),  vec = afun2( obj, vec );  return;  end
+
 [ n, siz ] = deal( obj.p.n, numel( vec ) / 2 );
 %  split vector array
 vec1 = reshape( vec(         1   : siz ), n, [] );
@@ -33,3 +36,22 @@ De = matmul( eps1, Hsig1 ) - matmul( eps2, Hsig2 ) -  ...
      
 %  pack into single vector
 vec = pack( obj, phi, a, De, alpha );
+
+
+function vec = afun2( obj, vec )
+%  AFUN2 - Matrix multiplication with Green functions in C++ memory.
+%    All products of Eqs. (10,11,14,17) are computed in a single pass
+%    through the H-matrix blocks.
+
+[ sig1, h1, sig2, h2 ] = unpack( obj, vec );
+[ n, siz ] = deal( obj.p.n, size( sig1, 2 ) );
+%  potentials [ sig1, h1, sig2, h2 ] for each excitation
+x = cat( 2, reshape( sig1, n, 1, siz ), reshape( h1, n, 3, siz ),  ...
+            reshape( sig2, n, 1, siz ), reshape( h2, n, 3, siz ) );
+%  BEM operator in cluster ordering
+tree = obj.hmat{ 1 }.tree;
+x = hmathandle( 'bemret', cellfun( @( h ) h.id, obj.hmat ),  ...
+                                 part2cluster( tree, reshape( x, n, [] ) ), obj.hop );
+x = reshape( cluster2part( tree, x ), n, 8, siz );
+%  pack into single vector
+vec = pack( obj, x( :, 1, : ), x( :, 2 : 4, : ), x( :, 5, : ), x( :, 6 : 8, : ) );
@@ -21,6 +21,11 @@ if isempty( obj.enei ) || obj.enei ~= enei
   obj.H1 = obj.g{ 1, 1 }.H1( enei ) - obj.g{ 2, 1 }.H1( enei );  obj = tocout( obj, 'H1' );
   obj.H2 = obj.g{ 2, 2 }.H2( enei ) - obj.g{ 1, 2 }.H2( enei );  obj = tocout( obj, 'H2' );
   
+  %  Green functions in C++ memory for native matrix multiplication
+  if obj.native && isa( obj.G1, 'hmatrix' ) && exist( 'hmathandle', 'file' ) == 3
+    obj = inithandle( obj );
+  end
+  
   %  initialize preconditioner
   if ~isempty( obj.precond ),  obj = initprecond( obj, enei );  end
   obj = tocout( obj, 'close' );
@@ -28,6 +33,24 @@ if isempty( obj.enei ) || obj.enei ~= enei
   %  save statistics
   obj = setstat( obj, 'G1', obj.G1 );  obj = setstat( obj, 'H1', obj.H1 );
   obj = setstat( obj, 'G2', obj.G2 );  obj = setstat( obj, 'H2', obj.H2 );
+  %  Green functions are only kept in C++ memory
+  if ~isempty( obj.hmat ),  [ obj.G1, obj.G2, obj.H1, obj.H2 ] = deal( [] );  end
 end
 
 
+function obj = inithandle( obj )
+%  INITHANDLE - Keep Green functions in C++ memory, see AFUN.
+
+%  Green functions with shared cluster tree
+hG1 = hmatrixhandle( obj.G1 );
+obj.hmat = { hG1, hmatrixhandle( obj.G2, hG1 ),  ...
+                  hmatrixhandle( obj.H1, hG1 ), hmatrixhandle( obj.H2, hG1 ) };
+%  conversion to cluster index
+tree = obj.G1.tree;
+fun = @( x ) part2cluster( tree, reshape( x, size( x, 1 ), [] ) );
+%  dielectric functions are either scalars or given for each boundary element
+[ eps1, eps2 ] = deal( obj.eps1, obj.eps2 );
+if numel( eps1 ) ~= 1,  eps1 = fun( eps1( : ) );  end
+if numel( eps2 ) ~= 1,  eps2 = fun( eps2( : ) );  end
+%  parameters of BEM operator
+obj.hop = struct( 'k', obj.k, 'nvec', fun( obj.nvec ), 'eps1', eps1, 'eps2', eps2 );
@@ -3,6 +3,11 @@ function obj = initprecond( obj, enei )
 % 
 %    See, e.g. Garcia de Abajo and Howie, PRB  65, 115418 (2002).
 
+%  compute preconditioner in C++ memory
+if strcmp( obj.precond, 'hmat' ) && ~isempty( obj.hmat )
+  obj = initprecond2( obj, enei );  return
+end
+
 %  wavenumber
 k = 2 * pi / enei;
 %  dielectric functions
@@ -74,3 +79,26 @@ nvec2 = spdiag( nvec( :, 2 ) );
 nvec3 = spdiag( nvec( :, 3 ) );
 
 Deltai = nvec1 * Deltai * nvec1 + nvec2 * Deltai * nvec2 + nvec3 * Deltai * nvec3;        
+
+
+function obj = initprecond2( obj, enei )
+%  INITPRECOND2 - Preconditioner for H-matrices in C++ memory.
+%    All intermediate matrices remain in C++, see HMATHANDLE.
+
+%  options, tolerance and maximal rank for low-rank matrices
+op = obj.hop;
+[ op.htol, op.kmax ] = deal( max( obj.op.htol ), min( obj.op.kmax ) );
+%  G1i, G2i, Sigma1, Deltai, Sigmai
+id = hmathandle( 'bemretprecond', cellfun( @( h ) h.id, obj.hmat ), op );
+h = arrayfun( @( id ) adopt( obj.hmat{ 1 }, id ), id, 'uniform', 0 );
+obj = tocout( obj, 'Sigmai' );
+
+%  save variables
+sav.k = 2 * pi / enei;
+sav.nvec = obj.p.nvec;
+[ sav.G1i, sav.G2i, sav.Sigma1, sav.Deltai, sav.Sigmai ] = deal( h{ : } );
+sav.eps1 = spdiag( obj.eps1 );
+sav.eps2 = spdiag( obj.eps2 );
+
+%  save structure
+obj.sav = sav;
@@ -26,6 +26,8 @@ classdef bemstatiter < bembase & bemiter
     g           %  Green function object
     lambda      %  resolvent matrix is - inv( lambda + F )
     mat         %  - inv( Lambda + F ) computed with H-matrix inversion
+    hF          %  F in C++ memory for native iterative solver
+    hmat        %  mat in C++ memory for native iterative solver
   end
   
   %%  Methods
@@ -5,3 +5,4 @@ function obj = clear( obj )
 %    obj = clear( obj )
 
 obj.mat = [];
+obj.hmat = [];
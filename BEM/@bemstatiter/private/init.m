@@ -28,6 +28,10 @@ obj.F = eval( obj.g, 'F' );
 obj.F.val = reshape( obj.F.val, [], 1 );
 %  add statistics
 obj = setstat( obj, 'F', obj.F );
+%  keep F in C++ memory for native iterative solver
+if obj.native && exist( 'hmathandle', 'file' ) == 3
+  obj.hF = hmatrixhandle( obj.F );
+end
 
 %  initialize for given wavelength
 if exist( 'enei', 'var' ) && ~isempty( enei )
@@ -23,6 +23,8 @@ if isempty( obj.enei ) || obj.enei ~= enei
         [ F.htol, F.kmax ] = deal( max( obj.op.htol ), min( obj.op.kmax ) );
         %  initialize preconditioner
         obj.mat = lu( - lambda - F );
+        %  preconditioner in C++ memory for native iterative solver
+        if ~isempty( obj.hF ),  obj.hmat = hmatrixhandle( obj.mat, obj.hF, true );  end
         %  save statistics for H-matrix operation
         obj = setstat( obj, 'mat', obj.mat );
       case 'full'
@@ -18,6 +18,13 @@ fa = @( x ) afun( obj, x );
 fm = [];
 %  function for preconditioner
 if ~isempty( obj.precond ), fm = @( x ) mfun( obj, x ); end
+%  iterative solution in C++ with A = - ( F + lambda )
+if ~isempty( obj.hmat ) && strcmp( obj.precond, 'hmat' ) &&  ...
+                                  obj.maxit ~= 0 && ~isempty( obj.solver )
+  fa = struct( 'mat', obj.hF, 'diag', obj.lambda( : ), 'scale', -1 );
+  fm = obj.hmat;
+  b = reshape( b, obj.p.n, [] );
+end
 
 %  iterative solution 
 [ x, obj ] = solve@bemiter( obj, [], b, fa, fm );
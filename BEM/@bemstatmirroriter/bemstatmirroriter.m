@@ -0,0 +1,59 @@
+classdef bemstatmirroriter < bembase & bemiter
+  %  Iterative BEM solver for quasistatic approximation and mirror symmetry.
+  %    Given an external excitation, BEMSTATMIRRORITER computes the surface
+  %    charges such that the boundary conditions of Maxwell's equations
+  %    in the quasistatic approximation are fulfilled.  The surface
+  %    derivative of the Green function is an H-matrix of the reduced
+  %    particle for each symmetry value, see ACA.COMPGREENSTATMIRROR, and
+  %    Maxwell's equations are solved iteratively.
+
+  %%  Properties
+  properties (Constant)
+    name = 'bemsolver'
+    needs = { struct( 'sim', 'stat' ), 'sym', 'iter' }
+  end
+
+  properties
+    p           %  composite particle (see COMPARTICLEMIRROR)
+    F           %  surface derivatives of Green function for symmetry values
+    enei        %  light wavelength in vacuum
+                %    to determine whether new computation of matrices     
+  end
+  
+  properties (Access = private)
+    op          %  option structure
+    g           %  Green function object
+    lambda      %  resolvent matrix is - inv( lambda + F )
+    mat         %  - inv( Lambda + F ) computed with H-matrix LU
+    hF          %  F in C++ memory for native iterative solver
+    hmat        %  mat in C++ memory for native iterative solver
+  end
+  
+  %%  Methods
+  methods  
+    function obj = bemstatmirroriter( varargin )
+      %  Initialize quasistatic, iterative BEM solver with mirror symmetry.
+      %
+      %  Usage :
+      %    obj = bemstatmirroriter( p,       op, PropertyPairs )
+      %    obj = bemstatmirroriter( p, [],   op, PropertyPairs )
+      %    obj = bemstatmirroriter( p, enei, op, PropertyPairs )
+      %  Input
+      %    p    :  compound of particles with mirror symmetry
+      %    enei :  light wavelength in vacuum
+      %    op   :  options 
+      %              additional fields of the option array can be passed as
+      %              pairs of PropertyName and Propertyvalue
+      obj = obj@bemiter( varargin{ 2 : end } );
+      obj = init( obj, varargin{ : } );
+    end
+    
+    function disp( obj )
+      %  Command window display.
+      disp( 'bemstatmirroriter : ' );
+      disp( struct( 'p', obj.p, 'F', { obj.F },  ...
+                           'solver', obj.solver, 'tol', obj.tol ) );
+    end
+  end
+  
+end
@@ -0,0 +1,8 @@
+function obj = clear( obj )
+%  CLEAR - Clear auxiliary matrices.
+%
+%  Usage for obj = bemstatmirroriter :
+%    obj = clear( obj )
+
+obj.mat = [];
+obj.hmat = [];
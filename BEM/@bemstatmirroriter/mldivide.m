@@ -0,0 +1,11 @@
+function [ sig, obj ] = mldivide( obj, exc )
+%  Surface charge for given excitation.
+%
+%  Usage for obj = bemstatmirroriter :
+%    [ sig, obj ] = obj \ exc
+%  Input
+%    exc    :  COMPSTRUCTMIRROR with field 'phip' for external excitation
+%  Output
+%    sig    :  COMPSTRUCTMIRROR with field for surface charge
+
+[ sig, obj ] = solve( obj, exc );
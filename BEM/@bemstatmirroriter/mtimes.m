@@ -0,0 +1,16 @@
+function phi = mtimes( obj, sig )
+%  Induced potential for given surface charge.
+%
+%  Usage for obj = bemstatmirroriter :
+%    phi = obj * sig
+%  Input
+%    sig    :  COMPSTRUCTMIRROR with fields for surface charge
+%  Output
+%    phi    :  COMPSTRUCTMIRROR with fields for induced potential
+
+phi  = potential( obj, sig, 1 );
+phi2 = potential( obj, sig, 2 );
+
+for i = 1 : length( sig.val )
+  phi.val{ i } = phi.val{ i } + phi2.val{ i };
+end
@@ -0,0 +1,43 @@
+function pot = potential( obj, sig, inout )
+%  Determine potentials and surface derivatives inside/outside of particle.
+%    Computed from solutions of Maxwell equations within the
+%    quasistatic approximation.
+%
+%  Usage for obj = bemstatmirroriter :
+%    pot = potential( obj, sig, inout )
+%  Input
+%    sig        :  COMPSTRUCTMIRROR with surface charges
+%    inout      :  potential inside (inout = 1) or
+%                           outside (inout = 2, default) of particle
+%  Output
+%    pot        :  COMPSTRUCTMIRROR object with potentials
+
+if ~exist( 'inout', 'var' ),  inout = 2;  end
+%  allocate output array
+pot = compstructmirror( sig.p, sig.enei, sig.fun );
+
+%  set parameters that depend on inside/outside
+H = subsref( { 'H1', 'H2' }, substruct( '{}', { inout } ) );
+%  H-matrices of Green function and surface derivative
+G = eval( obj.g, 'G' );
+H = eval( obj.g,  H  );
+
+matmul = @( x, y ) reshape( x * reshape( y, size( y, 1 ), [] ), size( y ) );
+%  loop over surface charges
+for i = 1 : length( sig.val )
+  %  surface charge
+  isig = sig.val{ i };
+  %  get symmetry value
+  ind = obj.p.symindex( isig.symval( end, : ) );
+  %  potential and surface derivative
+  phi  = matmul( G{ ind }, isig.sig );
+  phip = matmul( H{ ind }, isig.sig );
+
+  if inout == 1
+    pot.val{ i } = compstruct( sig.p, sig.enei, 'phi1', phi, 'phi1p', phip );
+  else
+    pot.val{ i } = compstruct( sig.p, sig.enei, 'phi2', phi, 'phi2p', phip );  
+  end
+  %  set symmetry value
+  pot.val{ i }.symval = isig.symval;
+end
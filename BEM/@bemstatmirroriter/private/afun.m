@@ -0,0 +1,8 @@
+function vec = afun( obj, ind, vec )
+%  AFUN - Matrix multiplication for CGS, BICGSTAB, GMRES.
+
+%  unpack vector
+vec = reshape( vec, obj.p.n, [] );
+%  - ( lambda + F ) * vec for symmetry value
+vec = - ( obj.F{ ind } * vec + bsxfun( @times, vec, obj.lambda( : ) ) );
+vec = reshape( vec, [], 1 );
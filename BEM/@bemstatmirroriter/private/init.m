@@ -0,0 +1,46 @@
+function obj = init( obj, p, varargin )
+%  INIT - Initialize quasistatic, iterative BEM solver with mirror symmetry.
+%
+%  Usage for obj = bemstatmirroriter :
+%    obj = init( obj, p,       op, PropertyName, PropertyValue, ... )
+%    obj = init( obj, p, [],   op, PropertyName, PropertyValue, ... )
+%    obj = init( obj, p, enei, op, PropertyName, PropertyValue, ... )
+%  Input
+%    p    :  compound of particles with mirror symmetry
+%    enei :  light wavelength in vacuum
+%    op   :  options 
+%              additional fields of the option array can be passed as
+%              pairs of PropertyName and Propertyvalue
+
+%  save particle
+obj.p = p;
+
+%  handle calls with and without ENEI
+if ~isempty( varargin ) && isnumeric( varargin{ 1 } )
+  [ enei, varargin ] = deal( varargin{ 1 }, varargin( 2 : end ) );
+end
+
+obj.op = getbemoptions( { 'iter', 'bemiter' }, varargin{ : } );
+%  Green function
+obj.g = aca.compgreenstatmirror( p, varargin{ : },  ...
+                          'htol', min( obj.op.htol ), 'kmax', max( obj.op.kmax ) );
+%  surface derivatives of Green function for symmetry values
+obj.F = eval( obj.g, 'F' );
+for i = 1 : numel( obj.F )
+  obj.F{ i }.val = reshape( obj.F{ i }.val, [], 1 );
+  %  add statistics
+  obj = setstat( obj, 'F', obj.F{ i } );
+end
+%  keep F in C++ memory for native iterative solver, shared cluster tree
+if obj.native && exist( 'hmathandle', 'file' ) == 3
+  obj.hF = cell( size( obj.F ) );
+  obj.hF{ 1 } = hmatrixhandle( obj.F{ 1 } );
+  for i = 2 : numel( obj.F )
+    obj.hF{ i } = hmatrixhandle( obj.F{ i }, obj.hF{ 1 } );
+  end
+end
+
+%  initialize for given wavelength
+if exist( 'enei', 'var' ) && ~isempty( enei )
+  obj = initmat( obj, enei );
+end
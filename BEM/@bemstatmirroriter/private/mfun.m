@@ -0,0 +1,16 @@
+function vec = mfun( obj, ind, vec )
+%  MFUN - Preconditioner for CGS, BICGSTAB, GMRES.
+%
+%  For the precoditioner we solve the BEM equations using the H-matrix LU
+%  decomposition of the resolvent matrix for the given symmetry value.
+
+vec = reshape( vec, obj.p.n, [] );
+%  preconditioner
+switch obj.precond
+  case 'hmat'
+    vec = solve( obj.mat{ ind }, vec );
+  case 'full'
+    vec = obj.mat{ ind } * vec;
+end
+%  pack vector
+vec = vec( : );
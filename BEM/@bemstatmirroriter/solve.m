@@ -0,0 +1,43 @@
+function [ sig, obj ] = solve( obj, exc )
+%  SOLVE - Solve BEM equations for given excitation.
+%
+%  Usage for obj = bemstatmirroriter :
+%    [ sig, obj ] = solve( obj, exc )
+%  Input
+%    exc    :  COMPSTRUCTMIRROR with fields for external excitation
+%  Output
+%    sig    :  COMPSTRUCTMIRROR with fields for surface charge
+
+%  initialize BEM solver (if needed)
+obj = subsref( obj, substruct( '()', { exc.enei } ) );
+%  initialize surface charges
+sig = compstructmirror( obj.p, exc.enei, exc.fun );
+
+%  loop over excitations
+for i = 1 : length( exc.val )
+  %  index of symmetry value
+  ind = obj.p.symindex( exc.val{ i }.symval( end, : ) );
+  %  excitation and size of excitation array
+  [ b, siz ] = deal( exc.val{ i }.phip( : ), size( exc.val{ i }.phip ) );
+ 
+  %  function for matrix multiplication 
+  fa = @( x ) afun( obj, ind, x );
+  fm = [];
+  %  function for preconditioner
+  if ~isempty( obj.precond ), fm = @( x ) mfun( obj, ind, x ); end
+  %  iterative solution in C++ with A = - ( F + lambda )
+  if ~isempty( obj.hmat ) && strcmp( obj.precond, 'hmat' ) &&  ...
+                                    obj.maxit ~= 0 && ~isempty( obj.solver )
+    fa = struct( 'mat', obj.hF{ ind }, 'diag', obj.lambda( : ), 'scale', -1 );
+    fm = obj.hmat{ ind };
+    b = reshape( b, obj.p.n, [] );
+  end
+
+  %  iterative solution 
+  [ x, obj ] = solve@bemiter( obj, [], b, fa, fm );
+  
+  %  surface charge
+  sig.val{ i } = compstruct( obj.p, exc.enei, 'sig', reshape( x, siz ) );
+  %  set symmetry value
+  sig.val{ i }.symval = exc.val{ i }.symval;
+end
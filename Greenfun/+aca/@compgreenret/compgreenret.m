@@ -3,7 +3,8 @@ classdef compgreenret
   
   %%  Properties
   properties
-    p       %  COMPARTICLE object
+    p       %  COMPARTICLE object, COMPOINT for rows of rectangular matrix
+    p2      %  COMPARTICLE for columns of rectangular matrix, empty otherwise
     g       %  Green functions connecting particle boundaries
     hmat    %  template for H-matrix     
   end
@@ -14,9 +15,12 @@ classdef compgreenret
       %  Initialize Green functions for composite objects.
       %  
       %  Usage :
-      %    obj = aca.compgreenret( p, op )
+      %    obj = aca.compgreenret( p,     op )
+      %    obj = aca.compgreenret( p, p2, op )
       %  Input
-      %    p    :  COMPARTICLE object
+      %    p    :  COMPARTICLE object, or COMPOINT object for evaluation
+      %              points of rectangular Green function matrix
+      %    p2   :  COMPARTICLE object for columns of rectangular matrix
       %    op   :  options (see BEMOPTIONS) 
       obj = init( obj, varargin{ : } );      
     end
@@ -24,7 +28,7 @@ classdef compgreenret
     function disp( obj )
       %  Command window display.
       disp( 'aca.compgreenret : ' );
-      disp( struct( 'p', obj.p, 'g', { obj.g }, 'hmat', obj.hmat ) );
+      disp( struct( 'p', obj.p, 'p2', obj.p2, 'g', { obj.g }, 'hmat', obj.hmat ) );
     end
   end
   
@@ -12,34 +12,55 @@ function hmat = eval( obj, i, j, key, enei )
 %              H1   -  F + 2 * pi
 %              H2   -  F - 2 * pi
 %    enei   :  light wavelength in vacuum
+%
+%  For rectangular matrices (evaluation points vs. boundary elements) only
+%  G, and F for particle rows, are implemented.
 
 [ p, hmat ] = deal( obj.p, obj.hmat );
+%  particle and cluster tree for columns
+[ p2, tree2 ] = deal( obj.p2, hmat.tree2 );
+if isempty( p2 ),  [ p2, tree2 ] = deal( p, hmat.tree );  end
+if ~isempty( obj.p2 ) && ~( strcmp( key, 'G' ) || ( strcmp( key, 'F' ) && ~isa( p, 'compoint' ) ) )
+  error( '%s not implemented for rectangular aca.compgreenret', key );
+end
+
+%  connectivity matrix
+con = obj.g.con{ i, j };
+%  symmetric storage of area-weighted Green function for symmetric connectivity,
+%    set before the full matrices such that only the lower ones are computed
+hmat.area = [];
+if hmat.hsym && strcmp( key, 'G' ) && isequal( con, con .' ) && isempty( obj.p2 )
+  hmat.area = reshape( p.area( hmat.tree.ind( :, 1 ) ), [], 1 );
+end
+
 %  fill full matrices
-fun = @( row, col ) eval( obj.g, i, j, key, enei, sub2ind( [ p.n, p.n ], row, col ) );
+fun = @( row, col ) eval( obj.g, i, j, key, enei, sub2ind( [ p.n, p2.n ], row, col ) );
 %  compute full matrices
 hmat = fillval( hmat, fun );
 
-%  size of clusters
+%  size of row and column clusters
 tree = hmat.tree;
-siz = tree.cind( :, 2 ) - tree.cind( :, 1 ) + 1;
+siz1 = tree.cind( :, 2 ) - tree.cind( :, 1 ) + 1;
+siz2 = tree2.cind( :, 2 ) - tree2.cind( :, 1 ) + 1;
 %  allocate low-rank matrices
-hmat.lhs = arrayfun( @( x ) zeros( x, 1 ), siz( hmat.row2 ), 'uniform', 0 );
-hmat.rhs = arrayfun( @( x ) zeros( x, 1 ), siz( hmat.col2 ), 'uniform', 0 );
+hmat.lhs = arrayfun( @( x ) zeros( x, 1 ), siz1( hmat.row2 ), 'uniform', 0 );
+hmat.rhs = arrayfun( @( x ) zeros( x, 1 ), siz2( hmat.col2 ), 'uniform', 0 );
 
 
-%  connectivity matrix
-con = obj.g.con{ i, j };
 %  evaluate dielectric functions to get wavenumbers
 [ ~, k ] = cellfun( @( eps ) ( eps( enei ) ), obj.p.eps, 'uniform', 1 );
 %  place wavevectors into cell array
 con( con == 0 ) = nan;  con( ~isnan( con ) ) = k( con( ~isnan( con ) ) );
 
 %  particle structure for MEX function call
-ind = hmat.tree.ind( :, 1 );
-pmex = struct( 'pos', p.pos( ind, : ), 'nvec', p.nvec( ind, : ), 'area', p.area( ind ) );
+pmex = aca.partmex( p, tree.ind( :, 1 ) );
+%  particles for rows and columns of rectangular matrix
+if ~isempty( obj.p2 ),  pmex = [ pmex, aca.partmex( p2, tree2.ind( :, 1 ) ) ];  end
 %  tree indices and options for MEX function call
 tmex = treemex( hmat );
 op = struct( 'htol', hmat.htol, 'kmax', hmat.kmax );
+%  symmetric storage
+op.hsym = ~isempty( hmat.area );
 
 for i = 1 : size( con, 1 )
 for j = 1 : size( con, 2 )
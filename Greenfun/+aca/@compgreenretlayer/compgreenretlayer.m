@@ -14,6 +14,8 @@ classdef compgreenretlayer
     ind           %  starting cluster index for given particle
     rmod = 'log'  %  'log' for logspace r-table or 'lin' for linspace
     zmod = 'log'  %  'log' for logspace z-table or 'lin' for linspace    
+    imod = 'linear'   %  'linear' or 'cubic' interpolation of tables
+    tabcache = false  %  keep tables in MEX cache, or directory for table files
   end
   
   %%  Methods  
@@ -0,0 +1,40 @@
+function tab = cachekey( obj, tab, name, enei )
+%  CACHEKEY - Add key for table cache to MEX table structure.
+%
+%    With the option tabcache the MEX functions keep the interpolation
+%    tables between calls.  The key identifies layer structure, wavelength
+%    and table grid, such that tables can be reused for different
+%    particles.  If tabcache is a directory name, the tables are also
+%    stored in files which can be used by later sessions.
+%
+%  Usage for obj = aca.compgreenretlayer :
+%    tab = cachekey( obj, tab, name, enei )
+%  Input
+%    tab    :  table structure for MEX function call
+%    name   :  name of Green function table, including table index
+%    enei   :  wavelength of light in vacuum
+%  Output
+%    tab    :  table structure with fields key and cachedir
+
+%  no caching
+if isequal( obj.tabcache, false ),  return;  end
+
+layer = obj.layer;
+%  dielectric functions of layer structure
+eps = cellfun( @( fun ) fun( enei ), layer.eps );
+%  numeric options of ODE integration
+op = [];
+if isstruct( layer.op )
+  op = struct2cell( layer.op );
+  op = [ op{ cellfun( @( x ) isnumeric( x ) && isscalar( x ), op ) } ];
+end
+%  first and last value, sum and number of table entries, the sum
+%  distinguishes grids with different (piecewise-uniform) spacing
+grid = cellfun( @( x ) [ x( 1 ), x( end ), sum( x ), numel( x ) ],  ...
+                              { tab.r, tab.z1, tab.z2 }, 'uniform', 0 );
+%  key for table cache
+tab.key = [ name, ':', sprintf( '%.15g,', enei, real( eps ), imag( eps ),  ...
+  layer.z, layer.rmin, layer.zmin, layer.semi, layer.ratio, op, grid{ : } ),  ...
+                                                       obj.rmod, obj.zmod ];
+%  directory for table files
+if ischar( obj.tabcache ),  tab.cachedir = obj.tabcache;  end
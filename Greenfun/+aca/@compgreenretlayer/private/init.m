@@ -7,6 +7,9 @@ op = getbemoptions( varargin{ : } );
 %  grid for tabulated Green functions
 if isfield( op, 'rmod' ),  obj.rmod = op.rmod;  end
 if isfield( op, 'zmod' ),  obj.zmod = op.zmod;  end
+if isfield( op, 'imod' ),  obj.imod = op.imod;  end
+%  cache for tabulated Green functions in MEX files
+if isfield( op, 'tabcache' ),  obj.tabcache = op.tabcache;  end
 %  initialize COMPGREEN object 
 obj.g = compgreenretlayer( p, p, varargin{ : } );
 
@@ -23,10 +23,10 @@ lhs = arrayfun( @( x ) zeros( x, 1 ), siz( hmat.row2 ), 'uniform', 0 );
 rhs = arrayfun( @( x ) zeros( x, 1 ), siz( hmat.col2 ), 'uniform', 0 );
 
 %  COMPGREENTABLAYER object
-%    table of reflected Green function, use INSIDE to select cell index
-gtab = eval( obj.g.gr.tab, enei );
-%   multiply Green function with distance-dependent factors
-[ g, fr, fz ] = cellfun( @( gtab ) norm( gtab ), gtab.g, 'uniform', 1 );
+%    table of reflected Green function, use INSIDE to select cell index,
+%    tables are only evaluated if not kept in table cache of MEX function
+gtab = obj.g.gr.tab;
+[ g, fr, fz ] = deal( cell( size( gtab.g ) ) );
 %  minimum distance to layer structure
 z = mindist( obj.layer, round( obj.layer, p.pos( :, 3 ) ) );
 
@@ -53,21 +53,29 @@ for i2 = 1 : p.np
   %  reshape function
   fun = @( x ) x( : );
   
+  %  table structure without values, key for table cache of MEX function
+  itab = inside( gtab, 0, z1, z2 );
+  tab = struct( 'r', gtab.g{ itab }.r, 'rmod', obj.rmod,  ...
+    'z1', gtab.g{ itab }.z1, 'z2', gtab.g{ itab }.z2, 'zmod', obj.zmod, 'imod', obj.imod );
+  tab = cachekey( obj, tab, [ name, num2str( itab ) ], enei );
+  %  evaluate table and multiply Green function with distance-dependent
+  %    factors, unless table is cached
+  if isempty( g{ itab } ) && ~incache( key, tab )
+    [ g{ itab }, fr{ itab }, fz{ itab } ] = norm( eval( gtab.g{ itab }, enei ) );
+  end
+  
   %  compute low-rank matrix using ACA
   switch key
     case 'G'
       %  tabulated Green functions
-      tab = gtab.g{ inside( gtab, 0, z1, z2 ) };
-      tab = struct( 'r', tab.r, 'rmod', obj.rmod,  ...
-        'z1', tab.z1, 'z2', tab.z2, 'zmod', obj.zmod, 'G', fun( g.( name ) ) );
+      if ~isempty( g{ itab } ),  tab.G = fun( g{ itab }.( name ) );  end
       %  compute Green function
       [ L, R ] = hmatgreentab1( pmex, tmex, row, col, tab, ind1, ind2, op );  
     case { 'F', 'H1', 'H2' }
       %  tabulated surface derivatives of Green functions
-      tab = gtab.g{ inside( gtab, 0, z1, z2 ) };
-      tab = struct( 'r', tab.r, 'rmod', obj.rmod,  ...
-        'z1', tab.z1, 'z2', tab.z2, 'zmod', obj.zmod, 'Fr', fun( fr.( name ) ),  ...
-                                                      'Fz', fun( fz.( name ) ) );
+      if ~isempty( fr{ itab } )
+        [ tab.Fr, tab.Fz ] = deal( fun( fr{ itab }.( name ) ), fun( fz{ itab }.( name ) ) );
+      end
       %  compute surface derivative of Green function
       [ L, R ] = hmatgreentab2( pmex, tmex, row, col, tab, ind1, ind2, op );
   end        
@@ -79,3 +87,17 @@ for i2 = 1 : p.np
   rhs( ind ) = R( ind );
 end
 end
+
+
+function in = incache( key, tab )
+%  INCACHE - Table kept in table cache of MEX function ?
+
+in = isfield( tab, 'key' );
+if in
+  switch key
+    case 'G'
+      in = hmatgreentab1( tab );
+    otherwise
+      in = hmatgreentab2( tab );
+  end
+end
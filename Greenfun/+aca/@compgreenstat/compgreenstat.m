@@ -4,7 +4,8 @@ classdef compgreenstat
   %%  Properties
 
   properties
-    p       %  COMPARTICLE object
+    p       %  COMPARTICLE object, COMPOINT for rows of rectangular matrix
+    p2      %  COMPARTICLE for columns of rectangular matrix, empty otherwise
     g       %  COMPGREENSTAT object
     hmat    %  template for H-matrix
   end
@@ -15,9 +16,12 @@ classdef compgreenstat
       %  Initialize Green function for COMPARTICLE.
       %  
       %  Usage :
-      %    obj = compgreenstat( p, op )
+      %    obj = compgreenstat( p,     op )
+      %    obj = compgreenstat( p, p2, op )
       %  Input
-      %    p    :  COMPARTICLE object
+      %    p    :  COMPARTICLE object, or COMPOINT object for evaluation
+      %              points of rectangular Green function matrix
+      %    p2   :  COMPARTICLE object for columns of rectangular matrix
       %    op   :  options (see BEMOPTIONS)
       obj = init( obj, varargin{ : } );      
     end
@@ -25,7 +29,7 @@ classdef compgreenstat
     function disp( obj )
       %  Command window display.
       disp( 'aca.compgreenstat : ' );
-      disp( struct( 'p', obj.p, 'g', obj.g, 'hmat', obj.hmat ) );
+      disp( struct( 'p', obj.p, 'p2', obj.p2, 'g', obj.g, 'hmat', obj.hmat ) );
     end    
   end
   
@@ -11,9 +11,13 @@ function varargout = eval( obj, varargin )
 %              H2   -  F - 2 * pi
 %  Output
 %    varargout  :  requested Green functions
+%
+%  For rectangular matrices (evaluation points vs. boundary elements) only
+%  G, and F for particle rows, are implemented.
 
-%  particle 
+%  particles for rows and columns
 p = obj.p;
+p2 = obj.p2;  if isempty( p2 ),  p2 = p;  end
 %  options for ACA
 hmat = obj.hmat;
 op = struct( 'htol', min( hmat.htol ), 'kmax', max( hmat.kmax ) );
@@ -25,24 +29,41 @@ for i = 1 : numel( varargout )
   if strcmp( varargin{ i }, 'Gp' )
     error( 'Gp not implemented for aca.compgreenstat' );  
   end
+  if ~isempty( obj.p2 ) && ~( strcmp( varargin{ i }, 'G' ) ||  ...
+                            ( strcmp( varargin{ i }, 'F' ) && ~isa( p, 'compoint' ) ) )
+    error( '%s not implemented for rectangular aca.compgreenstat', varargin{ i } );
+  end
   
+  %  symmetric storage of area-weighted Green function, set before the full
+  %    matrices such that only the lower ones are computed
+  hmat.area = [];
+  if strcmp( varargin{ i }, 'G' ) && hmat.hsym && isempty( obj.p2 )
+    hmat.area = reshape( p.area( hmat.tree.ind( :, 1 ) ), [], 1 );
+  end
   %  fill full matrices
-  fun = @( row, col ) eval( obj.g, sub2ind( [ p.n, p.n ], row, col ), varargin{ i } );
+  fun = @( row, col ) eval( obj.g, sub2ind( [ p.n, p2.n ], row, col ), varargin{ i } );
   %  compute full matrices
   hmat = fillval( hmat, fun );  
   
   %  particle structure for MEX function call
-  ind = hmat.tree.ind( :, 1 );
-  pmex = struct( 'pos', p.pos( ind, : ), 'nvec', p.nvec( ind, : ), 'area', p.area( ind ) );
+  pmex = aca.partmex( p, hmat.tree.ind( :, 1 ) );
+  %  particles for rows and columns of rectangular matrix
+  if ~isempty( obj.p2 )
+    pmex = [ pmex, aca.partmex( p2, hmat.tree2.ind( :, 1 ) ) ];
+  end
   %  tree and cluster indices for MEX function call
   tmex = treemex( hmat );
   %  compute low-rank approximation
   switch varargin{ i }
     case 'G'
-      [ hmat.lhs, hmat.rhs ] = hmatgreenstat( pmex, tmex, 'G', op );
+      op.hsym = ~isempty( hmat.area );
+      [ hmat.lhs, hmat.rhs, hstat ] = hmatgreenstat( pmex, tmex, 'G', op );
     case { 'F', 'H1', 'H2' }
-      [ hmat.lhs, hmat.rhs ] = hmatgreenstat( pmex, tmex, 'F', op );
+      op.hsym = false;
+      [ hmat.lhs, hmat.rhs, hstat ] = hmatgreenstat( pmex, tmex, 'F', op );
   end
+  %  block and ACA statistics of low-rank matrices
+  hmat.stat = struct( 'hstat', hstat );
  
   %  assign output
   varargout{ i } = hmat;
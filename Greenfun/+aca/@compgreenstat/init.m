@@ -1,12 +1,23 @@
 function obj = init( obj, p, varargin )
 %  INIT - initialize composite Green function.
 
+%  particle for columns of rectangular matrix
+if ~isempty( varargin ) && isa( varargin{ 1 }, 'compound' )
+  [ obj.p2, varargin ] = deal( varargin{ 1 }, varargin( 2 : end ) );
+end
 %  save particle
 obj.p = p;
-%  initialize COMPGREEN object
-obj.g = compgreenstat( p, p, varargin{ : } );
 
-%  make cluster tree
-tree = clustertree( p, varargin{ : } );
-%  template for H-matrix
-obj.hmat = hmatrix( tree, varargin{ : } );
+%  square Green function matrix
+if isempty( obj.p2 )
+  %  initialize COMPGREEN object
+  obj.g = compgreenstat( p, p, varargin{ : } );
+  %  template for H-matrix
+  obj.hmat = hmatrix( clustertree( p, varargin{ : } ), varargin{ : } );
+else
+  %  initialize COMPGREEN object
+  obj.g = compgreenstat( p, obj.p2, varargin{ : } );
+  %  template for H-matrix with row and column cluster trees
+  obj.hmat = hmatrix( clustertree( p,      varargin{ : } ),  ...
+                      clustertree( obj.p2, varargin{ : } ), varargin{ : } );
+end
@@ -0,0 +1,37 @@
+classdef compgreenstatmirror 
+  %  Green function for particle with mirror symmetry in quasistatic
+  %  approximation using ACA.
+
+  %%  Properties
+
+  properties
+    p       %  COMPARTICLEMIRROR object
+    g       %  COMPGREENSTAT object connecting p and full( p )
+    hmat    %  template for H-matrix
+  end
+    
+  %%  Methods  
+  methods 
+    function obj = compgreenstatmirror( varargin )
+      %  Initialize Green function for COMPARTICLEMIRROR.
+      %  
+      %  Usage :
+      %    obj = compgreenstatmirror( p, op )
+      %  Input
+      %    p    :  COMPARTICLEMIRROR object
+      %    op   :  options (see BEMOPTIONS)
+      obj = init( obj, varargin{ : } );      
+    end
+    
+    function disp( obj )
+      %  Command window display.
+      disp( 'aca.compgreenstatmirror : ' );
+      disp( struct( 'p', obj.p, 'g', obj.g, 'hmat', obj.hmat ) );
+    end    
+  end
+  
+  methods (Access = private)
+    obj = init( obj, varargin );
+  end
+    
+end
@@ -0,0 +1,54 @@
+function g = eval( obj, key )
+%  EVAL - Evaluate Green function with mirror symmetry.
+%
+%  Usage for obj = aca.compgreenstatmirror :
+%    g = eval( obj, key )
+%  Input
+%    key    :  G    -  Green function
+%              F    -  Surface derivative of Green function
+%              H1   -  F + 2 * pi
+%              H2   -  F - 2 * pi
+%  Output
+%    g      :  cell array of H-matrices for the different symmetry values
+
+[ p, hmat ] = deal( obj.p, obj.hmat );
+%  symmetry table
+tab = p.symtable;
+%  options for ACA
+op = struct( 'htol', min( hmat.htol ), 'kmax', max( hmat.kmax ) );
+
+%  particle structure for MEX function call
+ind = hmat.tree.ind( :, 1 );
+pmex = struct( 'pos', p.pos( ind, : ), 'nvec', p.nvec( ind, : ), 'area', p.area( ind ),  ...
+               'mirror', aca.mirrortable( p ), 'symtable', tab );
+%  tree and cluster indices for MEX function call
+tmex = treemex( hmat );
+%  low-rank matrices for all symmetry values, mirror images are
+%    summed up inside of MEX function
+switch key
+  case 'G'
+    [ lhs, rhs ] = hmatgreenstat( pmex, tmex, 'G', op );
+  case { 'F', 'H1', 'H2' }
+    [ lhs, rhs ] = hmatgreenstat( pmex, tmex, 'F', op );
+end
+
+%  allocate output
+g = cell( 1, size( tab, 1 ) );
+%  loop over symmetry values
+for i = 1 : size( tab, 1 )
+  %  fill full matrices
+  fun = @( row, col ) contract( obj.g, p.n, tab( i, : ), row, col, key );
+  g{ i } = fillval( hmat, fun );
+  %  set low-rank matrices
+  [ g{ i }.lhs, g{ i }.rhs ] = deal( lhs( :, i ), rhs( :, i ) );
+end
+
+
+function val = contract( g, n, tab, row, col, key )
+%  CONTRACT - Contract Green function elements for given symmetry values.
+
+val = 0;
+for j = 1 : numel( tab )
+  val = val + tab( j ) *  ...
+    eval( g, sub2ind( [ n, numel( tab ) * n ], row, col + ( j - 1 ) * n ), key );
+end
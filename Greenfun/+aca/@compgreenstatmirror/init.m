@@ -0,0 +1,12 @@
+function obj = init( obj, p, varargin )
+%  INIT - initialize composite Green function with mirror symmetry.
+
+%  save particle
+obj.p = p;
+%  initialize COMPGREEN object
+obj.g = compgreenstat( p, full( p ), varargin{ : } );
+
+%  make cluster tree for reduced particle
+tree = clustertree( p, varargin{ : } );
+%  template for H-matrix
+obj.hmat = hmatrix( tree, varargin{ : } );
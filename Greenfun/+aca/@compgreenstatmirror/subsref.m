@@ -0,0 +1,17 @@
+function varargout = subsref( obj, s )
+%  Derived properties for objects of class compgreenstatmirror.
+%
+%  Usage for obj = aca.compgreenstatmirror :
+%    obj.G                  :  H-matrices for different symmetry values
+%
+%    works for { G, F, H1, H2 } 
+
+switch s( 1 ).type
+  case '.'  
+    switch s( 1 ).subs
+      case { 'G', 'F', 'H1', 'H2' }
+        varargout{ 1 } = eval( obj, s.subs );
+      otherwise
+        [ varargout{ 1 : nargout } ]  = builtin( 'subsref', obj, s );
+    end
+end
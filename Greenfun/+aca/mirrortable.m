@@ -0,0 +1,19 @@
+function tab = mirrortable( p )
+%  MIRRORTABLE - Sign changes of mirror operations for MEX functions.
+%
+%  Usage :
+%    tab = aca.mirrortable( p )
+%  Input
+%    p      :  COMPARTICLEMIRROR object
+%  Output
+%    tab    :  sign changes of (x,y,z) coordinates for the mirror
+%              operations, ordered as the particles in FULL( p )
+
+switch p.sym
+  case 'x'
+    tab = [ 1, 1, 1; - 1, 1, 1 ];
+  case 'y'
+    tab = [ 1, 1, 1; 1, - 1, 1 ];
+  case 'xy'
+    tab = [ 1, 1, 1; - 1, 1, 1; 1, - 1, 1; - 1, - 1, 1 ];
+end
@@ -0,0 +1,17 @@
+function pmex = partmex( p, ind )
+%  PARTMEX - Particle structure for MEX functions in cluster ordering.
+%
+%  Usage :
+%    pmex = aca.partmex( p, ind )
+%  Input
+%    p      :  COMPARTICLE or COMPOINT object
+%    ind    :  conversion from cluster index to particle index
+%  Output
+%    pmex   :  structure with positions, normal vectors and areas,
+%              normal vectors and areas are empty for evaluation points
+
+if isa( p, 'compoint' )
+  pmex = struct( 'pos', p.pos( ind, : ), 'nvec', [], 'area', [] );
+else
+  pmex = struct( 'pos', p.pos( ind, : ), 'nvec', p.nvec( ind, : ), 'area', p.area( ind ) );
+end
@@ -28,6 +28,39 @@ end
 %  save wavelength table
 obj.enei = enei;
 
+%  native tabulation of substrate for all wavelengths
+if numel( obj.layer.z ) == 1 && exist( 'greenlayertab', 'file' ) == 3
+  [ G, Fr, Fz, obj.pos ] = greenmex( obj.layer, enei,  ...
+                      obj.r( : ), transpose( obj.z1( : ) ), obj.z2( : ) );
+  %  get field names
+  names = fieldnames( G );
+  %  size of Green function matrix, same layout as for EVAL
+  siz = [ numel( obj.r ), numel( obj.z1 ), numel( obj.z2 ) ];
+  
+  for i = 1 : length( names )
+    %  Green functions for last wavelength
+    obj.G.(  names{ i } ) = reshape( G.(  names{ i } )( :, :, :, end ), siz );
+    obj.Fr.( names{ i } ) = reshape( Fr.( names{ i } )( :, :, :, end ), siz );
+    obj.Fz.( names{ i } ) = reshape( Fz.( names{ i } )( :, :, :, end ), siz );
+    %  save Green functions with wavelength as first dimension
+    obj.Gsav.(  names{ i } ) = reshape( permute( G.(  names{ i } ), [ 4, 1, 2, 3 ] ), [ numel( enei ), siz ] );
+    obj.Frsav.( names{ i } ) = reshape( permute( Fr.( names{ i } ), [ 4, 1, 2, 3 ] ), [ numel( enei ), siz ] );
+    obj.Fzsav.( names{ i } ) = reshape( permute( Fz.( names{ i } ), [ 4, 1, 2, 3 ] ), [ numel( enei ), siz ] );
+  end
+  
+  %  update multiWaitbar once for all wavelengths
+  if iswaitbar && multiWaitbar( 'Initializing greentablayer', fun( numel( enei ) ) )
+    multiWaitbar( 'CloseAll' );  
+    error( 'Initilialization of greentablayer stopped' );
+  end
+  %  close waitbar
+  if iswaitbar && op.waitbarlimits( 2 ) == 1
+    multiWaitbar( 'Initializing greentablayer', 'Close' );  
+    drawnow;
+  end
+  return
+end
+
 %  loop over wavelengths
 for ien = 1 : numel( enei )
   
@@ -6,17 +6,36 @@ function mat = admissibility( obj1, obj2, varargin )
 %    mat = admissibility( obj1, obj2,     PropertyPairs )
 %  PropertyName
 %    fadmiss  :  function for admissibility, @( rad1, rad2, dist )
+%    admiss   :  'min' for eta * min( rad1, rad2 ) < dist (default),
+%                'max' for eta * max( rad1, rad2 ) < dist
+%    eta      :  admissibility parameter (default 2.5)
 %  Output
 %    mat      :  admissibility matrix
 %
 %  See S. Boerm et al., Eng. Analysis with Bound. Elem. 27, 405 (2003).
 
-op = getbemoptions( varargin{ : }, { 'hoptions' } );
+op = getbemoptions( { 'iter', 'hoptions' }, varargin{ : } );
+%  block tree in C++ for predefined admissibility conditions, FADMISS only for
+%    user-defined functions (BEMITER.OPTIONS sets ADMISS and ETA by default)
+if ~isfield( op, 'fadmiss' ) && exist( 'hmattree', 'file' ) == 3
+  [ row1, col1, row2, col2 ] = hmattree( 'admiss', treestruct( obj1 ), treestruct( obj2 ), op );
+  %  admissibility matrix
+  mat = sparse( [ row1; row2 ], [ col1; col2 ],  ...
+    [ 2 + 0 * row1; 1 + 0 * row2 ], size( obj1.son, 1 ), size( obj2.son, 1 ) );
+  return
+end
+
 %  function for admissibility condition
 if isfield( op, 'fadmiss' )
   fadmiss = op.fadmiss;
 else
-  fadmiss = @( rad1, rad2, dist ) 2.5 * min( rad1, rad2 ) < dist;
+  eta = 2.5;
+  if isfield( op, 'eta' ),  eta = op.eta;  end
+  if isfield( op, 'admiss' ) && strcmp( op.admiss, 'max' )
+    fadmiss = @( rad1, rad2, dist ) eta * max( rad1, rad2 ) < dist;
+  else
+    fadmiss = @( rad1, rad2, dist ) eta * min( rad1, rad2 ) < dist;
+  end
 end
 
 %  allocate matrix
@@ -72,3 +91,9 @@ else
   end
   end
 end
+
+
+function s = treestruct( obj )
+%  TREESTRUCT - Cluster tree structure to be passed to HMATTREE.
+
+s = struct( 'son', obj.son, 'mid', obj.mid, 'rad', obj.rad, 'ipart', obj.ipart );
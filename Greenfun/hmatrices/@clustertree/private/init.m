@@ -22,6 +22,16 @@ end
 %  save particle
 obj.p = p;
 
+%  cluster tree through bisection in C++
+if exist( 'hmattree', 'file' ) == 3
+  %  particle index of positions
+  siz = cellfun( @( p ) ( p.size ), p.p( p.mask ) );
+  ip = repelem( 1 : numel( siz ), siz );
+  [ obj.son, obj.cind, obj.ind, obj.mid, obj.rad, obj.ipart ] =  ...
+                                       hmattree( 'tree', p.pos, ip, cleaf );
+  return
+end
+
 %%  set up tree
 %    index to particle positions and cluster index
 [ ind, cind ] = deal( 1 : p.n );
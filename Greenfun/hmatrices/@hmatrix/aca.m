@@ -14,17 +14,18 @@ function obj = aca( obj, fun )
 %  large matrices ACA can be very slow and we recommend writing a MEX file
 %  which uses a C++ class derived from the acafunc class (see aca.h).
 
-tree = obj.tree;
+[ tree, tree2 ] = deal( obj.tree, coltree( obj ) );
 %  transformation to cluster indices
-ind = tree.ind( :, 2 );
+ind1 = tree.ind( :, 2 );
+ind2 = tree2.ind( :, 2 );
 %  modify input function
-fun2 = @( row, col ) fun( ind( row ), ind( col ) );
+fun2 = @( row, col ) fun( ind1( row ), ind2( col ) );
 
 %  compute full matrices
 for i = 1 : numel( obj.row1 )
   %  cluster indices
   indr = tree.cind( obj.row1( i ), : );
-  indc = tree.cind( obj.col1( i ), : );
+  indc = tree2.cind( obj.col1( i ), : );
   %  rows and columns
   [ row, col ] = ndgrid( indr( 1 ) : indr( 2 ), indc( 1 ) : indc( 2 ) );
   %  get function values
@@ -9,20 +9,42 @@ function obj = fillval( obj, fun )
 %              fun = @(row,col) A(sub2ind([n,n],row,col));
 %  Output
 %    obj    :  H-matrix with full matrices
+%
+%  For symmetric storage (non-empty area) only the lower full matrices are
+%  computed, the upper ones are obtained from the lower ones (see UNSYM).
 
-tree = obj.tree;
+[ tree, tree2 ] = deal( obj.tree, coltree( obj ) );
 %  transformation to cluster indices
-ind = tree.ind( :, 1 );
+ind1 = tree.ind( :, 1 );
+ind2 = tree2.ind( :, 1 );
 %  modify input function
-fun2 = @( row, col ) fun( ind( row ), ind( col ) );
+fun2 = @( row, col ) fun( ind1( row ), ind2( col ) );
+
+%  upper full matrices for symmetric storage
+if isempty( obj.area )
+  upper = false( size( obj.row1 ) );
+else
+  upper = tree.cind( obj.row1, 1 ) < tree.cind( obj.col1, 1 );
+end
 
 %  compute full matrices
-for i = 1 : numel( obj.row1 )
+for i = reshape( find( ~upper ), 1, [] )
   %  cluster indices
   indr = tree.cind( obj.row1( i ), : );
-  indc = tree.cind( obj.col1( i ), : );
+  indc = tree2.cind( obj.col1( i ), : );
   %  rows and columns
   [ row, col ] = ndgrid( indr( 1 ) : indr( 2 ), indc( 1 ) : indc( 2 ) );
   %  get function values
   obj.val{ i } = reshape( fun2( row( : ), col( : ) ), size( row ) );
 end
+
+%  lower partners of full matrices
+[ ~, partner ] = ismember( [ obj.col1, obj.row1 ], [ obj.row1, obj.col1 ], 'rows' );
+%  upper full matrices from lower ones, G(j,i) = diag(1/area)*transp(G(i,j))*diag(area)
+for i = reshape( find( upper ), 1, [] )
+  k = partner( i );
+  indr = tree.cind( obj.row1( i ), : );
+  indc = tree.cind( obj.col1( i ), : );
+  obj.val{ i } = bsxfun( @times, bsxfun( @rdivide, obj.val{ k } .',  ...
+    obj.area( indr( 1 ) : indr( 2 ) ) ), reshape( obj.area( indc( 1 ) : indc( 2 ) ), 1, [] ) );
+end
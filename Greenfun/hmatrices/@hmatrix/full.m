@@ -6,6 +6,8 @@ function mat = full( obj )
 %  Output
 %    mat  :  full matrix
 
+%  expand symmetric storage
+obj = unsym( obj );
 %  tree to be passed to MEX function of HLIB
 tree = treemex( obj );
 %  call MEX function
@@ -14,6 +16,7 @@ mat = hmatfull( tree, obj.val, obj.lhs, obj.rhs );
 clear hmatfull;
 
 %  transform to particle indices
-ind = obj.tree.ind( :, 2 );
+ind1 = obj.tree.ind( :, 2 );
+ind2 = coltree( obj ).ind( :, 2 );
 %  change from cluster index to normal index
-mat = mat( ind, ind );
+mat = mat( ind1, ind2 );
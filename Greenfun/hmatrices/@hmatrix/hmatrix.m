@@ -9,8 +9,10 @@ classdef hmatrix
   %%  Properties   
   properties
     tree            %  cluster tree
+    tree2           %  column cluster tree for rectangular matrices
     htol = 1e-6     %  tolerance for low-rank approximation
     kmax = 100      %  maximum rank for low-rank matrix
+    hsym = false    %  symmetric storage for area-weighted Green functions
   end
   
   properties
@@ -19,9 +21,13 @@ classdef hmatrix
     val             %  full matrix
     lhs,  rhs       %  low-rank matrix lhs * transp( rhs )
     
+    area            %  boundary element areas (cluster ordering) for 
+                    %    symmetric storage, only lower blocks are set
+    ldl = false     %  LDL' decomposition of symmetric storage
     op              %  option structure
     stat            %  statistics returned from MEX functions for
-                    %    H-matrix multiplication and inversion
+                    %    H-matrix fill, multiplication, LU and inversion,
+                    %    field hstat with ranks, storage and ACA statistics
   end
 
   %%  Methods
@@ -31,12 +37,19 @@ classdef hmatrix
       %
       %  Usage :
       %    obj = hmatrix( tree, op, PropertyPairs )
+      %    obj = hmatrix( tree, tree2, op, PropertyPairs )
       %  Input
       %    tree     :  cluster tree
+      %    tree2    :  column cluster tree for rectangular matrices, e.g.
+      %                  evaluation points vs. boundary elements
       %  PropertyName
       %    fadmiss  :  function for admissibility, e.g.
       %                  @( rad1, rad2, dist ) 2 * min( rad1, rad2 ) < dist
       %    htol     :  tolerance for low-rank approximation
+      %    hsym     :  symmetric storage of area-weighted Green functions
+      %                  G(i,j) = g(r_i,r_j)*area(j), multiplication
+      %                  with matrices, LU and solve use lower blocks,
+      %                  other operations expand to full storage (UNSYM)
       if ~isempty( varargin ),  obj = init( obj, varargin{ : } );  end
     end
     
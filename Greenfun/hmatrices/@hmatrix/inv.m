@@ -6,6 +6,8 @@ function obj = inv( obj )
 %  Output
 %    obj    :  inverse of H-matrix
 
+%  expand symmetric storage
+obj = unsym( obj );
 %  tree and options to be passed to MEX function of HLIB
 tree = treemex( obj );
 op = struct( 'htol', obj.htol, 'kmax', obj.kmax );
@@ -12,6 +12,8 @@ function obj1 = lsolve( obj1, obj2, key )
 %    obj    :  X
 
 if ~exist( 'key', 'var' ),  key = 'N';  end
+%  expand symmetric storage, LU decomposition of full storage required
+[ obj1, obj2 ] = deal( unsym( obj1 ), unsym( obj2 ) );
 %  tree and options to be passed to MEX function of HLIB
 tree = treemex( obj1 );
 op = struct( 'htol', obj1.htol, 'kmax', obj1.kmax );
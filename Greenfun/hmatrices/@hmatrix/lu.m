@@ -4,12 +4,16 @@ function obj = lu( obj )
 %  Usage for obj = hmatrix :
 %    obj = lu( obj )
 %  Output
-%    obj    :  LU decomposition of H-matrix
+%    obj    :  LU decomposition of H-matrix, for symmetric storage
+%                LDL' decomposition of G*diag(1/area)
 
 %  tree and options to be passed to MEX function of HLIB
 tree = treemex( obj );
 op = struct( 'htol', obj.htol, 'kmax', obj.kmax );
+if ~isempty( obj.area ),  op.area = obj.area;  end
 %  call MEX function 
 [ obj.val, obj.lhs, obj.rhs, obj.stat ] = hmatlu( tree, obj.val, obj.lhs, obj.rhs, op );
 %  clear persistent variables
 clear hmatlu;
+%  LDL' decomposition for symmetric storage, lower factor and upper blocks
+obj.ldl = ~isempty( obj.area );
@@ -0,0 +1,14 @@
+function tree = coltree( obj )
+%  COLTREE - Cluster tree for columns of H-matrix.
+%
+%  Usage for obj = hmatrix :
+%    tree = coltree( obj )
+%  Output
+%    tree   :  column cluster tree for rectangular matrices, 
+%              row cluster tree otherwise
+
+if isempty( obj.tree2 )
+  tree = obj.tree;
+else
+  tree = obj.tree2;
+end
@@ -2,24 +2,31 @@ function obj = init( obj, tree, varargin )
 %  INIT - Initialize hierarchical matrix.
 %
 %  Usage for obj = hmatrix :
-%    obj = init( obj, tree, op, PropertyPairs )
+%    obj = init( obj, tree,        op, PropertyPairs )
+%    obj = init( obj, tree, tree2, op, PropertyPairs )
 %  Input
-%    tree1    :  cluster tree 1
-%    tree2    :  cluster tree 2
+%    tree     :  cluster tree for rows (and columns)
+%    tree2    :  cluster tree for columns of rectangular matrix
 %  PropertyName
 %    fadmiss  :  function for admissibility
 %    htol     :  tolerance for low-rank approximation
+%    hsym     :  symmetric storage of area-weighted Green functions
 %
 %  See S. Boerm et al., Eng. Analysis with Bound. Elem. 27, 405 (2003).
 
+%  column cluster tree for rectangular matrix
+if ~isempty( varargin ) && isa( varargin{ 1 }, 'clustertree' )
+  [ obj.tree2, varargin ] = deal( varargin{ 1 }, varargin( 2 : end ) );
+end
 op = getbemoptions( { 'iter', 'hoptions' }, varargin{ : } );
 %  extract input
 if isfield( op, 'htol' ),  obj.htol = op.htol;  end
 if isfield( op, 'kmax' ),  obj.kmax = op.kmax;  end
+if isfield( op, 'hsym' ),  obj.hsym = op.hsym;  end
 
 %  save tree and compute admissibility matrix
 obj.tree = tree;
-admiss = admissibility( tree, tree, varargin{ : } );
+admiss = admissibility( tree, coltree( obj ), varargin{ : } );
 
 %  indices for low-rank and full matrices
 [ obj.row1, obj.col1 ] = find( admiss == 2 );
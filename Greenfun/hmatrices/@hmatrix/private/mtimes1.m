@@ -7,6 +7,9 @@ function result = mtimes1( first, second )
 %  Input
 %    mat    :  sparse diagonal
 
+%  diagonal scaling breaks symmetry, expand symmetric storage
+if issparse( first ),  second = unsym( second );  else  first = unsym( first );  end
+
 %  mat * obj
 if issparse( first )
   %  set output
@@ -8,14 +8,20 @@ function mat = mtimes2( obj, mat )
 %  Output
 %    mat    :  obj * mat
 
+if obj.ldl,  error( 'LDL'' decomposition of symmetric storage only supports SOLVE' );  end
 %  tree to be passed to MEX function of HLIB
 tree = treemex( obj );
 %  change to cluster index
-mat = part2cluster( obj.tree, mat );
+mat = part2cluster( coltree( obj ), mat );
 %  treat case that H-matrix is real and matrix complex
 if ~isreal( mat ),  obj.val{ 1 } = complex( obj.val{ 1 } );  end
 %  multiplication of H-matrix with matrix
-mat = hmatmul1( tree, obj.val, obj.lhs, obj.rhs, mat );
+if isempty( obj.area )
+  mat = hmatmul1( tree, obj.val, obj.lhs, obj.rhs, mat );
+else
+  %  symmetric storage, upper blocks from lower blocks
+  mat = hmatmul1( tree, obj.val, obj.lhs, obj.rhs, mat, struct( 'area', obj.area ) );
+end
 mat = cluster2part( obj.tree, mat );
 %  clear persistent variables
 clear hmatmul1;
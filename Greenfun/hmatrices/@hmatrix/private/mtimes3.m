@@ -6,6 +6,8 @@ function obj1 = mtimes3( obj1, obj2 )
 %  Output
 %    obj    :  matrix multiplication obj1 * obj2
 
+%  expand symmetric storage
+[ obj1, obj2 ] = deal( unsym( obj1 ), unsym( obj2 ) );
 %  tree to be passed to MEX function of HLIB
 tree = treemex( obj1 );
 op = struct( 'htol', obj1.htol, 'kmax', obj1.kmax );
@@ -4,6 +4,8 @@ function obj1 = plus2( obj1, obj2 )
 %  Usage for obj = hmatrix :
 %    obj = plus2( obj1, obj2 )
 
+%  expand symmetric storage
+[ obj1, obj2 ] = deal( unsym( obj1 ), unsym( obj2 ) );
 %  tree and options to be passed to MEX function of HLIB
 tree = treemex( obj1 );
 op = struct( 'htol', obj1.htol, 'kmax', obj1.kmax );
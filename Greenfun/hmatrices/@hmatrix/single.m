@@ -0,0 +1,16 @@
+function obj = single( obj )
+%  SINGLE - Store hierarchical matrix in single precision.
+%    Multiplication and solution with single precision matrices keep
+%    the vectors in double precision, e.g. for LU preconditioners.
+%
+%  Usage for obj = hmatrix :
+%    obj = single( obj )
+%  Output
+%    obj    :  hierarchical matrix with single precision blocks
+
+if ~isempty( obj.area )
+  error( 'single precision requires unsymmetric storage' );
+end
+obj.val = cellfun( @( val ) single( val ), obj.val, 'uniform', 0 );
+obj.lhs = cellfun( @( lhs ) single( lhs ), obj.lhs, 'uniform', 0 );
+obj.rhs = cellfun( @( rhs ) single( rhs ), obj.rhs, 'uniform', 0 );
@@ -11,11 +11,21 @@ function x = solve( obj, b, key )
 %    x      :  solution vector
 
 if ~exist( 'key', 'var' ),  key = 'N';  end
+%  real LU decomposition, solve for real and imaginary part of inhomogeneity
+if ~isreal( b ) && all( cellfun( @isreal, [ obj.val( : ); obj.lhs( : ) ] ) )
+  x = solve( obj, real( b ), key ) + 1i * solve( obj, imag( b ), key );
+  return
+end
 %  tree and change to cluster indexing
 tree = treemex( obj );
 b = part2cluster( obj.tree, b );
 %  call MEX function
-x = hmatsolve( tree, obj.val, obj.lhs, obj.rhs, b, key );
+if isempty( obj.area )
+  x = hmatsolve( tree, obj.val, obj.lhs, obj.rhs, b, key );
+else
+  %  symmetric storage with LDL' decomposition
+  x = hmatsolve( tree, obj.val, obj.lhs, obj.rhs, b, key, struct( 'area', obj.area ) );
+end
 %  clear persistent variables and change back to particle ordering
 clear hmatlu;
 x = cluster2part( obj.tree, x );
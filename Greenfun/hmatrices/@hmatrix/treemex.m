@@ -10,6 +10,8 @@ function tree = treemex( obj )
 %                  ind1   -  indices for full matrices
 %                  ind2   -  indices for low-rank matrices
 %                  ipart  -  particle index
+%                for rectangular matrices also csons, cind, cipart
+%                  for column cluster tree
 
 %  cluster tree
 tree = obj.tree;
@@ -26,3 +28,9 @@ ipart = uintmex( tree.ipart );
 %  structure to be passed to MEX functions of HLIB
 tree = struct( 'sons', sons, 'ind', ind,  ...
                'ind1', ind1, 'ind2', ind2, 'ipart', ipart );
+%  column tree for rectangular matrix
+if ~isempty( obj.tree2 )
+  tree.csons  = uintmex( obj.tree2.son  - 1 );
+  tree.cind   = uintmex( obj.tree2.cind - 1 );
+  tree.cipart = uintmex( obj.tree2.ipart );
+end
@@ -0,0 +1,43 @@
+function obj = unsym( obj )
+%  UNSYM - Expand symmetric storage of hierarchical matrix to full storage.
+%    For symmetric storage only the lower blocks of the area-weighted
+%    Green function G(i,j) = g(r_i,r_j)*area(j) are set, the upper blocks
+%    are G(j,i) = diag(1/area)*transp(G(i,j))*diag(area).
+%
+%  Usage for obj = hmatrix :
+%    obj = unsym( obj )
+%  Output
+%    obj    :  H-matrix with all blocks set and empty area
+
+if isempty( obj.area ),  return;  end
+%  LDL' decomposition has no LU factors of full storage
+if obj.ldl
+  error( 'LDL'' decomposition of symmetric storage only supports SOLVE' );
+end
+
+[ tree, area ] = deal( obj.tree, obj.area );
+%  first index of clusters, upper blocks have first row before first column
+first = tree.cind( :, 1 );
+%  areas of clusters
+fun = @( i ) reshape( area( tree.cind( i, 1 ) : tree.cind( i, 2 ) ), [], 1 );
+
+%  lower partners of full and low-rank matrices
+[ ~, partner1 ] = ismember( [ obj.col1, obj.row1 ], [ obj.row1, obj.col1 ], 'rows' );
+[ ~, partner2 ] = ismember( [ obj.col2, obj.row2 ], [ obj.row2, obj.col2 ], 'rows' );
+
+%  upper full matrices from lower partners
+for i = reshape( find( first( obj.row1 ) < first( obj.col1 ) ), 1, [] )
+  k = partner1( i );
+  [ ar, ac ] = deal( fun( obj.row1( i ) ), fun( obj.col1( i ) ) );
+  obj.val{ i } = bsxfun( @times, bsxfun( @rdivide, obj.val{ k } .', ar ), ac .' );
+end
+%  upper low-rank matrices, G(j,i) = ( R ./ area ) * transp( L .* area )
+for i = reshape( find( first( obj.row2 ) < first( obj.col2 ) ), 1, [] )
+  k = partner2( i );
+  [ ar, ac ] = deal( fun( obj.row2( i ) ), fun( obj.col2( i ) ) );
+  obj.lhs{ i } = bsxfun( @rdivide, obj.rhs{ k }, ar );
+  obj.rhs{ i } = bsxfun( @times,   obj.lhs{ k }, ac );
+end
+
+%  full storage
+obj.area = [];
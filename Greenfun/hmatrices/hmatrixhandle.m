@@ -0,0 +1,305 @@
+classdef hmatrixhandle < handle
+  %  Hierarchical matrix kept in C++ memory between MEX calls.
+  %    The H-matrix and its cluster tree are stored in the registry of the
+  %    MEX function HMATHANDLE, Matlab only holds an integer handle.
+  %    Multiplication, addition, LU decomposition and solution operate on
+  %    the handles, such that the H-matrix is not converted between Matlab
+  %    and C++ for each call.  The C++ memory is released when the object
+  %    is deleted.
+
+  %%  Properties
+  properties (SetAccess = private)
+    id              %  handle of H-matrix in C++ registry
+    tree            %  cluster tree
+    tree2           %  column cluster tree for rectangular matrices
+    islu = false    %  LU decomposition of H-matrix
+  end
+
+  properties (Access = private)
+    proto           %  H-matrix without values, for conversion to hmatrix
+  end
+
+  %%  Methods
+  methods
+    function obj = hmatrixhandle( hmat, share, islu )
+      %  Initialize H-matrix handle.
+      %
+      %  Usage :
+      %    obj = hmatrixhandle( hmat )
+      %    obj = hmatrixhandle( hmat, share )
+      %    obj = hmatrixhandle( hmat, share, islu )
+      %  Input
+      %    hmat   :  hierarchical matrix
+      %    share  :  H-matrix handle with same cluster tree, whose C++
+      %                cluster tree is shared, or []
+      %    islu   :  hmat is LU decomposition computed with HMATRIX/LU,
+      %                e.g. for preconditioner of ITERSOLVE
+      if ~exist( 'hmat', 'var' ),  return;  end
+      if exist( 'islu', 'var' ),  obj.islu = islu;  end
+      %  options to be passed to MEX function
+      op = struct( 'htol', hmat.htol, 'kmax', hmat.kmax, 'lu', obj.islu );
+      if ~isempty( hmat.area ),  op.area = hmat.area;  end
+      %  real or complex H-matrix
+      op.complex = ~all( cellfun( @isreal, [ hmat.val( : ); hmat.lhs( : ) ] ) );
+      %  import H-matrix into C++ registry
+      if exist( 'share', 'var' ) && ~isempty( share )
+        obj.id = hmathandle( 'create', share.id, hmat.val, hmat.lhs, hmat.rhs, op );
+      else
+        obj.id = hmathandle( 'create', treemex( hmat ), hmat.val, hmat.lhs, hmat.rhs, op );
+      end
+      %  save cluster trees and H-matrix without values
+      [ obj.tree, obj.tree2 ] = deal( hmat.tree, hmat.tree2 );
+      obj.proto = hmat;
+      [ obj.proto.val, obj.proto.lhs, obj.proto.rhs ] = deal( [] );
+    end
+
+    function delete( obj )
+      %  DELETE - Release C++ memory of H-matrix.
+      if ~isempty( obj.id ) && exist( 'hmathandle', 'file' ) == 3
+        hmathandle( 'delete', obj.id );
+      end
+    end
+
+    function disp( obj )
+      %  Command window display.
+      disp( 'hmatrixhandle : ' );
+      disp( struct( 'id', obj.id, 'tree', obj.tree, 'islu', obj.islu ) );
+    end
+
+    function hmat = hmatrix( obj )
+      %  HMATRIX - Convert to Matlab H-matrix.
+      %
+      %  Usage for obj = hmatrixhandle :
+      %    hmat = hmatrix( obj )
+      hmat = obj.proto;
+      [ hmat.val, hmat.lhs, hmat.rhs ] = hmathandle( 'get', obj.id );
+    end
+
+    function mat = full( obj )
+      %  FULL - Compute full matrix.
+      %
+      %  Usage for obj = hmatrixhandle :
+      %    mat = full( obj )
+      mat = hmathandle( 'full', obj.id );
+      %  change from cluster index to normal index
+      mat = mat( obj.tree.ind( :, 2 ), coltree( obj ).ind( :, 2 ) );
+    end
+
+    function mat = mtimes( obj, mat )
+      %  MTIMES - Multiplication of H-matrix with numerical matrix.
+      %
+      %  Usage for obj = hmatrixhandle :
+      %    mat = obj * mat
+      mat = part2cluster( coltree( obj ), mat );
+      mat = cluster2part( obj.tree, hmathandle( 'mul', obj.id, mat ) );
+    end
+
+    function obj = plus( obj1, obj2 )
+      %  PLUS - Add H-matrices with same cluster tree.
+      %
+      %  Usage for obj = hmatrixhandle :
+      %    obj = obj1 + obj2
+      obj = derived( obj1, hmathandle( 'add', obj1.id, obj2.id ), false );
+    end
+
+    function obj = lu( obj )
+      %  LU - LU decomposition of H-matrix.
+      %
+      %  Usage for obj = hmatrixhandle :
+      %    obj = lu( obj )
+      %  Output
+      %    obj    :  LU decomposition, for symmetric storage LDL'
+      %                decomposition of G*diag(1/area)
+      obj = derived( obj, hmathandle( 'lu', obj.id ), true );
+    end
+
+    function x = solve( obj, b, key )
+      %  SOLVE - Solve matrix equation (L*U)*x = b for LU decomposition.
+      %
+      %  Usage for obj = hmatrixhandle :
+      %    x = solve( obj, b )
+      %    x = solve( obj, b, key )
+      %  Input
+      %    b      :  inhomogeneity
+      %    key    :  'L' for lower, 'U' for upper matrix, 'N' for both
+      if ~exist( 'key', 'var' ),  key = 'N';  end
+      b = part2cluster( obj.tree, b );
+      x = cluster2part( obj.tree, hmathandle( 'solve', obj.id, b, key ) );
+    end
+
+    function save( obj, file )
+      %  SAVE - Save H-matrix and cluster tree to binary file.
+      %    The file can be loaded in later sessions or by other processes
+      %    with HMATRIXHANDLE.LOAD, the H-matrix blocks are then mapped
+      %    into memory and read from disk when first used.
+      %
+      %  Usage for obj = hmatrixhandle :
+      %    save( obj, file )
+      hmathandle( 'save', obj.id, file );
+    end
+
+    function spill( obj, dir, maxbytes )
+      %  SPILL - Move H-matrix to scratch file with memory budget.
+      %    Blocks are read from disk when used by MTIMES or SOLVE, at most
+      %    MAXBYTES of blocks are kept in memory.
+      %
+      %  Usage for obj = hmatrixhandle :
+      %    spill( obj, dir, maxbytes )
+      %  Input
+      %    dir        :  directory for scratch file (default tempdir)
+      %    maxbytes   :  memory budget in bytes (default 1 GB)
+      if ~exist( 'dir', 'var' ),  dir = tempdir;  end
+      if ~exist( 'maxbytes', 'var' ),  maxbytes = 2 ^ 30;  end
+      hmathandle( 'spill', obj.id, dir, maxbytes );
+    end
+
+    function s = stat( obj )
+      %  STAT - Block statistics and statistics of low-rank arithmetic.
+      %    Ranks, storage and compression of the blocks and levels of the
+      %    H-matrix, ACA calls and truncations of low-rank matrices of all
+      %    operations since the previous call of STAT.
+      %
+      %  Usage for obj = hmatrixhandle :
+      %    s = stat( obj )
+      %  Output
+      %    s      :  structure with fields bytes, compression, blocks,
+      %                levels, aca, truncate, and memory
+      s = hmathandle( 'stat', obj.id );
+    end
+
+    function obj = single( obj, A, op )
+      %  SINGLE - Store H-matrix in single precision.
+      %    Multiplications and solutions keep the vectors in double
+      %    precision, solutions with an LU decomposition are refined
+      %    iteratively with the double precision H-matrix A.
+      %
+      %  Usage for obj = hmatrixhandle :
+      %    obj = single( obj )
+      %    obj = single( obj, A, op )
+      %  Input
+      %    A      :  H-matrix for iterative refinement of solutions
+      %    op     :  structure with tolerance TOL and maximum number
+      %                MAXIT of refinement steps
+      if ~exist( 'A', 'var' ) || isempty( A ),  hA = [];  else  hA = A.id;  end
+      if ~exist( 'op', 'var' ),  op = struct;  end
+      hmathandle( 'single', obj.id, hA, op );
+    end
+
+    function [ x, flag, relres, iter ] = itersolve( obj, b, op, precond, x0 )
+      %  ITERSOLVE - Iterative solution of SCALE*(A+diag(DIAG))*x = b.
+      %    The Krylov solver runs in C++, such that the H-matrix and its
+      %    preconditioner are not passed through Matlab in each iteration.
+      %
+      %  Usage for obj = hmatrixhandle :
+      %    [ x, flag, relres, iter ] = itersolve( obj, b, op, precond, x0 )
+      %  Input
+      %    b        :  inhomogeneity, columns are solved simultaneously
+      %    op       :  structure with fields SOLVER ('gmres', 'bicgstab',
+      %                  'cgs'), TOL, MAXIT, RESTART, DIAG and SCALE
+      %    precond  :  LU decomposition used as preconditioner, or []
+      %    x0       :  initial guess
+      %  Output
+      %    x        :  solution vector
+      %    flag, relres, iter   :  statistics for columns of b, see GMRES
+      hp = [];
+      if exist( 'precond', 'var' ) && ~isempty( precond ),  hp = precond.id;  end
+      if ~exist( 'x0', 'var' ) || isempty( x0 )
+        x0 = [];
+      else
+        x0 = part2cluster( obj.tree, x0 );
+      end
+      if isfield( op, 'diag' ) && ~isempty( op.diag )
+        op.diag = part2cluster( obj.tree, op.diag( : ) );
+      end
+      [ x, flag, relres, iter ] =  ...
+        hmathandle( 'iter', obj.id, hp, part2cluster( obj.tree, b ), x0, op );
+      x = cluster2part( obj.tree, x );
+    end
+
+    function obj = adopt( obj0, id )
+      %  ADOPT - Object for H-matrix registered by HMATHANDLE.
+      %    The H-matrix must have the same cluster tree as obj0, e.g. the
+      %    matrices returned by HMATHANDLE('bemretprecond').
+      %
+      %  Usage for obj0 = hmatrixhandle :
+      %    obj = adopt( obj0, id )
+      obj = derived( obj0, id, hmathandle( 'islu', id ) );
+    end
+
+    function x = mldivide( obj, b )
+      %  MLDIVIDE - Solve matrix equation using LU decomposition.
+      %
+      %  Usage for obj = hmatrixhandle :
+      %    x = obj \ b
+      if ~obj.islu,  obj = lu( obj );  end
+      x = solve( obj, b );
+    end
+  end
+
+  methods (Access = private)
+    function tree = coltree( obj )
+      %  COLTREE - Cluster tree for columns of H-matrix.
+      if isempty( obj.tree2 )
+        tree = obj.tree;
+      else
+        tree = obj.tree2;
+      end
+    end
+
+    function obj = derived( obj0, id, islu )
+      %  DERIVED - New object for H-matrix computed from obj0.
+      obj = hmatrixhandle;
+      [ obj.id, obj.tree, obj.tree2, obj.proto, obj.islu ] =  ...
+                            deal( id, obj0.tree, obj0.tree2, obj0.proto, islu );
+    end
+  end
+
+  methods (Static)
+    function obj = load( file, hmat, check )
+      %  LOAD - Load H-matrix from file saved with SAVE.
+      %
+      %  Usage :
+      %    obj = hmatrixhandle.load( file, hmat )
+      %    obj = hmatrixhandle.load( file, hmat, check )
+      %  Input
+      %    file   :  file name
+      %    hmat   :  hierarchical matrix with same cluster tree, the
+      %                cluster tree of the file is compared with hmat
+      %    check  :  compare checksums of all blocks (default false)
+      if ~exist( 'check', 'var' ),  check = false;  end
+      obj = hmatrixhandle;
+      id = hmathandle( 'load', file, treemex( hmat ), check );
+      [ obj.id, obj.tree, obj.tree2, obj.proto ] = deal( id, hmat.tree, hmat.tree2, hmat );
+      [ obj.proto.val, obj.proto.lhs, obj.proto.rhs ] = deal( [] );
+      %  LU decomposition ?
+      obj.islu = hmathandle( 'islu', id );
+    end
+
+    function s = memory( maxmem )
+      %  MEMORY - Memory of C++ registry and peak memory since last call.
+      %    Allocations are tagged with fill, lu, inv, solve, temp (ACA
+      %    workspace) and other.  Operations which would exceed the
+      %    memory budget stop with an error.
+      %
+      %  Usage :
+      %    s = hmatrixhandle.memory
+      %    s = hmatrixhandle.memory( maxmem )
+      %  Input
+      %    maxmem :  memory budget in bytes, 0 for no limit
+      %  Output
+      %    s      :  structure with fields current, peak, budget, and
+      %                [current,peak] for each tag
+      if ~exist( 'maxmem', 'var' )
+        s = hmathandle( 'memory' );
+      else
+        s = hmathandle( 'memory', maxmem );
+      end
+    end
+
+    function clear
+      %  CLEAR - Release all H-matrices of C++ registry.
+      %    Existing hmatrixhandle objects become invalid.
+      hmathandle( 'clear' );
+    end
+  end
+end
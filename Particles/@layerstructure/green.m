@@ -18,6 +18,19 @@ function [ G, Fr, Fz, pos ] = green( obj, enei, r, z1, z2 )
 %
 %  If the sizes of the input arrays r, z1, z2 are identical, the direct
 %  product .* of the output arrays is taken, otherwise the outer product.
+%  For a substrate and the outer product of column and row vectors, the
+%  native tabulation of GREENMEX is used if the MEX file is available.
+
+%  native tabulation for substrate
+if numel( obj.z ) == 1 && exist( 'greenlayertab', 'file' ) == 3 &&  ...
+    iscolumn( r ) && isrow( z1 ) && iscolumn( z2 )
+  [ G, Fr, Fz, pos ] = greenmex( obj, enei, r, z1, z2 );
+  %  remove singleton dimensions
+  [ G, Fr, Fz ] = deal( structfun( @squeeze, G,  'UniformOutput', false ),  ...
+                        structfun( @squeeze, Fr, 'UniformOutput', false ),  ...
+                        structfun( @squeeze, Fz, 'UniformOutput', false ) );
+  return
+end
 
 %  round radii and z-values 
 r = max( r, obj.rmin );  [ z1, z2 ] = round( obj, z1, z2 );
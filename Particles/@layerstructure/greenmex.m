@@ -0,0 +1,45 @@
+function [ G, Fr, Fz, pos ] = greenmex( obj, enei, r, z1, z2 )
+%  GREENMEX - Reflected potential for substrate using native tabulation.
+%    The Green functions are computed with the MEX function GREENLAYERTAB
+%    in parallel for all positions and wavelengths.
+%
+%  Usage for obj = layerstructure :
+%    [ G, Fr, Fz, pos ] = greenmex( obj, enei, r, z1, z2 )
+%  Input
+%    enei       :  wavelengths of light in vacuum
+%    r          :  radial distance between points
+%    z1         :  z-values for position where potential is computed
+%    z2         :  z-values for position of exciting charge or current
+%  Output
+%    G          :  reflected Green function
+%    Fr         :  derivative of Green function in radial direction
+%    Fz         :  derivative of Green function in z-direction
+%    pos        :  expanded arrays for radii and heights
+%
+%  The output arrays are of size [ numel( r ), numel( z1 ), numel( z2 ),
+%  numel( enei ) ], the outer product of the input arrays is taken.
+
+assert( numel( obj.z ) == 1 );
+%  round radii and z-values
+r = max( r, obj.rmin );  [ z1, z2 ] = round( obj, z1, z2 );
+
+%  dielectric functions above and below interface
+eps = zeros( 2, numel( enei ) );
+for i = 1 : numel( enei )
+  eps( :, i ) = cellfun( @( fun ) fun( enei( i ) ), obj.eps );
+end
+%  layer structure and options for MEX function
+layer = struct( 'z', obj.z, 'eps', eps, 'rmin', obj.rmin, 'zmin', obj.zmin,  ...
+  'semi', obj.semi, 'ratio', obj.ratio );
+if isfield( obj.op, 'AbsTol' ),  layer.AbsTol = obj.op.AbsTol;  end
+if isfield( obj.op, 'RelTol' ),  layer.RelTol = obj.op.RelTol;  end
+
+%  tabulate Green functions
+[ G, Fr, Fz ] = greenlayertab( layer, enei( : ), r( : ), z1( : ), z2( : ) );
+
+%  expanded arrays for radii and heights
+[ r, z1, z2 ] = ndgrid( r( : ), z1( : ), z2( : ) );
+%  minimal distance to layers
+zmin = reshape( mindist( obj, z1( : ) ) + mindist( obj, z2( : ) ), size( r ) );
+%  save expanded arrays
+pos = struct( 'r', r, 'z1', z1, 'z2', z2, 'zmin', zmin );
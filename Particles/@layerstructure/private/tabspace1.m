@@ -9,6 +9,8 @@ function tab = tabspace1( obj, r, z1, z2, varargin )
 %  PropertyName
 %    'rmod'   :  'log' for logspace r-table (default) or 'lin' for linspace
 %    'zmod'   :  'log' for logspace z-table (default) or 'lin' for linspace
+%    'refine' :  refinement factor for small radii and heights close to layer,
+%                the first half of the table values are spaced more densely
 %  Output
 %    tab.r    :  tabulated radial values
 %    tab.z1   :  tabulated z1-values
@@ -27,10 +29,11 @@ obj.zmin = 0.999 * obj.zmin;
 %  default values
 if ~isfield( op, 'rmod' ),  op.rmod = 'log';  end
 if ~isfield( op, 'zmod' ),  op.zmod = 'log';  end
+if ~isfield( op, 'refine' ),  op.refine = 1;  end
 
 tab = struct;
 %  table for radii
-tab.r = linlogspace( max( r( 1 ), obj.rmin ), r( 2 ), r( 3 ), op.rmod );
+tab.r = linlogspace( max( r( 1 ), obj.rmin ), r( 2 ), r( 3 ), op.rmod, op.refine );
 
 if numel( z1 ) == 1
   tab.z1 = z1;
@@ -40,7 +43,7 @@ else
   %  handle case that z1-range is too small
   if abs( z1( 1 ) - z1( 2 ) ) < 1e-3,  z1 = expand( obj, z1 );  end
   %  table for z1 values
-  tab.z1 = zlinlogspace( obj, z1( 1 ), z1( 2 ), z1( 3 ), op.zmod );
+  tab.z1 = zlinlogspace( obj, z1( 1 ), z1( 2 ), z1( 3 ), op.zmod, op.refine );
 end
 
 if numel( z2 ) == 1
@@ -51,7 +54,7 @@ else
   %  handle case that z1-range is too small
   if abs( z2( 1 ) - z2( 2 ) ) < 1e-3,  z2 = expand( obj, z2 );  end  
   %  table for z1 values
-  tab.z2 = zlinlogspace( obj, z2( 1 ), z2( 2 ), z2( 3 ), op.zmod );
+  tab.z2 = zlinlogspace( obj, z2( 1 ), z2( 2 ), z2( 3 ), op.zmod, op.refine );
 end
 
 
@@ -64,39 +67,69 @@ function z = expand( obj, z )
 z( 1 : 2 ) = sort( [ z( 1 ) + sign( z( 1 ) - obj.z( ind ) ) * 0.1 * obj.zmin, z( 2 ) ] );
 
 
-function x = linlogspace( xmin, xmax, n, key, x0 )
+function x = linlogspace( xmin, xmax, n, key, k )
 %  LINLOGSPACE - Make table with linear or logarithmic spacing.
 %  
 %  Usage :
-%    x = linlogspace( xmin, xmax, n, key, offset )
+%    x = linlogspace( xmin, xmax, n, key, k )
 %  Input
 %    xmin   :  minimum of x-values
 %    xmax   :  maximum of x-values
 %    n      :  number of x-values
 %    key    :  'log' for logspace or 'lin' for linspace
-%    x0     :  offset 
+%    k      :  refinement factor for small x-values
 %  Output
 %    x      :  table of x-values
 
+if ~exist( 'k', 'var' ),  k = 1;  end
+
 switch key
   case 'lin'
-    x = linspace( xmin, xmax, n );
+    x = reflinspace( xmin, xmax, n, k );
   case 'log'
-    if ~exist( 'x0', 'var' ),  x0 = 0;  end
-    x = x0 + logspace( log10( xmin - x0 ), log10( xmax - x0 ), n );
+    x = 10 .^ reflinspace( log10( xmin ), log10( xmax ), n, k );
+end
+
+
+function x = reflinspace( xmin, xmax, n, k )
+%  REFLINSPACE - Piecewise uniform table with refinement for small values.
+%    For refinement factor k > 1 the first half of the table values has a
+%    step size that is k times smaller than the step size of second half.
+%
+%  Usage :
+%    x = reflinspace( xmin, xmax, n, k )
+%  Input
+%    xmin   :  minimum of x-values
+%    xmax   :  maximum of x-values
+%    n      :  number of x-values
+%    k      :  refinement factor
+%  Output
+%    x      :  table of x-values
+
+if k == 1 || n < 4
+  x = linspace( xmin, xmax, n );
+else
+  %  number of fine steps and fine step size
+  n1 = floor( n / 2 );
+  h = ( xmax - xmin ) / ( n1 + k * ( n - 1 - n1 ) );
+  %  table values
+  x = xmin + [ ( 0 : n1 ) * h, n1 * h + ( 1 : n - 1 - n1 ) * k * h ];
+  x( end ) = xmax;
 end
 
 
-function z = zlinlogspace( obj, zmin, zmax, n, key )
+function z = zlinlogspace( obj, zmin, zmax, n, key, k )
 %  ZLINLOGSPACE - Make table for heights.
 %  
 %  Usage for obj = layerstructure :
-%    z = zlinlogspace( obj, zmin, zmax, n, key, ind, dmin )
+%    z = zlinlogspace( obj, zmin, zmax, n, key, k )
 %  Input
 %    zmin    :  minimum of z-values
 %    zmax    :  maximum of z-values
 %    n       :  number of z-values
 %    key     :  'log' for logspace or 'lin' for linspace
+%    k       :  refinement factor for heights close to layer (upper and
+%               lower medium with logarithmic spacing only)
 %  Output
 %    z       :  table of z-values
 
@@ -109,12 +142,12 @@ switch key
     medium = indlayer( obj, zmin );
     %  upper layer
     if medium == 1   
-      z = obj.z( 1 ) + logspace( log10( zmin - obj.z( 1 ) ),  ...
-                                 log10( zmax - obj.z( 1 ) ), n );
+      z = obj.z( 1 ) + 10 .^ reflinspace( log10( zmin - obj.z( 1 ) ),  ...
+                                          log10( zmax - obj.z( 1 ) ), n, k );
     %  lower medium
     elseif medium == numel( obj.z ) + 1
-      z = obj.z( end ) - logspace( log10( obj.z( end ) - zmax ),  ...
-                                   log10( obj.z( end ) - zmin ), n );    
+      z = obj.z( end ) - 10 .^ reflinspace( log10( obj.z( end ) - zmax ),  ...
+                                            log10( obj.z( end ) - zmin ), n, k );    
       %  flip array
       z = fliplr( z );
     %  intermediate layer
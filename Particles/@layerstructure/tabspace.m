@@ -17,6 +17,8 @@ function tab = tabspace( obj, varargin )
 %  PropertyName
 %    'rmod'   :  'log' for logspace r-table (default) or 'lin' for linspace
 %    'zmod'   :  'log' for logspace z-table (default) or 'lin' for linspace
+%    'refine' :  refinement factor k for small r-values and z-values close
+%                to layer, first half of table with k times smaller steps
 %    'nr'     :  number of r-values for automatic grid
 %    'nz'     :  number of z-values for automatic grid
 %    'scale'  :  scale factor for automatic grid sizes
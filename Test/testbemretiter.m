@@ -0,0 +1,45 @@
+%  TESTBEMRETITER - Iterative retarded BEM solver with H-matrices in C++.
+%    Solves the full Maxwell equations for a metallic nanosphere with
+%    BEMRETITER, where the Green functions are only kept in C++ memory
+%    (HMATHANDLE), and compares the surface charges and currents with the
+%    iterative solver in Matlab and the direct BEM solver.  Requires
+%    compiled MEX files.
+%
+%  Usage :
+%    runtests( 'testbemretiter' )
+
+%  options for BEM simulation
+op = bemoptions( 'sim', 'ret', 'waitbar', 0 );
+%  table of dielectric functions
+epstab = { epsconst( 1 ), epstable( 'gold.dat' ) };
+%  nanosphere
+p = comparticle( epstab, { trisphere( 1444, 100 ) }, [ 2, 1 ], 1, op );
+
+%  plane wave excitation
+exc = planewave( [ 1, 0, 0; 0, 1, 0 ], [ 0, 0, 1; 0, 0, 1 ], op );
+%  light wavelength in vacuum
+enei = 600;
+%  surface charges and currents of direct BEM solver
+sig0 = bemret( p, op ) \ exc( p, enei );
+%  relative error of surface charges and currents
+err = @( sig, sig0 ) max( cellfun( @( name )  ...
+  norm( reshape( sig.( name ) - sig0.( name ), [], 1 ) ) /  ...
+  norm( reshape( sig0.( name ), [], 1 ) ), { 'sig1', 'sig2', 'h1', 'h2' } ) );
+
+%  iterative solver in Matlab
+op.iter = bemiter.options( 'native', false );
+sig1 = bemsolver( p, op ) \ exc( p, enei );
+assert( err( sig1, sig0 ) < 1e-4 );
+
+%%  native iterative solver with default options
+assert( exist( 'hmathandle', 'file' ) == 3, 'MEX file HMATHANDLE not compiled' );
+hmatrixhandle.clear;
+%  default options of iterative solver
+op.iter = bemiter.options;
+bem = bemsolver( p, op );
+assert( isa( bem, 'bemretiter' ) );
+
+sig = bem \ exc( p, enei );
+%  compare with iterative solver in Matlab and direct solver
+assert( err( sig, sig1 ) < 1e-4 );
+assert( err( sig, sig0 ) < 1e-4 );
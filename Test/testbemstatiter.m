@@ -0,0 +1,42 @@
+%  TESTBEMSTATITER - Iterative quasistatic BEM solver in C++.
+%    Solves the BEM equations for a metallic nanosphere with BEMSTATITER
+%    and default options, where the Krylov solver and the H-matrix LU
+%    preconditioner run in C++ (HMATHANDLE), and compares the surface
+%    charges with the direct BEM solver.  Requires compiled MEX files.
+%
+%  Usage :
+%    runtests( 'testbemstatiter' )
+
+%  options for BEM simulation
+op = bemoptions( 'sim', 'stat', 'waitbar', 0 );
+%  table of dielectric functions
+epstab = { epsconst( 1 ), epstable( 'gold.dat' ) };
+%  nanosphere
+p = comparticle( epstab, { trisphere( 1444, 20 ) }, [ 2, 1 ], 1, op );
+
+%  plane wave excitation
+exc = planewave( [ 1, 0, 0; 0, 0, 1 ], [ 0, 0, 1; 1, 0, 0 ], op );
+%  light wavelength in vacuum
+enei = 550;
+%  surface charges of direct BEM solver
+sig0 = bemstat( p, op ) \ exc( p, enei );
+%  relative error of surface charges
+err = @( sig ) norm( sig.sig - sig0.sig, 'fro' ) / norm( sig0.sig, 'fro' );
+
+%%  native iterative solver with default options
+assert( exist( 'hmathandle', 'file' ) == 3, 'MEX file HMATHANDLE not compiled' );
+hmatrixhandle.clear;
+%  default options of iterative solver
+op.iter = bemiter.options;
+bem = bemsolver( p, op );
+assert( isa( bem, 'bemstatiter' ) );
+
+sig = bem \ exc( p, enei );
+%  F and LU decomposition of preconditioner are kept in C++ memory
+assert( numel( hmathandle( 'list' ) ) == 2 );
+assert( err( sig ) < 1e-4 );
+
+%%  iterative solver in Matlab
+op.iter = bemiter.options( 'native', false );
+sig = bemsolver( p, op ) \ exc( p, enei );
+assert( err( sig ) < 1e-4 );
@@ -0,0 +1,46 @@
+%  TESTBEMSTATMIRRORITER - Iterative quasistatic BEM solver with mirror symmetry.
+%    Solves the BEM equations for a metallic nanosphere with mirror
+%    symmetry using BEMSTATMIRRORITER, where the surface derivative of the
+%    Green function is an H-matrix for each symmetry value, and compares
+%    the cross sections with the direct BEM solver.  Requires compiled MEX
+%    files.
+%
+%  Usage :
+%    runtests( 'testbemstatmirroriter' )
+
+%  options for BEM simulation with mirror symmetry
+op = bemoptions( 'sim', 'stat', 'sym', 'xy', 'waitbar', 0 );
+%  table of dielectric functions
+epstab = { epsconst( 1 ), epstable( 'gold.dat' ) };
+%  one quarter of a sphere
+p = trispheresegment( linspace( 0, pi / 2, 20 ), linspace( 0, pi, 40 ), 20 );
+%  initialize sphere with mirror symmetry
+p = comparticlemirror( epstab, { p }, [ 2, 1 ], 1, op );
+
+%  plane wave excitation
+exc = planewave( [ 1, 0, 0; 0, 1, 0 ], [ 0, 0, 1; 0, 0, 1 ], op );
+%  light wavelength in vacuum
+enei = 550;
+%  cross sections of direct BEM solver
+sig0 = bemsolver( p, op ) \ exc( p, enei );
+ext0 = exc.ext( sig0 );
+%  relative error of extinction cross sections
+err = @( sig ) norm( exc.ext( sig ) - ext0 ) / norm( ext0 );
+
+%%  native iterative solver with default options
+assert( exist( 'hmathandle', 'file' ) == 3, 'MEX file HMATHANDLE not compiled' );
+hmatrixhandle.clear;
+%  default options of iterative solver
+op.iter = bemiter.options;
+bem = bemsolver( p, op );
+assert( isa( bem, 'bemstatmirroriter' ) );
+
+sig = bem \ exc( p, enei );
+%  F and LU decomposition for all symmetry values are kept in C++ memory
+assert( numel( hmathandle( 'list' ) ) == 2 * numel( bem.F ) );
+assert( err( sig ) < 1e-4 );
+
+%%  iterative solver in Matlab
+op.iter = bemiter.options( 'native', false );
+sig = bemsolver( p, op ) \ exc( p, enei );
+assert( err( sig ) < 1e-4 );
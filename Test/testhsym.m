@@ -0,0 +1,64 @@
+%  TESTHSYM - Symmetric storage of area-weighted Green functions.
+%    Fills the quasistatic Green function G of a metallic nanosphere with
+%    symmetric storage (only lower blocks, hsym option of HMATRIX) and
+%    compares multiplication, subtraction, inversion, RSOLVE and the LDL'
+%    decomposition with the same H-matrix expanded to full storage (UNSYM).
+%    Requires compiled MEX files.
+%
+%  Usage :
+%    runtests( 'testhsym' )
+
+%  options for BEM simulation and H-matrices
+op = bemoptions( 'sim', 'stat', 'waitbar', 0 );
+op.iter = bemiter.options;
+%  table of dielectric functions
+epstab = { epsconst( 1 ), epstable( 'gold.dat' ) };
+%  nanosphere
+p = comparticle( epstab, { trisphere( 1444, 20 ) }, [ 2, 1 ], 1, op );
+
+%  Green function and surface derivative with full storage
+g = aca.compgreenstat( p, op );
+[ G0, F ] = eval( g, 'G', 'F' );
+%  Green function with symmetric storage and expanded to full storage
+G = eval( aca.compgreenstat( p, op, 'hsym', true ), 'G' );
+Gf = unsym( G );
+
+%  relative error
+err = @( a, b ) norm( a - b, 'fro' ) / norm( b, 'fro' );
+%  matrix for multiplication and solution
+x = rand( p.n, 3 );
+
+%%  symmetric storage
+assert( ~isempty( G.area ) && isempty( Gf.area ) );
+%  upper full matrices are not filled with the Green function, refined
+%    near-field elements are only approximately symmetric
+assert( err( full( G ), full( G0 ) ) < 1e-2 );
+assert( err( full( G ), full( Gf ) ) < 1e-10 );
+
+%%  multiplication
+assert( err( G * x, Gf * x ) < 1e-10 );
+
+%%  subtraction
+D = F - G;
+assert( isempty( D.area ) );
+assert( err( D * x, ( F - Gf ) * x ) < 1e-6 );
+assert( err( ( G - F ) * x, ( Gf - F ) * x ) < 1e-6 );
+
+%%  inversion
+assert( err( inv( G ) * x, inv( Gf ) * x ) < 1e-4 );
+
+%%  solve matrix equation with LU decomposition
+assert( err( full( rsolve( G, lu( Gf ) ) ), full( rsolve( Gf, lu( Gf ) ) ) ) < 1e-4 );
+assert( err( full( lsolve( G, lu( Gf ) ) ), full( lsolve( Gf, lu( Gf ) ) ) ) < 1e-4 );
+
+%%  LDL' decomposition
+Gi = lu( G );
+assert( Gi.ldl );
+assert( err( solve( Gi, x ), solve( lu( Gf ), x ) ) < 1e-4 );
+%  LDL' decomposition only supports solve
+try
+  rsolve( F, Gi );  ok = false;
+catch
+  ok = true;
+end
+assert( ok );
@@ -95,7 +95,8 @@ bemiter.options
 %       cleaf: 200
 %        htol: 1.0000e-06
 %        kmax: [4 100]
-%     fadmiss: @(rad1,rad2,dist)2.5*min(rad1,rad2)<dist
+%      admiss: 'min'
+%         eta: 2.5000
 %
 % In general the default settings returned by |bemiter.options| should work
 % perfectly for most problems of interest.  The meaning of the different
@@ -117,8 +118,12 @@ bemiter.options
 % * *|cleaf|* determines the minimum cluster size.
 % * *|htol|* is the tolerance for the H-matrix compression.
 % * *|kmax|* is the maximum rank for H-matrix compression.
-% * *|fadmiss|* is a function for the admissibility criterion for cluster
-% pairs.
+% * *|admiss|* and *|eta|* set the admissibility criterion for cluster
+% pairs, eta * min( rad1, rad2 ) < dist for |'min'|.
+% * *|fadmiss|* is an optional user-defined function
+% @( rad1, rad2, dist ) for the admissibility criterion, which replaces
+% |admiss| and |eta| but is evaluated in Matlab rather than in the MEX
+% file |hmattree|.
 %
 %% MEX Compilation
 %
@@ -91,7 +91,9 @@ obj = bemclass( varargin, op, PropertyName, PropertyValue );
 % * *|'cleaf'|* determines the minimum cluster size.
 % * *|'htol'|* is the tolerance for the H-matrix compression.
 % * *|'kmax'|* is the maximum rank for H-matrix compression.
-% * *|'fadmiss'|* is a function for the admissibility criterion for cluster
-% pairs.
+% * *|'admiss'|* and *|'eta'|* set the admissibility criterion for cluster
+% pairs, eta * min( rad1, rad2 ) < dist for |'min'|.
+% * *|'fadmiss'|* is an optional user-defined function for the
+% admissibility criterion, which replaces |'admiss'| and |'eta'|.
 %
 % Copyright 2017 Ulrich Hohenester
\ No newline at end of file
@@ -11,55 +11,50 @@
  * Static Green function
  */
 
-void greenstat::getrow(size_t r, double* b) const
+//  Green function element, sum over mirror images of column element
+double greenstat::elem(ptrdiff_t rr, ptrdiff_t cc) const
 {
-  ptrdiff_t n=ncols(), np=p.n, rr=siz.rbegin+r, cc=siz.cbegin, ione=1, ithree=3;
-  double d, pos[3];
-
-  for (ptrdiff_t c=0; c<n; c++)
+  ptrdiff_t n1=p1.n, n2=p2.n, ione=1, ithree=3;
+  double d, pos[3], g=0;
+  
+  for (size_t k=0; k<nmirror(); k++)
   {
     //  relative position
-    for (ptrdiff_t k=0; k<3; k++) pos[k]=p.pos[rr+np*k]-p.pos[cc+c+np*k];
+    for (ptrdiff_t l=0; l<3; l++) pos[l]=p1.pos[rr+n1*l]-sign(k,l)*p2.pos[cc+n2*l];
     //  distance
     d=F77_NAME(dnrm2)(&ithree, pos, &ione);
     
     //  Green function or surface derivative
     if (flag=="G")
-      b[c]=1./d*p.area[cc+c];
+      g+=value(k)/d;
     else
-      b[c]=-F77_NAME(ddot)(&ithree, pos, &ione, p.nvec+rr, &np)/pow(d,3)*p.area[cc+c];
+      g-=value(k)*F77_NAME(ddot)(&ithree, pos, &ione, p1.nvec+rr, &n1)/pow(d,3);
   }
+  
+  return g*p2.area[cc];
 }
 
-void greenstat::getcol(size_t c, double* a) const
+void greenstat::getrow(size_t r, double* b) const
 {
-  ptrdiff_t m=nrows(), np=p.n, rr=siz.rbegin, cc=siz.cbegin+c, ione=1, ithree=3;
-  double d, pos[3];
+  ptrdiff_t n=ncols(), rr=siz.rbegin+r, cc=siz.cbegin;
+  for (ptrdiff_t c=0; c<n; c++) b[c]=elem(rr,cc+c);
+}
 
-  for (ptrdiff_t r=0; r<m; r++)
-  {
-    //  relative position
-    for (ptrdiff_t k=0; k<3; k++) pos[k]=p.pos[rr+r+np*k]-p.pos[cc+np*k];
-    //  distance
-    d=F77_NAME(dnrm2)(&ithree, pos, &ione);
-    
-    //  Green function or surface derivative
-    if (flag=="G")
-      a[r]=1./d*p.area[cc];
-    else
-      a[r]=-F77_NAME(ddot)(&ithree, pos, &ione, p.nvec+rr+r, &np)/pow(d,3)*p.area[cc];
-  }
+void greenstat::getcol(size_t c, double* a) const
+{
+  ptrdiff_t m=nrows(), rr=siz.rbegin, cc=siz.cbegin+c;
+  for (ptrdiff_t r=0; r<m; r++) a[r]=elem(rr+r,cc);
 }
 
-hmatrix<double> greenstat::eval(double tol)
+hmatrix<double> greenstat::eval(double tol, bool sym)
 {
   //  low-rank matrices and H-matrix
   matrix<double> L,R;
   hmatrix<double> H;
   
-  //  loop over clusters
+  //  loop over clusters, lower block tree only for symmetric storage
   for (pairiterator it=tree.pair_begin(); it!=tree.pair_end(); it++)
-    if (tree.admiss(it->first,it->second)==flagRk)
+    if (tree.admiss(it->first,it->second)==flagRk && (!sym || tree.lower(it->first,it->second)))
     {
       //  set cluster
       init(it->first,it->second);
@@ -76,66 +71,53 @@ hmatrix<double> greenstat::eval(double tol)
  * Retarded Green function
  */
 
-void greenret::getrow(size_t r, dcmplx* b) const
+//  Green function element for row and column element
+dcmplx greenret::elem(ptrdiff_t rr, ptrdiff_t cc) const
 {
-  ptrdiff_t n=ncols(), np=p.n, rr=siz.rbegin+r, cc=siz.cbegin, ione=1, ithree=3;
+  ptrdiff_t n1=p1.n, n2=p2.n, ione=1, ithree=3;
   double d, pos[3], in;
-  dcmplx fac, iunit(0,1);
-
-  for (ptrdiff_t c=0; c<n; c++)
+  dcmplx fac, iunit(0,1), g;
+  
+  //  relative position
+  for (ptrdiff_t l=0; l<3; l++) pos[l]=p1.pos[rr+n1*l]-p2.pos[cc+n2*l];
+  //  distance and phase factor
+  d=F77_NAME(dnrm2)(&ithree, pos, &ione);
+  fac=exp(iunit*wav*d);
+  
+  //  Green function or surface derivative
+  if (flag=="G")
+    g=fac/d;
+  else
   {
-    //  relative position
-    for (ptrdiff_t k=0; k<3; k++) pos[k]=p.pos[rr+np*k]-p.pos[cc+c+np*k];
-    //  distance and phase factor
-    d=F77_NAME(dnrm2)(&ithree, pos, &ione);
-    fac=exp(iunit*wav*d);
-    
-    //  Green function or surface derivative
-    if (flag=="G")
-      b[c]=fac/d*p.area[cc+c];
-    else
-    {
-      in=F77_NAME(ddot)(&ithree, pos, &ione, p.nvec+rr, &np);
-      b[c]=in*(iunit*wav-1./d)*fac/pow(d,2)*p.area[cc+c];
-    }
+    in=F77_NAME(ddot)(&ithree, pos, &ione, p1.nvec+rr, &n1);
+    g=in*(iunit*wav-1./d)*fac/pow(d,2);
   }
+  
+  return g*p2.area[cc];
 }
 
-void greenret::getcol(size_t c, dcmplx* a) const
+void greenret::getrow(size_t r, dcmplx* b) const
 {
-  ptrdiff_t m=nrows(), np=p.n, rr=siz.rbegin, cc=siz.cbegin+c, ione=1, ithree=3;
-  double d, pos[3], in;
-  dcmplx fac, iunit(0,1);
+  ptrdiff_t n=ncols(), rr=siz.rbegin+r, cc=siz.cbegin;
+  for (ptrdiff_t c=0; c<n; c++) b[c]=elem(rr,cc+c);
+}
 
-  for (ptrdiff_t r=0; r<m; r++)
-  {
-    //  relative position
-    for (ptrdiff_t k=0; k<3; k++) pos[k]=p.pos[rr+r+np*k]-p.pos[cc+np*k];
-    //  distance
-    d=F77_NAME(dnrm2)(&ithree, pos, &ione);
-    fac=exp(iunit*wav*d);
-    
-    //  Green function or surface derivative
-    if (flag=="G")
-      a[r]=fac/d*p.area[cc];
-    else
-    {
-      in=F77_NAME(ddot)(&ithree, pos, &ione, p.nvec+rr+r, &np);
-      a[r]=in*(iunit*wav-1./d)*fac/pow(d,2)*p.area[cc];
-    }
-  }
+void greenret::getcol(size_t c, dcmplx* a) const
+{
+  ptrdiff_t m=nrows(), rr=siz.rbegin, cc=siz.cbegin+c;
+  for (ptrdiff_t r=0; r<m; r++) a[r]=elem(rr+r,cc);
 }
 
-hmatrix<dcmplx> greenret::eval(size_t i, size_t j, double tol)
+hmatrix<dcmplx> greenret::eval(size_t i, size_t j, double tol, bool sym)
 {
   //  low-rank matrices and H-matrix
   matrix<dcmplx> L,R;
   hmatrix<dcmplx> H;
    
-  //  loop over clusters
+  //  loop over clusters, lower block tree only for symmetric storage
   for (pairiterator it=tree.pair_begin(); it!=tree.pair_end(); it++)
-    if (tree.admiss(it->first,it->second)==flagRk && 
-        tree.ipart[it->first]==i && tree.ipart[it->second]==j)
+    if (tree.admiss(it->first,it->second)==flagRk && (!sym || tree.lower(it->first,it->second)) &&
+        tree.ipart[it->first]==i && tree.cpart(it->second)==j)
     {     
       //  set cluster
       init(it->first,it->second);
@@ -17,23 +17,42 @@
 
 /*
  * ACA function functor for static Green function
+ *
+ *   Rows and columns may refer to different particles, e.g. evaluation points and
+ *   boundary elements, together with a rectangular cluster tree (see clustertree.h).
+ *
+ *   For particles with mirror symmetry the Green function of a given symmetry sector 
+ *   is the sum over the mirror images of the column element, weighted with the 
+ *   symmetry values, see @compgreenstatmirror/eval.m.
+ *
+ *   g.mirror;      //  sign changes (x,y,z) for mirror operations, one row per operation
+ *   g.symval;      //  symmetry values of sector for mirror operations
+ *
+ *   The Green function G(i,j) = g(r_i,r_j)*area(j) is symmetric up to the area scaling,
+ *   with eval(tol,true) only the low-rank matrices of the lower block tree are computed
+ *   (symmetric storage, see ldl.h).
  */
 
 class greenstat : public acafunc<double>
 {
 public:
-  //  particle and flag ('G' or 'F')
-  particle p;
+  //  particles for rows and columns and flag ('G' or 'F')
+  particle p1, p2;
   std::string flag;
+  //  mirror operations and symmetry values (empty w/o mirror symmetry)
+  matrix<double> mirror, symval;
   //  row and columnn of cluster and cluster size
   size_t row, col;
   mask_t siz;
   
   greenstat() {};
-  greenstat(const particle& pin, const std::string& flagin) : p(pin), flag(flagin) {}
+  greenstat(const particle& pin, const std::string& flagin) : p1(pin), p2(pin), flag(flagin) {}
+  greenstat(const particle& p1in, const particle& p2in, const std::string& flagin) 
+                                              : p1(p1in), p2(p2in), flag(flagin) {}
   greenstat(const greenstat& g) { *this=g; }
   
-  const greenstat& operator= (const greenstat& g) { p=g.p; flag=g.flag; return *this; }
+  const greenstat& operator= (const greenstat& g) 
+    { p1=g.p1; p2=g.p2; flag=g.flag; mirror=g.mirror; symval=g.symval; return *this; }
   
   //  number of rows and columns
   size_t nrows() const { return siz.nrows(); }
@@ -46,21 +65,32 @@ public:
   
   //  initialize cluster
   void init(size_t r, size_t c) 
-    { siz=mask_t(tree.size(row=r),tree.size(col=c)); }
+    { siz=mask_t(tree.size(row=r),tree.csize(col=c)); }
       
   //  evaluate Green function matrices
-  hmatrix<double> eval(double tol);
+  hmatrix<double> eval(double tol, bool sym=false);
+  
+private:
+  //  number of mirror operations, sign change and symmetry value of mirror operation
+  size_t nmirror() const { return mirror.empty() ? 1 : mirror.nrows(); }
+  double sign(size_t k, size_t l) const { return mirror.empty() ? 1. : mirror(k,l); }
+  double value(size_t k) const { return symval.empty() ? 1. : symval[k]; }
+  //  Green function element for row and column element
+  double elem(ptrdiff_t rr, ptrdiff_t cc) const;
 };  
   
 /*
  * ACA function functor for retarded Green function
+ *
+ *   Same as greenstat, mirror symmetry is only supported for the static Green function
+ *   (there is no iterative retarded solver with mirror symmetry).
  */
 
 class greenret : public acafunc<dcmplx>
 {
 public:
-  //  particle and flag ('G' or 'F')
-  particle p;
+  //  particles for rows and columns and flag ('G' or 'F')
+  particle p1, p2;
   std::string flag;
   //  wavenumber
   dcmplx wav;
@@ -70,11 +100,13 @@ public:
   
   greenret() {};
   greenret(const particle& pin, const std::string& flagin, const dcmplx& wavin) 
-                                              : p(pin), flag(flagin), wav(wavin) {}
+                                              : p1(pin), p2(pin), flag(flagin), wav(wavin) {}
+  greenret(const particle& p1in, const particle& p2in, const std::string& flagin, const dcmplx& wavin) 
+                                              : p1(p1in), p2(p2in), flag(flagin), wav(wavin) {}
   greenret(const greenret& g) { *this=g; }
   
   const greenret& operator= (const greenret& g) 
-    { p=g.p; flag=g.flag; wav=g.wav; return *this; }
+    { p1=g.p1; p2=g.p2; flag=g.flag; wav=g.wav; return *this; }
   
   //  number of rows and columns
   size_t nrows() const { return siz.nrows(); }
@@ -87,10 +119,14 @@ public:
   
   //  initialize cluster
   void init(size_t r, size_t c) 
-    { siz=mask_t(tree.size(row=r),tree.size(col=c)); }
+    { siz=mask_t(tree.size(row=r),tree.csize(col=c)); }
       
   //  evaluate Green function matrices
-  hmatrix<dcmplx> eval(size_t i, size_t j, double tol);
+  hmatrix<dcmplx> eval(size_t i, size_t j, double tol, bool sym=false);
+  
+private:
+  //  Green function element for row and column element
+  dcmplx elem(ptrdiff_t rr, ptrdiff_t cc) const;
 };  
   
 #endif  //  acagreen_h
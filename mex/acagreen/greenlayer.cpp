@@ -0,0 +1,397 @@
+#include <cmath>
+#include <complex>
+#include <vector>
+#include <algorithm>
+
+#include "greenlayer.h"
+
+static const double pi=3.14159265358979323846;
+static const double euler=0.57721566490153286061;
+static const dcmplx I(0,1);
+
+//  arguments of Bessel functions above which asymptotic expansions are used
+static const double zasym=12;
+//  maximal number of subintervals for adaptive integration
+static const size_t maxint=500;
+
+
+/*
+ * Complex Bessel and Hankel functions of order 0 and 1
+ */
+
+//  power series for Bessel functions J and Y, see Abramowitz and Stegun 9.1.10-13
+static void besselser(const dcmplx& z, dcmplx& j0, dcmplx& j1, dcmplx* y0=0, dcmplx* y1=0)
+{
+  //  -z^2/4 and terms q^k/(k!)^2, q^k/(k!(k+1)!)
+  dcmplx q=-0.25*z*z, t0=1, t1=1;
+  //  sums for J0 and J1, and for Y0 and Y1 with digamma functions psi(k+1)+psi(k+2)
+  dcmplx s0=1, s1=1, u0=0, u1=1-2*euler;
+  //  harmonic number
+  double h=0;
+
+  for (size_t k=1; k<100; k++)
+  {
+    t0*=q/(double)(k*k);
+    t1*=q/(double)(k*(k+1));
+    h+=1.0/k;
+
+    s0+=t0;  u0+=h*t0;
+    s1+=t1;  u1+=(-2*euler+2*h+1.0/(k+1))*t1;
+    //  terms decrease for k > |z|/2
+    if (k>0.5*abs(z) && abs(t0)+abs(t1)<1e-17*(abs(s0)+abs(s1))) break;
+  }
+  j0=s0;
+  j1=0.5*z*s1;
+  //  Bessel functions of second kind
+  if (y0)
+  {
+    dcmplx lz=log(0.5*z);
+    *y0=2/pi*(lz+euler)*j0-2/pi*u0;
+    *y1=-2.0/(pi*z)+2/pi*lz*j1-0.5/pi*z*u1;
+  }
+}
+
+//  asymptotic series sum_k (i*s/z)^k a_k(nu), mu = 4*nu^2
+static dcmplx asymsum(double mu, const dcmplx& fac)
+{
+  dcmplx sum=1, t=1;
+
+  for (size_t k=1; k<100; k++)
+  {
+    dcmplx tn=t*fac*(mu-(2*k-1)*(2*k-1))/(8.0*k);
+    //  asymptotic series starts to diverge
+    if (abs(tn)>=abs(t)) break;
+    sum+=(t=tn);
+    if (abs(t)<1e-17*abs(sum)) break;
+  }
+  return sum;
+}
+
+//  asymptotic expansion of Hankel functions of first (s=1) or second (s=-1) kind
+static void hankelasym(const dcmplx& z, double s, dcmplx& h0, dcmplx& h1)
+{
+  dcmplx pre=sqrt(2.0/(pi*z)), fac=s*I/z;
+
+  h0=pre*exp(s*I*(z-0.25*pi))*asymsum(0,fac);
+  h1=pre*exp(s*I*(z-0.75*pi))*asymsum(4,fac);
+}
+
+//  Bessel functions of first kind
+void besselj(const dcmplx& z, dcmplx& j0, dcmplx& j1)
+{
+  if (abs(z)<=zasym)
+    besselser(z,j0,j1);
+  else
+  {
+    dcmplx a0, a1, b0, b1;
+    hankelasym(z, 1,a0,a1);
+    hankelasym(z,-1,b0,b1);
+    j0=0.5*(a0+b0);
+    j1=0.5*(a1+b1);
+  }
+}
+
+//  Hankel functions of first kind
+void besselh(const dcmplx& z, dcmplx& h0, dcmplx& h1)
+{
+  if (abs(z)<=zasym)
+  {
+    dcmplx j0, j1, y0, y1;
+    besselser(z,j0,j1,&y0,&y1);
+    h0=j0+I*y0;
+    h1=j1+I*y1;
+  }
+  else
+    hankelasym(z,1,h0,h1);
+}
+
+
+/*
+ * Reflection coefficients and integrands for Sommerfeld integrals
+ */
+
+//  position and wavenumbers for Sommerfeld integration
+struct sommerfeld
+{
+  //  radial distance, distances to interface, sign of z1-z
+  double r, d1, d2, s1;
+  //  media of positions, 0 above and 1 below interface
+  int i1, i2;
+  //  dielectric functions, wavenumbers, wavenumber of light in vacuum
+  dcmplx eps[2], k[2];
+  double k0;
+  //  large half-axis and imaginary part of semi-ellipse
+  double k1max, semi;
+
+  //  reflection coefficients for parallel wavevector, see layerstructure/reflectionsubs.m
+  void refl(const dcmplx& kpar, dcmplx* r, dcmplx* rz, dcmplx& kz1) const;
+  //  integrands with Bessel and Hankel functions
+  void intbessel(const dcmplx& kpar, dcmplx* y) const;
+  void inthankel(const dcmplx& kpar, dcmplx* y) const;
+  //  integrand for semi-ellipse (0), real axis (1), and imaginary axis (2)
+  void integrand(int path, double x, dcmplx* y) const;
+};
+
+//  element (i,j) of reflection and transmission matrices mat1, mat2 of reflectionsubs.m
+static dcmplx element(bool one, int i, int j, const dcmplx& r1, const dcmplx& r2,
+                      const dcmplx& k1z, const dcmplx& k2z)
+{
+  if (i==0 && j==0) return r1;
+  if (i==1 && j==1) return one ? r2 : -r2;
+  if (i==0) return one ? k1z/k2z*(r2+1.0) : -k1z/k2z*r2;
+  return one ? k2z/k1z*(r1+1.0) : k2z/k1z*r1;
+}
+
+void sommerfeld::refl(const dcmplx& kpar, dcmplx* r, dcmplx* rz, dcmplx& kz1) const
+{
+  //  z-component of wavevector with positive imaginary part
+  dcmplx kz[2];
+  for (int i=0; i<2; i++)
+  {
+    kz[i]=sqrt(k[i]*k[i]-kpar*kpar);
+    if (imag(kz[i])+1e-10<0) kz[i]=-kz[i];
+  }
+  //  dielectric functions and wavevectors above and below interface
+  const dcmplx &e1=eps[0], &e2=eps[1], &k1z=kz[0], &k2z=kz[1];
+  //  auxiliary quantity
+  dcmplx Delta=(k2z+k1z)*(e1*k2z+e2*k1z);
+
+  //  parallel surface current
+  dcmplx rr=(k1z-k2z)/(k2z+k1z), p[4]={ rr, 1.0+rr, 1.0-rr, -rr };
+  r[0]=p[2*i1+i2];
+  //  induced surface charge, from surface charge source
+  r[1]=element(true,i1,i2,
+    (k1z+k2z)*(2.0*e1*k1z-e2*k1z-e1*k2z)/Delta,(k2z+k1z)*(2.0*e2*k2z-e1*k2z-e2*k1z)/Delta,k1z,k2z);
+  //  induced surface current, from surface charge source
+  r[2]=element(false,i1,i2,
+    -2*k0*(e2-e1)*e1*k1z/Delta,-2*k0*(e1-e2)*e2*k2z/Delta,k1z,k2z);
+  //  induced surface charge, from surface current source
+  r[3]=element(false,i1,i2,-2*k0*(e2-e1)*k1z/Delta,-2*k0*(e1-e2)*k2z/Delta,k1z,k2z);
+  //  induced surface current, from surface current source
+  r[4]=element(true,i1,i2,
+    (k1z-k2z)*(2.0*e1*k1z-e2*k1z+e1*k2z)/Delta,(k2z-k1z)*(2.0*e2*k2z-e1*k2z+e2*k1z)/Delta,k1z,k2z);
+
+  //  propagation from and to interface
+  dcmplx g1=exp(I*kz[i1]*d1), g2=exp(I*kz[i2]*d2);
+  for (int i=0; i<nGreen; i++)
+  {
+    rz[i]=s1*g1*r[i]*g2;
+    r[i]=g1*r[i]*g2;
+  }
+  kz1=kz[i1];
+}
+
+//  integrand with Bessel functions, see layerstructure/private/intbessel.m
+void sommerfeld::intbessel(const dcmplx& kpar, dcmplx* y) const
+{
+  dcmplx rr[nGreen], rz[nGreen], kz, j0, j1;
+  refl(kpar,rr,rz,kz);
+  besselj(kpar*r,j0,j1);
+
+  for (int i=0; i<nGreen; i++)
+  {
+    y[3*i  ]=I*j0*rr[i]*kpar/kz;
+    y[3*i+1]=I*j1*rr[i]*(-kpar*kpar/kz);
+    y[3*i+2]=I*j0*(I*rz[i]*kpar);
+  }
+}
+
+//  integrand with Hankel functions, see layerstructure/private/inthankel.m
+void sommerfeld::inthankel(const dcmplx& kpar, dcmplx* y) const
+{
+  dcmplx k1=kpar, k2=conj(kpar), r1[nGreen], r1z[nGreen], r2[nGreen], r2z[nGreen], kz1, kz2, h0, h1;
+  refl(k1,r1,r1z,kz1);
+  refl(k2,r2,r2z,kz2);
+  besselh(kpar*r,h0,h1);
+
+  for (int i=0; i<nGreen; i++)
+  {
+    y[3*i  ]=0.5*I*(h0*r1[i]*k1/kz1-conj(h0)*r2[i]*k2/kz2);
+    y[3*i+1]=0.5*I*(h1*r1[i]*(-k1*k1/kz1)-conj(h1)*r2[i]*(-k2*k2/kz2));
+    y[3*i+2]=0.5*I*(h0*I*r1z[i]*k1-conj(h0)*I*r2z[i]*k2);
+  }
+}
+
+//  integrand for integration path, see layerstructure/green.m
+void sommerfeld::integrand(int path, double x, dcmplx* y) const
+{
+  dcmplx fac;
+  switch (path)
+  {
+    case 0:
+      //  semi-ellipse
+      intbessel(k1max*(1-cos(x)-I*semi*sin(x)),y);
+      fac=k1max*(sin(x)-I*semi*cos(x));
+      break;
+    case 1:
+      //  real kr-axis
+      intbessel(2*k1max/x,y);
+      fac=-2*k1max/(x*x);
+      break;
+    default:
+      //  imaginary kr-axis
+      inthankel(2*k1max*(1.0-I+I/x),y);
+      fac=-2.0*I*k1max/(x*x);
+  }
+  for (int i=0; i<3*nGreen; i++) y[i]*=fac;
+}
+
+
+/*
+ * Adaptive Gauss-Kronrod integration
+ */
+
+//  nodes and weights of 7-point Gauss and 15-point Kronrod rules
+static const double xgk[8]={
+  0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+  0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+  0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+  0.207784955007898467600689403773245, 0.000000000000000000000000000000000 };
+static const double wgk[8]={
+  0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+  0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+  0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+  0.204432940075298892414161999234649, 0.209482141084727828012999174891714 };
+static const double wg[4]={
+  0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+  0.381830050505118944950369775488975, 0.417959183673469387755102040816327 };
+
+//  integral over subinterval with error estimate
+struct interval
+{
+  double a, b;
+  dcmplx val[3*nGreen], err[3*nGreen];
+};
+
+//  Gauss-Kronrod rule for subinterval
+static void gk15(const sommerfeld& s, int path, interval& in)
+{
+  double c=0.5*(in.a+in.b), h=0.5*(in.b-in.a);
+  dcmplx y1[3*nGreen], y2[3*nGreen], g[3*nGreen];
+
+  //  center of interval
+  s.integrand(path,c,y1);
+  for (int i=0; i<3*nGreen; i++) in.val[i]=wgk[7]*y1[i], g[i]=wg[3]*y1[i];
+  //  symmetric pairs of nodes, odd nodes belong to Gauss rule
+  for (int j=0; j<7; j++)
+  {
+    s.integrand(path,c-h*xgk[j],y1);
+    s.integrand(path,c+h*xgk[j],y2);
+    for (int i=0; i<3*nGreen; i++)
+    {
+      in.val[i]+=wgk[j]*(y1[i]+y2[i]);
+      if (j%2) g[i]+=wg[j/2]*(y1[i]+y2[i]);
+    }
+  }
+  for (int i=0; i<3*nGreen; i++) in.val[i]*=h, in.err[i]=in.val[i]-h*g[i];
+}
+
+//  adaptive integration over [a,b], bisect interval with largest error until
+//    error of each component is below max(abstol,reltol*|y|),
+//    returns false if maximal number of subintervals is reached
+static bool integrate(const sommerfeld& s, int path, double a, double b,
+                      double abstol, double reltol, dcmplx* y)
+{
+  std::vector<interval> in(1);
+  in[0].a=a;  in[0].b=b;
+  gk15(s,path,in[0]);
+
+  while (in.size()<maxint)
+  {
+    //  total integral and error
+    double err[3*nGreen];
+    for (int i=0; i<3*nGreen; i++) y[i]=0, err[i]=0;
+    for (size_t j=0; j<in.size(); j++)
+    for (int i=0; i<3*nGreen; i++) y[i]+=in[j].val[i], err[i]+=abs(in[j].err[i]);
+    //  converged ?
+    bool conv=true;
+    for (int i=0; i<3*nGreen; i++) conv=conv && err[i]<=std::max(abstol,reltol*abs(y[i]));
+    if (conv) return true;
+
+    //  interval with largest relative error
+    size_t jmax=0;
+    double emax=0;
+    for (size_t j=0; j<in.size(); j++)
+    for (int i=0; i<3*nGreen; i++)
+    {
+      double e=abs(in[j].err[i])/std::max(abstol,reltol*abs(y[i]));
+      if (e>emax) emax=e, jmax=j;
+    }
+    //  bisect interval
+    interval right=in[jmax];
+    in[jmax].b=right.a=0.5*(in[jmax].a+in[jmax].b);
+    gk15(s,path,in[jmax]);
+    gk15(s,path,right);
+    in.push_back(right);
+  }
+  //  maximal number of subintervals reached
+  for (int i=0; i<3*nGreen; i++) y[i]=0;
+  for (size_t j=0; j<in.size(); j++)
+  for (int i=0; i<3*nGreen; i++) y[i]+=in[j].val[i];
+  return false;
+}
+
+
+/*
+ * Tabulation of reflected Green functions
+ */
+
+//  reflected Green functions and derivatives for single position
+bool greenlayer::eval(double enei, const dcmplx& eps1, const dcmplx& eps2,
+  double r, double z1, double z2, dcmplx* g, dcmplx* fr, dcmplx* fz) const
+{
+  sommerfeld s;
+  //  minimal radial distance
+  s.r=std::max(r,rmin);
+  //  shift points that are too close to interface, see layerstructure/round.m
+  double sign1=(z1>z)-(z1<z), sign2=(z2>z)-(z2<z);
+  if (fabs(z1-z)<=zmin) z1=z+sign1*zmin;
+  if (fabs(z2-z)<=zmin) z2=z+sign2*zmin;
+  //  distances to interface and media of positions
+  s.d1=fabs(z1-z);  s.i1=(z1>z) ? 0 : 1;  s.s1=sign1;
+  s.d2=fabs(z2-z);  s.i2=(z2>z) ? 0 : 1;
+  //  dielectric functions and wavenumbers
+  s.k0=2*pi/enei;
+  s.eps[0]=eps1;  s.k[0]=s.k0*sqrt(eps1);
+  s.eps[1]=eps2;  s.k[1]=s.k0*sqrt(eps2);
+  //  large half-axis and imaginary part of semi-ellipse
+  s.k1max=std::max(real(s.k[0]),real(s.k[1]))+s.k0;
+  s.semi=semi;
+
+  dcmplx y1[3*nGreen], y2[3*nGreen];
+  //  semi-ellipse in complex kr-plane
+  bool conv=integrate(s,0,0,pi,abstol,reltol,y1);
+  //  integration along real or imaginary axis from 1 to 1e-10
+  conv=integrate(s,s.d1+s.d2>=s.r/ratio ? 1 : 2,1e-10,1,abstol,reltol,y2) && conv;
+
+  for (int i=0; i<nGreen; i++)
+  {
+    g [i]=y1[3*i  ]-y2[3*i  ];
+    fr[i]=y1[3*i+1]-y2[3*i+1];
+    fz[i]=y1[3*i+2]-y2[3*i+2];
+  }
+  return conv;
+}
+
+//  tabulate reflected Green functions and derivatives on grid (r,z1,z2) for wavelengths,
+//    returns number of tabulation points where integration has not converged
+size_t greenlayer::tab(size_t ne, const double* enei, const dcmplx* eps1, const dcmplx* eps2,
+  size_t nr, const double* r, size_t n1, const double* z1, size_t n2, const double* z2,
+  dcmplx* G[], dcmplx* Fr[], dcmplx* Fz[]) const
+{
+  //  number of grid points
+  ptrdiff_t n=nr*n1*n2, ntot=n*ne, nfail=0;
+
+  //  parallel loop over grid points and wavelengths
+  #pragma omp parallel for schedule(dynamic) reduction(+:nfail)
+  for (ptrdiff_t i=0; i<ntot; i++)
+  {
+    //  indices of wavelength and grid position
+    size_t ie=i/n, ir=(i%n)%nr, i1=((i%n)/nr)%n1, i2=(i%n)/(nr*n1);
+    dcmplx g[nGreen], fr[nGreen], fz[nGreen];
+    if (!eval(enei[ie],eps1[ie],eps2[ie],r[ir],z1[i1],z2[i2],g,fr,fz)) nfail++;
+
+    for (int k=0; k<nGreen; k++) G[k][i]=g[k], Fr[k][i]=fr[k], Fz[k][i]=fz[k];
+  }
+  return nfail;
+}
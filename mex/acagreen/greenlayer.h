@@ -0,0 +1,66 @@
+//  greenlayer.h - Tabulation of reflected Green functions for substrate.
+//
+//  Native version of layerstructure/green.m for a single interface, see Waxenegger
+//  et al., Comp. Phys. Commun. 193, 138 (2015).  The Sommerfeld integrals are computed
+//  along the integration path of M. Paulus et al., PRE 62, 5797 (2000), consisting of
+//  a semi-ellipse in the complex kr-plane followed by an integration along the real
+//  or imaginary axis.  Instead of the ODE integration of Matlab we use an adaptive
+//  Gauss-Kronrod quadrature for each tabulation point, such that grid points and
+//  wavelengths can be processed in parallel.
+//
+//  The tabulated values are written in column-major order (r,z1,z2), which is the
+//  layout used by interp2 and interp3.  The reflected Green functions are ordered as
+//  p, ss, hs, sh, hh, in agreement with layerstructure/reflectionsubs.m.
+
+/* greenlayer layer;                  //  substrate with default options
+ * layer.z=0;  layer.rmin=1e-2; ...   //  set interface position and options
+ * nfail=layer.tab(ne,enei,eps1,eps2,nr,r,n1,z1,n2,z2,G,Fr,Fz);
+ *                                    //  tabulate Green functions for ne wavelengths,
+ *                                    //    G[i], Fr[i], Fz[i] arrays of size nr*n1*n2*ne,
+ *                                    //    nfail points where integration not converged
+ * conv=layer.eval(enei,eps1,eps2,r,z1,z2,g,fr,fz);
+ *                                    //  Green functions for single position
+ */
+
+#include <cmath>
+#include <complex>
+
+#include "hoptions.h"
+
+#ifndef greenlayer_h
+#define greenlayer_h
+
+//  number of reflected Green functions p, ss, hs, sh, hh
+#define nGreen 5
+
+//  complex Bessel functions of order 0 and 1, and Hankel functions of first kind
+void besselj(const dcmplx& z, dcmplx& j0, dcmplx& j1);
+void besselh(const dcmplx& z, dcmplx& h0, dcmplx& h1);
+
+class greenlayer
+{
+public:
+  //  z-value of interface
+  double z;
+  //  minimal radial distance and minimal distance to interface
+  double rmin, zmin;
+  //  imaginary part of semi-ellipse, z : r ratio which determines integration path
+  double semi, ratio;
+  //  absolute and relative tolerance for integration
+  double abstol, reltol;
+
+  //  constructor, default values of layerstructure.options
+  greenlayer() : z(0), rmin(1e-2), zmin(1e-2), semi(0.1), ratio(2), abstol(1e-6), reltol(1e-3) {}
+
+  //  tabulate reflected Green functions and derivatives on grid (r,z1,z2) for
+  //    wavelengths enei with dielectric functions eps1 and eps2 above and below interface,
+  //    returns number of tabulation points where integration has not converged
+  size_t tab(size_t ne, const double* enei, const dcmplx* eps1, const dcmplx* eps2,
+    size_t nr, const double* r, size_t n1, const double* z1, size_t n2, const double* z2,
+    dcmplx* G[], dcmplx* Fr[], dcmplx* Fz[]) const;
+  //  reflected Green functions and derivatives for single position, false if not converged
+  bool eval(double enei, const dcmplx& eps1, const dcmplx& eps2,
+    double r, double z1, double z2, dcmplx* g, dcmplx* fr, dcmplx* fz) const;
+};
+
+#endif  //  greenlayer_h
@@ -2,8 +2,13 @@
 #include <cmath>
 
 #include "greentab.h"
+#ifdef MEX
+#include "tabcache.h"
 #include "mex.h"
 
+//  cache for Green function tables, kept between MEX calls
+static tabcache cache;
+
 std::string getstring(const mxArray* rhs)
 {
   char str[10];
@@ -12,6 +17,49 @@ std::string getstring(const mxArray* rhs)
   return std::string(str);
 }
 
+//  interpolation method, "linear" (default) or "cubic"
+std::string getimod(const mxArray* rhs)
+{
+  return mxGetField(rhs,0,"imod") ? getstring(mxGetField(rhs,0,"imod")) : "linear";
+}
+
+//  string field of arbitrary length, empty if not present
+static std::string getfield(const mxArray* rhs, const char* name)
+{
+  const mxArray* field=mxGetField(rhs,0,name);
+  if (!field || !mxIsChar(field)) return "";
+  
+  char* str=mxArrayToString(field);
+  std::string s(str);
+  mxFree(str);
+  return s;
+}
+
+//  key for table cache, extended by table name, interpolation method and dimension,
+//    empty if table should not be cached
+static std::string getkey(const mxArray* rhs, const char* name, size_t dim)
+{
+  std::string key=getfield(rhs,"key");
+  //  maximal size of resident tables in MB
+  if (mxGetField(rhs,0,"cachesize")) 
+    cache.maxbytes=(size_t)(mxGetScalar(mxGetField(rhs,0,"cachesize"))*(1<<20));
+  
+  return key.empty() ? key : key+"/"+name+"/"+getimod(rhs)+(dim==2 ? "/2D" : "/3D");
+}
+
+//  is table of Matlab structure available in table cache (memory or file) ?
+bool incache(const mxArray* rhs, const char* name)
+{
+  size_t dim=mxIsScalar(mxGetField(rhs,0,"z2")) ? 2 : 3;
+  std::string key=getkey(rhs,name,dim), dir=getfield(rhs,"cachedir");
+  if (key.empty()) return false;
+  
+  if (dim==2) { interp2<dcmplx> t;  return cache.find(key,dir,t); }
+  interp3<dcmplx> t;
+  return cache.find(key,dir,t);
+}
+#endif  //  MEX
+
 //  evaluate Green function matrix 
 hmatrix<dcmplx> greentab::eval(size_t i, size_t j, double tol)
 {
@@ -34,35 +82,46 @@ hmatrix<dcmplx> greentab::eval(size_t i, size_t j, double tol)
   return H;
 } 
 
+
 /*
  * 2D interpolation of Green function
  */
 
+#ifdef MEX
 //  constructor
 greentabG2::greentabG2(const particle& part, const mxArray* prhs[]) : greentab(part)
 {
-  matrix<double>  r=matrix<double>::getmex(mxGetField(prhs[0],0,"r"));
-  matrix<double> z1=matrix<double>::getmex(mxGetField(prhs[0],0,"z1"));
-  matrix<dcmplx>  g=matrix<dcmplx>::getmex(mxGetField(prhs[0],0,"G"));
-  //  storage type "lin" or "log"
-  std::string rmod=getstring(mxGetField(prhs[0],0,"rmod"));
-  std::string zmod=getstring(mxGetField(prhs[0],0,"zmod"));
-
-  //  initialize interpolator
-  gtab=interp2<dcmplx>(r,rmod,z1,zmod,g);
+  //  key and directory for table cache
+  std::string key=getkey(prhs[0],"G",2), dir=getfield(prhs[0],"cachedir");
+  //  import table if not cached
+  if (key.empty() || !cache.find(key,dir,gtab))
+  {
+    matrix<double>  r;  r.mexview(mxGetField(prhs[0],0,"r"));
+    matrix<double> z1;  z1.mexview(mxGetField(prhs[0],0,"z1"));
+    matrix<dcmplx>  g;  g.mexview(mxGetField(prhs[0],0,"G"));
+    //  storage type "lin" or "log"
+    std::string rmod=getstring(mxGetField(prhs[0],0,"rmod"));
+    std::string zmod=getstring(mxGetField(prhs[0],0,"zmod"));
+    
+    //  initialize interpolator
+    gtab=interp2<dcmplx>(r,rmod,z1,zmod,g,getimod(prhs[0]));
+    if (!key.empty()) cache.insert(key,dir,gtab);
+  }
   //  layer index
   size_t ind=(size_t)mxGetScalar(prhs[1]);
   //  uppermost layer
   uplo=(ind==1) ? 'U' : 'L';
   //  minimum radial distance
-  rmin=r[0];
+  rmin=gtab.ax.tab[0];
 }
+#endif  //  MEX
 
 //  get row for 2D Green function
 void greentabG2::getrow(size_t r, dcmplx* b) const
 {
   ptrdiff_t n=ncols(), np=p.n, rr=siz.rbegin+r, cc=siz.cbegin;
-  matrix<double> rho(n,1), z(n,1);
+  greenwork& w=workspace(n);
+  double *rho=&w.rho[0], *z=&w.z1[0];
   
   //  distances
   for (ptrdiff_t c=0; c<n; c++) 
@@ -74,19 +133,20 @@ void greentabG2::getrow(size_t r, dcmplx* b) const
     z[c]=p.z[rr]+(uplo=='U' ? 1 : -1)*p.z[cc+c];
   }
   
-  //  perform interpolation
-  matrix<dcmplx> g=gtab(rho,z);
+  //  perform interpolation, write directly to output
+  gtab(n,rho,z,b);
   //  Green function, for interpolation see 
   //    Waxenegger et al., Comp. Phys. Commun. 193, 138 (2015), Eq. (15).
   for (ptrdiff_t c=0; c<n; c++) 
-    b[c]=g[c]/sqrt(pow(rho[c],2)+pow(z[c],2))*p.area[cc+c];
+    b[c]=b[c]/sqrt(pow(rho[c],2)+pow(z[c],2))*p.area[cc+c];
 }
 
 //  get column for 2D Green function
 void greentabG2::getcol(size_t c, dcmplx* a) const
 {
   ptrdiff_t m=nrows(), np=p.n, rr=siz.rbegin, cc=siz.cbegin+c;
-  matrix<double> rho(m,1), z(m,1);
+  greenwork& w=workspace(m);
+  double *rho=&w.rho[0], *z=&w.z1[0];
   
   //  distances
   for (ptrdiff_t r=0; r<m; r++) 
@@ -98,39 +158,51 @@ void greentabG2::getcol(size_t c, dcmplx* a) const
     z[r]=p.z[rr+r]+(uplo=='U' ? 1 : -1)*p.z[cc];
   }
   
-  //  perform interpolation
-  matrix<dcmplx> g=gtab(rho,z);
+  //  perform interpolation, write directly to output
+  gtab(m,rho,z,a);
   //  Green function, for interpolation see 
   //    Waxenegger et al., Comp. Phys. Commun. 193, 138 (2015), Eq. (15).
   for (ptrdiff_t r=0; r<m; r++) 
-    a[r]=g[r]/sqrt(pow(rho[r],2)+pow(z[r],2))*p.area[cc];
+    a[r]=a[r]/sqrt(pow(rho[r],2)+pow(z[r],2))*p.area[cc];
 }
 
 /*
  * 3D interpolation of Green function
  */
 
+#ifdef MEX
 //  constructor
 greentabG3::greentabG3(const particle& part, const mxArray* prhs[]) : greentab(part)
 {
-  matrix<double>  r=matrix<double>::getmex(mxGetField(prhs[0],0,"r"));
-  matrix<double> z1=matrix<double>::getmex(mxGetField(prhs[0],0,"z1"));
-  matrix<double> z2=matrix<double>::getmex(mxGetField(prhs[0],0,"z2"));
-  matrix<dcmplx>  g=matrix<dcmplx>::getmex(mxGetField(prhs[0],0,"G"));
-  //  storage type "lin" or "log"
-  std::string rmod=getstring(mxGetField(prhs[0],0,"rmod"));
-  std::string zmod=getstring(mxGetField(prhs[0],0,"zmod"));
-  //  initialize interpolator
-  gtab=interp3<dcmplx>(r,rmod,z1,zmod,z2,zmod,g);
+  //  key and directory for table cache
+  std::string key=getkey(prhs[0],"G",3), dir=getfield(prhs[0],"cachedir");
+  //  import table if not cached
+  if (key.empty() || !cache.find(key,dir,gtab))
+  {
+    matrix<double>  r;  r.mexview(mxGetField(prhs[0],0,"r"));
+    matrix<double> z1;  z1.mexview(mxGetField(prhs[0],0,"z1"));
+    matrix<double> z2;  z2.mexview(mxGetField(prhs[0],0,"z2"));
+    matrix<dcmplx>  g;  g.mexview(mxGetField(prhs[0],0,"G"));
+    //  storage type "lin" or "log"
+    std::string rmod=getstring(mxGetField(prhs[0],0,"rmod"));
+    std::string zmod=getstring(mxGetField(prhs[0],0,"zmod"));
+    //  initialize interpolator
+    gtab=interp3<dcmplx>(r,rmod,z1,zmod,z2,zmod,g,getimod(prhs[0]));
+    //  store table in bricks for cache-friendly access of interpolation stencils
+    gtab.tile(4);
+    if (!key.empty()) cache.insert(key,dir,gtab);
+  }
   //  minimum radial distance
-  rmin=r[0];  
+  rmin=gtab.ax.tab[0];  
 }
+#endif  //  MEX
 
 //  get row for 3D Green function
 void greentabG3::getrow(size_t r, dcmplx* b) const
 {
   ptrdiff_t n=ncols(), np=p.n, rr=siz.rbegin+r, cc=siz.cbegin;
-  matrix<double> rho(n,1), z1(n,1), z2(n,1);
+  greenwork& w=workspace(n);
+  double *rho=&w.rho[0], *z1=&w.z1[0], *z2=&w.z2[0];
   
   //  distances
   for (ptrdiff_t c=0; c<n; c++) 
@@ -143,70 +215,83 @@ void greentabG3::getrow(size_t r, dcmplx* b) const
     z2[c]=p.z[cc+c];
   }
   
-  //  perform interpolation
-  matrix<dcmplx> g=gtab(rho,z1,z2);
+  //  perform interpolation, write directly to output
+  gtab(n,rho,z1,z2,b);
   //  Green function, for interpolation see 
   //    Waxenegger et al., Comp. Phys. Commun. 193, 138 (2015), Eq. (15).
   for (ptrdiff_t c=0; c<n; c++) 
-    b[c]=g[c]/sqrt(pow(rho[c],2)+pow(z1[c]+z2[c],2))*p.area[cc+c];
+    b[c]=b[c]/sqrt(pow(rho[c],2)+pow(z1[c]+z2[c],2))*p.area[cc+c];
 }
 
 //  get column for 3D Green function
 void greentabG3::getcol(size_t c, dcmplx* a) const
 {
   ptrdiff_t m=nrows(), np=p.n, rr=siz.rbegin, cc=siz.cbegin+c;
-  matrix<double> rho(m,1), z1(m,1), z2(m,1);
+  greenwork& w=workspace(m);
+  double *rho=&w.rho[0], *z1=&w.z1[0], *z2=&w.z2[0];
   
   //  distances
   for (ptrdiff_t r=0; r<m; r++) 
   {
     //  polar distance
     rho[r]=sqrt(pow(p.pos[rr+r]-p.pos[cc],2)+pow(p.pos[rr+r+np]-p.pos[cc+np],2));
-    rho[c]=std::max<double>(rmin,rho[c]);
+    rho[r]=std::max<double>(rmin,rho[r]);
     //  z-distances
     z1[r]=p.z[rr+r];
     z2[r]=p.z[cc];
   }
   
-  //  perform interpolation
-  matrix<dcmplx> g=gtab(rho,z1,z2);
+  //  perform interpolation, write directly to output
+  gtab(m,rho,z1,z2,a);
   //  Green function, for interpolation see 
   //    Waxenegger et al., Comp. Phys. Commun. 193, 138 (2015), Eq. (15).
   for (ptrdiff_t r=0; r<m; r++) 
-    a[r]=g[r]/sqrt(pow(rho[r],2)+pow(z1[r]+z2[r],2))*p.area[cc];
+    a[r]=a[r]/sqrt(pow(rho[r],2)+pow(z1[r]+z2[r],2))*p.area[cc];
 }
 
 /*
  * 2D interpolation of surface derivative of Green function
  */
 
+#ifdef MEX
 //  constructor
 greentabF2::greentabF2(const particle& part, const mxArray* prhs[]) : greentab(part)
 {
-  matrix<double>  r=matrix<double>::getmex(mxGetField(prhs[0],0,"r"));
-  matrix<double> z1=matrix<double>::getmex(mxGetField(prhs[0],0,"z1"));
-  matrix<dcmplx> fr=matrix<dcmplx>::getmex(mxGetField(prhs[0],0,"Fr"));
-  matrix<dcmplx> fz=matrix<dcmplx>::getmex(mxGetField(prhs[0],0,"Fz"));
-  //  storage type "lin" or "log"
-  std::string rmod=getstring(mxGetField(prhs[0],0,"rmod"));
-  std::string zmod=getstring(mxGetField(prhs[0],0,"zmod"));
-
-  //  initialize interpolators
-  frtab=interp2<dcmplx>(r,rmod,z1,zmod,fr);
-  fztab=interp2<dcmplx>(r,rmod,z1,zmod,fz);
+  //  key and directory for table cache
+  std::string key=getkey(prhs[0],"F",2), dir=getfield(prhs[0],"cachedir");
+  //  import table if not cached
+  if (key.empty() || !cache.find(key,dir,ftab))
+  {
+    matrix<double>  r;  r.mexview(mxGetField(prhs[0],0,"r"));
+    matrix<double> z1;  z1.mexview(mxGetField(prhs[0],0,"z1"));
+    //  surface derivatives, interpolated together on same grid
+    std::vector<matrix<dcmplx> > f(2);
+    f[0].mexview(mxGetField(prhs[0],0,"Fr"));
+    f[1].mexview(mxGetField(prhs[0],0,"Fz"));
+    //  storage type "lin" or "log"
+    std::string rmod=getstring(mxGetField(prhs[0],0,"rmod"));
+    std::string zmod=getstring(mxGetField(prhs[0],0,"zmod"));
+    
+    //  initialize interpolator
+    ftab=interp2<dcmplx>(r,rmod,z1,zmod,f,getimod(prhs[0]));
+    if (!key.empty()) cache.insert(key,dir,ftab);
+  }
   //  layer index
   size_t ind=(size_t)mxGetScalar(prhs[1]);
   //  uppermost layer
   uplo=(ind==1) ? 'U' : 'L';
   //  minimum radial distance
-  rmin=r[0];  
+  rmin=ftab.ax.tab[0];  
 }
+#endif  //  MEX
 
 //  get row for 2D surface derivative of Green function
 void greentabF2::getrow(size_t r, dcmplx* b) const
 {
   ptrdiff_t n=ncols(), np=p.n, rr=siz.rbegin+r, cc=siz.cbegin;
-  matrix<double> rho(n,1), z(n,1), in(n,1);
+  greenwork& w=workspace(n,2);
+  double *rho=&w.rho[0], *z=&w.z1[0], *in=&w.in[0];
+  const dcmplx* f=&w.f[0];
   double x, y;
   
   //  distances
@@ -222,14 +307,14 @@ void greentabF2::getrow(size_t r, dcmplx* b) const
     z[c]=p.z[rr]+(uplo=='U' ? 1 : -1)*p.z[cc+c];
   }
   
-  //  perform interpolation
-  matrix<dcmplx> fr=frtab(rho,z), fz=fztab(rho,z);
+  //  perform interpolation, Fr and Fz interleaved
+  ftab(n,rho,z,&w.f[0]);
   //  Green function, for interpolation see 
   //    Waxenegger et al., Comp. Phys. Commun. 193, 138 (2015), Eq. (15).
   for (ptrdiff_t c=0; c<n; c++) 
   {
     double d=sqrt(pow(rho[c],2)+pow(z[c],2));
-    b[c]=(in[c]*rho[c]*fr[c]+p.nvec[rr+2*np]*z[c]*fz[c])/pow(d,3)*p.area[cc+c];
+    b[c]=(in[c]*rho[c]*f[2*c]+p.nvec[rr+2*np]*z[c]*f[2*c+1])/pow(d,3)*p.area[cc+c];
   }
 }
 
@@ -237,7 +322,9 @@ void greentabF2::getrow(size_t r, dcmplx* b) const
 void greentabF2::getcol(size_t c, dcmplx* a) const
 {
   ptrdiff_t m=nrows(), np=p.n, rr=siz.rbegin, cc=siz.cbegin+c;
-  matrix<double> rho(m,1), z(m,1), in(m,1);
+  greenwork& w=workspace(m,2);
+  double *rho=&w.rho[0], *z=&w.z1[0], *in=&w.in[0];
+  const dcmplx* f=&w.f[0];
   double x, y;
   
   //  distances
@@ -253,14 +340,14 @@ void greentabF2::getcol(size_t c, dcmplx* a) const
     z[r]=p.z[rr+r]+(uplo=='U' ? 1 : -1)*p.z[cc];
   }
   
-  //  perform interpolation
-  matrix<dcmplx> fr=frtab(rho,z), fz=fztab(rho,z);
+  //  perform interpolation, Fr and Fz interleaved
+  ftab(m,rho,z,&w.f[0]);
   //  Green function, for interpolation see 
   //    Waxenegger et al., Comp. Phys. Commun. 193, 138 (2015), Eq. (15).
   for (ptrdiff_t r=0; r<m; r++) 
   {
     double d=sqrt(pow(rho[r],2)+pow(z[r],2));
-    a[r]=(in[r]*rho[r]*fr[r]+p.nvec[rr+r+2*np]*z[r]*fz[r])/pow(d,3)*p.area[cc];
+    a[r]=(in[r]*rho[r]*f[2*r]+p.nvec[rr+r+2*np]*z[r]*f[2*r+1])/pow(d,3)*p.area[cc];
   }
 }
 
@@ -268,29 +355,43 @@ void greentabF2::getcol(size_t c, dcmplx* a) const
  * 3D interpolation of surface derivative of Green function
  */
 
+#ifdef MEX
 //  constructor
 greentabF3::greentabF3(const particle& part, const mxArray* prhs[]) : greentab(part)
 {
-  matrix<double>  r=matrix<double>::getmex(mxGetField(prhs[0],0,"r"));
-  matrix<double> z1=matrix<double>::getmex(mxGetField(prhs[0],0,"z1"));
-  matrix<double> z2=matrix<double>::getmex(mxGetField(prhs[0],0,"z2"));
-  matrix<dcmplx> fr=matrix<dcmplx>::getmex(mxGetField(prhs[0],0,"Fr"));
-  matrix<dcmplx> fz=matrix<dcmplx>::getmex(mxGetField(prhs[0],0,"Fz"));
-  //  storage type "lin" or "log"
-  std::string rmod=getstring(mxGetField(prhs[0],0,"rmod"));
-  std::string zmod=getstring(mxGetField(prhs[0],0,"zmod"));
-  //  initialize interpolators
-  frtab=interp3<dcmplx>(r,rmod,z1,zmod,z2,zmod,fr);
-  fztab=interp3<dcmplx>(r,rmod,z1,zmod,z2,zmod,fz);
+  //  key and directory for table cache
+  std::string key=getkey(prhs[0],"F",3), dir=getfield(prhs[0],"cachedir");
+  //  import table if not cached
+  if (key.empty() || !cache.find(key,dir,ftab))
+  {
+    matrix<double>  r;  r.mexview(mxGetField(prhs[0],0,"r"));
+    matrix<double> z1;  z1.mexview(mxGetField(prhs[0],0,"z1"));
+    matrix<double> z2;  z2.mexview(mxGetField(prhs[0],0,"z2"));
+    //  surface derivatives, interpolated together on same grid
+    std::vector<matrix<dcmplx> > f(2);
+    f[0].mexview(mxGetField(prhs[0],0,"Fr"));
+    f[1].mexview(mxGetField(prhs[0],0,"Fz"));
+    //  storage type "lin" or "log"
+    std::string rmod=getstring(mxGetField(prhs[0],0,"rmod"));
+    std::string zmod=getstring(mxGetField(prhs[0],0,"zmod"));
+    //  initialize interpolator
+    ftab=interp3<dcmplx>(r,rmod,z1,zmod,z2,zmod,f,getimod(prhs[0]));
+    //  store table in bricks for cache-friendly access of interpolation stencils
+    ftab.tile(4);
+    if (!key.empty()) cache.insert(key,dir,ftab);
+  }
   //  minimum radial distance
-  rmin=r[0];  
+  rmin=ftab.ax.tab[0];  
 }
+#endif  //  MEX
 
 //  get row for 3D surface derivative of Green function
 void greentabF3::getrow(size_t r, dcmplx* b) const
 {
   ptrdiff_t n=ncols(), np=p.n, rr=siz.rbegin+r, cc=siz.cbegin;
-  matrix<double> rho(n,1), z1(n,1), z2(n,1), in(n,1);
+  greenwork& w=workspace(n,2);
+  double *rho=&w.rho[0], *z1=&w.z1[0], *z2=&w.z2[0], *in=&w.in[0];
+  const dcmplx* f=&w.f[0];
   double x, y;
   
   //  distances
@@ -307,14 +408,14 @@ void greentabF3::getrow(size_t r, dcmplx* b) const
     z2[c]=p.z[cc+c];
   }
   
-  //  perform interpolation
-  matrix<dcmplx> fr=frtab(rho,z1,z2), fz=fztab(rho,z1,z2);
+  //  perform interpolation, Fr and Fz interleaved
+  ftab(n,rho,z1,z2,&w.f[0]);
   //  Green function, for interpolation see 
   //    Waxenegger et al., Comp. Phys. Commun. 193, 138 (2015), Eq. (15).
   for (ptrdiff_t c=0; c<n; c++) 
   {
     double z=z1[c]+z2[c], d=sqrt(pow(rho[c],2)+pow(z,2));
-    b[c]=(in[c]*rho[c]*fr[c]+p.nvec[rr+2*np]*z*fz[c])/pow(d,3)*p.area[cc+c];
+    b[c]=(in[c]*rho[c]*f[2*c]+p.nvec[rr+2*np]*z*f[2*c+1])/pow(d,3)*p.area[cc+c];
   }
 }
 
@@ -322,7 +423,9 @@ void greentabF3::getrow(size_t r, dcmplx* b) const
 void greentabF3::getcol(size_t c, dcmplx* a) const
 {
   ptrdiff_t m=nrows(), np=p.n, rr=siz.rbegin, cc=siz.cbegin+c;
-  matrix<double> rho(m,1), z1(m,1), z2(m,1), in(m,1);
+  greenwork& w=workspace(m,2);
+  double *rho=&w.rho[0], *z1=&w.z1[0], *z2=&w.z2[0], *in=&w.in[0];
+  const dcmplx* f=&w.f[0];
   double x, y;
   
   //  distances
@@ -339,13 +442,13 @@ void greentabF3::getcol(size_t c, dcmplx* a) const
     z2[r]=p.z[cc];
   }
   
-  //  perform interpolation
-  matrix<dcmplx> fr=frtab(rho,z1,z2), fz=fztab(rho,z1,z2);
+  //  perform interpolation, Fr and Fz interleaved
+  ftab(m,rho,z1,z2,&w.f[0]);
   //  Green function, for interpolation see 
   //    Waxenegger et al., Comp. Phys. Commun. 193, 138 (2015), Eq. (15).
   for (ptrdiff_t r=0; r<m; r++) 
   {
     double z=z1[r]+z2[r], d=sqrt(pow(rho[r],2)+pow(z,2));
-    a[r]=(in[r]*rho[r]*fr[r]+p.nvec[rr+r+2*np]*z*fz[r])/pow(d,3)*p.area[cc];
+    a[r]=(in[r]*rho[r]*f[2*r]+p.nvec[rr+r+2*np]*z*f[2*r+1])/pow(d,3)*p.area[cc];
   }
 }
@@ -1,6 +1,16 @@
 //  greentab.h - Interpolation of tabulated Green function values.
+//
+//  The table structure passed from Matlab may contain the optional field imod,
+//  'linear' (default) or 'cubic', which selects the interpolation method.
+//  With the optional field key the interpolator is kept in a table cache between
+//  MEX calls (see tabcache.h), with cachedir the tables are also stored in files
+//  and cachesize (in MB) sets the maximal size of resident tables.  Cached tables
+//  need no table values, use incache to check before tabulating.  The table grids
+//  r, z1, z2 may be piecewise uniform (see tabspace with option 'refine'), the
+//  segments are detected when the interpolation axes are set up.
 
 #include <string>
+#include <vector>
 
 #include "hoptions.h"
 #include "basemat.h"
@@ -13,6 +23,23 @@
 #ifndef greentab_h
 #define greentab_h
 
+#ifdef MEX
+//  is table of Matlab structure in table cache, name "G" or "F"
+bool incache(const mxArray* rhs, const char* name);
+#endif
+
+
+//  workspace for distances, inner products and interpolated values
+struct greenwork
+{
+  std::vector<double> rho, z1, z2, in;
+  std::vector<dcmplx> f;
+  
+  //  make sure that arrays can hold n elements and nc interpolated values per element
+  void resize(size_t n, size_t nc=1)
+    { if (rho.size()<n) rho.resize(n), z1.resize(n), z2.resize(n), in.resize(n);
+      if (f.size()<nc*n) f.resize(nc*n); }
+};
 
 //  base class
 class greentab : public acafunc<dcmplx>
@@ -25,8 +52,8 @@ public:
   mask_t siz;
   
   //  constructors
-  greentab() {}
-  greentab(const particle& part) : p(part) {}
+  greentab() : work(nthreads()) {}
+  greentab(const particle& part) : p(part), work(nthreads()) {}
   
   //  number of rows and columns
   size_t nrows() const { return siz.nrows(); }
@@ -38,10 +65,19 @@ public:
   virtual void getcol(size_t c, dcmplx* a) const = 0;
   //  initialize cluster
   void init(size_t r, size_t c) 
-    { siz=mask_t(tree.size(row=r),tree.size(col=c)); }
+    { siz=mask_t(tree.size(row=r),tree.csize(col=c)); }
       
   //  evaluate Green function matrices
   hmatrix<dcmplx> eval(size_t i, size_t j, double tol);
+  
+protected:
+  //  reusable workspace of current thread for n elements
+  greenwork& workspace(size_t n, size_t nc=1) const
+    { greenwork& w=work[ithread()];  w.resize(n,nc);  return w; }
+  
+private:
+  //  workspaces, one per thread
+  mutable std::vector<greenwork> work;
 };
 
 
@@ -58,8 +94,12 @@ public:
   interp2<dcmplx> gtab;
   double rmin;
   
-  //  constructor
+  //  constructors, from Matlab table structure and layer index or from interpolator
+  #ifdef MEX
   greentabG2(const particle& p, const mxArray* prhs[]);
+  #endif
+  greentabG2(const particle& p, const interp2<dcmplx>& tab, size_t ind)
+    : greentab(p), uplo(ind==1 ? 'U' : 'L'), gtab(tab), rmin(tab.ax.tab[0]) {}
   //  get rows and columns of matrix
   void getrow(size_t r, dcmplx* b) const;
   void getcol(size_t c, dcmplx* a) const;
@@ -74,8 +114,12 @@ public:
   interp3<dcmplx> gtab;
   double rmin;
   
-  //  constructor
+  //  constructors, from Matlab table structure and layer index or from interpolator
+  #ifdef MEX
   greentabG3(const particle& p, const mxArray* prhs[]);
+  #endif
+  greentabG3(const particle& p, const interp3<dcmplx>& tab, size_t ind)
+    : greentab(p), uplo(ind==1 ? 'U' : 'L'), gtab(tab), rmin(tab.ax.tab[0]) {}
   //  get rows and columns of matrix
   void getrow(size_t r, dcmplx* b) const;
   void getcol(size_t c, dcmplx* a) const;
@@ -91,12 +135,16 @@ class greentabF2 : public greentab
 public:
   //  upper or lower medium of layer structure
   char uplo;
-  //  interpolator for surface derivatives of Green functions
-  interp2<dcmplx> frtab, fztab;
+  //  interpolator for surface derivatives of Green functions, channels Fr and Fz
+  interp2<dcmplx> ftab;
   double rmin;
   
-  //  constructor
-  greentabF2(const particle& p, const mxArray* prhs[]);  
+  //  constructors, from Matlab table structure and layer index or from interpolator
+  #ifdef MEX
+  greentabF2(const particle& p, const mxArray* prhs[]);
+  #endif
+  greentabF2(const particle& p, const interp2<dcmplx>& tab, size_t ind)
+    : greentab(p), uplo(ind==1 ? 'U' : 'L'), ftab(tab), rmin(tab.ax.tab[0]) {}
   //  get rows and columns of matrix
   void getrow(size_t r, dcmplx* b) const;
   void getcol(size_t c, dcmplx* a) const;
@@ -107,12 +155,16 @@ class greentabF3 : public greentab
 public:
   //  upper or lower medium of layer structure
   char uplo;
-  //  interpolator for surface derivatives of Green functions
-  interp3<dcmplx> frtab, fztab;
+  //  interpolator for surface derivatives of Green functions, channels Fr and Fz
+  interp3<dcmplx> ftab;
   double rmin;
   
-  //  constructor
-  greentabF3(const particle& p, const mxArray* prhs[]);  
+  //  constructors, from Matlab table structure and layer index or from interpolator
+  #ifdef MEX
+  greentabF3(const particle& p, const mxArray* prhs[]);
+  #endif
+  greentabF3(const particle& p, const interp3<dcmplx>& tab, size_t ind)
+    : greentab(p), uplo(ind==1 ? 'U' : 'L'), ftab(tab), rmin(tab.ax.tab[0]) {}
   //  get rows and columns of matrix
   void getrow(size_t r, dcmplx* b) const;
   void getcol(size_t c, dcmplx* a) const;
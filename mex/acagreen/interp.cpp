@@ -1,35 +1,50 @@
 #include <cmath>
 #include <algorithm>
+#include <vector>
 
 #include "hoptions.h"
 #include "interp.h"
 
-//  interpolation for linear equidistant mesh
-matrix<size_t> linind(const matrix<double>& xtab, const matrix<double>& x)
+//  initialize axis with linear or logarithmic scaling
+interpaxis::interpaxis(const matrix<double>& x, const std::string& flag) : tab(x)
 {
-  //  number of tabulated and interpolation values
-  size_t ntab=xtab.nrows()*xtab.ncols(), n=x.nrows()*x.ncols();
-  //  stepsize 
-  double h=(xtab[ntab-1]-xtab[0])/(double)(ntab-1);
-  //  index array
-  matrix<size_t> ind(x.nrows(),x.ncols());
+  //  number of tabulated values
+  n=x.nrows()*x.ncols();
+  //  limits and inverse stepsize of scaled axis
+  logscale=(flag!="lin");
+  x0=logscale ? log(x[0]) : x[0];
+  hinv=(double)(n-1)/((logscale ? log(x[n-1]) : x[n-1])-x0);
+  binv=0;
+  //  inverse bin sizes
+  hbin=matrix<double>(n,1);
+  for (size_t i=0; i+1<n; i++) hbin[i]=1/(x[i+1]-x[i]);
+  hbin[n-1]=0;
   
-  for (size_t i=0; i<n; i++) ind[i]=std::min<size_t>((size_t)((x[i]-xtab[0])/h),ntab-2);
+  //  scaled axis
+  std::vector<double> s(n);
+  for (size_t i=0; i<n; i++) s[i]=logscale ? log(x[i]) : x[i];
+  //  split axis into segments with constant step size
+  for (size_t i=0; i+1<n; i++)
+    if (sx.empty() || fabs((s[i+1]-s[i])*sh.back()-1)>1e-6)
+    {
+      sx.push_back(s[i]);
+      sh.push_back(1/(s[i+1]-s[i]));
+      si.push_back(i);
+    }
+  //  equidistant axis
+  if (sx.size()<=1) { sx.clear();  sh.clear();  si.clear();  return; }
   
-  return ind;
+  //  bucket size, shortest segment but at most 8*n buckets
+  double len=s[n-1]-s[0], lmin=len;
+  for (size_t j=0; j<sx.size(); j++) 
+    lmin=std::min(lmin,((j+1<sx.size()) ? sx[j+1] : s[n-1])-sx[j]);
+  size_t nb=std::min<size_t>((size_t)ceil(len/lmin),8*n);
+  binv=nb/len;
+  //  first segment overlapping with each bucket
+  lut.resize(nb);
+  for (size_t b=0, j=0; b<nb; b++)
+  {
+    while (j+1<sx.size() && x0+b/binv>=sx[j+1]) j++;
+    lut[b]=j;
+  }
 }
-
-//   interpolation for logarithmic equidistant mesh
-matrix<size_t> logind(const matrix<double>& xtab, const matrix<double>& x)
-{
-  //  number of tabulated and interpolation values
-  size_t ntab=xtab.nrows()*xtab.ncols(), n=x.nrows()*x.ncols();
-  //  limits and stepsize 
-  double a=log10(xtab[0]), b=log10(xtab[ntab-1]), h=(b-a)/(double)(ntab-1);
-  //  index array
-  matrix<size_t> ind(x.nrows(),x.ncols());
-  
-  for (size_t i=0; i<n; i++) ind[i]=std::min<size_t>((size_t)((log10(x[i])-a)/h),ntab-2);
-  
-  return ind;
-}
\ No newline at end of file
@@ -1,6 +1,53 @@
 //  interp.h - 2D and 3D interpolation.
+//
+//  The tabulated values are given on grids with linear or logarithmic scaling.  
+//  Indices and bin coordinates are computed in a single pass using precomputed 
+//  inverse step sizes, the scaling of the axes is resolved at compile time through 
+//  the template arguments of the interpolation kernels.
+//
+//  Axes need not be equidistant on the scaled axis.  For piecewise-uniform axes, 
+//  e.g. with a finer grid for small distances, the axis is split into segments of
+//  constant step size.  The segment of a position is found through a lookup table
+//  of equally sized buckets, each of which overlaps with only a few segments, such
+//  that the index lookup remains constant in time.  For cubic interpolation the
+//  Catmull-Rom weights are computed with respect to the (fractional) node index.
+//
+//  Several value tables over the same grid (channels) can be interpolated in one
+//  pass, the values are stored interleaved per grid node.  The interpolated values
+//  are then returned interleaved as well, v[nc*i+c] for position i and channel c.
+//
+//  Besides multilinear interpolation ("linear") we provide cubic Catmull-Rom
+//  interpolation ("cubic") on the scaled axes, which reaches the same accuracy on
+//  much coarser grids.  Cubic interpolation requires at least four values per axis.
+//
+//  Large 3D tables are usually stored in column-major order, where the corners of an
+//  interpolation cell are spread over three strides and far apart in memory.  With
+//  tile(b) the table is reordered into bricks of b*b*b grid nodes, such that most
+//  interpolation stencils lie within one or two bricks.  The storage position of
+//  grid node (i,j,k) is ox[i]+oy[j]+oz[k], with offset tables for the three axes.
+//
+//  The tabulated values can also reside in external memory, e.g. a memory-mapped file
+//  or the table cache of tabcache.h, which must outlive the interpolator.
+
+/* interp2<dcmplx> gtab(x,"lin",y,"log",v);     //  initialize interpolator
+ * interp2<dcmplx> ftab(x,"lin",y,"log",vs);    //  several value tables vs over same grid
+ * interp2<dcmplx> ctab(x,"lin",y,"log",v,"cubic");   //  cubic interpolation
+ * v=gtab(x,y);                                 //  interpolate at positions x,y
+ * gtab(n,x,y,v);                               //  interpolate n values, write to v
+ * gtab.nc;                                     //  number of channels
+ *
+ * interp3<dcmplx> gtab(x,"lin",y,"log",z,"log",v);
+ * v=gtab(x,y,z);  gtab(n,x,y,z,v);             //  same for 3D interpolation
+ * gtab.tile(4);                                //  store table in bricks of 4x4x4 nodes
+ *
+ * t=gtab.view();                               //  interpolator sharing table memory
+ * gtab.attach(v);  gtab.attach(v,b);           //  use external table values (brick size b)
+ */
 
 #include <string>
+#include <vector>
+#include <cmath>
+#include <algorithm>
 
 #include "hoptions.h"
 #include "basemat.h"
@@ -8,65 +55,229 @@
 #ifndef interp_h
 #define interp_h
 
-//  linear and logarithmic interpolation
-matrix<size_t> linind(const matrix<double>&, const matrix<double>&);
-matrix<size_t> logind(const matrix<double>&, const matrix<double>&);
+//  axis with linear or logarithmic scaling, equidistant or piecewise uniform
+class interpaxis
+{
+public:
+  //  tabulated values and inverse bin sizes
+  matrix<double> tab, hbin;
+  //  number of tabulated values
+  size_t n;
+  //  logarithmic scaling, first value and inverse step size of (scaled) axis
+  bool logscale;
+  double x0, hinv;
+  //  segments of piecewise-uniform axis (empty for equidistant axis), 
+  //    start on scaled axis, inverse step size, and index of first node
+  std::vector<double> sx, sh;
+  std::vector<size_t> si;
+  //  first segment for buckets of scaled axis, inverse bucket size
+  std::vector<size_t> lut;
+  double binv;
+
+  //  constructors
+  interpaxis() : n(0), logscale(false), x0(0), hinv(0), binv(0) {}
+  interpaxis(const matrix<double>& x, const std::string& flag);
+  
+  //  fractional node index for position s on scaled axis
+  double index(double s) const
+  {
+    if (lut.empty()) return (s-x0)*hinv;
+    //  bucket and first segment overlapping with bucket
+    double b=(s-x0)*binv;
+    size_t j=lut[(b>0) ? std::min<size_t>((size_t)b,lut.size()-1) : 0];
+    while (j+1<sx.size() && s>=sx[j+1]) j++;
+    
+    return (double)si[j]+(s-sx[j])*sh[j];
+  }
+};
+
+//  scaling of axes
+struct linaxis { static double scale(double x) { return x; } };
+struct logaxis { static double scale(double x) { return std::log(x); } };
+
+//  index and bin coordinate for interpolation
+template<class S>
+inline size_t bin(const interpaxis& ax, const double* tab, const double* hbin, double x, double& xb)
+{
+  //  position on scaled axis
+  double t=ax.index(S::scale(x));
+  size_t i=(t>0) ? std::min<size_t>((size_t)t,ax.n-2) : 0;
+  //  bin coordinate
+  xb=(x-tab[i])*hbin[i];
+  return i;
+}
+
+//  first index and weights for cubic interpolation with stencil i-1:i+2,
+//    Catmull-Rom for inner bins and Lagrange polynomial for first and last bin
+template<class S>
+inline size_t cbin(const interpaxis& ax, double x, double* w)
+{
+  //  position on scaled axis and bin index
+  double t=ax.index(S::scale(x));
+  size_t i=(t>0) ? std::min<size_t>((size_t)t,ax.n-2) : 0;
+  
+  if (i==0 || i==ax.n-2)
+  {
+    //  first index of stencil and position wrt stencil
+    size_t i0=(i==0) ? 0 : ax.n-4;
+    double s=t-(double)i0;
+    //  Lagrange polynomial for nodes 0, 1, 2, 3
+    w[0]=-(s-1)*(s-2)*(s-3)/6;
+    w[1]=s*(s-2)*(s-3)/2;
+    w[2]=-s*(s-1)*(s-3)/2;
+    w[3]=s*(s-1)*(s-2)/6;
+    return i0;
+  }
+  
+  //  position within bin and Catmull-Rom weights
+  t-=(double)i;
+  double t2=t*t, t3=t2*t;
+  w[0]=0.5*(-t3+2*t2-t);
+  w[1]=0.5*(3*t3-5*t2+2);
+  w[2]=0.5*(-3*t3+4*t2+t);
+  w[3]=0.5*(t3-t2);
+  
+  return i-1;
+}
+
+//  cubic interpolation requested and possible for table ?
+inline bool iscubic(const std::string& imod, size_t n)
+{
+  return imod=="cubic" && n>=4;
+}
+
+//  interleave value tables, v(c,i) = vs[c][i]
+template<class T>
+matrix<T> interleave(const std::vector<matrix<T> >& vs)
+{
+  size_t nc=vs.size(), n=vs[0].nrows()*vs[0].ncols();
+  matrix<T> v(nc,n);
+  
+  for (size_t i=0; i<n; i++)
+  for (size_t c=0; c<nc; c++) v[c+nc*i]=vs[c][i];
+  
+  return v;
+}
 
 /*
  * 2D interpolation
  */
 
 template<class T>
-class interp2 
+class interp2
 {
 public:
-  matrix<double> xtab, ytab;
+  interpaxis ax, ay;
+  //  tabulated values (interleaved for several channels) and number of channels
   matrix<T> vtab;
-  //  index functions
-  matrix<size_t> (*funx)(const matrix<double>&, const matrix<double>&);
-  matrix<size_t> (*funy)(const matrix<double>&, const matrix<double>&);
-  
+  size_t nc;
+  //  cubic or linear interpolation
+  bool cubic;
+  //  external table memory, used instead of vtab if set
+  const T* vext;
+
   //  constructors
-  interp2() {}
+  interp2() : nc(0), cubic(false), vext(0) {}
   interp2(
     const matrix<double>& x, const std::string& xflag,
-    const matrix<double>& y, const std::string& yflag, const matrix<T>& v) : xtab(x), ytab(y), vtab(v)
-    {
-      funx=(xflag=="lin") ? linind : logind;
-      funy=(yflag=="lin") ? linind : logind;
-    }
-  
+    const matrix<double>& y, const std::string& yflag, const matrix<T>& v,
+    const std::string& imod="linear") 
+      : ax(x,xflag), ay(y,yflag), vtab(v), nc(1), cubic(iscubic(imod,std::min(ax.n,ay.n))), vext(0) {}
+  interp2(
+    const matrix<double>& x, const std::string& xflag,
+    const matrix<double>& y, const std::string& yflag, const std::vector<matrix<T> >& vs,
+    const std::string& imod="linear") 
+      : ax(x,xflag), ay(y,yflag), vtab(interleave(vs)), nc(vs.size()), 
+        cubic(iscubic(imod,std::min(ax.n,ay.n))), vext(0) {}
+
   //  perform 2D interpolation
-  matrix<T> operator() (const matrix<double>& x, const matrix<double>& y) const;
+  matrix<T> operator() (const matrix<double>& x, const matrix<double>& y) const
+    { matrix<T> v(nc*x.nrows(),x.ncols());  (*this)(x.nrows()*x.ncols(),x.val,y.val,v.val);  return v; }
+  void operator() (size_t n, const double* x, const double* y, T* v) const;
+  
+  //  tabulated values and number of table entries
+  const T* values() const { return vext ? vext : vtab.val; }
+  size_t size() const { return ax.n*ay.n; }
+  //  interpolator sharing table memory
+  interp2<T> view() const
+    { interp2<T> t;  t.ax=ax;  t.ay=ay;  t.nc=nc;  t.cubic=cubic;  t.vext=values();  return t; }
+  //  use external table memory
+  void attach(const T* v) { vtab.clear();  vext=v; }
+
+private:
+  //  interpolation kernel for given axis scalings
+  template<class SX, class SY>
+  void kernel(size_t n, const double* x, const double* y, T* v) const;
+  template<class SX, class SY>
+  void ckernel(size_t n, const double* x, const double* y, T* v) const;
+  //  linear or cubic interpolation
+  template<class SX, class SY>
+  void dispatch(size_t n, const double* x, const double* y, T* v) const
+    { cubic ? ckernel<SX,SY>(n,x,y,v) : kernel<SX,SY>(n,x,y,v); }
 };
 
 //  perform 2D interpolation
 template<class T>
-matrix<T> interp2<T>::operator() (const matrix<double>& x, const matrix<double>& y) const
-{
-  size_t mtab=xtab.nrows()*xtab.ncols(), m=x.nrows(), n=x.ncols();
-  matrix<size_t> ix=(*funx)(xtab,x), iy=(*funy)(ytab,y);
-  //  bin coordinates
-  matrix<double> xbin(m,n);  for (size_t i=0,ii; i<m*n; i++) ii=ix[i], xbin[i]=(x[i]-xtab[ii])/(xtab[ii+1]-xtab[ii]);
-  matrix<double> ybin(m,n);  for (size_t i=0,ii; i<m*n; i++) ii=iy[i], ybin[i]=(y[i]-ytab[ii])/(ytab[ii+1]-ytab[ii]);
-  //  interpolated values
-  matrix<T> v(x.nrows(),x.ncols());
-  
-  for (size_t i=0; i<m*n; i++)
+void interp2<T>::operator() (size_t n, const double* x, const double* y, T* v) const
+{
+  if (!ax.logscale)
+    ay.logscale ? dispatch<linaxis,logaxis>(n,x,y,v) : dispatch<linaxis,linaxis>(n,x,y,v);
+  else
+    ay.logscale ? dispatch<logaxis,logaxis>(n,x,y,v) : dispatch<logaxis,linaxis>(n,x,y,v);
+}
+
+template<class T> template<class SX, class SY>
+void interp2<T>::kernel(size_t n, const double* x, const double* y, T* v) const
+{
+  const double *xtab=ax.tab.val, *xbin=ax.hbin.val, *ytab=ay.tab.val, *ybin=ay.hbin.val;
+  const T* vt=values();
+  size_t mtab=ax.n;
+
+  for (size_t i=0; i<n; i++)
   {
+    double xb, yb;
     //  convert subscripts to linear indices
-    size_t ind=ix[i]+iy[i]*mtab;
-    double xb=xbin[i], xa=1-xb, yb=ybin[i], ya=1-yb;
-    
-    #define vv(i,j) vtab[ind+i+j*mtab]
-    
+    size_t ind=bin<SX>(ax,xtab,xbin,x[i],xb)+bin<SY>(ay,ytab,ybin,y[i],yb)*mtab;
+    double xa=1-xb, ya=1-yb;
+    //  weights for linear interpolation
+    double w00=xa*ya, w10=xb*ya, w01=xa*yb, w11=xb*yb;
+    //  tabulated values and output for all channels
+    const T* vp=vt+nc*ind;
+    T* out=v+nc*i;
+
+    #define vv(i,j) vp[c+nc*(i+j*mtab)]
+
     //  linear interpolation
-    v[i]=xa*ya*vv(0,0)+xb*ya*vv(1,0)+xa*yb*vv(0,1)+xb*yb*vv(1,1);
-    
+    for (size_t c=0; c<nc; c++) out[c]=w00*vv(0,0)+w10*vv(1,0)+w01*vv(0,1)+w11*vv(1,1);
+
     #undef vv
   }
-  
-  return v;
+}
+
+template<class T> template<class SX, class SY>
+void interp2<T>::ckernel(size_t n, const double* x, const double* y, T* v) const
+{
+  const T* vt=values();
+  size_t mtab=ax.n;
+
+  for (size_t i=0; i<n; i++)
+  {
+    double wx[4], wy[4];
+    //  first index of interpolation stencil
+    size_t ind=cbin<SX>(ax,x[i],wx)+cbin<SY>(ay,y[i],wy)*mtab;
+    //  tabulated values and output for all channels
+    const T* vp=vt+nc*ind;
+    T* out=v+nc*i;
+
+    for (size_t c=0; c<nc; c++) out[c]=0;
+    //  cubic interpolation
+    for (size_t j=0; j<4; j++)
+    for (size_t k=0; k<4; k++)
+    {
+      double w=wx[k]*wy[j];
+      for (size_t c=0; c<nc; c++) out[c]+=w*vp[c+nc*(k+j*mtab)];
+    }
+  }
 }
 
 /*
@@ -74,64 +285,215 @@ matrix<T> interp2<T>::operator() (const matrix<double>& x, const matrix<double>&
  */
 
 template<class T>
-class interp3 
+class interp3
 {
 public:
-  matrix<double> xtab, ytab, ztab;
+  interpaxis ax, ay, az;
+  //  tabulated values (interleaved for several channels) and number of channels
   matrix<T> vtab;
-  //  index functions
-  matrix<size_t> (*funx)(const matrix<double>&, const matrix<double>&);
-  matrix<size_t> (*funy)(const matrix<double>&, const matrix<double>&);
-  matrix<size_t> (*funz)(const matrix<double>&, const matrix<double>&);
-  
+  size_t nc;
+  //  cubic or linear interpolation
+  bool cubic;
+  //  brick size of table (0 for column-major order) and node offsets for axes
+  size_t bsiz;
+  std::vector<size_t> ox, oy, oz;
+  //  external table memory, used instead of vtab if set
+  const T* vext;
+
   //  constructors
-  interp3() {}
+  interp3() : nc(0), cubic(false), bsiz(0), vext(0) {}
   interp3(
     const matrix<double>& x, const std::string& xflag,
-    const matrix<double>& y, const std::string& yflag, 
-    const matrix<double>& z, const std::string& zflag, const matrix<T>& v) : xtab(x), ytab(y), ztab(z), vtab(v)
-    {
-      funx=(xflag=="lin") ? linind : logind;
-      funy=(yflag=="lin") ? linind : logind;
-      funz=(yflag=="lin") ? linind : logind;
-    }
-  
+    const matrix<double>& y, const std::string& yflag,
+    const matrix<double>& z, const std::string& zflag, const matrix<T>& v,
+    const std::string& imod="linear")
+      : ax(x,xflag), ay(y,yflag), az(z,zflag), vtab(v), nc(1), 
+        cubic(iscubic(imod,std::min(ax.n,std::min(ay.n,az.n)))), vext(0) { layout(0); }
+  interp3(
+    const matrix<double>& x, const std::string& xflag,
+    const matrix<double>& y, const std::string& yflag,
+    const matrix<double>& z, const std::string& zflag, const std::vector<matrix<T> >& vs,
+    const std::string& imod="linear")
+      : ax(x,xflag), ay(y,yflag), az(z,zflag), vtab(interleave(vs)), nc(vs.size()), 
+        cubic(iscubic(imod,std::min(ax.n,std::min(ay.n,az.n)))), vext(0) { layout(0); }
+
   //  perform 3D interpolation
-  matrix<T> operator() (const matrix<double>& x, const matrix<double>& y, const matrix<double>& z) const;
+  matrix<T> operator() (const matrix<double>& x, const matrix<double>& y, const matrix<double>& z) const
+    { matrix<T> v(nc*x.nrows(),x.ncols());  (*this)(x.nrows()*x.ncols(),x.val,y.val,z.val,v.val);  return v; }
+  void operator() (size_t n, const double* x, const double* y, const double* z, T* v) const;
+  //  reorder table into bricks of size b*b*b, column-major order for b=0
+  void tile(size_t b);
+  
+  //  tabulated values and number of table entries (including padding of bricks)
+  const T* values() const { return vext ? vext : vtab.val; }
+  size_t size() const;
+  //  interpolator sharing table memory
+  interp3<T> view() const;
+  //  use external table memory with brick size b
+  void attach(const T* v, size_t b=0) { vtab.clear();  vext=v;  layout(b); }
+
+private:
+  //  set node offsets for given brick size
+  void layout(size_t b);
+  //  resolve scaling of y and z axes
+  template<class SX>
+  void kernely(size_t n, const double* x, const double* y, const double* z, T* v) const;
+  template<class SX, class SY>
+  void kernelz(size_t n, const double* x, const double* y, const double* z, T* v) const;
+  //  interpolation kernel for given axis scalings
+  template<class SX, class SY, class SZ>
+  void kernel(size_t n, const double* x, const double* y, const double* z, T* v) const;
+  template<class SX, class SY, class SZ>
+  void ckernel(size_t n, const double* x, const double* y, const double* z, T* v) const;
+  //  linear or cubic interpolation
+  template<class SX, class SY, class SZ>
+  void dispatch(size_t n, const double* x, const double* y, const double* z, T* v) const
+    { cubic ? ckernel<SX,SY,SZ>(n,x,y,z,v) : kernel<SX,SY,SZ>(n,x,y,z,v); }
 };
 
-//  perform 3D interpolation
+//  set node offsets for given brick size
 template<class T>
-matrix<T> interp3<T>::operator() (const matrix<double>& x, const matrix<double>& y, const matrix<double>& z) const
-{
-  //  number of x and y values
-  size_t numx=xtab.nrows()*xtab.ncols(), numy=xtab.nrows()*ytab.ncols();
-  //  interpolation indices
-  size_t m=x.nrows(), n=x.ncols();
-  matrix<size_t> ix=(*funx)(xtab,x), iy=(*funy)(ytab,y), iz=(*funz)(ztab,z);
-  //  bin coordinates
-  matrix<double> xbin(m,n);  for (size_t i=0,ii; i<m*n; i++) ii=ix[i], xbin[i]=(x[i]-xtab[ii])/(xtab[ii+1]-xtab[ii]);
-  matrix<double> ybin(m,n);  for (size_t i=0,ii; i<m*n; i++) ii=iy[i], ybin[i]=(y[i]-ytab[ii])/(ytab[ii+1]-ytab[ii]);
-  matrix<double> zbin(m,n);  for (size_t i=0,ii; i<m*n; i++) ii=iz[i], zbin[i]=(z[i]-ztab[ii])/(ztab[ii+1]-ztab[ii]);
-  //  interpolated values
-  matrix<T> v(x.nrows(),x.ncols());
+void interp3<T>::layout(size_t b)
+{
+  size_t nx=ax.n, ny=ay.n, nz=az.n;
+  ox.resize(nx);  oy.resize(ny);  oz.resize(nz);
   
-  for (size_t i=0; i<m*n; i++)
+  if ((bsiz=b)==0)
   {
-    //  convert subscripts to linear indices
-    size_t ind=ix[i]+iy[i]*numx+iz[i]*numy;
-    double xb=xbin[i], xa=1-xb, yb=ybin[i], ya=1-yb, zb=zbin[i], za=1-zb;
-    
-    #define vv(i,j,k) vtab[ind+i+j*numx+k*numx*numy]
-    
+    //  column-major order
+    for (size_t i=0; i<nx; i++) ox[i]=i;
+    for (size_t j=0; j<ny; j++) oy[j]=j*nx;
+    for (size_t k=0; k<nz; k++) oz[k]=k*nx*ny;
+  }
+  else
+  {
+    //  number of bricks along x and y, brick volume
+    size_t bx=(nx+b-1)/b, by=(ny+b-1)/b, b3=b*b*b;
+    //  brick offset plus position within brick
+    for (size_t i=0; i<nx; i++) ox[i]=(i/b)*b3+i%b;
+    for (size_t j=0; j<ny; j++) oy[j]=(j/b)*b3*bx+(j%b)*b;
+    for (size_t k=0; k<nz; k++) oz[k]=(k/b)*b3*bx*by+(k%b)*b*b;
+  }
+}
+
+//  number of table entries, including padding of incomplete bricks
+template<class T>
+size_t interp3<T>::size() const
+{
+  size_t b=bsiz, nx=ax.n, ny=ay.n, nz=az.n;
+  return b ? ((nx+b-1)/b)*((ny+b-1)/b)*((nz+b-1)/b)*b*b*b : nx*ny*nz;
+}
+
+//  reorder table into bricks of size b*b*b
+template<class T>
+void interp3<T>::tile(size_t b)
+{
+  //  table values and offsets of present layout
+  const T* vt=values();
+  std::vector<size_t> px=ox, py=oy, pz=oz;
+  layout(b);
+  
+  matrix<T> v(nc,size(),(T)0);
+  //  copy table values to new positions
+  for (size_t k=0; k<az.n; k++)
+  for (size_t j=0; j<ay.n; j++)
+  for (size_t i=0; i<ax.n; i++)
+  {
+    const T* src=vt+nc*(px[i]+py[j]+pz[k]);
+    std::copy(src,src+nc,v.val+nc*(ox[i]+oy[j]+oz[k]));
+  }
+  vtab=v;  vext=0;
+}
+
+//  interpolator sharing table memory
+template<class T>
+interp3<T> interp3<T>::view() const
+{
+  interp3<T> t;
+  t.ax=ax;  t.ay=ay;  t.az=az;  t.nc=nc;  t.cubic=cubic;
+  t.bsiz=bsiz;  t.ox=ox;  t.oy=oy;  t.oz=oz;  t.vext=values();
+  
+  return t;
+}
+
+//  perform 3D interpolation
+template<class T>
+void interp3<T>::operator() (size_t n, const double* x, const double* y, const double* z, T* v) const
+{
+  ax.logscale ? kernely<logaxis>(n,x,y,z,v) : kernely<linaxis>(n,x,y,z,v);
+}
+
+template<class T> template<class SX>
+void interp3<T>::kernely(size_t n, const double* x, const double* y, const double* z, T* v) const
+{
+  ay.logscale ? kernelz<SX,logaxis>(n,x,y,z,v) : kernelz<SX,linaxis>(n,x,y,z,v);
+}
+
+template<class T> template<class SX, class SY>
+void interp3<T>::kernelz(size_t n, const double* x, const double* y, const double* z, T* v) const
+{
+  az.logscale ? dispatch<SX,SY,logaxis>(n,x,y,z,v) : dispatch<SX,SY,linaxis>(n,x,y,z,v);
+}
+
+template<class T> template<class SX, class SY, class SZ>
+void interp3<T>::kernel(size_t n, const double* x, const double* y, const double* z, T* v) const
+{
+  const double *xtab=ax.tab.val, *xbin=ax.hbin.val, *ytab=ay.tab.val, *ybin=ay.hbin.val,
+               *ztab=az.tab.val, *zbin=az.hbin.val;
+  const T* vt=values();
+  //  node offsets of table layout
+  const size_t *pox=&ox[0], *poy=&oy[0], *poz=&oz[0];
+
+  for (size_t i=0; i<n; i++)
+  {
+    double xb, yb, zb;
+    //  bin indices
+    size_t ix=bin<SX>(ax,xtab,xbin,x[i],xb), iy=bin<SY>(ay,ytab,ybin,y[i],yb),
+           iz=bin<SZ>(az,ztab,zbin,z[i],zb);
+    double xa=1-xb, ya=1-yb, za=1-zb;
+    //  weights for linear interpolation
+    double w000=xa*ya*za, w100=xb*ya*za, w010=xa*yb*za, w110=xb*yb*za,
+           w001=xa*ya*zb, w101=xb*ya*zb, w011=xa*yb*zb, w111=xb*yb*zb;
+    //  offsets of x-positions, and of y-z positions of cell corners
+    size_t x0=pox[ix], x1=pox[ix+1], 
+           o00=poy[iy]+poz[iz], o10=poy[iy+1]+poz[iz], o01=poy[iy]+poz[iz+1], o11=poy[iy+1]+poz[iz+1];
+    T* out=v+nc*i;
+
+    #define vv(ox,oyz) vt[c+nc*(ox+oyz)]
+
     //  linear interpolation
-    v[i]=xa*ya*za*vv(0,0,0)+xb*ya*za*vv(1,0,0)+xa*yb*za*vv(0,1,0)+xb*yb*za*vv(1,1,0)+
-         xa*ya*zb*vv(0,0,1)+xb*ya*zb*vv(1,0,1)+xa*yb*zb*vv(0,1,1)+xb*yb*zb*vv(1,1,1);
-    
+    for (size_t c=0; c<nc; c++)
+      out[c]=w000*vv(x0,o00)+w100*vv(x1,o00)+w010*vv(x0,o10)+w110*vv(x1,o10)+
+             w001*vv(x0,o01)+w101*vv(x1,o01)+w011*vv(x0,o11)+w111*vv(x1,o11);
+
     #undef vv
   }
-  
-  return v;
+}
+
+template<class T> template<class SX, class SY, class SZ>
+void interp3<T>::ckernel(size_t n, const double* x, const double* y, const double* z, T* v) const
+{
+  const T* vt=values();
+
+  for (size_t i=0; i<n; i++)
+  {
+    double wx[4], wy[4], wz[4];
+    //  first indices of interpolation stencil and node offsets of table layout
+    const size_t *pox=&ox[cbin<SX>(ax,x[i],wx)], *poy=&oy[cbin<SY>(ay,y[i],wy)], 
+                 *poz=&oz[cbin<SZ>(az,z[i],wz)];
+    T* out=v+nc*i;
+
+    for (size_t c=0; c<nc; c++) out[c]=0;
+    //  cubic interpolation
+    for (size_t l=0; l<4; l++)
+    for (size_t j=0; j<4; j++)
+    for (size_t k=0; k<4; k++)
+    {
+      double w=wx[k]*wy[j]*wz[l];
+      const T* vp=vt+nc*(pox[k]+poy[j]+poz[l]);
+      for (size_t c=0; c<nc; c++) out[c]+=w*vp[c];
+    }
+  }
 }
 
 #endif  //  interp_h
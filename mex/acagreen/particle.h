@@ -21,30 +21,41 @@ public:
   //  distance to closest layer (for layer structure)
   const double *z;
   
-  particle() {}
+  particle() : n(0), pos(0), nvec(0), area(0), z(0) {}
   particle(const particle& p) { *this=p; }
   
   const particle& operator= (const particle& p)
     { n=p.n; pos=p.pos; nvec=p.nvec; area=p.area; z=p.z; return *this; }
   
-  //  convert Matlab structure to particle
+  //  convert Matlab structure to particle, i is index of structure array
+  //    (normal vectors and areas are missing or empty for evaluation points)
   #ifdef MEX
-  static particle getmex(const mxArray* rhs)
+  static particle getmex(const mxArray* rhs, size_t i=0)
     {
       particle p;
       
       //  number of boundary elements
-      p.n=mxGetM(mxGetField(rhs,0,"pos"));
+      p.n=mxGetM(mxGetField(rhs,i,"pos"));
       //  centroids, normal vectors and areas of boundary elements
-      p.pos =mxGetPr(mxGetField(rhs,0,"pos" ));
-      p.nvec=mxGetPr(mxGetField(rhs,0,"nvec"));
-      p.area=mxGetPr(mxGetField(rhs,0,"area"));
+      p.pos =field(rhs,i,"pos" );
+      p.nvec=field(rhs,i,"nvec");
+      p.area=field(rhs,i,"area");
       //  distance to closest layer (for layerstructure)
-      if (mxGetField(rhs,0,"z" )) p.z=mxGetPr(mxGetField(rhs,0,"z" ));
+      p.z   =field(rhs,i,"z"   );
       
       return p;
     }
   #endif
+
+private:
+  #ifdef MEX
+  //  data of structure field, 0 if field is missing or empty
+  static const double* field(const mxArray* rhs, size_t i, const char* name)
+    {
+      const mxArray* f=mxGetField(rhs,i,name);
+      return (f && !mxIsEmpty(f)) ? mxGetPr(f) : 0;
+    }
+  #endif
 };
 
 #endif  //  particle_h
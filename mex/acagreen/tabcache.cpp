@@ -0,0 +1,267 @@
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <sstream>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "tabcache.h"
+
+//  identifier and version of table files
+static const char magic[8]={'M','N','P','B','E','M','T','B'};
+static const size_t version=1;
+//  alignment of table values in file
+static const size_t align=64;
+
+//  file name for key, hash of key string (FNV-1a)
+static std::string filename(const std::string& key, const std::string& dir)
+{
+  unsigned long long h=14695981039346656037ULL;
+  for (size_t i=0; i<key.size(); i++) h=(h^(unsigned char)key[i])*1099511628211ULL;
+
+  char str[17];
+  sprintf(str,"%016llx",h);
+  return dir+"/"+str+".tab";
+}
+
+//  read and write size_t values
+static bool getval(FILE* fid, size_t& n) { return std::fread(&n,sizeof(size_t),1,fid)==1; }
+static void putval(FILE* fid, size_t n)  { std::fwrite(&n,sizeof(size_t),1,fid); }
+
+//  read and write axis of interpolator
+static bool getaxis(FILE* fid, interpaxis& ax)
+{
+  size_t logscale;
+  if (!getval(fid,logscale)) return false;
+  matrix<double> x=matrix<double>::fread(fid);
+  if (feof(fid) || x.nrows()*x.ncols()<2) return false;
+
+  ax=interpaxis(x,logscale ? "log" : "lin");
+  return true;
+}
+
+static void putaxis(FILE* fid, const interpaxis& ax)
+{
+  putval(fid,ax.logscale);
+  ax.tab.fwrite(fid);
+}
+
+
+//  look up table in memory or load file
+tabcache::entry* tabcache::lookup(const std::string& key, const std::string& dir)
+{
+  std::map<std::string,entry>::iterator it=tab.find(key);
+  //  table resident in memory
+  if (it!=tab.end())
+  {
+    it->second.used=++count;
+    return &it->second;
+  }
+  //  load table from file
+  entry e;
+  if (dir.empty() || !load(key,filename(key,dir),e)) return 0;
+  //  add to cache
+  entry& r=add(key,e.bytes);
+  e.used=r.used;
+  return &(r=e);
+}
+
+//  add entry to cache and remove least recently used entries
+tabcache::entry& tabcache::add(const std::string& key, size_t siz)
+{
+  typedef std::map<std::string,entry>::iterator iterator;
+  //  replace existing entry
+  iterator it=tab.find(key);
+  if (it!=tab.end()) { release(it->second);  tab.erase(it); }
+
+  while (!tab.empty() && bytes+siz>maxbytes)
+  {
+    //  least recently used entry
+    iterator old=tab.begin();
+    for (iterator it=tab.begin(); it!=tab.end(); it++)
+      if (it->second.used<old->second.used) old=it;
+    release(old->second);
+    tab.erase(old);
+  }
+
+  entry& e=tab[key];
+  bytes+=(e.bytes=siz);
+  e.used=++count;
+  return e;
+}
+
+//  release memory of entry
+void tabcache::release(entry& e)
+{
+  if (e.buf)
+  #ifdef _WIN32
+    delete[] e.buf;
+  #else
+    munmap(e.buf,e.len);
+  #endif
+  e.buf=0;
+  bytes-=e.bytes;
+}
+
+//  clear cache
+void tabcache::clear()
+{
+  for (std::map<std::string,entry>::iterator it=tab.begin(); it!=tab.end(); it++)
+    release(it->second);
+  tab.clear();
+  bytes=0;
+}
+
+//  get view of cached table
+bool tabcache::find(const std::string& key, const std::string& dir, interp2<dcmplx>& t)
+{
+  entry* e=lookup(key,dir);
+  if (!e || !e->t2.nc) return false;
+
+  t=e->t2.view();
+  return true;
+}
+
+bool tabcache::find(const std::string& key, const std::string& dir, interp3<dcmplx>& t)
+{
+  entry* e=lookup(key,dir);
+  if (!e || !e->t3.nc) return false;
+
+  t=e->t3.view();
+  return true;
+}
+
+//  add table to cache and save to directory
+void tabcache::insert(const std::string& key, const std::string& dir, interp2<dcmplx>& t)
+{
+  entry& e=add(key,t.nc*t.size()*sizeof(dcmplx));
+  e.t2=t;
+  t=e.t2.view();
+  if (!dir.empty()) save(key,filename(key,dir),e,2);
+}
+
+void tabcache::insert(const std::string& key, const std::string& dir, interp3<dcmplx>& t)
+{
+  entry& e=add(key,t.nc*t.size()*sizeof(dcmplx));
+  e.t3=t;
+  t=e.t3.view();
+  if (!dir.empty()) save(key,filename(key,dir),e,3);
+}
+
+
+//  read table file and map table values into memory
+bool tabcache::load(const std::string& key, const std::string& file, entry& e)
+{
+  FILE* fid=fopen(file.c_str(),"rb");
+  if (!fid) return false;
+
+  //  header of table file
+  char str[8];
+  size_t ver, len, dim, nc, cubic, bsiz, ntab;
+  bool ok=std::fread(str,1,8,fid)==8 && !memcmp(str,magic,8) &&
+          getval(fid,ver) && ver==version && getval(fid,len) && len==key.size();
+  //  key, files with same hash but different key are ignored
+  std::string fkey(len,' ');
+  ok=ok && std::fread(&fkey[0],1,len,fid)==len && fkey==key;
+  ok=ok && getval(fid,dim) && getval(fid,nc) && getval(fid,cubic) && getval(fid,bsiz);
+  //  axes of interpolator
+  interpaxis ax[3];
+  for (size_t i=0; ok && i<dim && i<3; i++) ok=getaxis(fid,ax[i]);
+  ok=ok && getval(fid,ntab) && (dim==2 || dim==3) && nc;
+  //  offset of table values
+  size_t offset=(ftell(fid)+align-1)/align*align;
+  fclose(fid);
+  if (!ok) return false;
+
+  //  size of table values
+  e.bytes=ntab*nc*sizeof(dcmplx);
+
+  #ifdef _WIN32
+  //  no memory mapping, read file into memory
+  if (!(fid=fopen(file.c_str(),"rb"))) return false;
+  fseek(fid,0,SEEK_END);
+  e.len=ftell(fid);
+  fseek(fid,0,SEEK_SET);
+  e.buf=new char[e.len];
+  ok=e.len>=offset+e.bytes && std::fread(e.buf,1,e.len,fid)==e.len;
+  fclose(fid);
+  if (!ok) { delete[] e.buf;  e.buf=0;  return false; }
+  #else
+  //  map file into memory, pages are shared between processes
+  int fd=open(file.c_str(),O_RDONLY);
+  struct stat st;
+  if (fd<0) return false;
+  if (fstat(fd,&st) || (size_t)st.st_size<offset+e.bytes) { close(fd);  return false; }
+  e.len=st.st_size;
+  void* buf=mmap(0,e.len,PROT_READ,MAP_SHARED,fd,0);
+  close(fd);
+  if (buf==MAP_FAILED) return false;
+  e.buf=(char*)buf;
+  #endif
+
+  //  set up interpolator with mapped table values
+  const dcmplx* v=(const dcmplx*)(e.buf+offset);
+  if (dim==2)
+  {
+    e.t2.ax=ax[0];  e.t2.ay=ax[1];  e.t2.nc=nc;  e.t2.cubic=cubic!=0;
+    e.t2.attach(v);
+  }
+  else
+  {
+    e.t3.ax=ax[0];  e.t3.ay=ax[1];  e.t3.az=ax[2];  e.t3.nc=nc;  e.t3.cubic=cubic!=0;
+    e.t3.attach(v,bsiz);
+  }
+
+  return true;
+}
+
+//  write table to file, saving is only attempted and errors are ignored
+void tabcache::save(const std::string& key, const std::string& file, const entry& e, size_t dim) const
+{
+  //  write to temporary file first, which is renamed when complete
+  std::ostringstream tmp;
+  tmp<<file<<"."<<getpid()<<".tmp";
+  FILE* fid=fopen(tmp.str().c_str(),"wb");
+  if (!fid) return;
+
+  //  header of table file
+  std::fwrite(magic,1,8,fid);
+  putval(fid,version);
+  putval(fid,key.size());
+  std::fwrite(key.c_str(),1,key.size(),fid);
+  putval(fid,dim);
+  //  number of channels, interpolation method, brick size, axes, and table values
+  size_t ntab;
+  const dcmplx* v;
+  if (dim==2)
+  {
+    putval(fid,e.t2.nc);  putval(fid,e.t2.cubic);  putval(fid,0);
+    putaxis(fid,e.t2.ax);  putaxis(fid,e.t2.ay);
+    putval(fid,ntab=e.t2.size());
+    v=e.t2.values();
+  }
+  else
+  {
+    putval(fid,e.t3.nc);  putval(fid,e.t3.cubic);  putval(fid,e.t3.bsiz);
+    putaxis(fid,e.t3.ax);  putaxis(fid,e.t3.ay);  putaxis(fid,e.t3.az);
+    putval(fid,ntab=e.t3.size());
+    v=e.t3.values();
+  }
+  //  pad to aligned offset
+  char zero[align]={0};
+  std::fwrite(zero,1,(align-ftell(fid)%align)%align,fid);
+  size_t n=ntab*(dim==2 ? e.t2.nc : e.t3.nc);
+  bool ok=std::fwrite(v,sizeof(dcmplx),n,fid)==n;
+  ok=!fclose(fid) && ok;
+
+  //  move completed file to final destination
+  if (!ok || std::rename(tmp.str().c_str(),file.c_str())) std::remove(tmp.str().c_str());
+}
@@ -0,0 +1,84 @@
+//  tabcache.h - Cache for tabulated Green functions across MEX calls.
+//
+//  Interpolators for tabulated Green functions are kept resident between MEX calls,
+//  using a key that identifies layer structure, wavelength and table grid.  With a
+//  cache directory the tables are additionally stored in binary files, which are
+//  memory-mapped in later calls or sessions and shared between parallel workers
+//  without copying.  When the total size of the resident tables exceeds the cache
+//  size, the least recently used tables are removed.  The cache is released when
+//  the MEX file is cleared from memory.
+//
+//  File format:  magic string, version, key, table dimension, number of channels,
+//  interpolation method, brick size, axes (scaling and values), number of table
+//  entries, table values starting at an offset aligned to 64 bytes.
+
+/* tabcache cache;                        //  cache object
+ * cache.maxbytes=512<<20;                //  maximal size of resident tables
+ * cache.find(key,dir,t);                 //  get view of table, from memory or file
+ * cache.insert(key,dir,t);               //  add table to cache, save to dir
+ * cache.clear();                         //  clear cache and unmap files
+ */
+
+#include <string>
+#include <map>
+#include <cstdio>
+
+#include "hoptions.h"
+#include "basemat.h"
+#include "interp.h"
+
+#ifndef tabcache_h
+#define tabcache_h
+
+class tabcache
+{
+public:
+  //  maximal size of resident tables in bytes
+  size_t maxbytes;
+
+  //  constructor and destructor
+  tabcache() : maxbytes((size_t)512<<20), bytes(0), count(0) {}
+  ~tabcache() { clear(); }
+
+  //  get view of cached table from memory or directory dir (empty for no file storage),
+  //    returns false if table is not available
+  bool find(const std::string& key, const std::string& dir, interp2<dcmplx>& t);
+  bool find(const std::string& key, const std::string& dir, interp3<dcmplx>& t);
+  //  add table to cache and save to directory, t becomes view of cached table
+  void insert(const std::string& key, const std::string& dir, interp2<dcmplx>& t);
+  void insert(const std::string& key, const std::string& dir, interp3<dcmplx>& t);
+
+  //  number and size of resident tables
+  size_t size() const { return tab.size(); }
+  size_t nbytes() const { return bytes; }
+  //  clear cache
+  void clear();
+
+private:
+  //  cached table, either in memory or in mapped file
+  struct entry
+  {
+    interp2<dcmplx> t2;
+    interp3<dcmplx> t3;
+    //  start and length of mapped or loaded file, table size in bytes, last use
+    char* buf;
+    size_t len, bytes, used;
+
+    entry() : buf(0), len(0), bytes(0), used(0) {}
+  };
+
+  std::map<std::string,entry> tab;
+  //  total size of tables and counter for least recent use
+  size_t bytes, count;
+
+  //  look up table in memory or load file
+  entry* lookup(const std::string& key, const std::string& dir);
+  //  add entry to cache and remove least recently used entries
+  entry& add(const std::string& key, size_t siz);
+  void release(entry& e);
+  //  read and write table files
+  bool load(const std::string& key, const std::string& file, entry& e);
+  void save(const std::string& key, const std::string& file, const entry& e, size_t dim) const;
+};
+
+#endif  //  tabcache_h
@@ -0,0 +1,358 @@
+//  bench.cpp - Benchmarks of H-matrix operations without Matlab.
+//
+//  For each mesh, number of boundary elements, tolerance, maximum rank and number of
+//  threads the program builds the cluster tree and times the ACA fill of the low-rank
+//  blocks, the full blocks, LU decomposition, solution, H-matrix multiplication and
+//  multiplication with a vector.  The diagonal elements of the Green function are
+//  replaced by the self terms of flat elements, such that the matrices can be inverted.
+//  Wall-clock times in seconds are the minimum over repetitions, results are written as
+//  JSON or CSV together with the number of ACA calls terminated by the maximal rank and
+//  the mean ranks before and after truncation in the LU decomposition (see hstats.h).
+//  For each stage the peak number of bytes allocated by matrices is reported, including
+//  the matrices of previous stages that are still alive (see hmemory.h).
+
+/* bench [options]
+ *   --mesh sphere,rod,dimer,substrate    meshes (see mesh.h)
+ *   --n 1000,4000                        numbers of boundary elements
+ *   --green stat,ret                     static or retarded Green function
+ *   --wav 0.1                            wavenumber of retarded Green function (1/nm)
+ *   --htol 1e-6  --kmax 100              tolerances and maximum ranks
+ *   --threads 1,2,4                      numbers of OpenMP threads
+ *   --cleaf 32  --repeat 1               leaf size of cluster tree, repetitions
+ *   --maxmem 0                           memory budget in bytes (0 for no limit)
+ *   --format json|csv  --out file        output format and file (default stdout)
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+
+#include "hoptions.h"
+#include "basemat.h"
+#include "clustertree.h"
+#include "hmatrix.h"
+#include "lu.h"
+#include "hstats.h"
+#include "acagreen.h"
+#include "mesh.h"
+
+using namespace std;
+
+//  cluster tree
+clustertree tree;
+//  indices for full and low-rank matrices
+matrix<size_t> ind1,ind2;
+
+struct hoptions hopts = { 1e-6, 100 };
+map<string,double> timer;
+
+
+//  wall-clock time in seconds
+static double walltime()
+{
+  #ifdef _OPENMP
+  return omp_get_wtime();
+  #else
+  return std::clock()/(double)CLOCKS_PER_SEC;
+  #endif
+}
+
+//  split comma-separated list
+static vector<string> split(const string& str)
+{
+  vector<string> list;
+  stringstream ss(str);
+  string item;
+  while (getline(ss,item,',')) if (!item.empty()) list.push_back(item);
+  return list;
+}
+
+//  benchmark parameters and results
+struct result
+{
+  string mesh, green;
+  size_t n, kmax, threads, nfull, nrk, rmax, kmaxhits;
+  double htol, wav, compression, resid;
+  //  mean ranks before and after truncation in LU decomposition
+  double rank1, rank2;
+  //  times of stages and peak bytes of matrices during stages
+  map<string,double> time, memory;
+};
+
+//  stages in output order
+static const char* stages[]={ "tree", "aca", "full", "lu", "solve", "hmul", "mvm" };
+static const size_t nstage=sizeof(stages)/sizeof(stages[0]);
+
+
+//  low-rank blocks of Green function
+static hmatrix<double> acafill(greenstat& g, size_t)
+{
+  return g.eval(hopts.tol);
+}
+static hmatrix<dcmplx> acafill(greenret& g, size_t npart)
+{
+  hmatrix<dcmplx> H;
+  //  loop over particle pairs
+  for (size_t i=1; i<=npart; i++)
+  for (size_t j=1; j<=npart; j++)
+  {
+    hmatrix<dcmplx> Hij=g.eval(i,j,hopts.tol);
+    for (hmatrix<dcmplx>::const_iterator it=Hij.begin(); it!=Hij.end(); it++) H[it->first]=it->second;
+  }
+  return H;
+}
+
+//  self term of flat element with area a, integral of exp(i*k*r)/r over disk
+static double selfterm(const greenstat&, double a) { return 2*sqrt(acos(-1.)*a); }
+static dcmplx selfterm(const greenret& g, double a) { return 2*sqrt(acos(-1.)*a)+dcmplx(0,1)*g.wav*a; }
+
+//  full blocks of Green function
+template<class T, class G>
+static void fullfill(G& g, hmatrix<T>& H)
+{
+  for (pairiterator it=tree.pair_begin(); it!=tree.pair_end(); it++)
+    if (tree.admiss(it->first,it->second)==flagFull)
+    {
+      g.init(it->first,it->second);
+      matrix<T> mat(g.nrows(),g.ncols());
+      for (size_t c=0; c<mat.ncols(); c++) g.getcol(c,&mat(0,c));
+      //  self terms for diagonal blocks
+      if (it->first==it->second)
+        for (size_t i=0; i<mat.nrows(); i++) mat(i,i)=selfterm(g,g.p2.area[tree.size(it->first).first+i]);
+      H[*it]=submatrix<T>(it->first,it->second,mat);
+    }
+}
+
+//  number of blocks, maximal rank and memory compared to full matrix
+template<class T>
+static void blockstat(const hmatrix<T>& H, result& res)
+{
+  hstats hs(H);
+  res.nfull=0;  res.nrk=0;  res.rmax=0;
+  for (size_t l=0; l<hs.levels.size(); l++)
+  {
+    res.nfull+=hs.levels[l].nfull;  res.nrk+=hs.levels[l].nrk;
+    res.rmax=std::max(res.rmax,hs.levels[l].rmax);
+  }
+  res.compression=hs.compression;
+}
+
+//  relative residual of solution
+template<class T>
+static double residual(const hmatrix<T>& A, const matrix<T>& x, const matrix<T>& b)
+{
+  matrix<T> r=A*x-b;
+  double s=0, t=0;
+  for (size_t i=0; i<r.nrows(); i++) { s+=abs(r[i])*abs(r[i]);  t+=abs(b[i])*abs(b[i]); }
+  return sqrt(s/t);
+}
+
+//  peak bytes of stage, reset peak for next stage
+static void mempeak(result& res, const char* stage)
+{
+  res.memory[stage]=std::max(res.memory[stage],(double)memstat.peak);
+  memstat.reset(memstat.budget);
+}
+
+//  run benchmark for Green function object
+template<class T, class G>
+static void run(G& g, size_t npart, size_t repeat, result& res)
+{
+  size_t n=tree.size(0).second;
+  for (size_t i=0; i<nstage; i++) res.time[stages[i]]=1e300;
+
+  for (size_t rep=0; rep<repeat; rep++)
+  {
+    double t;
+    memstat.reset(memstat.budget);
+    //  ACA fill of low-rank blocks and full blocks
+    t=walltime();
+    acastat.clear();
+    hmatrix<T> A=acafill(g,npart);
+    res.time["aca"]=std::min(res.time["aca"],walltime()-t);
+    mempeak(res,"aca");
+    res.kmaxhits=acastat.kmaxhits;
+    t=walltime();
+    fullfill(g,A);
+    res.time["full"]=std::min(res.time["full"],walltime()-t);
+    mempeak(res,"full");
+
+    //  LU decomposition and solution
+    hmatrix<T> LU;
+    t=walltime();
+    acastat.clear();
+    lu(A,LU);
+    res.time["lu"]=std::min(res.time["lu"],walltime()-t);
+    mempeak(res,"lu");
+    //  mean ranks before and after truncation in LU decomposition
+    res.rank1=acastat.trunc ? acastat.rank1/(double)acastat.trunc : 0;
+    res.rank2=acastat.trunc ? acastat.rank2/(double)acastat.trunc : 0;
+    matrix<T> b(n,1,(T)1), x=b;
+    t=walltime();
+    solve(LU,x,0,'L');
+    solve(LU,x,0,'U');
+    res.time["solve"]=std::min(res.time["solve"],walltime()-t);
+    mempeak(res,"solve");
+
+    //  H-matrix multiplication and multiplication with vector
+    t=walltime();
+    hmatrix<T> C=A*A;
+    res.time["hmul"]=std::min(res.time["hmul"],walltime()-t);
+    mempeak(res,"hmul");
+    t=walltime();
+    matrix<T> y=A*x;
+    res.time["mvm"]=std::min(res.time["mvm"],walltime()-t);
+    mempeak(res,"mvm");
+
+    if (rep==0)
+    {
+      blockstat(A,res);
+      res.resid=residual(A,x,b);
+    }
+  }
+}
+
+//  write results
+static void write(ostream& os, const vector<result>& list, const string& format)
+{
+  if (format=="csv")
+  {
+    os<<"mesh,green,n,htol,kmax,threads,wav,nfull,nrk,rmax,compression,resid,kmaxhits,rank1,rank2";
+    for (size_t i=0; i<nstage; i++) os<<","<<stages[i];
+    for (size_t i=0; i<nstage; i++) os<<",mem_"<<stages[i];
+    os<<endl;
+    for (size_t k=0; k<list.size(); k++)
+    {
+      const result& r=list[k];
+      os<<r.mesh<<","<<r.green<<","<<r.n<<","<<r.htol<<","<<r.kmax<<","<<r.threads<<","<<r.wav<<","
+        <<r.nfull<<","<<r.nrk<<","<<r.rmax<<","<<r.compression<<","<<r.resid<<","
+        <<r.kmaxhits<<","<<r.rank1<<","<<r.rank2;
+      for (size_t i=0; i<nstage; i++) os<<","<<r.time.find(stages[i])->second;
+      for (size_t i=0; i<nstage; i++) os<<","<<r.memory.find(stages[i])->second;
+      os<<endl;
+    }
+  }
+  else
+  {
+    os<<"["<<endl;
+    for (size_t k=0; k<list.size(); k++)
+    {
+      const result& r=list[k];
+      os<<"  { \"mesh\": \""<<r.mesh<<"\", \"green\": \""<<r.green<<"\", \"n\": "<<r.n
+        <<", \"htol\": "<<r.htol<<", \"kmax\": "<<r.kmax<<", \"threads\": "<<r.threads
+        <<", \"wav\": "<<r.wav<<", \"nfull\": "<<r.nfull<<", \"nrk\": "<<r.nrk
+        <<", \"rmax\": "<<r.rmax<<", \"compression\": "<<r.compression<<", \"resid\": "<<r.resid
+        <<", \"kmaxhits\": "<<r.kmaxhits<<", \"rank1\": "<<r.rank1<<", \"rank2\": "<<r.rank2
+        <<", \"time\": { ";
+      for (size_t i=0; i<nstage; i++)
+        os<<(i ? ", " : "")<<"\""<<stages[i]<<"\": "<<r.time.find(stages[i])->second;
+      os<<" }, \"memory\": { ";
+      for (size_t i=0; i<nstage; i++)
+        os<<(i ? ", " : "")<<"\""<<stages[i]<<"\": "<<r.memory.find(stages[i])->second;
+      os<<" } }"<<(k+1<list.size() ? "," : "")<<endl;
+    }
+    os<<"]"<<endl;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  //  default options
+  map<string,string> op;
+  op["mesh"]="sphere";  op["n"]="1000,2000,4000";  op["green"]="stat";  op["wav"]="0.1";
+  op["htol"]="1e-6";  op["kmax"]="100";  op["threads"]="1";  op["cleaf"]="32";
+  op["repeat"]="1";  op["maxmem"]="0";  op["format"]="json";  op["out"]="";
+  //  read options
+  for (int i=1; i<argc; i++)
+  {
+    string key=argv[i];
+    if (key.size()<3 || key.substr(0,2)!="--" || !op.count(key.substr(2)) || i+1==argc)
+    {
+      cerr<<"usage: bench [--mesh sphere,rod,dimer,substrate] [--n 1000,4000] [--green stat,ret]"<<endl
+          <<"             [--wav 0.1] [--htol 1e-6] [--kmax 100] [--threads 1,2] [--cleaf 32]"<<endl
+          <<"             [--repeat 1] [--maxmem 0] [--format json|csv] [--out file]"<<endl;
+      return 1;
+    }
+    op[key.substr(2)]=argv[++i];
+  }
+  size_t cleaf=atoi(op["cleaf"].c_str()), repeat=std::max(atoi(op["repeat"].c_str()),1);
+  double wav=atof(op["wav"].c_str());
+  size_t maxmem=(size_t)atof(op["maxmem"].c_str());
+
+  vector<result> list;
+  vector<string> meshes=split(op["mesh"]), ns=split(op["n"]), greens=split(op["green"]),
+                 htols=split(op["htol"]), kmaxs=split(op["kmax"]), threads=split(op["threads"]);
+  //  loop over meshes and sizes
+  for (size_t im=0; im<meshes.size(); im++)
+  for (size_t in=0; in<ns.size(); in++)
+  {
+    mesh m=mesh::get(meshes[im],atoi(ns[in].c_str()));
+    if (!m.size()) { cerr<<"bench: unknown mesh "<<meshes[im]<<endl;  return 1; }
+    size_t npart=*std::max_element(m.ip.begin(),m.ip.end());
+
+    //  cluster tree and block tree, boundary elements in cluster ordering
+    double t=walltime();
+    memstat.reset(maxmem);
+    treebuilder tb;
+    tb.build(m.pos,m.ip,cleaf);
+    tb.blocktree(tb,admiss_min(),ind1,ind2);
+    tb.set(tree,ind1,ind2);
+    double ttree=walltime()-t, mtree=(double)memstat.peak;
+    m.permute(tb.perm);
+
+    for (size_t ig=0; ig<greens.size(); ig++)
+    for (size_t ih=0; ih<htols.size(); ih++)
+    for (size_t ik=0; ik<kmaxs.size(); ik++)
+    for (size_t it=0; it<threads.size(); it++)
+    {
+      result res;
+      res.mesh=meshes[im];  res.green=greens[ig];  res.n=m.size();  res.wav=0;
+      res.htol=hopts.tol=atof(htols[ih].c_str());
+      res.kmax=hopts.kmax=atoi(kmaxs[ik].c_str());
+      res.threads=atoi(threads[it].c_str());
+      #ifdef _OPENMP
+      omp_set_num_threads((int)res.threads);
+      #else
+      res.threads=1;
+      #endif
+
+      if (res.green=="stat")
+      {
+        greenstat g(m.part(),"G");
+        run<double>(g,npart,repeat,res);
+      }
+      else if (res.green=="ret")
+      {
+        greenret g(m.part(),"G",res.wav=wav);
+        run<dcmplx>(g,npart,repeat,res);
+      }
+      else
+      {
+        cerr<<"bench: unknown Green function "<<res.green<<endl;
+        return 1;
+      }
+      res.time["tree"]=ttree;  res.memory["tree"]=mtree;
+      list.push_back(res);
+      cerr<<res.mesh<<" "<<res.green<<" n="<<res.n<<" htol="<<res.htol<<" kmax="<<res.kmax
+          <<" threads="<<res.threads<<" lu="<<res.time["lu"]<<"s "<<res.memory["lu"]/1048576<<"MB"<<endl;
+    }
+    tree.clear();  ind1.clear();  ind2.clear();
+  }
+
+  //  output
+  if (op["out"].empty())
+    write(cout,list,op["format"]);
+  else
+  {
+    ofstream fid(op["out"].c_str());
+    write(fid,list,op["format"]);
+  }
+
+  return 0;
+}
@@ -0,0 +1,141 @@
+//  mesh.h - Parametrized boundary element meshes for benchmarks.
+//
+//  The boundary elements are given by centroids, outer normal vectors and areas.  Points
+//  are distributed on spirals with the golden angle, such that the element areas are
+//  equal on each surface.  Composite meshes have one particle index per surface.
+
+/* mesh m=mesh::sphere(n,diameter);            //  sphere with n boundary elements
+ * m=mesh::rod(n,diameter,length);             //  rod with hemispherical caps
+ * m=mesh::dimer(n,diameter,gap);              //  two spheres separated by gap
+ * m=mesh::substrate(n,diameter,gap,width);    //  sphere above square plate of given width
+ * m=mesh::get(name,n);                        //  mesh by name with default parameters
+ *
+ * m.pos, m.nvec, m.area;                      //  centroids and normals (n x 3), areas
+ * m.ip;                                       //  particle index of boundary elements
+ * m.permute(perm);                            //  reorder boundary elements, e.g. cluster order
+ * p=m.part();                                 //  particle for Green functions (particle.h)
+ */
+
+#include <string>
+#include <cmath>
+
+#ifndef mesh_h
+#define mesh_h
+
+#include "hoptions.h"
+#include "basemat.h"
+#include "particle.h"
+
+class mesh
+{
+public:
+  //  centroids, normal vectors and areas of boundary elements
+  matrix<double> pos, nvec, area;
+  //  particle index (starting with 1)
+  matrix<size_t> ip;
+
+  mesh() {}
+  mesh(size_t n) : pos(n,3), nvec(n,3), area(n,1), ip(n,1,1) {}
+
+  //  number of boundary elements
+  size_t size() const { return pos.empty() ? 0 : pos.nrows(); }
+
+  //  sphere with n boundary elements
+  static mesh sphere(size_t n, double diameter)
+    {
+      mesh m(n);
+      m.sphere(0,n,0.5*diameter,0,0,0);
+      return m;
+    }
+  //  rod with hemispherical caps, length includes caps
+  static mesh rod(size_t n, double diameter, double length)
+    {
+      double a=0.5*diameter, l=std::max(length-diameter,0.);
+      //  elements of cylinder proportional to area
+      size_t nc=(size_t)(n*2*l/(2*l+4*a)+0.5), ns=n-nc;
+      mesh m(n);
+      //  caps, upper hemisphere shifted by l/2, lower by -l/2
+      m.sphere(0,ns,a,0,0,0);
+      for (size_t i=0; i<ns; i++) m.pos(i,2)+=(m.nvec(i,2)>=0 ? 0.5 : -0.5)*l;
+      //  cylinder
+      for (size_t i=0; i<nc; i++)
+      {
+        double z=-0.5*l+l*(i+0.5)/nc, phi=i*golden();
+        m.set(ns+i,a*std::cos(phi),a*std::sin(phi),z,std::cos(phi),std::sin(phi),0,2*pi()*a*l/nc);
+      }
+      return m;
+    }
+  //  two spheres separated by gap along x
+  static mesh dimer(size_t n, double diameter, double gap)
+    {
+      double x=0.5*(diameter+gap);
+      mesh m(n);
+      m.sphere(0,n/2,0.5*diameter,-x,0,0);
+      m.sphere(n/2,n,0.5*diameter,x,0,0,2);
+      return m;
+    }
+  //  sphere above square plate in the xy-plane
+  static mesh substrate(size_t n, double diameter, double gap, double width)
+    {
+      size_t k=(size_t)std::sqrt(0.5*n), np=k*k;
+      mesh m(n);
+      m.sphere(0,n-np,0.5*diameter,0,0,0.5*diameter+gap);
+      for (size_t i=0; i<k; i++)
+      for (size_t j=0; j<k; j++)
+        m.set(n-np+i+k*j,width*((i+0.5)/k-0.5),width*((j+0.5)/k-0.5),0,0,0,1,width*width/np,2);
+      return m;
+    }
+  //  mesh by name with default parameters (nm)
+  static mesh get(const std::string& name, size_t n)
+    {
+      if (name=="sphere") return sphere(n,20);
+      if (name=="rod") return rod(n,10,50);
+      if (name=="dimer") return dimer(n,20,2);
+      if (name=="substrate") return substrate(n,20,1,60);
+      return mesh();
+    }
+
+  //  reorder boundary elements, element i becomes element perm[i]
+  void permute(const matrix<size_t>& perm)
+    {
+      mesh m(size());
+      for (size_t i=0; i<size(); i++)
+      {
+        for (size_t k=0; k<3; k++) { m.pos(i,k)=pos(perm[i],k);  m.nvec(i,k)=nvec(perm[i],k); }
+        m.area[i]=area[perm[i]];  m.ip[i]=ip[perm[i]];
+      }
+      *this=m;
+    }
+  //  particle for Green functions, mesh must outlive particle
+  particle part() const
+    {
+      particle p;
+      p.n=size();  p.pos=pos.begin();  p.nvec=nvec.begin();  p.area=area.begin();
+      return p;
+    }
+
+private:
+  static double pi() { return 3.14159265358979323846; }
+  static double golden() { return pi()*(3-std::sqrt(5.)); }
+
+  //  set boundary element
+  void set(size_t i, double x, double y, double z, double nx, double ny, double nz,
+           double a, size_t ipart=1)
+    {
+      pos(i,0)=x;  pos(i,1)=y;  pos(i,2)=z;  nvec(i,0)=nx;  nvec(i,1)=ny;  nvec(i,2)=nz;
+      area[i]=a;  ip[i]=ipart;
+    }
+  //  elements i0 to i1 on sphere with radius a and center (x,y,z)
+  void sphere(size_t i0, size_t i1, double a, double x, double y, double z, size_t ipart=1)
+    {
+      size_t n=i1-i0;
+      for (size_t i=0; i<n; i++)
+      {
+        double t=1-2*(i+0.5)/n, r=std::sqrt(1-t*t), phi=i*golden();
+        double nx=r*std::cos(phi), ny=r*std::sin(phi);
+        set(i0+i,x+a*nx,y+a*ny,z+a*t,nx,ny,t,4*pi()*a*a/n,ipart);
+      }
+    }
+};
+
+#endif  //  mesh_h
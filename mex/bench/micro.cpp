@@ -0,0 +1,521 @@
+//  micro.cpp - Microbenchmarks of the leaf kernels of the H-matrix library.
+//
+//  Each kernel is called repeatedly until the minimal measurement time is reached, the
+//  time per call is the minimum over repetitions after one warm-up call.  Throughput is
+//  given in elements per second and GFLOP/s.  Elements are matrix entries for ACA, LU,
+//  Green functions and submatrices, and interpolation points for the interpolators.
+//  Floating point operations are counted as follows:
+//
+//    aca       (m+n)*k*(k+3) for a m x n block of rank k (dgemm updates, scaling, norms)
+//    lu        2/3*n^3 for the Crout decomposition
+//    interp    4 per table value (complex value times real weight), 4, 16, 64 values
+//                for bilinear, bicubic, trilinear and tricubic interpolation
+//    green     nominal count of the element formula, square roots, divisions and
+//                exponentials counted as one operation, plus interpolation for tables
+//    mul       2*m*n per column for full matrices, 2*k*(m+n) for low-rank matrices
+//    cat       copy only, no floating point operations
+//
+//  Complex operations count four times as real ones.  The kernels run on a single
+//  thread unless --threads is given, the Green functions are evaluated for the two
+//  spheres of a dimer in cluster ordering, the tables are smooth synthetic functions.
+
+/* micro [options]
+ *   --kernel aca,lu,interp,green,mul,cat      kernels (default all)
+ *   --n 512          block size (matrix entries n x n, Green functions for 2n elements)
+ *   --rank 16        rank of synthetic ACA and low-rank blocks
+ *   --points 100000  number of interpolation points
+ *   --imod linear,cubic                       interpolation methods
+ *   --mintime 0.2  --repeat 5                 minimal time per measurement, repetitions
+ *   --threads 1      number of OpenMP threads
+ *   --format json|csv  --out file             output format and file (default stdout)
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+
+#include "hoptions.h"
+#include "basemat.h"
+#include "clustertree.h"
+#include "hmatrix.h"
+#include "aca.h"
+#include "lu.h"
+#include "interp.h"
+#include "acagreen.h"
+#include "greentab.h"
+#include "mesh.h"
+
+using namespace std;
+
+//  cluster tree
+clustertree tree;
+//  indices for full and low-rank matrices
+matrix<size_t> ind1,ind2;
+
+struct hoptions hopts = { 1e-6, 500 };
+map<string,double> timer;
+
+
+//  wall-clock time in seconds
+static double walltime()
+{
+  #ifdef _OPENMP
+  return omp_get_wtime();
+  #else
+  return std::clock()/(double)CLOCKS_PER_SEC;
+  #endif
+}
+
+//  split comma-separated list
+static vector<string> split(const string& str)
+{
+  vector<string> list;
+  stringstream ss(str);
+  string item;
+  while (getline(ss,item,',')) if (!item.empty()) list.push_back(item);
+  return list;
+}
+
+//  uniform random number in [a,b), reproducible sequence
+static double urand(double a=0, double b=1)
+{
+  return a+(b-a)*(rand()/((double)RAND_MAX+1));
+}
+
+//  random values
+template<class T> T randval();
+template<> double randval<double>() { return urand(-1,1); }
+template<> dcmplx randval<dcmplx>() { return dcmplx(urand(-1,1),urand(-1,1)); }
+
+template<class T>
+matrix<T> randval(size_t m, size_t n)
+{
+  matrix<T> a(m,n);
+  for (T* p=a.begin(); p!=a.end(); p++) *p=randval<T>();
+  return a;
+}
+
+//  factor for complex operations
+static double cfac(double) { return 1; }
+static double cfac(dcmplx) { return 4; }
+//  type name
+static const char* tname(double) { return "double"; }
+static const char* tname(dcmplx) { return "complex"; }
+
+
+//  kernel with elements and floating point operations per call
+class kernel
+{
+public:
+  string name, type;
+  size_t size;
+  double elements, flops;
+
+  kernel() : size(0), elements(0), flops(0) {}
+  virtual ~kernel() {}
+  //  single call of kernel
+  virtual void run() = 0;
+};
+
+//  measurement for kernel
+struct result
+{
+  string name, type;
+  size_t size, threads;
+  double time, elements, flops;
+};
+
+//  time per call, minimum over repetitions after warm-up
+static double measure(kernel& k, double mintime, size_t repeat)
+{
+  k.run();
+  double tmin=1e300;
+  for (size_t rep=0; rep<repeat; rep++)
+  {
+    size_t ncall=0;
+    double t=walltime(), dt;
+    do { k.run();  ncall++; } while ((dt=walltime()-t)<mintime);
+    tmin=std::min(tmin,dt/ncall);
+  }
+  return tmin;
+}
+
+
+/*
+ * ACA and LU decomposition
+ */
+
+//  ACA of full matrix with known rank
+template<class T>
+class acakernel : public kernel
+{
+public:
+  matrix<T> mat, L, R;
+  double tol;
+
+  acakernel(size_t n, size_t rank, double tolin) : tol(tolin)
+    {
+      name="aca";  type=tname(T());  size=n;
+      matrix<T> a=randval<T>(n,rank), b=randval<T>(n,rank);
+      mat=mul(a,a.size(),'N',b,b.size(),'T');
+      //  rank of approximation determines number of operations
+      run();
+      size_t k=L.ncols();
+      elements=(double)n*n;
+      flops=cfac(T())*(2.*n)*k*(k+3);
+    }
+  void run() { aca(mat,L,R,tol); }
+};
+
+//  Crout LU decomposition of diagonally dominant matrix
+template<class T>
+class lukernel : public kernel
+{
+public:
+  matrix<T> mat;
+
+  lukernel(size_t n)
+    {
+      name="lu";  type=tname(T());  size=n;
+      mat=randval<T>(n,n);
+      for (size_t i=0; i<n; i++) mat(i,i)+=(T)(double)n;
+      elements=(double)n*n;
+      flops=cfac(T())*2./3.*n*n*n;
+    }
+  void run() { matrix<T> LU=lu(mat); }
+};
+
+
+/*
+ * Interpolation
+ */
+
+//  synthetic tables, smooth complex functions on lin-log grids (nm)
+static interp2<dcmplx> table2(const string& imod, size_t nc)
+{
+  size_t nr=200, nz=100;
+  matrix<double> r(nr,1), z(nz,1);
+  for (size_t i=0; i<nr; i++) r[i]=0.01+50.*i/(nr-1);
+  for (size_t i=0; i<nz; i++) z[i]=exp(log(50.)*i/(nz-1));
+  vector<matrix<dcmplx> > v(nc,matrix<dcmplx>(nr,nz));
+  for (size_t c=0; c<nc; c++)
+  for (size_t i=0; i<nr; i++)
+  for (size_t j=0; j<nz; j++)
+    v[c](i,j)=exp(dcmplx(0,0.1*(c+1))*sqrt(r[i]*r[i]+z[j]*z[j]));
+
+  return interp2<dcmplx>(r,"lin",z,"log",v,imod);
+}
+
+static interp3<dcmplx> table3(const string& imod, size_t nc)
+{
+  size_t nr=100, nz=50;
+  matrix<double> r(nr,1), z(nz,1);
+  for (size_t i=0; i<nr; i++) r[i]=0.01+50.*i/(nr-1);
+  for (size_t i=0; i<nz; i++) z[i]=0.5*exp(log(50.)*i/(nz-1));
+  vector<matrix<dcmplx> > v(nc,matrix<dcmplx>(nr*nz,nz));
+  for (size_t c=0; c<nc; c++)
+  for (size_t i=0; i<nr; i++)
+  for (size_t j=0; j<nz; j++)
+  for (size_t k=0; k<nz; k++)
+    v[c](i+nr*j,k)=exp(dcmplx(0,0.1*(c+1))*sqrt(r[i]*r[i]+pow(z[j]+z[k],2)));
+
+  return interp3<dcmplx>(r,"lin",z,"log",z,"log",v,imod);
+}
+
+//  number of table values per interpolation point
+static double taps(size_t dim, bool cubic)
+{
+  return dim==2 ? (cubic ? 16 : 4) : (cubic ? 64 : 8);
+}
+
+//  2D interpolation at random points
+class interp2kernel : public kernel
+{
+public:
+  interp2<dcmplx> tab;
+  vector<double> x, y;
+  vector<dcmplx> v;
+
+  interp2kernel(size_t n, const string& imod) : tab(table2(imod,1)), x(n), y(n), v(n)
+    {
+      name="interp2/"+imod;  type="complex";  size=n;
+      for (size_t i=0; i<n; i++) { x[i]=urand(0.01,50);  y[i]=exp(urand(0,log(50.))); }
+      elements=(double)n;
+      flops=4*taps(2,tab.cubic)*n;
+    }
+  void run() { tab(x.size(),&x[0],&y[0],&v[0]); }
+};
+
+//  3D interpolation at random points
+class interp3kernel : public kernel
+{
+public:
+  interp3<dcmplx> tab;
+  vector<double> x, y, z;
+  vector<dcmplx> v;
+
+  interp3kernel(size_t n, const string& imod) : tab(table3(imod,1)), x(n), y(n), z(n), v(n)
+    {
+      name="interp3/"+imod;  type="complex";  size=n;
+      for (size_t i=0; i<n; i++)
+      {
+        x[i]=urand(0.01,50);
+        y[i]=0.5*exp(urand(0,log(50.)));
+        z[i]=0.5*exp(urand(0,log(50.)));
+      }
+      elements=(double)n;
+      flops=4*taps(3,tab.cubic)*n;
+    }
+  void run() { tab(x.size(),&x[0],&y[0],&z[0],&v[0]); }
+};
+
+
+/*
+ * Green functions
+ */
+
+//  rows or columns of Green function for block between spheres of dimer (clusters 1,2)
+template<class T, class G>
+class greenkernel : public kernel
+{
+public:
+  G g;
+  bool col;
+  vector<T> buf;
+
+  greenkernel(const G& gin, const string& namein, bool colin, double fpe) : g(gin), col(colin)
+    {
+      g.init(1,2);
+      name=namein+(col ? "/getcol" : "/getrow");  type=tname(T());  size=g.nrows();
+      buf.resize(std::max(g.nrows(),g.ncols()));
+      elements=(double)g.nrows()*g.ncols();
+      flops=fpe*elements;
+    }
+  void run()
+    {
+      if (col)
+        for (size_t c=0; c<g.ncols(); c++) g.getcol(c,&buf[0]);
+      else
+        for (size_t r=0; r<g.nrows(); r++) g.getrow(r,&buf[0]);
+    }
+};
+
+//  add kernels for rows and columns
+template<class T, class G>
+static void addgreen(vector<kernel*>& list, const G& g, const string& name, double fpe)
+{
+  list.push_back(new greenkernel<T,G>(g,name,false,fpe));
+  list.push_back(new greenkernel<T,G>(g,name,true ,fpe));
+}
+
+
+/*
+ * Submatrices
+ */
+
+//  multiplication of full or low-rank submatrix with vectors
+template<class T>
+class mulkernel : public kernel
+{
+public:
+  submatrix<T> sub;
+  matrix<T> x;
+
+  mulkernel(size_t rank, size_t nrhs)
+    {
+      size_t m=tree.size(1).second-tree.size(1).first, n=tree.size(2).second-tree.size(2).first;
+      if (rank)
+        sub=submatrix<T>(1,2,randval<T>(m,rank),randval<T>(n,rank));
+      else
+        sub=submatrix<T>(1,2,randval<T>(m,n));
+      x=randval<T>(tree.size(0).second,nrhs);
+
+      ostringstream ss;  ss<<"mul/"<<sub.name()<<"/"<<nrhs;
+      name=ss.str();  type=tname(T());  size=m;
+      elements=(double)m*n*nrhs;
+      flops=cfac(T())*nrhs*(rank ? 2.*rank*(m+n) : 2.*m*n);
+    }
+  void run() { matrix<T> y=mul(sub,x); }
+};
+
+//  concatenation of 2 x 2 full or low-rank submatrices
+template<class T>
+class catkernel : public kernel
+{
+public:
+  matrix<submatrix<T> > sub;
+
+  catkernel(size_t n, size_t rank) : sub(2,2)
+    {
+      size_t m=n/2;
+      for (size_t i=0; i<4; i++)
+        sub[i]=rank ? submatrix<T>(1,1,randval<T>(m,rank),randval<T>(m,rank)) :
+                      submatrix<T>(1,1,randval<T>(m,m));
+      name=string("cat/")+sub[0].name();  type=tname(T());  size=n;
+      //  entries of output matrices
+      elements=rank ? 2.*(2*m)*(4*rank) : 4.*m*m;
+      flops=0;
+    }
+  void run() { submatrix<T> A=cat(sub,0,0); }
+};
+
+
+//  write results
+static void write(ostream& os, const vector<result>& list, const string& format)
+{
+  if (format=="csv")
+  {
+    os<<"kernel,type,size,threads,time,elements_per_s,gflops"<<endl;
+    for (size_t k=0; k<list.size(); k++)
+    {
+      const result& r=list[k];
+      os<<r.name<<","<<r.type<<","<<r.size<<","<<r.threads<<","<<r.time<<","
+        <<r.elements/r.time<<","<<1e-9*r.flops/r.time<<endl;
+    }
+  }
+  else
+  {
+    os<<"["<<endl;
+    for (size_t k=0; k<list.size(); k++)
+    {
+      const result& r=list[k];
+      os<<"  { \"kernel\": \""<<r.name<<"\", \"type\": \""<<r.type<<"\", \"size\": "<<r.size
+        <<", \"threads\": "<<r.threads<<", \"time\": "<<r.time
+        <<", \"elements_per_s\": "<<r.elements/r.time<<", \"gflops\": "<<1e-9*r.flops/r.time
+        <<" }"<<(k+1<list.size() ? "," : "")<<endl;
+    }
+    os<<"]"<<endl;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  //  default options
+  map<string,string> op;
+  op["kernel"]="aca,lu,interp,green,mul,cat";  op["n"]="512";  op["rank"]="16";
+  op["points"]="100000";  op["imod"]="linear,cubic";  op["mintime"]="0.2";  op["repeat"]="5";
+  op["threads"]="1";  op["format"]="json";  op["out"]="";
+  //  read options
+  for (int i=1; i<argc; i++)
+  {
+    string key=argv[i];
+    if (key.size()<3 || key.substr(0,2)!="--" || !op.count(key.substr(2)) || i+1==argc)
+    {
+      cerr<<"usage: micro [--kernel aca,lu,interp,green,mul,cat] [--n 512] [--rank 16]"<<endl
+          <<"             [--points 100000] [--imod linear,cubic] [--mintime 0.2] [--repeat 5]"<<endl
+          <<"             [--threads 1] [--format json|csv] [--out file]"<<endl;
+      return 1;
+    }
+    op[key.substr(2)]=argv[++i];
+  }
+  size_t n=std::max(atoi(op["n"].c_str()),2), rank=std::max(atoi(op["rank"].c_str()),1);
+  size_t points=std::max(atoi(op["points"].c_str()),1);
+  size_t repeat=std::max(atoi(op["repeat"].c_str()),1), threads=atoi(op["threads"].c_str());
+  double mintime=atof(op["mintime"].c_str());
+  #ifdef _OPENMP
+  omp_set_num_threads((int)threads);
+  #else
+  threads=1;
+  #endif
+
+  //  dimer with n elements per sphere, clusters 1 and 2 are the spheres
+  mesh m=mesh::dimer(2*n,20,2);
+  treebuilder tb;
+  tb.build(m.pos,m.ip,n);
+  tb.set(tree,ind1,ind2);
+  m.permute(tb.perm);
+  //  distance to layer at z=-11 for tabulated Green functions
+  matrix<double> zl(2*n,1);
+  for (size_t i=0; i<2*n; i++) zl[i]=m.pos(i,2)+11;
+  particle p=m.part();
+  p.z=zl.begin();
+
+  vector<string> kernels=split(op["kernel"]), imods=split(op["imod"]);
+  vector<kernel*> list;
+  for (size_t ik=0; ik<kernels.size(); ik++)
+  {
+    const string& k=kernels[ik];
+    if (k=="aca")
+    {
+      list.push_back(new acakernel<double>(n,rank,hopts.tol));
+      list.push_back(new acakernel<dcmplx>(n,rank,hopts.tol));
+    }
+    else if (k=="lu")
+    {
+      list.push_back(new lukernel<double>(n));
+      list.push_back(new lukernel<dcmplx>(n));
+    }
+    else if (k=="interp")
+      for (size_t i=0; i<imods.size(); i++)
+      {
+        list.push_back(new interp2kernel(points,imods[i]));
+        list.push_back(new interp3kernel(points,imods[i]));
+      }
+    else if (k=="green")
+    {
+      addgreen<double>(list,greenstat(p,"G"),"greenstat/G",12);
+      addgreen<double>(list,greenstat(p,"F"),"greenstat/F",20);
+      addgreen<dcmplx>(list,greenret(p,"G",0.1),"greenret/G",20);
+      addgreen<dcmplx>(list,greenret(p,"F",0.1),"greenret/F",30);
+      for (size_t i=0; i<imods.size(); i++)
+      {
+        interp2<dcmplx> g2=table2(imods[i],1), f2=table2(imods[i],2);
+        interp3<dcmplx> g3=table3(imods[i],1), f3=table3(imods[i],2);
+        addgreen<dcmplx>(list,greentabG2(p,g2,1),"greentabG2/"+imods[i],12+4*taps(2,g2.cubic));
+        addgreen<dcmplx>(list,greentabG3(p,g3,1),"greentabG3/"+imods[i],12+4*taps(3,g3.cubic));
+        addgreen<dcmplx>(list,greentabF2(p,f2,1),"greentabF2/"+imods[i],20+8*taps(2,f2.cubic));
+        addgreen<dcmplx>(list,greentabF3(p,f3,1),"greentabF3/"+imods[i],20+8*taps(3,f3.cubic));
+      }
+    }
+    else if (k=="mul")
+    {
+      list.push_back(new mulkernel<double>(0,1));
+      list.push_back(new mulkernel<double>(rank,1));
+      list.push_back(new mulkernel<dcmplx>(0,1));
+      list.push_back(new mulkernel<dcmplx>(rank,1));
+      list.push_back(new mulkernel<dcmplx>(rank,16));
+    }
+    else if (k=="cat")
+    {
+      list.push_back(new catkernel<double>(n,0));
+      list.push_back(new catkernel<double>(n,rank));
+      list.push_back(new catkernel<dcmplx>(n,0));
+      list.push_back(new catkernel<dcmplx>(n,rank));
+    }
+    else
+    {
+      cerr<<"micro: unknown kernel "<<k<<endl;
+      return 1;
+    }
+  }
+
+  //  measurements
+  vector<result> res;
+  for (size_t i=0; i<list.size(); i++)
+  {
+    result r;
+    r.name=list[i]->name;  r.type=list[i]->type;  r.size=list[i]->size;  r.threads=threads;
+    r.elements=list[i]->elements;  r.flops=list[i]->flops;
+    r.time=measure(*list[i],mintime,repeat);
+    res.push_back(r);
+    cerr<<r.name<<" "<<r.type<<" "<<r.time<<"s "<<1e-9*r.flops/r.time<<" GFLOP/s"<<endl;
+    delete list[i];
+  }
+
+  //  output
+  if (op["out"].empty())
+    write(cout,res,op["format"]);
+  else
+  {
+    ofstream fid(op["out"].c_str());
+    write(fid,res,op["format"]);
+  }
+
+  return 0;
+}
@@ -0,0 +1,120 @@
+#include "mex.h"
+#include "matrix.h"
+
+#include <vector>
+#include <cstdio>
+
+#include "hoptions.h"
+#include "basemat.h"
+#include "greenlayer.h"
+#include "hrecord.h"
+
+using namespace std;
+
+map<string,double> timer;
+
+//  names of reflected Green functions, see layerstructure/reflectionsubs.m
+static const char* names[nGreen]={ "p", "ss", "hs", "sh", "hh" };
+
+//  scalar field of structure, default value if not present or empty
+static double getfield(const mxArray* rhs, const char* name, double val)
+{
+  const mxArray* field=mxGetField(rhs,0,name);
+  return (field && !mxIsEmpty(field)) ? mxGetScalar(field) : val;
+}
+
+//  complex output array of dimension siz, pointer to interleaved values of size n
+//    (Matlab memory for interleaved complex API, buffer otherwise)
+static mxArray* newarray(const mwSize* siz, vector<dcmplx>& buf, dcmplx*& val)
+{
+  mxArray* x=mxCreateNumericArray(4,siz,mxDOUBLE_CLASS,mxCOMPLEX);
+#if MX_HAS_INTERLEAVED_COMPLEX
+  val=(dcmplx*)mxGetComplexDoubles(x);
+#else
+  buf.resize(siz[0]*siz[1]*siz[2]*siz[3]);
+  val=buf.empty() ? 0 : &buf[0];
+#endif
+  return x;
+}
+
+//  copy buffer to output array (separate real and imaginary parts only)
+static void setarray(mxArray* x, const vector<dcmplx>& buf)
+{
+#if !MX_HAS_INTERLEAVED_COMPLEX
+  double *pr=mxGetPr(x), *pi=mxGetPi(x);
+  for (size_t i=0; i<buf.size(); i++) pr[i]=real(buf[i]), pi[i]=imag(buf[i]);
+#endif
+}
+
+
+//  tabulate reflected Green functions for substrate, deal with calling sequence:
+//    layer, enei, r, z1, z2, with layer structure containing the fields z, eps (2 x ne),
+//    and options rmin, zmin, semi, ratio, AbsTol, RelTol
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  //  record inputs for replay (hrecord.h)
+  record("greenlayertab",nlhs,nrhs,prhs);
+  //  layer structure and integration options
+  greenlayer layer;
+  layer.z     =getfield(prhs[0],"z",    layer.z);
+  layer.rmin  =getfield(prhs[0],"rmin", layer.rmin);
+  layer.zmin  =getfield(prhs[0],"zmin", layer.zmin);
+  layer.semi  =getfield(prhs[0],"semi", layer.semi);
+  layer.ratio =getfield(prhs[0],"ratio",layer.ratio);
+  layer.abstol=getfield(prhs[0],"AbsTol",layer.abstol);
+  layer.reltol=getfield(prhs[0],"RelTol",layer.reltol);
+  //  dielectric functions above and below interface for wavelengths
+  if (!mxGetField(prhs[0],0,"eps")) mexErrMsgTxt("greenlayertab: layer structure requires field eps");
+  matrix<dcmplx> eps=matrix<dcmplx>::getmex(mxGetField(prhs[0],0,"eps"));
+
+  //  wavelengths and tabulation grid
+  size_t ne=mxGetNumberOfElements(prhs[1]), nr=mxGetNumberOfElements(prhs[2]),
+         n1=mxGetNumberOfElements(prhs[3]), n2=mxGetNumberOfElements(prhs[4]);
+  if (eps.nrows()!=2 || eps.ncols()!=ne)
+    mexErrMsgTxt("greenlayertab: eps must be array of size 2 x numel(enei)");
+
+  vector<dcmplx> eps1(ne), eps2(ne);
+  for (size_t i=0; i<ne; i++) eps1[i]=eps(0,i), eps2[i]=eps(1,i);
+
+  //  output structures with arrays of size [nr,n1,n2,ne]
+  mwSize siz[4]={ (mwSize)nr, (mwSize)n1, (mwSize)n2, (mwSize)ne };
+  plhs[0]=mxCreateStructMatrix(1,1,nGreen,names);
+  plhs[1]=mxCreateStructMatrix(1,1,nGreen,names);
+  plhs[2]=mxCreateStructMatrix(1,1,nGreen,names);
+  //  allocate output arrays
+  vector<vector<dcmplx> > G(nGreen), Fr(nGreen), Fz(nGreen);
+  dcmplx *pG[nGreen], *pFr[nGreen], *pFz[nGreen];
+  for (int i=0; i<nGreen; i++)
+  {
+    mxSetField(plhs[0],0,names[i],newarray(siz,G [i],pG [i]));
+    mxSetField(plhs[1],0,names[i],newarray(siz,Fr[i],pFr[i]));
+    mxSetField(plhs[2],0,names[i],newarray(siz,Fz[i],pFz[i]));
+  }
+
+  //  tabulate Green functions
+  if (nr*n1*n2*ne)
+  {
+    tic;
+    size_t nfail=layer.tab(ne,mxGetPr(prhs[1]),&eps1[0],&eps2[0],nr,mxGetPr(prhs[2]),
+                           n1,mxGetPr(prhs[3]),n2,mxGetPr(prhs[4]),pG,pFr,pFz);
+    toc("greenlayertab");
+    //  warn about Sommerfeld integrals with maximal number of subintervals
+    if (nfail)
+    {
+      char msg[200];
+      std::sprintf(msg,"greenlayertab: integration not converged for %lu of %lu tabulation points",
+                   (unsigned long)nfail,(unsigned long)(nr*n1*n2*ne));
+      mexWarnMsgTxt(msg);
+    }
+  }
+  //  convert to separate real and imaginary parts
+  for (int i=0; i<nGreen; i++)
+  {
+    setarray(mxGetField(plhs[0],0,names[i]),G [i]);
+    setarray(mxGetField(plhs[1],0,names[i]),Fr[i]);
+    setarray(mxGetField(plhs[2],0,names[i]),Fz[i]);
+  }
+
+  //  clear globals
+  timer.clear();
+}
@@ -5,6 +5,10 @@
 
 #include "hoptions.h"
 #include "aca.h"
+#include "hstats.h"
+
+//  statistics of ACA calls and truncations
+acastats acastat;
 
 /*
  * Double precision ACA
@@ -60,10 +64,14 @@ void aca(const acafunc<double>& fun, matrix<double>& L, matrix<double>& R, doubl
   const char *chN="N", *chT="T";
   double pone=1., mone=-1., zero=0.;
   
-  //  build up low-rank approximation A * B' using ACA
+  //  build up low-rank approximation A * B' using ACA, workspace is tagged as temporary
+  memscope scope(memTemp);
   matrix<double> A(m,kmax,(double)0), B(n,kmax);
+  scope.close();
   //  summed up norm and new norm
   double Nsum=0, Nk, scale;
+  //  relative norms of updates
+  std::vector<double> hist;
   //  vector for pivot elements
   std::vector<ptrdiff_t> row(m);  for (i=0; i<m; i++) row[i]=i;
  
@@ -92,6 +100,7 @@ void aca(const acafunc<double>& fun, matrix<double>& L, matrix<double>& R, doubl
     for (r=row.front(), i=0; i<row.size(); i++) if (abs(A(row[i],k))>abs(A(r,k))) r=row[i];
     //  norm of new vector elements
     Nk=F77_NAME(dnrm2)(&m, A.val+k*m, &ione)*F77_NAME(dnrm2)(&n, B.val+k*n, &ione);
+    hist.push_back(Nsum>0 ? Nk/Nsum : 1);
     //  check for convergence
     if (Nk<tol*Nsum || row.empty())
       break;
@@ -99,6 +108,8 @@ void aca(const acafunc<double>& fun, matrix<double>& L, matrix<double>& R, doubl
       Nsum=sqrt(pow(Nsum,2)+pow(Nk,2));
   }
   
+  //  statistics, ACA loop terminated by maximal rank ?
+  acastat.aca(std::min<ptrdiff_t>(k+1,kmax),k==kmax && (size_t)kmax==hopts.kmax,hist);
   //  set output
   L=matrix<double>(m,std::min<ptrdiff_t>(k+1,kmax),A.val);
   R=matrix<double>(n,std::min<ptrdiff_t>(k+1,kmax),B.val);
@@ -163,10 +174,14 @@ void aca(const acafunc<dcmplx>& fun, matrix<dcmplx>& L, matrix<dcmplx>& R, doubl
   const char *chN="N", *chT="T";
   dcmplx pone=1., mone=-1., zero=0., scale;
   
-  //  build up low-rank approximation A * B' using ACA
+  //  build up low-rank approximation A * B' using ACA, workspace is tagged as temporary
+  memscope scope(memTemp);
   matrix<dcmplx> A(m,kmax,(dcmplx)0), B(n,kmax);
+  scope.close();
   //  summed up norm and new norm
   double Nsum=0, Nk;
+  //  relative norms of updates
+  std::vector<double> hist;
   //  vector for pivot elements
   std::vector<ptrdiff_t> row(m);  for (i=0; i<m; i++) row[i]=i;
   std::vector<ptrdiff_t>::iterator it;
@@ -203,6 +218,7 @@ void aca(const acafunc<dcmplx>& fun, matrix<dcmplx>& L, matrix<dcmplx>& R, doubl
     Nk=F77_NAME(dznrm2)(&m, (const double*)(A.val+k*m), &ione)*
        F77_NAME(dznrm2)(&n, (const double*)(B.val+k*n), &ione);
     
+    hist.push_back(Nsum>0 ? Nk/Nsum : 1);
     //  check for convergence
     if (Nk<tol*Nsum || row.empty())
       break;
@@ -210,6 +226,8 @@ void aca(const acafunc<dcmplx>& fun, matrix<dcmplx>& L, matrix<dcmplx>& R, doubl
       Nsum=sqrt(pow(Nsum,2)+pow(Nk,2));
   }
   
+  //  statistics, ACA loop terminated by maximal rank ?
+  acastat.aca(std::min<ptrdiff_t>(k+1,kmax),k==kmax && (size_t)kmax==hopts.kmax,hist);
   //  set output
   L=matrix<dcmplx>(m,std::min<ptrdiff_t>(k+1,kmax),A.val);
   R=matrix<dcmplx>(n,std::min<ptrdiff_t>(k+1,kmax),B.val);
@@ -6,8 +6,24 @@
 
 #include "hoptions.h"
 #include "basemat.h"
+
+#ifdef MEX
 #include "lapack.h"
+#else
+//  LAPACK routines as declared in lapack.h of Matlab
+extern "C"
+{
+  void F77_NAME(dgetrf)(const ptrdiff_t*, const ptrdiff_t*, double*, const ptrdiff_t*, ptrdiff_t*, ptrdiff_t*);
+  void F77_NAME(dgetri)(const ptrdiff_t*, double*, const ptrdiff_t*, const ptrdiff_t*, double*,
+                        const ptrdiff_t*, ptrdiff_t*);
+  void F77_NAME(zgetrf)(const ptrdiff_t*, const ptrdiff_t*, double*, const ptrdiff_t*, ptrdiff_t*, ptrdiff_t*);
+  void F77_NAME(zgetri)(const ptrdiff_t*, double*, const ptrdiff_t*, const ptrdiff_t*, double*,
+                        const ptrdiff_t*, ptrdiff_t*);
+}
+#endif
 
+//  memory accounting of matrix allocations (hmemory.h)
+memstats memstat;
   
 /*
  * Double precision matrix specializations
@@ -125,10 +141,28 @@ matrix<double> inv(const matrix<double>& A)
 mxArray* setmex(const matrix<double>& mat)
 {
   mxArray* lhs=mxCreateNumericMatrix(mat.nrows(),mat.ncols(),mxDOUBLE_CLASS,mxREAL);
-  std::copy(mat.begin(),mat.end(),(double*)mxGetPr(lhs));
+  std::copy(mat.begin(),mat.end(),(double*)mxGetData(lhs));
+  
+  return lhs;
+}
+
+//  new Matlab array, mat is view of its memory
+mxArray* mexalloc(size_t m, size_t n, matrix<double>& mat)
+{
+  mxArray* lhs=mxCreateNumericMatrix(m,n,mxDOUBLE_CLASS,mxREAL);
+  mat.view(m,n,(double*)mxGetData(lhs));
   
   return lhs;
 }
+
+//  return Matlab array if mat is still view of its memory, copy mat otherwise
+mxArray* setmex(const matrix<double>& mat, mxArray* lhs)
+{
+  if (lhs && mat.isview() && mat.begin()==(const double*)mxGetData(lhs)) return lhs;
+  if (lhs) mxDestroyArray(lhs);
+  
+  return setmex(mat);
+}
 #endif  //  MEX
 
 
@@ -241,6 +275,52 @@ matrix<dcmplx> inv(const matrix<dcmplx>& A)
 }
 
 #ifdef MEX
+#if MX_HAS_INTERLEAVED_COMPLEX
+//  interleaved complex API (mex -R2018a), Matlab arrays have same memory layout as dcmplx
+template<>
+matrix<dcmplx> matrix<dcmplx>::getmex(const mxArray* rhs)
+{
+  size_t m=mxGetM(rhs), n=mxGetN(rhs);
+  //  complex input
+  if (mxIsComplex(rhs)) return matrix<dcmplx>(m,n,(const dcmplx*)mxGetComplexDoubles(rhs));
+  //  real input
+  matrix<dcmplx> mat(m,n);
+  std::copy(mxGetDoubles(rhs),mxGetDoubles(rhs)+m*n,mat.val);
+  
+  return mat;
+}
+
+//  view of complex Matlab array, real arrays are converted
+template<>
+matrix<dcmplx>& matrix<dcmplx>::mexview(const mxArray* rhs)
+{
+  if (mxIsComplex(rhs)) return view(mxGetM(rhs),mxGetN(rhs),(dcmplx*)mxGetComplexDoubles(rhs));
+  matrix<dcmplx> mat=getmex(rhs);
+  swap(mat);
+  
+  return *this;
+}
+
+//  copy C++ matrix into Matlab array
+mxArray* setmex(const matrix<dcmplx>& mat)
+{
+  mxArray* x=mxCreateDoubleMatrix(mat.nrows(),mat.ncols(),mxCOMPLEX);
+  std::copy(mat.begin(),mat.end(),(dcmplx*)mxGetComplexDoubles(x));
+  
+  return x;
+}
+
+//  new Matlab array, mat is view of its memory
+mxArray* mexalloc(size_t m, size_t n, matrix<dcmplx>& mat)
+{
+  mxArray* x=mxCreateDoubleMatrix(m,n,mxCOMPLEX);
+  mat.view(m,n,(dcmplx*)mxGetComplexDoubles(x));
+  
+  return x;
+}
+
+#else
+//  separate storage of real and imaginary parts, arrays must be converted
 template<>
 matrix<dcmplx> matrix<dcmplx>::getmex(const mxArray* rhs)
 {
@@ -254,6 +334,16 @@ matrix<dcmplx> matrix<dcmplx>::getmex(const mxArray* rhs)
   return mat;
 }
 
+//  no views possible, copy of Matlab array
+template<>
+matrix<dcmplx>& matrix<dcmplx>::mexview(const mxArray* rhs)
+{
+  matrix<dcmplx> mat=getmex(rhs);
+  swap(mat);
+  
+  return *this;
+}
+
 //  copy C++ matrix into Matlab array
 mxArray* setmex(const matrix<dcmplx>& mat)
 {
@@ -266,4 +356,223 @@ mxArray* setmex(const matrix<dcmplx>& mat)
     
   return x;
 }
-#endif // MEX
\ No newline at end of file
+
+//  no views possible, mat is allocated and copied to Matlab array by setmex(mat,lhs)
+mxArray* mexalloc(size_t m, size_t n, matrix<dcmplx>& mat)
+{
+  mat=matrix<dcmplx>(m,n);
+  return 0;
+}
+#endif // MX_HAS_INTERLEAVED_COMPLEX
+
+//  return Matlab array if mat is still view of its memory, copy mat otherwise
+mxArray* setmex(const matrix<dcmplx>& mat, mxArray* lhs)
+{
+  if (lhs && mat.isview() && mat.begin()==(const dcmplx*)mxGetData(lhs)) return lhs;
+  if (lhs) mxDestroyArray(lhs);
+  
+  return setmex(mat);
+}
+#endif // MEX
+
+/*
+ * Single precision matrix specializations, used for storage of H-matrices (mixed.h)
+ */
+
+//  copy array to matrix
+template<> 
+const matrix<float>& matrix<float>::copy(const float* t)
+{
+  ptrdiff_t n=mld*nld, ione=1;
+  F77_NAME(scopy)(&n, t, &ione, val, &ione);
+  
+  return *this;
+} 
+
+//  add matrices
+template<> 
+const matrix<float>& matrix<float>::add_to(const matrix<float>& mat, const float& a)
+{
+  ptrdiff_t n=mld*nld, ione=1;
+  F77_NAME(saxpy)(&n, &a, mat.val, &ione, val, &ione);
+  
+  return *this;
+}  
+
+//  scale matrix with constant value
+template<> 
+const matrix<float>& matrix<float>::scale(const float& a)
+{
+  ptrdiff_t n=mld*nld, ione=1;
+  F77_NAME(sscal)(&n, &a, val, &ione);
+  
+  return *this;
+}
+
+//  concatenate matrices horizontally
+template<> 
+matrix<float> cat(const matrix<float>& A, const matrix<float>& B)
+{
+  ptrdiff_t nA=A.nrows()*A.ncols(), nB=B.nrows()*B.ncols(), ione=1;
+  
+  ASSERT(A.nrows()==B.nrows());
+  matrix<float> C(A.nrows(),A.ncols()+B.ncols());
+  F77_NAME(scopy)(&nA, A.begin(), &ione, C.begin(),    &ione);
+  F77_NAME(scopy)(&nB, B.begin(), &ione, C.begin()+nA, &ione);
+  
+  return C;
+}
+
+//  multiply matrices using the BLAS library, C = C + op( A )*op( B )  
+template<>
+void add_mul(const matrix<float>& A, const mask_t& maskA, char transA,
+             const matrix<float>& B, const mask_t& maskB, char transB,
+                   matrix<float>& C, const mask_t& maskC)
+{
+  //  variables for BLAS routine sgemm, C := alpha*op( A )*op( B ) + beta*C
+  ptrdiff_t mA=maskA.nrows(), nA=maskA.ncols(),  
+            mB=maskB.nrows(), nB=maskB.ncols(), m, n, k;
+  ptrdiff_t ldA=A.nrows(), ldB=B.nrows(), ldC=C.nrows();
+  float alpha=1, beta=1;
+  //  pointer to first elements of matrices
+  const float *pA=&A(maskA.rbegin,maskA.cbegin), *pB=&B(maskB.rbegin,maskB.cbegin);
+  float *pC=&C(maskC.rbegin,maskC.cbegin);
+  
+       if (transA=='N' && transB=='N') m=mA, k=nA, n=nB;
+  else if (transA=='T' && transB=='N') m=nA, k=mA, n=nB;
+  else if (transA=='N' && transB=='T') m=mA, k=nA, n=mB;
+  else if (transA=='T' && transB=='T') m=nA, k=mA, n=mB; 
+  
+  //  call BLAS routine 
+  tic; 
+  F77_NAME(sgemm)(&transA, &transB, &m, &n, &k, &alpha, pA, &ldA, pB, &ldB, &beta, pC, &ldC);
+  toc("mul_BLAS");
+}
+
+//  copy array to matrix
+template<> 
+const matrix<fcmplx>& matrix<fcmplx>::copy(const fcmplx* t)
+{
+  ptrdiff_t n=mld*nld, ione=1;
+  F77_NAME(ccopy)(&n, (const float*)t, &ione, (float*)val, &ione);
+  
+  return *this;
+} 
+
+//  add matrices
+template<> 
+const matrix<fcmplx>& matrix<fcmplx>::add_to(const matrix<fcmplx>& mat, const fcmplx& a)
+{
+  ptrdiff_t n=mld*nld, ione=1;
+  F77_NAME(caxpy)(&n, (const float*)&a, (const float*)mat.val, &ione, (float*)val, &ione);
+  
+  return *this;
+}  
+
+//  scale matrix with constant value
+template<> 
+const matrix<fcmplx>& matrix<fcmplx>::scale(const fcmplx& a)
+{
+  ptrdiff_t n=mld*nld, ione=1;
+  F77_NAME(cscal)(&n, (const float*)&a, (float*)val, &ione);
+  
+  return *this;
+}
+
+//  concatenate matrices horizontally
+template<> 
+matrix<fcmplx> cat(const matrix<fcmplx>& A, const matrix<fcmplx>& B)
+{
+  ptrdiff_t nA=A.nrows()*A.ncols(), nB=B.nrows()*B.ncols(), ione=1;
+  
+  ASSERT(A.nrows()==B.nrows());
+  matrix<fcmplx> C(A.nrows(),A.ncols()+B.ncols());
+  F77_NAME(ccopy)(&nA, (const float*)A.begin(), &ione, (float*) C.begin(),     &ione);
+  F77_NAME(ccopy)(&nB, (const float*)B.begin(), &ione, (float*)(C.begin()+nA), &ione);
+  
+  return C;
+}
+
+//  multiply matrices using the BLAS library, C = C + op( A )*op( B )  
+template<>
+void add_mul(const matrix<fcmplx>& A, const mask_t& maskA, char transA,
+             const matrix<fcmplx>& B, const mask_t& maskB, char transB,
+                   matrix<fcmplx>& C, const mask_t& maskC)
+{
+  //  variables for BLAS routine cgemm, C := alpha*op( A )*op( B ) + beta*C
+  ptrdiff_t mA=maskA.nrows(), nA=maskA.ncols(), 
+            mB=maskB.nrows(), nB=maskB.ncols(), m, n, k;
+  ptrdiff_t ldA=A.nrows(), ldB=B.nrows(), ldC=C.nrows();
+  fcmplx alpha=1, beta=1;
+  //  pointer to first elements of matrices
+  const float *pA=(const float*)&A(maskA.rbegin,maskA.cbegin), 
+              *pB=(const float*)&B(maskB.rbegin,maskB.cbegin);
+  float *pC=(float*)&C(maskC.rbegin,maskC.cbegin);
+  
+       if (transA=='N' && transB=='N') m=mA, k=nA, n=nB;
+  else if (transA=='T' && transB=='N') m=nA, k=mA, n=nB;
+  else if (transA=='N' && transB=='T') m=mA, k=nA, n=mB;
+  else if (transA=='T' && transB=='T') m=nA, k=mA, n=mB; 
+  
+  //  call BLAS routine 
+  tic; 
+  F77_NAME(cgemm)(&transA, &transB, &m, &n, &k, (const float*)&alpha, pA, &ldA, pB, &ldB, 
+                                                (const float*)&beta,  pC, &ldC);
+  toc("mul_BLAS");
+}
+
+#ifdef MEX
+#if MX_HAS_INTERLEAVED_COMPLEX
+//  interleaved complex API, single precision Matlab arrays have same memory layout as fcmplx
+template<>
+matrix<fcmplx> matrix<fcmplx>::getmex(const mxArray* rhs)
+{
+  size_t m=mxGetM(rhs), n=mxGetN(rhs);
+  //  complex input
+  if (mxIsComplex(rhs)) return matrix<fcmplx>(m,n,(const fcmplx*)mxGetComplexSingles(rhs));
+  //  real input
+  matrix<fcmplx> mat(m,n);
+  std::copy(mxGetSingles(rhs),mxGetSingles(rhs)+m*n,mat.val);
+  
+  return mat;
+}
+
+//  view of complex Matlab array, real arrays are converted
+template<>
+matrix<fcmplx>& matrix<fcmplx>::mexview(const mxArray* rhs)
+{
+  if (mxIsComplex(rhs)) return view(mxGetM(rhs),mxGetN(rhs),(fcmplx*)mxGetComplexSingles(rhs));
+  matrix<fcmplx> mat=getmex(rhs);
+  swap(mat);
+  
+  return *this;
+}
+
+#else
+//  separate storage of real and imaginary parts, arrays must be converted
+template<>
+matrix<fcmplx> matrix<fcmplx>::getmex(const mxArray* rhs)
+{
+  matrix<fcmplx> mat(mxGetM(rhs),mxGetN(rhs));
+  ptrdiff_t n=mat.nrows()*mat.ncols(), ione=1, itwo=2;
+  //  copy real and imaginary parts
+  F77_NAME(scopy)(&n, (const float*)mxGetData(rhs), &ione, (float*)mat.val, &itwo);
+  if (mxIsComplex(rhs)) 
+    F77_NAME(scopy)(&n, (const float*)mxGetImagData(rhs), &ione, (float*)mat.val+1, &itwo);
+  else
+    for (ptrdiff_t i=0; i<n; i++) mat.val[i].imag(0);
+  
+  return mat;
+}
+
+//  no views possible, copy of Matlab array
+template<>
+matrix<fcmplx>& matrix<fcmplx>::mexview(const mxArray* rhs)
+{
+  matrix<fcmplx> mat=getmex(rhs);
+  swap(mat);
+  
+  return *this;
+}
+#endif // MX_HAS_INTERLEAVED_COMPLEX
+#endif // MEX
@@ -1,17 +1,26 @@
 //  basemat.h - Simple matrix class with basic functionality.
 //
-//  The class makes extensive use of BLAS and LAPACK routines for speedup.
+//  The class makes extensive use of BLAS and LAPACK routines for speedup.  Matrices of
+//  type float and fcmplx are supported for storage and multiplication in single precision.
 
 /* matrix<double> a(m,n), b(m,n,0.), ... ;  //  initialization
  * 
  * a=matrix<double>::getmex(rhs); //  convert Matlab array to C++ matrix
  * lhs=setmex(a);                 //  copy C++ matrix into Matlab array
+ * a.view(m,n,ptr);               //  non-owning view of external memory
+ * a.mexview(rhs);                //  view of Matlab array (copy if conversion needed)
+ * lhs=mexalloc(m,n,a);           //  new Matlab array, a is view of its memory
+ * lhs=mexalloc(rhs,a);           //  same, initialized with values of rhs
+ * lhs=setmex(a,lhs);             //  no copy if a is still view of lhs
  * a=matrix<double>::fread(fid);  //  read matrix from file
  * fid=a.fwrite(fid);             //  write matrix to file
  * 
  * a.nrows();       //  number of rows
  * a.ncols();       //  number of columns
  * a.empty();       //  is matrix empty?
+ * a.swap(b);       //  exchange contents of matrices
+ * a.isview();      //  memory owned by someone else?
+ *                  //  allocations are counted in memstat (hmemory.h)
  * 
  * a(i,j);          //  reference
  * a[i]             //  access elements (FORTRAN storage, rows first) 
@@ -21,6 +30,7 @@
  * mask_t amask(r0,r1,c0,c1);     //  size of matrix (r0,r1,c0,c1)
  * 
  * at=transp(a);                  //  transpose of matrix
+ * b=recast<float>(a);            //  matrix with other precision (float, fcmplx, ...)
  * b=mask(a,amask)                //  matrix masking
  * copy(a,amask,b,bmask);         //  copy contents from a to b using masking
  * add(a,amask,b,bmask,c,cmask);  //  summation c=a+b using masking
@@ -41,11 +51,13 @@
 #include <fstream>
 #include <cstdlib>
 #include <cstdarg>
+#include <stdexcept>
 
 #ifndef basemat_h
 #define basemat_h
 
 #include "hoptions.h"
+#include "hmemory.h"
 
 //  class for masking of matrix
 class mask_t
@@ -91,13 +103,13 @@ public:
   T *val;  
 
   //  constructors
-  matrix<T>() : val(0) {}
-  matrix<T>(const matrix<T>& mat) : val(0)  { *this=mat; }
-  matrix<T>(size_t m, size_t n, const T* t) : val(0) { allocate(m,n); copy(t); }
-  matrix<T>(size_t m, size_t n)             : val(0) { allocate(m,n);          }
-  matrix<T>(size_t m, size_t n, const T& t) : val(0) { allocate(m,n); std::fill(val,val+m*n,t); }
+  matrix<T>() : val(0), own(true) {}
+  matrix<T>(const matrix<T>& mat) : val(0), own(true)  { *this=mat; }
+  matrix<T>(size_t m, size_t n, const T* t) : val(0), own(true) { allocate(m,n); copy(t); }
+  matrix<T>(size_t m, size_t n)             : val(0), own(true) { allocate(m,n);          }
+  matrix<T>(size_t m, size_t n, const T& t) : val(0), own(true) { allocate(m,n); std::fill(val,val+m*n,t); }
   //  destructor
-  ~matrix<T>() { if (val) delete[] val; }
+  ~matrix<T>() { release(); }
   
   //  size of matrix
   size_t nrows() const { return mld; }
@@ -130,7 +142,17 @@ public:
   //  matrix size
   mask_t size() const { return mask_t(0,mld,0,nld); }
   //  clear vector
-  matrix<T>& clear() { if (val) delete[] val; val=0; return *this; }
+  matrix<T>& clear() { release(); val=0; return *this; }
+  //  exchange contents with other matrix without copying
+  void swap(matrix<T>& mat) 
+    { std::swap(mld,mat.mld); std::swap(nld,mat.nld); std::swap(val,mat.val); std::swap(own,mat.own);
+      std::swap(tag,mat.tag); }
+  
+  //  non-owning view of external memory, which must outlive the matrix,
+  //    views are never reallocated, assignment of a matrix detaches the view
+  matrix<T>& view(size_t m, size_t n, T* t) 
+    { release(); mld=m; nld=n; val=t; own=false; return *this; }
+  bool isview() const { return val && !own; }
   
   //  read matrix from file or write matrix to file
   static matrix<T> fread(FILE* fid);
@@ -138,11 +160,19 @@ public:
   //  convert Matlab array to C++ matrix
   #ifdef MEX
   static matrix<T> getmex(const mxArray* rhs);
+  //  view of Matlab array, copy if array must be converted
+  matrix<T>& mexview(const mxArray* rhs);
   #endif // MEX
   
 private:
-  //  allocate memory
+  //  memory allocated by matrix or view of external memory
+  bool own;
+  //  tag of allocation for memory accounting (hmemory.h)
+  unsigned char tag;
+  //  allocate and release memory
   void allocate(size_t m, size_t n);
+  void release() 
+    { if (val && own) { memstat.sub(mld*nld*sizeof(T),(memtag)tag);  delete[] val; }  own=true; }
   //  basic routines for matrix manipulation
   const matrix<T>& copy(const T* t) { std::copy(t,t+mld*nld,val); return *this; }
   const matrix<T>& add_to(const matrix<T>& mat, const T& a=(T)1);
@@ -150,14 +180,25 @@ private:
 };
 
 
-//  convert Matlab array to C++ matrix
+//  convert Matlab array to C++ matrix, complex arrays only for complex matrices (exception
+//    raised as Matlab error by mexcall, see hoptions.h)
 #ifdef MEX
 template<class T>
 matrix<T> matrix<T>::getmex(const mxArray* rhs)
 { 
-  return matrix<T>(mxGetM(rhs),mxGetN(rhs),(const T*)mxGetPr(rhs)); 
+  if (mxIsComplex(rhs)) throw std::invalid_argument("getmex: complex Matlab array for real matrix");
+  return matrix<T>(mxGetM(rhs),mxGetN(rhs),(const T*)mxGetData(rhs)); 
+}
+template<class T>
+matrix<T>& matrix<T>::mexview(const mxArray* rhs)
+{
+  if (mxIsComplex(rhs)) throw std::invalid_argument("mexview: complex Matlab array for real matrix");
+  return view(mxGetM(rhs),mxGetN(rhs),(T*)mxGetData(rhs));
 }
 template<> matrix<dcmplx> matrix<dcmplx>::getmex(const mxArray* rhs);
+template<> matrix<dcmplx>& matrix<dcmplx>::mexview(const mxArray* rhs);
+template<> matrix<fcmplx> matrix<fcmplx>::getmex(const mxArray* rhs);
+template<> matrix<fcmplx>& matrix<fcmplx>::mexview(const mxArray* rhs);
 #endif
 
 //  specializations for class functions
@@ -169,19 +210,31 @@ template<> const matrix<dcmplx>& matrix<dcmplx>::copy(const dcmplx* t);
 template<> const matrix<dcmplx>& matrix<dcmplx>::add_to(const matrix<dcmplx>& mat, const dcmplx& a);
 template<> const matrix<dcmplx>& matrix<dcmplx>::scale(const dcmplx& a);
 
+template<> const matrix<float>& matrix<float>::copy(const float* t);
+template<> const matrix<float>& matrix<float>::add_to(const matrix<float>& mat, const float& a);
+template<> const matrix<float>& matrix<float>::scale(const float& a);
+
+template<> const matrix<fcmplx>& matrix<fcmplx>::copy(const fcmplx* t);
+template<> const matrix<fcmplx>& matrix<fcmplx>::add_to(const matrix<fcmplx>& mat, const fcmplx& a);
+template<> const matrix<fcmplx>& matrix<fcmplx>::scale(const fcmplx& a);
+
 
 //  allocate memory (if needed)
 template<class T>
 void matrix<T>::allocate(size_t m, size_t n)
 {
   //  allocate memory ?
-  if (val && (mld!=m || nld!=n))
+  if (val && (mld!=m || nld!=n || !own))
   {
-    delete[] val;
-    val=new T[m*n];
+    release();
+    val=NULL;
   }
-  else if (val==NULL)
+  //  add allocation to memory accounting before allocation
+  if (val==NULL)
+  {
+    tag=(unsigned char)memstat.add(m*n*sizeof(T));
     val=new T[m*n];
+  }
     
   //  save matrix dimensions
   mld=m; nld=n;
@@ -193,11 +246,8 @@ const matrix<T>& matrix<T>::operator= (const matrix<T>& mat)
 {
   //  deal with empty matrices
   if (mat.val==NULL)
-  {
-    if (val) delete[] val;
-    val=NULL;
-  }
-  else
+    clear();
+  else if (mat.val!=val)
   {
     allocate(mat.mld,mat.nld);
     copy(mat.val);
@@ -206,6 +256,17 @@ const matrix<T>& matrix<T>::operator= (const matrix<T>& mat)
   return *this;
 }
 
+//  convert matrix to other precision
+template<class S, class T>
+matrix<S> recast(const matrix<T>& A)
+{
+  if (A.empty()) return matrix<S>();
+  matrix<S> B(A.nrows(),A.ncols());
+  for (size_t i=0; i<A.nrows()*A.ncols(); i++) B[i]=(S)A[i];
+  
+  return B;
+}
+
 //  transpose matrix
 template<class T>
 matrix<T> transpose(const matrix<T>& A)
@@ -291,6 +352,14 @@ template<>
 void add_mul(const matrix<dcmplx>& A, const mask_t& maskA, char transA,
              const matrix<dcmplx>& B, const mask_t& maskB, char transB,
                    matrix<dcmplx>& C, const mask_t& maskC);
+template<>
+void add_mul(const matrix<float>& A, const mask_t& maskA, char transA,
+             const matrix<float>& B, const mask_t& maskB, char transB,
+                   matrix<float>& C, const mask_t& maskC);
+template<>
+void add_mul(const matrix<fcmplx>& A, const mask_t& maskA, char transA,
+             const matrix<fcmplx>& B, const mask_t& maskB, char transB,
+                   matrix<fcmplx>& C, const mask_t& maskC);
 
 //  multiply matrices, C = op( A )*op( B ) 
 template<class T>
@@ -338,6 +407,8 @@ matrix<T> cat(const matrix<T>& A, const matrix<T>& B)
 //  specialization using BLAS
 template<> matrix<double> cat(const matrix<double>& A, const matrix<double>& B);
 template<> matrix<dcmplx> cat(const matrix<dcmplx>& A, const matrix<dcmplx>& B);
+template<> matrix<float>  cat(const matrix<float>&  A, const matrix<float>&  B);
+template<> matrix<fcmplx> cat(const matrix<fcmplx>& A, const matrix<fcmplx>& B);
 
 //  concatenate matrices
 template<class T>
@@ -399,6 +470,28 @@ matrix<dcmplx> inv(const matrix<dcmplx>&);
 //  copy C++ matrix into Matlab array (basemat.cpp)
 mxArray* setmex(const matrix<double>& mat);
 mxArray* setmex(const matrix<dcmplx>& mat);
+//  new Matlab array, mat is view of its memory such that results can be computed in place,
+//    setmex(mat,lhs) returns lhs if mat is still a view and copies mat otherwise
+mxArray* mexalloc(size_t m, size_t n, matrix<double>& mat);
+mxArray* mexalloc(size_t m, size_t n, matrix<dcmplx>& mat);
+mxArray* setmex(const matrix<double>& mat, mxArray* lhs);
+mxArray* setmex(const matrix<dcmplx>& mat, mxArray* lhs);
+
+//  new Matlab array initialized with values of rhs, mat is view of its memory
+template<class T>
+mxArray* mexalloc(const mxArray* rhs, matrix<T>& mat)
+{
+  matrix<T> a;
+  a.mexview(rhs);
+  mxArray* lhs=mexalloc(a.nrows(),a.ncols(),mat);
+  //  copy values, or take over converted array if mat cannot be view
+  if (mat.isview() || a.isview()) 
+    std::copy(a.begin(),a.end(),mat.begin());
+  else
+    mat.swap(a);
+  
+  return lhs;
+}
 #endif
 
 //  read matrix from file
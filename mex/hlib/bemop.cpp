@@ -0,0 +1,156 @@
+#include <vector>
+#include <algorithm>
+
+#include "bemop.h"
+#include "lu.h"
+
+//  dielectric function, scalar or for each face
+static inline dcmplx eps(const matrix<dcmplx>& e, size_t i)
+  { return (e.nrows()*e.ncols()==1) ? e[0] : e[i]; }
+
+//  multiply H-matrix with diagonal matrices from left and right, diag(d1)*A*diag(d2)
+static hmatrix<dcmplx> scale(const matrix<dcmplx>& d1, const hmatrix<dcmplx>& A, const matrix<dcmplx>& d2)
+{
+  hmatrix<dcmplx> B=A;
+  for (hmatrix<dcmplx>::iterator it=B.begin(); it!=B.end(); it++)
+  {
+    submatrix<dcmplx>& sub=it->second;
+    size_t r0=tree.size(sub.row).first, c0=tree.size(sub.col).first;
+    //  full matrix, or low-rank matrix lhs*rhs.'
+    if (sub.flag()==flagFull)
+      for (size_t j=0; j<sub.mat.ncols(); j++)
+      for (size_t i=0; i<sub.mat.nrows(); i++) sub.mat(i,j)*=d1[r0+i]*d2[c0+j];
+    else if (sub.flag()==flagRk)
+    {
+      for (size_t j=0; j<sub.lhs.ncols(); j++)
+      for (size_t i=0; i<sub.lhs.nrows(); i++) sub.lhs(i,j)*=d1[r0+i];
+      for (size_t j=0; j<sub.rhs.ncols(); j++)
+      for (size_t i=0; i<sub.rhs.nrows(); i++) sub.rhs(i,j)*=d2[c0+i];
+    }
+  }
+  return B;
+}
+
+//  products G1*x1, H1*x1, G2*x2, H2*x2 with single pass through blocks
+void bemretop::mul(const matrix<dcmplx>& x1, const matrix<dcmplx>& x2, matrix<dcmplx> y[4]) const
+{
+  const hmatrix<dcmplx>* A[4]={ G1, H1, G2, H2 };
+  const matrix<dcmplx>* x[4]={ &x1, &x1, &x2, &x2 };
+  //  cluster pairs of blocks, shared by all H-matrices
+  std::vector<pair_t> key;
+  for (hmatrix<dcmplx>::const_iterator it=G1->begin(); it!=G1->end(); it++) key.push_back(it->first);
+
+  for (int m=0; m<4; m++) y[m]=matrix<dcmplx>(x1.nrows(),x1.ncols(),(dcmplx)0);
+
+  #pragma omp parallel
+  {
+    //  products for blocks of thread
+    matrix<dcmplx> z[4];
+    for (int m=0; m<4; m++) z[m]=matrix<dcmplx>(x1.nrows(),x1.ncols(),(dcmplx)0);
+
+    #pragma omp for schedule(dynamic)
+    for (ptrdiff_t i=0; i<(ptrdiff_t)key.size(); i++)
+    for (int m=0; m<4; m++)
+    {
+      const submatrix<dcmplx>* sub=A[m]->find(key[i].first,key[i].second);
+      if (sub) add_mul(*sub,*x[m],z[m]);
+    }
+
+    #pragma omp critical(bemretop)
+    for (int m=0; m<4; m++) y[m]+=z[m];
+  }
+}
+
+//  apply BEM operator
+matrix<dcmplx> bemretop::operator() (const matrix<dcmplx>& x) const
+{
+  size_t n=x.nrows(), ns=x.ncols()/8;
+  //  potentials inside and outside of particle, [sig1,h1] and [sig2,h2]
+  matrix<dcmplx> x1(n,4*ns), x2(n,4*ns);
+  for (size_t j=0; j<ns; j++)
+  for (size_t l=0; l<4; l++)
+  {
+    std::copy(&x(0,8*j+l),  &x(0,8*j+l)+n,  &x1(0,4*j+l));
+    std::copy(&x(0,8*j+4+l),&x(0,8*j+4+l)+n,&x2(0,4*j+l));
+  }
+  //  multiplication with Green functions and surface derivatives
+  matrix<dcmplx> y[4];
+  mul(x1,x2,y);
+  const matrix<dcmplx> &G1x=y[0], &H1x=y[1], &G2x=y[2], &H2x=y[3];
+
+  matrix<dcmplx> b(n,8*ns);
+  const dcmplx ik=dcmplx(0,k);
+
+  for (size_t j=0; j<ns; j++)
+  for (size_t i=0; i<n; i++)
+  {
+    dcmplx e1=eps(eps1,i), e2=eps(eps2,i);
+    //  Eq. (10)
+    b(i,8*j)=G1x(i,4*j)-G2x(i,4*j);
+    //  Eq. (17), surface charge terms
+    dcmplx De=e1*H1x(i,4*j)-e2*H2x(i,4*j), s=e1*G1x(i,4*j)-e2*G2x(i,4*j);
+
+    for (size_t d=0; d<3; d++)
+    {
+      dcmplx Gh1=G1x(i,4*j+1+d), Gh2=G2x(i,4*j+1+d);
+      //  Eq. (11)
+      b(i,8*j+1+d)=Gh1-Gh2;
+      //  Eq. (14)
+      b(i,8*j+5+d)=H1x(i,4*j+1+d)-H2x(i,4*j+1+d)-ik*nvec(i,d)*s;
+      //  Eq. (17), surface current terms
+      De-=ik*nvec(i,d)*(e1*Gh1-e2*Gh2);
+    }
+    b(i,8*j+4)=De;
+  }
+
+  return b;
+}
+
+//  compute preconditioner, Eqs. (19-22)
+void bemretop::precond(bemretprec& P) const
+{
+  size_t n=nvec.nrows();
+  hmatrix<dcmplx> Sigma2;
+
+  //  inverse Green functions, inside and outside decompositions are independent
+  #pragma omp parallel sections
+  {
+    #pragma omp section
+    lu(*G1,P.G1i);
+    #pragma omp section
+    lu(*G2,P.G2i);
+  }
+
+  //  Sigma matrices, Sigma = H*inv(G), Eq. (21)
+  #pragma omp parallel sections
+  {
+    #pragma omp section
+    {
+      rsolve(*H1,P.G1i,P.Sigma1,0,0,'U');
+      rsolve(P.Sigma1,P.G1i,P.Sigma1,0,0,'L');
+    }
+    #pragma omp section
+    {
+      rsolve(*H2,P.G2i,Sigma2,0,0,'U');
+      rsolve(Sigma2,P.G2i,Sigma2,0,0,'L');
+    }
+  }
+
+  //  inverse Delta matrix
+  P.Deltai=inv(P.Sigma1-Sigma2);
+
+  //  dielectric functions, wavenumber times difference times normal vectors
+  matrix<dcmplx> e1(n,1), e2(n,1), one(n,1,(dcmplx)1), dn[3];
+  for (size_t d=0; d<3; d++) dn[d]=matrix<dcmplx>(n,1);
+  for (size_t i=0; i<n; i++)
+  {
+    e1[i]=eps(eps1,i);  e2[i]=eps(eps2,i);
+    for (size_t d=0; d<3; d++) dn[d][i]=k*(e1[i]-e2[i])*nvec(i,d);
+  }
+  //  Sigma matrix, Eq. (21)
+  hmatrix<dcmplx> Sigma=scale(e1,P.Sigma1,one)-scale(e2,Sigma2,one);
+  for (size_t d=0; d<3; d++) Sigma+=scale(dn[d],P.Deltai,dn[d]);
+
+  //  LU decomposition of Sigma matrix, Eq. (22)
+  lu(Sigma,P.Sigmai);
+}
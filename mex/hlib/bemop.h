@@ -0,0 +1,68 @@
+//  bemop.h - Operators of the retarded BEM equations built from H-matrices.
+//
+//  The BEM equations of Garcia de Abajo and Howie, PRB 65, 115418 (2002), couple the
+//  surface charges and currents inside (sig1,h1) and outside (sig2,h2) of the particle
+//  through the Green functions G1, G2 and their surface derivatives H1, H2.  bemretop
+//  applies the operator of Eqs. (10,11,14,17) with a single pass through the blocks of
+//  the four H-matrices, which share the same cluster tree, and combines the products with
+//  the dielectric functions and the outer surface normals row by row.
+//
+//  Vectors are matrices with n rows (cluster ordering) and 8 columns per excitation,
+//    input   sig1, h1 (x,y,z), sig2, h2 (x,y,z)
+//    output  phi,  a  (x,y,z), De,   alpha (x,y,z)
+//
+//  The preconditioner of Eqs. (19-22) is computed without leaving C++, the LU
+//  decompositions of G1 and G2 and the Sigma matrices of both media are computed in
+//  parallel.  Tolerance and maximal rank of low-rank matrices are taken from hopts.
+
+/* bemretop op(G1,G2,H1,H2);          //  set Green functions and surface derivatives
+ * op.k=k;  op.nvec=nvec;             //  wavenumber of light in vacuum, outer surface normals
+ * op.eps1=eps1;  op.eps2=eps2;       //  dielectric functions (scalar or for each face)
+ * y=op(x);                           //  apply BEM operator, see krylov.h
+ * op.precond(P);                     //  preconditioner matrices
+ */
+
+#include <vector>
+
+#ifndef bemop_h
+#define bemop_h
+
+#include "hoptions.h"
+#include "basemat.h"
+#include "clustertree.h"
+#include "hmatrix.h"
+
+//  matrices of preconditioner, Eqs. (19-22)
+struct bemretprec
+{
+  //  LU decompositions of G1 and G2, Sigma1 = H1*inv(G1), inv(Sigma1-Sigma2),
+  //    LU decomposition of Sigma matrix
+  hmatrix<dcmplx> G1i, G2i, Sigma1, Deltai, Sigmai;
+};
+
+class bemretop
+{
+public:
+  //  Green functions and surface derivatives inside and outside of particle
+  const hmatrix<dcmplx> *G1, *G2, *H1, *H2;
+  //  outer surface normals (n,3), dielectric functions inside and outside
+  matrix<double> nvec;
+  matrix<dcmplx> eps1, eps2;
+  //  wavenumber of light in vacuum
+  double k;
+
+  bemretop(const hmatrix<dcmplx>& g1, const hmatrix<dcmplx>& g2,
+           const hmatrix<dcmplx>& h1, const hmatrix<dcmplx>& h2)
+    : G1(&g1), G2(&g2), H1(&h1), H2(&h2), k(0) {}
+
+  //  apply BEM operator
+  matrix<dcmplx> operator() (const matrix<dcmplx>& x) const;
+  //  compute preconditioner
+  void precond(bemretprec& P) const;
+
+private:
+  //  products G1*x1, H1*x1, G2*x2, H2*x2 with single pass through blocks
+  void mul(const matrix<dcmplx>& x1, const matrix<dcmplx>& x2, matrix<dcmplx> y[4]) const;
+};
+
+#endif  //  bemop_h
@@ -0,0 +1,161 @@
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "clustertree.h"
+
+//  cluster during construction of tree
+struct cluster
+{
+  size_t son1, son2, begin, end;
+  double mid[3], rad;
+};
+
+//  new cluster with indices (begin,end) and bounding sphere of positions
+static cluster newcluster(const matrix<double>& pos, const std::vector<size_t>& ix,
+                          size_t begin, size_t end)
+{
+  cluster c;
+  c.son1=0;  c.son2=0;  c.begin=begin;  c.end=end;
+  //  bounding box
+  double lo[3], hi[3], s=0;
+  for (size_t k=0; k<3; k++)
+  {
+    lo[k]=hi[k]=pos(ix[0],k);
+    for (size_t i=1; i<ix.size(); i++)
+      { lo[k]=std::min(lo[k],pos(ix[i],k));  hi[k]=std::max(hi[k],pos(ix[i],k)); }
+  }
+  //  center position and radius
+  for (size_t k=0; k<3; k++) { c.mid[k]=0.5*(lo[k]+hi[k]);  s+=(hi[k]-lo[k])*(hi[k]-lo[k]); }
+  c.rad=0.5*std::sqrt(s);
+
+  return c;
+}
+
+//  split cluster into different particles, returns false for single particle
+static bool partsplit(const matrix<size_t>& ip, const std::vector<size_t>& ix,
+                      std::vector<size_t>& ix1, std::vector<size_t>& ix2)
+{
+  for (size_t i=0; i<ix.size(); i++)
+    (ip[ix[i]]==ip[ix[0]] ? ix1 : ix2).push_back(ix[i]);
+  if (!ix2.empty()) return true;
+
+  ix1.clear();
+  return false;
+}
+
+//  split cluster by bisection of bounding box along longest side
+static void bisplit(const matrix<double>& pos, const std::vector<size_t>& ix,
+                    std::vector<size_t>& ix1, std::vector<size_t>& ix2)
+{
+  double lo[3], hi[3];
+  for (size_t k=0; k<3; k++)
+  {
+    lo[k]=hi[k]=pos(ix[0],k);
+    for (size_t i=1; i<ix.size(); i++)
+      { lo[k]=std::min(lo[k],pos(ix[i],k));  hi[k]=std::max(hi[k],pos(ix[i],k)); }
+  }
+  //  split direction and position
+  size_t k=0;
+  for (size_t j=1; j<3; j++) if (hi[j]-lo[j]>hi[k]-lo[k]) k=j;
+  double mid=lo[k]+0.5*(hi[k]-lo[k]);
+
+  for (size_t i=0; i<ix.size(); i++) (pos(ix[i],k)<mid ? ix1 : ix2).push_back(ix[i]);
+  //  coincident positions, split index list
+  if (ix1.empty())
+  {
+    ix1.assign(ix.begin(),ix.begin()+ix.size()/2);
+    ix2.assign(ix.begin()+ix.size()/2,ix.end());
+  }
+}
+
+//  split cluster ic with positions ix, see @clustertree/private/bisection.m
+static void bisection(const matrix<double>& pos, const matrix<size_t>& ip, size_t cleaf,
+                      std::vector<cluster>& tree, std::vector<size_t>& perm,
+                      size_t ic, std::vector<size_t>& ix)
+{
+  std::vector<size_t> ix1, ix2;
+  //  try particle split, bisection split otherwise
+  bool psplit=partsplit(ip,ix,ix1,ix2);
+  if (!psplit) bisplit(pos,ix,ix1,ix2);
+  //  positions are passed on to sons
+  std::vector<size_t>().swap(ix);
+
+  //  add sons to parent cluster
+  size_t siz=tree.size(), c0=tree[ic].begin, c1=c0+ix1.size();
+  tree[ic].son1=siz;
+  tree[ic].son2=siz+1;
+  tree.push_back(newcluster(pos,ix1,c0,c1));
+  tree.push_back(newcluster(pos,ix2,c1,tree[ic].end));
+
+  //  further splitting of clusters ?
+  if ((ix1.size()>cleaf || psplit) && ix1.size()>1)
+    bisection(pos,ip,cleaf,tree,perm,siz,ix1);
+  else
+    std::copy(ix1.begin(),ix1.end(),perm.begin()+c0);
+  if ((ix2.size()>cleaf || psplit) && ix2.size()>1)
+    bisection(pos,ip,cleaf,tree,perm,siz+1,ix2);
+  else
+    std::copy(ix2.begin(),ix2.end(),perm.begin()+c1);
+}
+
+//  build cluster tree through bisection, see @clustertree/private/init.m
+void treebuilder::build(const matrix<double>& pos, const matrix<size_t>& ip, size_t cleaf)
+{
+  size_t n=pos.empty() ? 0 : pos.nrows();
+  if (!n) { sons.clear();  ind.clear();  ipart.clear();  perm.clear();  mid.clear();  rad.clear();  return; }
+  std::vector<size_t> ix(n), p(n);
+  for (size_t i=0; i<n; i++) ix[i]=i;
+
+  tic;
+  //  root cluster is always split
+  std::vector<cluster> tree(1,newcluster(pos,ix,0,n));
+  if (n>1)
+    bisection(pos,ip,cleaf,tree,p,0,ix);
+  else
+    p[0]=0;
+  toc("bisection");
+
+  //  extract information from tree
+  size_t nc=tree.size();
+  sons=matrix<size_t>(nc,2);  ind=matrix<size_t>(nc,2);  ipart=matrix<size_t>(nc,1);
+  mid=matrix<double>(nc,3);   rad=matrix<double>(nc,1);
+  perm=matrix<size_t>(n,1,&p[0]);
+  for (size_t i=0; i<nc; i++)
+  {
+    const cluster& c=tree[i];
+    sons(i,0)=c.son1;  sons(i,1)=c.son2;
+    ind (i,0)=c.begin;  ind(i,1)=c.end;
+    for (size_t k=0; k<3; k++) mid(i,k)=c.mid[k];
+    rad[i]=c.rad;
+    //  particle index of first and last position, zero for composite clusters
+    size_t ip1=ip[p[c.begin]], ip2=ip[p[c.end-1]];
+    ipart[i]=(ip1==ip2) ? ip1 : 0;
+  }
+}
+
+//  convert list of (col,row) pairs to index matrix, sorted by columns and rows
+matrix<size_t> treebuilder::index(std::vector<pair_t>& pairs)
+{
+  std::sort(pairs.begin(),pairs.end());
+  if (pairs.empty()) return matrix<size_t>();
+
+  matrix<size_t> ind(pairs.size(),2);
+  for (size_t i=0; i<pairs.size(); i++)
+    { ind(i,0)=pairs[i].second;  ind(i,1)=pairs[i].first; }
+  return ind;
+}
+
+//  set cluster tree and admissibility for full and low-rank matrices
+void treebuilder::set(clustertree& tree, const matrix<size_t>& ind1, const matrix<size_t>& ind2,
+                      const treebuilder* t2) const
+{
+  tree.clear();
+  tree.sons=sons;  tree.ind=ind;  tree.ipart=ipart;
+  if (t2) { tree.csons=t2->sons;  tree.cind=t2->ind;  tree.cipart=t2->ipart; }
+
+  if (!ind1.empty())
+    for (size_t i=0; i<ind1.nrows(); i++) tree.ad[pair_t(ind1(i,0),ind1(i,1))]=flagFull;
+  if (!ind2.empty())
+    for (size_t i=0; i<ind2.nrows(); i++) tree.ad[pair_t(ind2(i,0),ind2(i,1))]=flagRk;
+}
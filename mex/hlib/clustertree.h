@@ -9,6 +9,7 @@
 #include <utility>
 #include <fstream>
 #include <cstdlib>
+#include <cmath>
 
 #ifndef clustertree_h
 #define clustertree_h
@@ -105,11 +106,16 @@ public:
  * tree.sons;                     //  list of cluster sons
  * tree.ind;                      //  row or column indices (ibegin,iend) for clusters
  * tree.ipart;                    //  particle index (only used for Green functions)
+ * tree.csons, tree.cind, ...     //  column tree for rectangular matrices (empty otherwise)
  * 
  * tree.size(i);                  //  size of cluster i
  * tree.size(i,j);                //  size of sub-cluster i wrt size of parent cluster j
+ * tree.csize(i), tree.csize(i,j) //  same for column tree (row tree for square matrices)
  * tree.leaf(i);                  //  determine whether cluster i is leaf
+ * tree.rect();                   //  separate row and column trees ?
+ * tree.lower(i,j);               //  cluster pair in lower block tree (symmetric storage) ?
  * tree.clear();                  //  clear object
+ * tree.swap(tree2);              //  exchange contents with other tree
  * tree.name(i,j);                //  "full" for full matrices and "Rk" for low-rank matrices
  * tree.flag(i,j);                //  flagFull or flagRk
  * tree.admiss(i,j);              //  flagFull, flagRk for full and low-rank matrices, 0 else
@@ -120,16 +126,23 @@ public:
   typedef treeiterator iterator;
   //  sons and cluster indices, particle indices
   matrix<size_t> sons, ind, ipart; 
+  //  column tree for rectangular matrices, e.g. evaluation points vs. boundary elements,
+  //    empty for square matrices where the row tree is used for columns as well
+  matrix<size_t> csons, cind, cipart;
   //  admissibility of cluster pairs, to be set in hmatrix
   //  flagRk for cluster pairs admissible to low-rank approximation, flagFull for full matrices, 0 else
   std::map<pair_t,short> ad;  
   
   //  assignement operator
   const clustertree& operator= (const clustertree& tree)
-    { sons=tree.sons; ind=tree.ind; ipart=tree.ipart; ad=tree.ad; return *this; }
+    { sons=tree.sons; ind=tree.ind; ipart=tree.ipart; 
+      csons=tree.csons; cind=tree.cind; cipart=tree.cipart; ad=tree.ad; return *this; }
   //  iterator for loop over sons
   iterator begin(size_t ic=0) const 
     { return leaf(ic) ? iterator(ic) : iterator(sons(ic,0),sons(ic,1)); }
+  iterator cbegin(size_t ic=0) const 
+    { if (!rect()) return begin(ic);
+      return cleaf(ic) ? iterator(ic) : iterator(csons(ic,0),csons(ic,1)); }
   iterator end() const { return iterator(); }
   //  iterator for loop over clusters
   pairiterator pair_begin(size_t r=0, size_t c=0) const
@@ -139,10 +152,29 @@ public:
   //  size of cluster (wrt second cluster)
   pair_t size(size_t i) const { return pair_t(ind(i,0),ind(i,1)); }
   pair_t size(size_t i, size_t j) const { return pair_t(ind(i,0)-ind(j,0),ind(i,1)-ind(j,0)); }
+  //  size of column cluster (wrt second cluster)
+  pair_t csize(size_t i) const 
+    { return rect() ? pair_t(cind(i,0),cind(i,1)) : size(i); }
+  pair_t csize(size_t i, size_t j) const 
+    { return rect() ? pair_t(cind(i,0)-cind(j,0),cind(i,1)-cind(j,0)) : size(i,j); }
+  //  particle index of column cluster
+  size_t cpart(size_t i) const { return rect() ? cipart[i] : ipart[i]; }
   //  determine whether cluster is leaf
-  bool leaf(size_t ic) const { return sons(ic,0)==0 && sons(ic,1)==0; }
+  bool  leaf(size_t ic) const { return  sons(ic,0)==0 &&  sons(ic,1)==0; }
+  bool cleaf(size_t ic) const { return rect() ? csons(ic,0)==0 && csons(ic,1)==0 : leaf(ic); }
+  //  separate row and column trees ?
+  bool rect() const { return !csons.empty(); }
+  //  cluster pair in lower block tree ?  cluster pairs of the block tree are either
+  //    diagonal or have disjoint row and column indices
+  bool lower(size_t i, size_t j) const { return ind(i,0)>=ind(j,0); }
+  //  exchange contents with other tree without copying
+  void swap(clustertree& tree)
+    { sons.swap(tree.sons); ind.swap(tree.ind); ipart.swap(tree.ipart);
+      csons.swap(tree.csons); cind.swap(tree.cind); cipart.swap(tree.cipart); ad.swap(tree.ad); }
   //  clear cluster tree
-  clustertree& clear() { sons.clear(); ind.clear(); ad.clear(); return *this; }
+  clustertree& clear() 
+    { sons.clear(); ind.clear(); ipart.clear(); 
+      csons.clear(); cind.clear(); cipart.clear(); ad.clear(); return *this; }
   
   //  admissibility of cluster pairs (no further subdivision)
   short admiss(size_t row, size_t col) const
@@ -168,11 +200,21 @@ public:
   //  get cluster tree from MEX function
   void getmex(const mxArray* prhs, matrix<size_t>& ind1, matrix<size_t>& ind2)
     {
+      //  column tree and admissibility of previous block tree
+      clear();
       sons =matrix<size_t>::getmex(mxGetField(prhs,0,"sons"  )); 
       ind  =matrix<size_t>::getmex(mxGetField(prhs,0,"ind"   ));
       ipart=matrix<size_t>::getmex(mxGetField(prhs,0,"ipart" ));
       //  second index entry should be post elememt
       for (size_t i=0; i<ind.nrows(); i++) ind(i,1)++; 
+      //  column tree for rectangular matrices
+      if (mxGetField(prhs,0,"csons"))
+      {
+        csons =matrix<size_t>::getmex(mxGetField(prhs,0,"csons" )); 
+        cind  =matrix<size_t>::getmex(mxGetField(prhs,0,"cind"  ));
+        cipart=matrix<size_t>::getmex(mxGetField(prhs,0,"cipart"));
+        for (size_t i=0; i<cind.nrows(); i++) cind(i,1)++;
+      }
       
       //  indices to full and low-rank matrices
       ind1=matrix<size_t>::getmex(mxGetField(prhs,0,"ind1"));
@@ -189,12 +231,116 @@ private:
     if (admiss(r,c))
       ind.push_back(pair_t(r,c));
     else
-      for (iterator row=begin(r); row!=end(); row++)
-      for (iterator col=begin(c); col!=end(); col++)
+      for (iterator row= begin(r); row!=end(); row++)
+      for (iterator col=cbegin(c); col!=end(); col++)
         tree_loop(*row,*col,ind);
   }
 };
 
+//  admissibility conditions for cluster pairs with bounding spheres of radii rad1, rad2
+//    and distance dist between midpoints, admiss_min is the default of admissibility.m
+struct admiss_min
+{
+  double eta;
+  admiss_min(double e=2.5) : eta(e) {}
+  bool operator() (double rad1, double rad2, double dist) const
+    { return eta*std::min(rad1,rad2)<dist; }
+};
+//  stronger condition using the larger cluster
+struct admiss_max
+{
+  double eta;
+  admiss_max(double e=2.5) : eta(e) {}
+  bool operator() (double rad1, double rad2, double dist) const
+    { return eta*std::max(rad1,rad2)<dist; }
+};
+
+/* treebuilder t;
+ * t.build(pos,ip,cleaf);         //  cluster tree through bisection of positions (n x 3),
+ *                                //    ip particle index of positions (starting with 1)
+ * t.sons, t.ind, t.ipart;        //  same as for clustertree
+ * t.mid, t.rad;                  //  midpoints and radii of bounding spheres
+ * t.perm;                        //  position index for cluster index
+ * t.blocktree(t2,fadmiss,ind1,ind2); //  indices to full and low-rank matrices for
+ *                                //    row tree t and column tree t2
+ * t.set(tree,ind1,ind2,[&t2]);   //  set cluster tree and admissibility
+ *
+ * Same trees as @clustertree/clustertree.m and @clustertree/admissibility.m:  clusters
+ * of composite particles are first split into particles, otherwise the bounding box is
+ * bisected along its longest side, clusters with at most cleaf positions are leaves.
+ * Cluster pairs of composite clusters are never low-rank.
+ */
+class treebuilder
+{
+public:
+  //  sons and cluster indices, particle indices (0 for composite clusters)
+  matrix<size_t> sons, ind, ipart;
+  //  position index for cluster index
+  matrix<size_t> perm;
+  //  midpoints and radii of bounding spheres
+  matrix<double> mid, rad;
+
+  //  build cluster tree through bisection
+  void build(const matrix<double>& pos, const matrix<size_t>& ip, size_t cleaf=32);
+  //  block tree with indices to full and low-rank matrices, sorted as find in Matlab
+  template<class F>
+  void blocktree(const treebuilder& t2, const F& fadmiss,
+                 matrix<size_t>& ind1, matrix<size_t>& ind2) const;
+  //  set cluster tree, column tree t2 for rectangular matrices
+  void set(clustertree& tree, const matrix<size_t>& ind1, const matrix<size_t>& ind2,
+           const treebuilder* t2=0) const;
+
+  //  determine whether cluster is leaf
+  bool leaf(size_t ic) const { return sons(ic,0)==0 && sons(ic,1)==0; }
+  //  distance between midpoints of clusters
+  double dist(size_t i1, const treebuilder& t2, size_t i2) const
+    { double s=0;
+      for (size_t k=0; k<3; k++) s+=(mid(i1,k)-t2.mid(i2,k))*(mid(i1,k)-t2.mid(i2,k));
+      return std::sqrt(s); }
+
+private:
+  //  recursive construction of block tree, cluster pairs stored as (col,row)
+  template<class F>
+  void blocktree(const treebuilder& t2, const F& fadmiss, size_t i1, size_t i2,
+                 std::vector<pair_t>& full, std::vector<pair_t>& rk) const;
+  //  convert list of (col,row) pairs to sorted index matrix
+  static matrix<size_t> index(std::vector<pair_t>& pairs);
+};
+
+
+//  block tree with indices to full and low-rank matrices
+template<class F>
+void treebuilder::blocktree(const treebuilder& t2, const F& fadmiss,
+                            matrix<size_t>& ind1, matrix<size_t>& ind2) const
+{
+  std::vector<pair_t> full, rk;
+
+  tic;
+  blocktree(t2,fadmiss,0,0,full,rk);
+  ind1=index(full);
+  ind2=index(rk);
+  toc("blocktree");
+}
+
+//  recursive construction of block tree, see admissibility.m
+template<class F>
+void treebuilder::blocktree(const treebuilder& t2, const F& fadmiss, size_t i1, size_t i2,
+                            std::vector<pair_t>& full, std::vector<pair_t>& rk) const
+{
+  if (leaf(i1) && t2.leaf(i2))
+    full.push_back(pair_t(i2,i1));
+  else if (ipart[i1] && t2.ipart[i2] && fadmiss(rad[i1],t2.rad[i2],dist(i1,t2,i2)))
+    rk.push_back(pair_t(i2,i1));
+  else
+  {
+    //  loop over sons, leaves are paired with sons of other cluster
+    size_t n1=leaf(i1) ? 1 : 2, n2=t2.leaf(i2) ? 1 : 2;
+    for (size_t r=0; r<n1; r++)
+    for (size_t c=0; c<n2; c++)
+      blocktree(t2,fadmiss,leaf(i1) ? i1 : sons(i1,r),t2.leaf(i2) ? i2 : t2.sons(i2,c),full,rk);
+  }
+}
+
 //  one tree accessible for everyone
 extern clustertree tree;
 //  index to full and low-rank matrices
@@ -0,0 +1,234 @@
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdio>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "hfile.h"
+
+//  identifier and version of H-matrix files
+static const char magic[8]={'M','N','P','B','E','M','H','M'};
+static const size_t version=1;
+
+//  file header
+struct header
+{
+  char magic[8];
+  size_t version, type, islu;
+  double htol;
+  size_t kmax, nblock;
+  //  offsets of tree, index and data, checksum of tree and index
+  size_t tree, index, data, sum;
+};
+
+//  append bytes to buffer, pad buffer to aligned size
+static void append(std::vector<char>& buf, const void* val, size_t bytes)
+  { buf.insert(buf.end(),(const char*)val,(const char*)val+bytes); }
+static void pad(std::vector<char>& buf)
+  { buf.resize((buf.size()+63)/64*64,0); }
+
+//  append matrix as number of rows and columns followed by values at aligned offset
+template<class T>
+static void append(std::vector<char>& buf, const matrix<T>& mat)
+{
+  size_t siz[2]={ mat.empty() ? 0 : mat.nrows(), mat.empty() ? 0 : mat.ncols() };
+  append(buf,siz,sizeof(siz));
+  pad(buf);
+  append(buf,mat.begin(),siz[0]*siz[1]*sizeof(T));
+  pad(buf);
+}
+
+//  copy matrix at position pos of mapped file, returns position of next matrix
+template<class T>
+static size_t extract(const char* buf, size_t len, size_t pos, matrix<T>& mat)
+{
+  if (pos>len || 2*sizeof(size_t)>len-pos) return len+1;
+  size_t m=((const size_t*)(buf+pos))[0], n=((const size_t*)(buf+pos))[1];
+  pos=(pos+2*sizeof(size_t)+63)/64*64;
+  //  sizes of corrupt header must not overflow
+  if (pos>len || (n!=0 && m>(len-pos)/sizeof(T)/n)) return len+1;
+
+  if (m!=0 && n!=0) mat=matrix<T>(m,n,(const T*)(buf+pos)); else mat.clear();
+  return (pos+m*n*sizeof(T)+63)/64*64;
+}
+
+
+//  checksum of memory (FNV-1a)
+size_t hfile::checksum(const void* val, size_t bytes, size_t h)
+{
+  const unsigned char* p=(const unsigned char*)val;
+  for (size_t i=0; i<bytes; i++) h=(h^p[i])*1099511628211ULL;
+  return h;
+}
+
+//  write array at aligned offset
+bool hfile::writedata(FILE* fid, const void* val, size_t bytes)
+{
+  static const char zero[64]={0};
+  return std::fwrite(val,1,bytes,fid)==bytes &&
+         std::fwrite(zero,1,aligned(bytes)-bytes,fid)==aligned(bytes)-bytes;
+}
+
+//  write header, tree and index, set offsets of blocks
+bool hfile::writehead(FILE* fid, size_t type, const hfileinfo& info, std::vector<hblock>& index)
+{
+  header h;
+  memcpy(h.magic,magic,8);
+  h.version=version;  h.type=type;  h.islu=info.islu;  h.htol=info.htol;  h.kmax=info.kmax;
+  h.nblock=index.size();
+
+  //  cluster tree and index lists
+  std::vector<char> buf(sizeof(header));
+  pad(buf);
+  h.tree=buf.size();
+  append(buf,tree.sons);   append(buf,tree.ind);   append(buf,tree.ipart);
+  append(buf,tree.csons);  append(buf,tree.cind);  append(buf,tree.cipart);
+  append(buf,ind1);  append(buf,ind2);  append(buf,info.area);
+  //  block index, offsets of blocks
+  h.index=buf.size();
+  size_t pos=(h.index+index.size()*sizeof(hblock)+63)/64*64;
+  h.data=pos;
+  for (size_t i=0; i<index.size(); i++)
+  {
+    hblock& b=index[i];
+    size_t siz=(b.flag==flagFull) ? b.m*b.n : b.m*b.k;
+    size_t bytes=siz*(type==1 ? sizeof(double) : sizeof(dcmplx));
+    b.offset=pos;
+    pos+=aligned(bytes);
+    if (b.flag==flagRk) pos+=aligned(b.n*b.k*(type==1 ? sizeof(double) : sizeof(dcmplx)));
+  }
+  if (!index.empty()) append(buf,&index[0],index.size()*sizeof(hblock));
+  pad(buf);
+  //  checksum of tree and index
+  h.sum=checksum(&buf[h.tree],buf.size()-h.tree);
+  memcpy(&buf[0],&h,sizeof(header));
+
+  return std::fwrite(&buf[0],1,buf.size(),fid)==buf.size();
+}
+
+
+//  map file into memory and read header
+bool hfile::open(const std::string& file)
+{
+  close();
+  #ifdef _WIN32
+  //  no memory mapping, read file into memory
+  FILE* fid=fopen(file.c_str(),"rb");
+  if (!fid) return false;
+  fseek(fid,0,SEEK_END);
+  len=ftell(fid);
+  fseek(fid,0,SEEK_SET);
+  buf=new char[len];
+  bool ok=std::fread(buf,1,len,fid)==len;
+  fclose(fid);
+  if (!ok) { close();  return false; }
+  #else
+  //  map file into memory, pages are shared between processes
+  int fd=::open(file.c_str(),O_RDONLY);
+  struct stat st;
+  if (fd<0) return false;
+  if (fstat(fd,&st) || (size_t)st.st_size<sizeof(header)) { ::close(fd);  return false; }
+  len=st.st_size;
+  void* p=mmap(0,len,PROT_READ,MAP_SHARED,fd,0);
+  ::close(fd);
+  if (p==MAP_FAILED) { len=0;  return false; }
+  buf=(char*)p;
+  #endif
+
+  //  check header and checksum of tree and index
+  header h;
+  memcpy(&h,buf,sizeof(header));
+  bool ok=!memcmp(h.magic,magic,8) && h.version==version && (h.type==1 || h.type==2) &&
+          h.tree<=h.index && h.index<=h.data && h.data<=len &&
+          h.nblock<=(h.data-h.index)/sizeof(hblock) &&
+          checksum(buf+h.tree,h.data-h.tree)==h.sum;
+  if (!ok) { close();  return false; }
+
+  //  options and areas
+  type=h.type;  tpos=h.tree;
+  info.islu=h.islu!=0;  info.htol=h.htol;  info.kmax=h.kmax;
+  matrix<size_t> tmp;
+  size_t pos=h.tree;
+  for (int i=0; i<8; i++) pos=extract(buf,h.index,pos,tmp);
+  pos=extract(buf,h.index,pos,info.area);
+  //  block index
+  index.resize(h.nblock);
+  if (h.nblock) memcpy(&index[0],buf+h.index,h.nblock*sizeof(hblock));
+  for (size_t i=0; ok && i<index.size(); i++)
+  {
+    const hblock& b=index[i];
+    ok=(b.flag==flagFull || b.flag==flagRk) && b.offset>=h.data && b.offset+bytes(i)<=len;
+  }
+  if (!ok || pos>h.index) { close();  return false; }
+
+  return true;
+}
+
+//  unmap file
+void hfile::close()
+{
+  if (buf)
+  #ifdef _WIN32
+    delete[] buf;
+  #else
+    munmap(buf,len);
+  #endif
+  buf=0;  len=0;  type=0;
+  index.clear();
+  info=hfileinfo();
+}
+
+//  copy cluster tree and index lists, set admissibility
+void hfile::gettree(clustertree& tree, matrix<size_t>& ind1, matrix<size_t>& ind2) const
+{
+  tree.clear();
+  size_t pos=tpos;
+  pos=extract(buf,len,pos,tree.sons);   pos=extract(buf,len,pos,tree.ind);
+  pos=extract(buf,len,pos,tree.ipart);  pos=extract(buf,len,pos,tree.csons);
+  pos=extract(buf,len,pos,tree.cind);   pos=extract(buf,len,pos,tree.cipart);
+  pos=extract(buf,len,pos,ind1);        pos=extract(buf,len,pos,ind2);
+  //  set admissibility for full and low-rank matrices
+  if (!ind1.empty())
+    for (size_t i=0; i<ind1.nrows(); i++) tree.ad[pair_t(ind1(i,0),ind1(i,1))]=flagFull;
+  if (!ind2.empty())
+    for (size_t i=0; i<ind2.nrows(); i++) tree.ad[pair_t(ind2(i,0),ind2(i,1))]=flagRk;
+}
+
+//  compare checksums of blocks
+bool hfile::verify() const
+{
+  size_t siz=(type==1) ? sizeof(double) : sizeof(dcmplx);
+  for (size_t i=0; i<index.size(); i++)
+  {
+    const hblock& b=index[i];
+    size_t sum=(b.flag==flagFull) ? checksum(buf+b.offset,b.m*b.n*siz) :
+      checksum(buf+b.offset+aligned(b.m*b.k*siz),b.n*b.k*siz,checksum(buf+b.offset,b.m*b.k*siz));
+    if (sum!=b.sum) return false;
+  }
+  return true;
+}
+
+//  size of block in file
+size_t hfile::bytes(size_t i) const
+{
+  const hblock& b=index[i];
+  size_t siz=(type==1) ? sizeof(double) : sizeof(dcmplx);
+  return (b.flag==flagFull) ? aligned(b.m*b.n*siz) : aligned(b.m*b.k*siz)+aligned(b.n*b.k*siz);
+}
+
+//  prefetch or release mapped pages of block
+void hfile::advise(size_t i, bool need) const
+{
+  #ifndef _WIN32
+  //  pages containing block
+  size_t page=sysconf(_SC_PAGESIZE);
+  size_t begin=index[i].offset/page*page, end=index[i].offset+bytes(i);
+  madvise(buf+begin,end-begin,need ? MADV_WILLNEED : MADV_DONTNEED);
+  #endif
+}
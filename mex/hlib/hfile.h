@@ -0,0 +1,189 @@
+//  hfile.h - Versioned binary file format for cluster trees and H-matrices.
+//
+//  An H-matrix is stored together with its cluster tree and options, such that e.g. the
+//  LU decomposition of a preconditioner can be computed once and reloaded by later runs.
+//  The file is memory-mapped when opened, only the header, the cluster tree and the
+//  block index are read.  Blocks are returned as views of the mapped pages, which are
+//  read from disk on first access and shared between processes.
+//
+//  File format (integers of type size_t, byte order of writing machine):
+//    header    magic string "MNPBEMHM", version, value type (1 real, 2 complex), LU flag,
+//              htol (double), kmax, number of blocks, offsets of tree, index and data,
+//              checksum (FNV-1a) of tree and index
+//    tree      sons, ind, ipart, csons, cind, cipart, ind1, ind2, area, each matrix as
+//              number of rows and columns followed by values at aligned offset
+//    index     row, col, flag, rows, columns, rank, offset and checksum for each block
+//    data      full matrix, or lhs followed by rhs for low-rank matrices,
+//              all arrays start at offsets aligned to 64 bytes
+
+/* hfile::write(file,H,info);     //  write H-matrix with global tree to file
+ * hfile f;  f.open(file);        //  map file into memory, read tree and block index
+ * f.info;  f.iscomplex();        //  options and value type of H-matrix
+ * f.gettree(tree,ind1,ind2);     //  copy cluster tree and index lists
+ * f.block(i,sub);                //  block i of index, view of mapped memory
+ * f.get(H);                      //  H-matrix with views of all blocks
+ * f.verify();                    //  compare checksums of all blocks
+ * f.bytes(i);  f.advise(i,need);  //  size of block i, prefetch or release its pages
+ * f.close();                     //  unmap file, views become invalid
+ */
+
+#include <string>
+#include <vector>
+#include <cstdio>
+
+#ifndef hfile_h
+#define hfile_h
+
+#include "hoptions.h"
+#include "basemat.h"
+#include "clustertree.h"
+#include "hmatrix.h"
+
+//  options stored with H-matrix
+struct hfileinfo
+{
+  //  LU (or LDL') decomposition
+  bool islu;
+  //  tolerance and maximal rank for low-rank matrices
+  double htol;
+  size_t kmax;
+  //  boundary element areas for symmetric storage (empty otherwise)
+  matrix<double> area;
+
+  hfileinfo() : islu(false), htol(1e-6), kmax(100) {}
+};
+
+//  entry of block index
+struct hblock
+{
+  size_t row, col, flag, m, n, k, offset, sum;
+};
+
+class hfile
+{
+public:
+  hfileinfo info;
+  std::vector<hblock> index;
+
+  hfile() : buf(0), len(0), type(0), tpos(0) {}
+  ~hfile() { close(); }
+
+  //  map file into memory and read header, returns false for invalid files
+  bool open(const std::string& file);
+  void close();
+  //  complex values ?
+  bool iscomplex() const { return type==2; }
+  //  copy cluster tree and index lists, set admissibility
+  void gettree(clustertree& tree, matrix<size_t>& ind1, matrix<size_t>& ind2) const;
+  //  compare checksums of blocks
+  bool verify() const;
+  //  size of block i in file
+  size_t bytes(size_t i) const;
+  //  prefetch (need) or release mapped pages of block i, no effect without memory mapping
+  void advise(size_t i, bool need) const;
+
+  //  block i of index as view of mapped memory
+  template<class T> bool block(size_t i, submatrix<T>& sub) const;
+  //  H-matrix with views of all blocks
+  template<class T> bool get(hmatrix<T>& H) const;
+  //  write H-matrix with global cluster tree to file
+  template<class T>
+  static bool write(const std::string& file, const hmatrix<T>& H, const hfileinfo& info);
+
+private:
+  //  start and length of mapped file, value type
+  char* buf;
+  size_t len, type;
+  //  offset of tree in file
+  size_t tpos;
+
+  //  no copies of mapped files
+  hfile(const hfile&);
+  hfile& operator= (const hfile&);
+
+  //  value type tag
+  static size_t tag(double) { return 1; }
+  static size_t tag(dcmplx) { return 2; }
+  //  write header, tree and index, set offsets of blocks
+  static bool writehead(FILE* fid, size_t type, const hfileinfo& info, std::vector<hblock>& index);
+  //  write array at aligned offset
+  static bool writedata(FILE* fid, const void* val, size_t bytes);
+  //  checksum of memory
+  static size_t checksum(const void* val, size_t bytes, size_t h=14695981039346656037ULL);
+  //  size of array including padding to aligned offset
+  static size_t aligned(size_t bytes) { return (bytes+63)/64*64; }
+};
+
+
+//  block i of index as view of mapped memory
+template<class T>
+bool hfile::block(size_t i, submatrix<T>& sub) const
+{
+  if (i>=index.size() || type!=tag(T())) return false;
+  const hblock& b=index[i];
+  T* val=(T*)(buf+b.offset);
+
+  sub.row=b.row;  sub.col=b.col;
+  sub.mat.clear();  sub.lhs.clear();  sub.rhs.clear();
+  if (b.flag==flagFull)
+    sub.mat.view(b.m,b.n,val);
+  else
+  {
+    sub.lhs.view(b.m,b.k,val);
+    sub.rhs.view(b.n,b.k,(T*)(buf+b.offset+aligned(b.m*b.k*sizeof(T))));
+  }
+  return true;
+}
+
+//  H-matrix with views of all blocks
+template<class T>
+bool hfile::get(hmatrix<T>& H) const
+{
+  H.clear();
+  for (size_t i=0; i<index.size(); i++)
+    if (!block(i,H[pair_t(index[i].row,index[i].col)])) return false;
+  return true;
+}
+
+//  write H-matrix with global cluster tree to file
+template<class T>
+bool hfile::write(const std::string& file, const hmatrix<T>& H, const hfileinfo& info)
+{
+  //  block index, offsets are set in writehead
+  std::vector<hblock> index;
+  for (typename hmatrix<T>::const_iterator it=H.begin(); it!=H.end(); it++)
+  {
+    const submatrix<T>& sub=it->second;
+    hblock b={ it->first.first, it->first.second, (size_t)sub.flag(), 0, 0, 0, 0, 0 };
+    if (b.flag==flagFull)
+      b.m=sub.mat.nrows(), b.n=sub.mat.ncols(),
+      b.sum=checksum(sub.mat.begin(),b.m*b.n*sizeof(T));
+    else if (b.flag==flagRk)
+      b.m=sub.lhs.nrows(), b.n=sub.rhs.nrows(), b.k=sub.lhs.ncols(),
+      b.sum=checksum(sub.rhs.begin(),b.n*b.k*sizeof(T),checksum(sub.lhs.begin(),b.m*b.k*sizeof(T)));
+    else
+      continue;
+    index.push_back(b);
+  }
+
+  FILE* fid=fopen(file.c_str(),"wb");
+  if (!fid) return false;
+  bool ok=writehead(fid,tag(T()),info,index);
+  //  values of blocks
+  for (size_t i=0; ok && i<index.size(); i++)
+  {
+    const hblock& b=index[i];
+    const submatrix<T>& sub=H.mat.find(pair_t(b.row,b.col))->second;
+    if (b.flag==flagFull)
+      ok=writedata(fid,sub.mat.begin(),b.m*b.n*sizeof(T));
+    else
+      ok=writedata(fid,sub.lhs.begin(),b.m*b.k*sizeof(T)) &&
+         writedata(fid,sub.rhs.begin(),b.n*b.k*sizeof(T));
+  }
+  ok=!fclose(fid) && ok;
+
+  if (!ok) std::remove(file.c_str());
+  return ok;
+}
+
+#endif  //  hfile_h
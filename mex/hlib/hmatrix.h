@@ -4,8 +4,10 @@
 
 /* hmatrix<double> A;                   //  initialize empty H-matrix
  * A=hmatrix<double>::getmex(prhs);     //  convert Matlab H-matrix to C++
+ * A.mexview(prhs);                     //  H-matrix with views of Matlab arrays
  * setmex(A,plhs);                      //  copy C++ matrices to Matlab
  * A.fread(fid);                        //  read H-matrix from file
+ * A.fwrite(fid);                       //  write H-matrix to file (see hfile.h for indexed files)
  * 
  * for (hmatrix<double>::iterator it=A.begin(); it!=A.end(); it++) *it;
  *                        //  loop over H-matrices (works also for const_iterator)
@@ -15,6 +17,9 @@
  * A*B;                   //  H-matrix multiplication
  * C=mul(A,B,i,j,k);      //  C(i,j)=A(i,k)*B(k,j)
  * inv(A);                //  invert H-matrix
+ *
+ * Rectangular H-matrices (tree.rect()) support filling, conversion to full matrices and
+ * multiplication with matrices, H-matrix arithmetic requires a square cluster tree.
  */
 
 #include <iostream>
@@ -81,6 +86,13 @@ public:
   //  convert Matlab arrays to H-matrix
   #ifdef MEX
   static hmatrix<T> getmex(const mxArray* prhs[]);
+  //  submatrices are views of Matlab arrays, valid only during MEX call
+  hmatrix<T>& mexview(const mxArray* prhs[]);
+  #endif // MEX
+  
+private:
+  #ifdef MEX
+  void getmex(const mxArray* prhs[], bool view);
   #endif // MEX
 };
 
@@ -91,7 +103,7 @@ matrix<T> full(const hmatrix<T>& A)
   typedef typename std::map<pair_t,submatrix<T> >::const_iterator const_iterator;
   const std::map<pair_t,submatrix<T> >& mat=A.mat;
   //  allocate full matrix
-  matrix<T> B(tree.ind(0,1),tree.ind(0,1));
+  matrix<T> B(tree.size(0).second,tree.csize(0).second);
 
   //  loop over submatrices
   for (const_iterator it=mat.begin(); it!=mat.end(); it++)
@@ -99,16 +111,17 @@ matrix<T> full(const hmatrix<T>& A)
     //  expand sub-matrix to full size
     matrix<T> sub=convert(it->second,flagFull).mat;
     //  copy to full matrix
-    copy(sub,sub.size(),B,mask_t(tree.size(it->first.first),tree.size(it->first.second)));
+    copy(sub,sub.size(),B,mask_t(tree.size(it->first.first),tree.csize(it->first.second)));
   }
   return B;
 }
 
 //  multiplication with matrix, y = A*x
+//    works also for rectangular H-matrices with separate row and column trees
 template<class T>
 matrix<T> hmatrix<T>::operator* (const matrix<T>& x) const
 {
-  matrix<T> y=matrix<T>(x.nrows(),x.ncols(),(T)0);
+  matrix<T> y=matrix<T>(tree.size(0).second,x.ncols(),(T)0);
       
   //  loop over all sub-matrices and perform submatrix-vector multiplication
   for (const_iterator it=mat.begin(); it!=mat.end(); it++) add_mul(it->second,x,y);
@@ -201,7 +214,7 @@ hmatrix<T> subtract(const hmatrix<T>& A, const hmatrix<T>& B, size_t i, size_t j
 template<class T>
 hmatrix<T> operator- (const hmatrix<T>& A, const hmatrix<T>& B)
 {
-  return subtract(A,B);
+  return subtract(A,B,0,0);
 }
 
 /*
@@ -243,8 +256,9 @@ submatrix<T> add_mul2(const Amat& A, const Bmat& B, size_t i, size_t j, size_t k
 }
 
 //  recursive function for H-matrix multiplication, C(H) = A(sub,H)*B(sub,H)
+//    for lower==true only the lower block tree of C is computed (symmetric storage)
 template<class T, class Amat, class Bmat>
-void add_mul(const Amat& A, const Bmat& B, hmatrix<T>& C, size_t i, size_t j, size_t k)
+void add_mul(const Amat& A, const Bmat& B, hmatrix<T>& C, size_t i, size_t j, size_t k, bool lower=false)
 {
   //  are matrices of type submatrix ?
   const submatrix<T> *pA=A.find(i,k), *pB=B.find(k,j);
@@ -257,18 +271,21 @@ void add_mul(const Amat& A, const Bmat& B, hmatrix<T>& C, size_t i, size_t j, si
     for (treeiterator jj=tree.begin(j); jj!=tree.end(); jj++)
     for (treeiterator kk=tree.begin(k); kk!=tree.end(); kk++)       
     {
+      //  skip upper blocks
+      if (lower && !tree.lower(*ii,*jj)) continue;
+      
       if (pA==0 && pB==0) 
         //  C(H) = A(H)*B(H)
-        add_mul(A,B,C,*ii,*jj,*kk);
+        add_mul(A,B,C,*ii,*jj,*kk,lower);
       else if (pA!=0 && pB==0)
         //  C(H) = A(sub)*B(H)
-        add_mul(*pA,B,C,*ii,*jj,*kk);
+        add_mul(*pA,B,C,*ii,*jj,*kk,lower);
       else if (pA==0 && pB!=0)
         //  C(H) = A(H)*B(sub)
-        add_mul(A,*pB,C,*ii,*jj,*kk);
+        add_mul(A,*pB,C,*ii,*jj,*kk,lower);
       else
         //  C(H) = A(sub)*B(sub)
-        add_mul(*pA,*pB,C,*ii,*jj,*kk);        
+        add_mul(*pA,*pB,C,*ii,*jj,*kk,lower);        
     }
   else if (adC!=0 && pA!=0 && pB!=0)
     //  C(sub) = A(sub)*B(sub)
@@ -383,23 +400,67 @@ void hmatrix<T>::fread(FILE* fid)
   }  
 }
 
+//  write H-matrix to file, same format as fread
+template<class T>
+FILE* hmatrix<T>::fwrite(FILE* fid) const
+{
+  //  rows and columns of full and low-rank matrices
+  std::vector<pair_t> rc[2];
+  for (const_iterator it=mat.begin(); it!=mat.end(); it++)
+    if (it->second.flag()) rc[it->second.flag()==flagFull ? 0 : 1].push_back(it->first);
+  
+  for (int k=0; k<2; k++)
+  {
+    matrix<size_t> ind(rc[k].size(),2);
+    for (size_t i=0; i<rc[k].size(); i++) ind(i,0)=rc[k][i].first, ind(i,1)=rc[k][i].second;
+    ind.fwrite(fid);
+    //  write full or low-rank matrices
+    for (size_t i=0; i<rc[k].size(); i++)
+    {
+      const submatrix<T>& sub=mat.find(rc[k][i])->second;
+      if (k==0) sub.mat.fwrite(fid); else { sub.lhs.fwrite(fid);  sub.rhs.fwrite(fid); }
+    }
+  }
+  return fid;
+}
+
 #ifdef MEX
 //  convert Matlab arrays to H-matrix
 template<class T>
 hmatrix<T> hmatrix<T>::getmex(const mxArray* prhs[])
 {
-  const mxArray *A=prhs[0], *L=prhs[1], *R=prhs[2];
-  //  return matrix
   hmatrix<T> H;
+  H.getmex(prhs,false);
+  return H;
+}
+
+//  H-matrix with views of Matlab arrays
+template<class T>
+hmatrix<T>& hmatrix<T>::mexview(const mxArray* prhs[])
+{
+  getmex(prhs,true);
+  return *this;
+}
+
+//  convert Matlab arrays to H-matrix, copy or view of Matlab arrays
+template<class T>
+void hmatrix<T>::getmex(const mxArray* prhs[], bool view)
+{
+  const mxArray *A=prhs[0], *L=prhs[1], *R=prhs[2];
+  mat.clear();
   
   //  loop over full matrices
   for (size_t i=0; i<ind1.nrows(); i++)
   {
     //  rows and columns
     size_t row=ind1(i,0), col=ind1(i,1);
+    //  skip empty cells (upper blocks for symmetric storage)
+    if (!mxGetCell(A,i) || !mxGetM(mxGetCell(A,i))) continue;
     
-    H.mat[pair_t(row,col)]=
-            submatrix<T>(row,col,matrix<T>::getmex(mxGetCell(A,i)));
+    submatrix<T>& sub=mat[pair_t(row,col)];
+    sub.row=row;  sub.col=col;
+    if (view) sub.mat.mexview(mxGetCell(A,i));
+    else      sub.mat=matrix<T>::getmex(mxGetCell(A,i));
   }
   
   //  loop over low-rank matrices
@@ -407,13 +468,14 @@ hmatrix<T> hmatrix<T>::getmex(const mxArray* prhs[])
   {
     //  rows and columns
     size_t row=ind2(i,0), col=ind2(i,1);
+    //  skip empty cells (upper blocks for symmetric storage)
+    if (!mxGetCell(L,i) || !mxGetM(mxGetCell(L,i))) continue;
     
-    H.mat[pair_t(row,col)]=
-            submatrix<T>(row,col,matrix<T>::getmex(mxGetCell(L,i)),
-                                 matrix<T>::getmex(mxGetCell(R,i)));
+    submatrix<T>& sub=mat[pair_t(row,col)];
+    sub.row=row;  sub.col=col;
+    if (view) { sub.lhs.mexview(mxGetCell(L,i));  sub.rhs.mexview(mxGetCell(R,i)); }
+    else      { sub.lhs=matrix<T>::getmex(mxGetCell(L,i));  sub.rhs=matrix<T>::getmex(mxGetCell(R,i)); }
   }  
-  //  return H-matrix
-  return H;
 }
 
 //  copy H-matrix to Matlab arrays
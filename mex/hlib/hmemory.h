@@ -0,0 +1,175 @@
+//  hmemory.h - Accounting of memory allocated by matrices.
+//
+//  All allocations of matrix<T> (basemat.h) are counted in the global object memstat,
+//  which keeps the current and peak number of bytes, in total and for each tag.  The tag
+//  of allocations is set for a scope with memscope, within parallel regions the tag of
+//  the enclosing serial code applies.  The counters are process-wide for each MEX file,
+//  the MEX functions reset the peak values and the budget at the beginning of each call.
+//  If the budget is exceeded, the allocation throws memerror instead of being performed.
+//  Within parallel regions the allocation is performed and the error is raised by the
+//  next allocation outside of the region or by memstat.check().  MEX functions are called
+//  through mexcall (hoptions.h), which raises the Matlab error after the stack has been
+//  unwound, such that the matrices of the failed call are released.
+
+/* memstat.reset(budget);      //  peak values set to current values, new budget
+ * memstat.budget=bytes;       //  maximal number of allocated bytes (0 for no limit)
+ * memstat.getmex(op);         //  budget from field maxmem of Matlab options (MEX)
+ * memstat.cur, memstat.peak;  //  current and peak bytes of all allocations
+ * memstat.tcur[memLU], memstat.tpeak[memLU];    //  current and peak bytes for tag
+ * memstat.check();            //  error if budget has been exceeded in parallel region
+ *
+ * { memscope scope(memLU);   //  allocations within scope are tagged with memLU
+ *   ...
+ *   scope.close(); }          //  restore previous tag before end of scope
+ *
+ * plhs[0]=setmex(memstat);    //  Matlab structure with memory statistics
+ * addmex(lhs,memstat);        //  add field memory to Matlab structure lhs
+ */
+
+#include <cstdio>
+#include <algorithm>
+#include <stdexcept>
+
+#ifndef hmemory_h
+#define hmemory_h
+
+#include "hoptions.h"
+
+//  tags for allocations, temporaries are workspaces of low-rank approximations
+enum memtag { memOther, memFill, memLU, memInv, memSolve, memTemp, memNtag };
+
+//  exception for exceeded memory budget
+class memerror : public std::runtime_error
+{
+public:
+  memerror(const char* msg) : std::runtime_error(msg) {}
+};
+
+//  current and peak bytes of matrix allocations
+class memstats
+{
+public:
+  //  current and peak bytes, maximal number of bytes (0 for no limit)
+  size_t cur, peak, budget;
+  //  current and peak bytes for each tag
+  size_t tcur[memNtag], tpeak[memNtag];
+  //  tag of allocations
+  memtag tag;
+  //  budget exceeded within parallel region
+  bool exceeded;
+
+  memstats() : cur(0), peak(0), budget(0), tag(memOther), exceeded(false)
+    { std::fill(tcur,tcur+memNtag,0);  std::fill(tpeak,tpeak+memNtag,0); }
+
+  //  name of tag
+  static const char* name(size_t t)
+    {
+      static const char* names[]={ "other", "fill", "lu", "inv", "solve", "temp" };
+      return names[t];
+    }
+  //  set peak values to current values, set budget (0 for no limit)
+  void reset(size_t bytes=0)
+    {
+      peak=cur;  std::copy(tcur,tcur+memNtag,tpeak);
+      budget=bytes;  exceeded=false;  tag=memOther;
+    }
+  //  add allocation with current tag, return tag
+  memtag add(size_t bytes)
+    {
+      memtag t=tag;
+      bool fail=false;
+      #pragma omp critical (memstats)
+      {
+        if (!inparallel() && (exceeded || (budget && cur+bytes>budget)))
+          fail=true;
+        else
+        {
+          if (budget && cur+bytes>budget) exceeded=true;
+          cur+=bytes;  tcur[t]+=bytes;
+          peak=std::max(peak,cur);  tpeak[t]=std::max(tpeak[t],tcur[t]);
+        }
+      }
+      if (fail) error(exceeded ? peak : cur+bytes,t);
+      return t;
+    }
+  //  remove allocation
+  void sub(size_t bytes, memtag t)
+    {
+      #pragma omp critical (memstats)
+      {
+        cur-=bytes;  tcur[t]-=bytes;
+      }
+    }
+  //  error if budget has been exceeded within parallel region
+  void check() { if (exceeded && !inparallel()) error(peak,tag); }
+
+  #ifdef MEX
+  //  budget from field maxmem (bytes) of Matlab options
+  void getmex(const mxArray* op)
+    {
+      const mxArray* f;
+      if (op && mxIsStruct(op) && (f=mxGetField(op,0,"maxmem")) && !mxIsEmpty(f))
+        budget=(size_t)mxGetScalar(f);
+    }
+  #endif  //  MEX
+
+private:
+  //  error message for exceeded budget
+  void error(size_t bytes, memtag t)
+    {
+      char msg[160];
+      std::sprintf(msg,"hlib: memory budget of %.0f bytes exceeded, %.0f bytes requested (%s)",
+                   (double)budget,(double)bytes,name(t));
+      exceeded=false;
+      #ifdef MEX
+        throw memerror(msg);
+      #else
+        ERROR(msg);
+      #endif
+    }
+};
+extern memstats memstat;
+
+//  tag of allocations within scope, only set outside of parallel regions
+class memscope
+{
+public:
+  memscope(memtag t) : prev(memstat.tag), set(!inparallel()) { if (set) memstat.tag=t; }
+  ~memscope() { close(); }
+  //  restore previous tag
+  void close() { if (set) memstat.tag=prev;  set=false; }
+
+private:
+  memtag prev;
+  bool set;
+};
+
+#ifdef MEX
+//  Matlab structure with current, peak and maximal bytes, fields for tags with
+//    current and peak bytes
+inline mxArray* setmex(const memstats& s)
+{
+  mxArray* lhs=mxCreateStructMatrix(1,1,0,NULL);
+  mxAddField(lhs,"current");  mxSetField(lhs,0,"current",mxCreateDoubleScalar((double)s.cur));
+  mxAddField(lhs,"peak");     mxSetField(lhs,0,"peak",   mxCreateDoubleScalar((double)s.peak));
+  mxAddField(lhs,"budget");   mxSetField(lhs,0,"budget", mxCreateDoubleScalar((double)s.budget));
+  for (size_t t=0; t<memNtag; t++)
+  {
+    mxArray* x=mxCreateDoubleMatrix(1,2,mxREAL);
+    mxGetPr(x)[0]=(double)s.tcur[t];  mxGetPr(x)[1]=(double)s.tpeak[t];
+    mxAddField(lhs,memstats::name(t));
+    mxSetField(lhs,0,memstats::name(t),x);
+  }
+  return lhs;
+}
+
+//  add field memory with memory statistics to Matlab structure
+inline mxArray* addmex(mxArray* lhs, const memstats& s)
+{
+  mxAddField(lhs,"memory");
+  mxSetField(lhs,0,"memory",setmex(s));
+  return lhs;
+}
+#endif  //  MEX
+
+#endif  //  hmemory_h
@@ -9,6 +9,14 @@
  * tic;             //  start timer
  * ...
  * toc(txt);        //  add txt entry to timer 
+ *
+ * nthreads();      //  maximal number of threads (1 w/o OpenMP)
+ * ithread();       //  index of current thread (0 w/o OpenMP)
+ *
+ * void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+ *   { mexcall(mexbody,clearglobals,nlhs,plhs,nrhs,prhs); }
+ *                  //  exceptions of mexbody as Matlab error, clearglobals is called
+ *                  //  after mexbody also if an exception is thrown
  */
 
 #ifndef hoptions_h
@@ -24,10 +32,20 @@
 #include <ctime>
 #include <complex>
 #include <cstddef>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
 
 #include "blas.h"
 
-#define MEX
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
+//  MEX functions for Matlab, native programs are compiled with -DNOMEX (see bench/)
+#ifndef NOMEX
+  #define MEX
+#endif
 #define TIMER
 
 #ifdef MEX
@@ -41,7 +59,7 @@
     }                                                                                                     \
   }
 #else
-  #define ERROR(err) { std:cout << err << std::endl;  exit(1); }
+  #define ERROR(err) { std::cout << err << std::endl;  exit(1); }
   #define ASSERT(x) assert(x)
 #endif
 
@@ -52,8 +70,14 @@
 #endif
 
 typedef std::complex<double> dcmplx;
+typedef std::complex<float>  fcmplx;
 typedef std::pair<size_t,size_t> pair_t;
 
+//  single precision type for storage of H-matrices (see mixed.h)
+template<class T> struct single;
+template<> struct single<double> { typedef float  type; };
+template<> struct single<dcmplx> { typedef fcmplx type; };
+
 //  option array for H-matrices
 struct hoptions
 {
@@ -62,13 +86,57 @@ struct hoptions
 };
 extern struct hoptions hopts;
 
+//  number of threads, index of current thread, inside of parallel region ?
+#ifdef _OPENMP
+  inline size_t nthreads()  { return (size_t)omp_get_max_threads(); }
+  inline size_t ithread()   { return (size_t)omp_get_thread_num(); }
+  inline bool   inparallel() { return omp_in_parallel()!=0; }
+#else
+  inline size_t nthreads()  { return 1; }
+  inline size_t ithread()   { return 0; }
+  inline bool   inparallel() { return false; }
+#endif
+
 #ifdef TIMER
   extern std::map<std::string,double> timer;
   #define tic std::clock_t start=std::clock()
-  #define toc(id) timer[id]+=(std::clock()-start)/(double)CLOCKS_PER_SEC
+  //  only the master thread of parallel regions adds to the timer
+  #define toc(id) do { if (!ithread()) timer[id]+=(std::clock()-start)/(double)CLOCKS_PER_SEC; } while (0)
 #else
   #define tic
   #define toc(id)
 #endif
 
+#ifdef MEX
+//  clean-up of global variables (cluster tree, timer, ...) for lifetime of object
+struct mexguard
+{
+  void (*fun)();
+  mexguard(void (*f)()) : fun(f) {}
+  ~mexguard() { if (fun) fun(); }
+};
+
+//  call body of MEX function, exceptions (e.g. exceeded memory budget, see hmemory.h) are
+//    raised as Matlab error after the objects of the call have been destroyed and the
+//    globals have been cleared, because mexErrMsgTxt leaves the function without
+//    unwinding the stack, errors within the body must therefore be thrown as well
+inline void mexcall(void (*body)(int, mxArray**, int, const mxArray**), void (*cleanup)(),
+                    int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  char msg[512]="";
+  {
+    mexguard guard(cleanup);
+    try
+    {
+      body(nlhs,plhs,nrhs,prhs);
+    }
+    catch (const std::exception& e)
+    {
+      std::strncpy(msg,*e.what() ? e.what() : "unknown error",sizeof(msg)-1);
+    }
+  }
+  if (*msg) mexErrMsgTxt(msg);
+}
+#endif  //  MEX
+
 #endif // hoptions_h
@@ -0,0 +1,131 @@
+//  hrecord.h - Recording of MEX inputs for replay without Matlab.
+//
+//  If the environment variable MNPBEM_RECORD is set to a directory, e.g. in Matlab with
+//  setenv('MNPBEM_RECORD','/tmp/rec'), the MEX functions write their input arrays to a
+//  new file name_time_count.rec in this directory before the computation starts.  The
+//  file contains the cluster tree, particles, H-matrix cells, options and tables exactly
+//  as passed by Matlab, the native programs of replay/ rerun the call, e.g. under a
+//  profiler.  Without the environment variable recording costs one call to getenv.
+//
+//  File format (integers of type size_t, byte order of writing machine):
+//    header    magic string "MNPBEMRC", version, name of MEX function, nlhs, nrhs
+//    arrays    nrhs arrays, each with class ID (mxClassID), complex flag, number of
+//              dimensions and dimensions, followed by
+//                numeric, char and logical arrays   element size and values, real and
+//                                                     imaginary parts interleaved
+//                cell arrays                        arrays of all elements
+//                structures                         number of fields and field names,
+//                                                     arrays of all elements and fields
+//              strings are stored as length and characters, missing arrays (empty cells)
+//              and arrays that cannot be replayed (function handles, objects) as
+//              mxUNKNOWN_CLASS without dimensions
+
+/* record(name,nlhs,nrhs,prhs);   //  record inputs if MNPBEM_RECORD is set (MEX)
+ */
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#ifndef hrecord_h
+#define hrecord_h
+
+#include "hoptions.h"
+
+//  magic string and version of record files
+static const char hrecord_magic[8]={ 'M','N','P','B','E','M','R','C' };
+static const size_t hrecord_version=1;
+
+#ifdef MEX
+//  write integer or string
+inline void recput(FILE* fid, size_t n) { std::fwrite(&n,sizeof(size_t),1,fid); }
+inline void recput(FILE* fid, const char* str)
+{
+  size_t n=std::strlen(str);
+  recput(fid,n);
+  std::fwrite(str,1,n,fid);
+}
+
+//  write Matlab array
+inline void recput(FILE* fid, const mxArray* rhs)
+{
+  mxClassID id=rhs ? mxGetClassID(rhs) : mxUNKNOWN_CLASS;
+  //  arrays that can be replayed
+  bool ok=id==mxCELL_CLASS || id==mxSTRUCT_CLASS || id==mxLOGICAL_CLASS || id==mxCHAR_CLASS ||
+          (id>=mxDOUBLE_CLASS && id<=mxUINT64_CLASS);
+  if (!ok) { recput(fid,(size_t)mxUNKNOWN_CLASS);  recput(fid,(size_t)0);  recput(fid,(size_t)0);  return; }
+
+  size_t n=mxGetNumberOfElements(rhs), ndim=mxGetNumberOfDimensions(rhs);
+  recput(fid,(size_t)id);
+  recput(fid,(size_t)mxIsComplex(rhs));
+  recput(fid,ndim);
+  for (size_t i=0; i<ndim; i++) recput(fid,(size_t)mxGetDimensions(rhs)[i]);
+
+  if (id==mxCELL_CLASS)
+    for (size_t i=0; i<n; i++) recput(fid,mxGetCell(rhs,i));
+  else if (id==mxSTRUCT_CLASS)
+  {
+    int nf=mxGetNumberOfFields(rhs);
+    recput(fid,(size_t)nf);
+    for (int k=0; k<nf; k++) recput(fid,mxGetFieldNameByNumber(rhs,k));
+    for (size_t i=0; i<n; i++)
+    for (int k=0; k<nf; k++) recput(fid,mxGetFieldByNumber(rhs,i,k));
+  }
+  else
+  {
+    size_t esize=mxGetElementSize(rhs);
+#if MX_HAS_INTERLEAVED_COMPLEX
+    //  element size of complex arrays includes real and imaginary part
+    recput(fid,esize);
+    if (n) std::fwrite(mxGetData(rhs),esize,n,fid);
+#else
+    if (!mxIsComplex(rhs))
+    {
+      recput(fid,esize);
+      if (n) std::fwrite(mxGetData(rhs),esize,n,fid);
+    }
+    else
+    {
+      //  interleave real and imaginary parts
+      std::vector<char> buf(2*esize*n);
+      const char *re=(const char*)mxGetData(rhs), *im=(const char*)mxGetImagData(rhs);
+      for (size_t i=0; i<n; i++)
+      {
+        std::memcpy(&buf[2*i*esize],      re+i*esize,esize);
+        std::memcpy(&buf[(2*i+1)*esize],  im+i*esize,esize);
+      }
+      recput(fid,2*esize);
+      if (n) std::fwrite(&buf[0],2*esize,n,fid);
+    }
+#endif
+  }
+}
+
+//  record inputs of MEX function if environment variable MNPBEM_RECORD is set
+inline void record(const char* name, int nlhs, int nrhs, const mxArray* prhs[])
+{
+  const char* dir=std::getenv("MNPBEM_RECORD");
+  if (!dir || !*dir) return;
+  //  number of recorded calls of this MEX file
+  static size_t count=0;
+
+  char file[64];
+  std::sprintf(file,"%s_%lu_%lu.rec",name,(unsigned long)std::time(0),(unsigned long)count++);
+  std::string path=std::string(dir)+"/"+file;
+  FILE* fid=std::fopen(path.c_str(),"wb");
+  if (!fid) { mexPrintf("%s: cannot write record file %s\n",name,path.c_str());  return; }
+
+  std::fwrite(hrecord_magic,1,sizeof(hrecord_magic),fid);
+  recput(fid,hrecord_version);
+  recput(fid,name);
+  recput(fid,(size_t)nlhs);
+  recput(fid,(size_t)nrhs);
+  for (int i=0; i<nrhs; i++) recput(fid,prhs[i]);
+  std::fclose(fid);
+}
+#endif  //  MEX
+
+#endif  //  hrecord_h
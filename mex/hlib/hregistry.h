@@ -0,0 +1,145 @@
+//  hregistry.h - Registry of H-matrices kept in memory between MEX calls.
+//
+//  H-matrices and their cluster trees are stored on the C++ side, Matlab only holds
+//  an integer handle.  Several H-matrices (e.g. a matrix and its LU decomposition)
+//  share the same cluster tree, which is reference counted and removed together with
+//  the last H-matrix using it.  Before operating on an H-matrix, the cluster tree and
+//  the index lists are swapped into the global variables tree, ind1, ind2 used by the
+//  H-matrix functions, and swapped back afterwards.
+
+/* hregistry reg;                     //  registry object
+ * size_t it=reg.addtree(t);          //  register cluster tree (contents are moved)
+ * size_t h=reg.add(it);              //  add new H-matrix using cluster tree
+ * hentry* e=reg.find(h);             //  H-matrix for handle (0 if not registered)
+ * { hbind bind(reg,*e); ... }        //  cluster tree of H-matrix bound to globals
+ * { hbind bind(t,*e); ... }          //  same for cluster tree before registration
+ * reg.remove(h);  reg.clear();       //  remove H-matrix or all H-matrices
+ *
+ * H-matrices loaded from files (hfile.h) or moved to disk (hstore.h) are views of the
+ * mapped file, which is owned by the registry entry and unmapped when the entry is removed.
+ * H-matrices converted to single precision (mixed.h) are stored in As or Zs instead of A or Z.
+ */
+
+#include <map>
+#include <vector>
+
+#include "hoptions.h"
+#include "basemat.h"
+#include "clustertree.h"
+#include "hmatrix.h"
+#include "hfile.h"
+#include "hstore.h"
+
+#ifndef hregistry_h
+#define hregistry_h
+
+//  cluster tree with index lists to full and low-rank matrices
+struct htree
+{
+  clustertree tree;
+  matrix<size_t> ind1, ind2;
+  //  number of H-matrices using tree
+  size_t refs;
+
+  htree() : refs(0) {}
+};
+
+//  registered H-matrix, real or complex
+struct hentry
+{
+  //  key of cluster tree
+  size_t tree;
+  //  complex H-matrix, LU (or LDL') decomposition
+  bool iscomplex, islu;
+  hmatrix<double> A;
+  hmatrix<dcmplx> Z;
+  //  boundary element areas for symmetric storage (empty otherwise)
+  matrix<double> area;
+  //  tolerance and maximal rank for low-rank matrices
+  double htol;
+  size_t kmax;
+  //  mapped file for H-matrices loaded from file or moved to disk (owned by registry)
+  hfile* file;
+  hstore* store;
+  //  single precision storage, handle of double precision H-matrix for iterative
+  //    refinement of solutions (0 if none), tolerance and maximal number of steps
+  bool issingle;
+  hmatrix<float>  As;
+  hmatrix<fcmplx> Zs;
+  size_t refine, rmaxit;
+  double rtol;
+
+  hentry() : tree(0), iscomplex(false), islu(false), htol(1e-6), kmax(100), file(0), store(0),
+             issingle(false), refine(0), rmaxit(5), rtol(1e-10) {}
+};
+
+class hregistry
+{
+public:
+  std::map<size_t,htree> trees;
+  std::map<size_t,hentry> mat;
+
+  hregistry() : count(0) {}
+
+  //  register cluster tree, returns key for tree
+  size_t addtree(htree& t)
+    { htree& r=trees[++count];  r.tree.swap(t.tree);  r.ind1.swap(t.ind1);  r.ind2.swap(t.ind2);
+      return count; }
+  //  register H-matrix for given tree, returns handle
+  size_t add(size_t tree)
+    { hentry& e=mat[++count];  e.tree=tree;  trees[tree].refs++;  return count; }
+  //  H-matrix for handle, 0 if not registered
+  hentry* find(size_t h)
+    { std::map<size_t,hentry>::iterator it=mat.find(h);  return it==mat.end() ? 0 : &it->second; }
+
+  //  remove H-matrix and tree if no longer used
+  bool remove(size_t h)
+    {
+      std::map<size_t,hentry>::iterator it=mat.find(h);
+      if (it==mat.end()) return false;
+      if (--trees[it->second.tree].refs==0) trees.erase(it->second.tree);
+      delete it->second.file;  delete it->second.store;
+      mat.erase(it);
+      return true;
+    }
+  //  remove all H-matrices and trees
+  void clear() 
+    {
+      for (std::map<size_t,hentry>::iterator it=mat.begin(); it!=mat.end(); it++) { delete it->second.file;  delete it->second.store; }
+      mat.clear();  trees.clear();
+    }
+
+  //  number of registered H-matrices
+  size_t size() const { return mat.size(); }
+  //  handles of registered H-matrices
+  std::vector<size_t> handles() const
+    {
+      std::vector<size_t> h;
+      for (std::map<size_t,hentry>::const_iterator it=mat.begin(); it!=mat.end(); it++)
+        h.push_back(it->first);
+      return h;
+    }
+
+private:
+  //  counter for keys of trees and handles
+  size_t count;
+};
+
+//  bind cluster tree of H-matrix to global variables for lifetime of object, errors in
+//    the scope are thrown as exceptions such that the globals are restored (mexcall)
+class hbind
+{
+public:
+  hbind(hregistry& reg, const hentry& e) : t(reg.trees[e.tree])
+    { swap();  hopts.tol=e.htol;  hopts.kmax=e.kmax; }
+  //  cluster tree not (yet) registered, options of e
+  hbind(htree& t0, const hentry& e) : t(t0)
+    { swap();  hopts.tol=e.htol;  hopts.kmax=e.kmax; }
+  ~hbind() { swap(); }
+
+private:
+  htree& t;
+  void swap() { tree.swap(t.tree);  ind1.swap(t.ind1);  ind2.swap(t.ind2); }
+};
+
+#endif  //  hregistry_h
@@ -0,0 +1,212 @@
+//  hstats.h - Statistics of H-matrices and of low-rank arithmetic.
+//
+//  Block statistics are computed from an H-matrix and the global cluster tree, the
+//  level of a block is the level of its row cluster (root at level 0).  Storage is
+//  counted in bytes of the stored values, the compression is the ratio between stored
+//  values and the full matrix.  ACA calls and truncations of low-rank matrices are
+//  counted in the global object acastat, which the MEX functions reset together with
+//  the timer.  Calls from parallel regions are serialized in a critical section.
+
+/* hstats s(A);               //  block statistics of H-matrix A
+ * s.blocks[i];               //  row, col, level, flag, rank and bytes of block
+ * s.levels[l];               //  number of blocks, rmax, ranksum and bytes of level l
+ * s.bytes, s.compression;    //  storage and compression of H-matrix
+ * s.levels[l].bytes/s.levels[l].fullbytes;      //  compression of level
+ *
+ * acastat.clear();           //  reset ACA and truncation statistics
+ * acastat.calls, acastat.iter, acastat.kmaxhits;  //  ACA calls, iterations, kmax hits
+ * acastat.history(k);        //  mean of log10(Nk/Nsum) in iteration k
+ * acastat.trunc, acastat.rank1, acastat.rank2;    //  truncations, sum of ranks before
+ *                                                 //    and after truncation
+ * plhs[0]=setmex(s);         //  Matlab structure with block and ACA statistics
+ */
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#ifndef hstats_h
+#define hstats_h
+
+#include "hoptions.h"
+#include "basemat.h"
+#include "clustertree.h"
+
+//  statistics of ACA calls and truncations of low-rank matrices
+class acastats
+{
+public:
+  //  ACA calls, sum and maximum of iterations, calls terminated by maximal rank
+  size_t calls, iter, maxiter, kmaxhits;
+  //  sum of log10(Nk/Nsum) and number of calls for each iteration
+  std::vector<double> hsum;
+  std::vector<size_t> hcount;
+  //  truncations, sum and maximum of ranks before (1) and after (2) truncation
+  size_t trunc, rank1, rank2, rmax1, rmax2;
+
+  acastats() { clear(); }
+
+  //  reset statistics
+  void clear()
+    {
+      calls=iter=maxiter=kmaxhits=0;  trunc=rank1=rank2=rmax1=rmax2=0;
+      hsum.clear();  hcount.clear();
+    }
+  //  add ACA call with number of iterations, relative norms of updates
+  void aca(size_t it, bool kmaxhit, const std::vector<double>& hist)
+    {
+      #pragma omp critical (acastats)
+      {
+        calls++;  iter+=it;  maxiter=std::max(maxiter,it);  if (kmaxhit) kmaxhits++;
+        if (hsum.size()<hist.size()) { hsum.resize(hist.size(),0);  hcount.resize(hist.size(),0); }
+        for (size_t k=0; k<hist.size(); k++) if (hist[k]>0)
+          { hsum[k]+=std::log10(hist[k]);  hcount[k]++; }
+      }
+    }
+  //  add truncation of low-rank matrix
+  void truncate(size_t k1, size_t k2)
+    {
+      #pragma omp critical (acastats)
+      {
+        trunc++;  rank1+=k1;  rank2+=k2;  rmax1=std::max(rmax1,k1);  rmax2=std::max(rmax2,k2);
+      }
+    }
+  //  mean of log10(Nk/Nsum) in iteration k
+  double history(size_t k) const { return hcount[k] ? hsum[k]/hcount[k] : 0; }
+};
+extern acastats acastat;
+
+
+//  statistics of block
+struct blockstat
+{
+  size_t row, col, level, rank, bytes;
+  short flag;
+};
+
+//  statistics of blocks of level
+struct levelstat
+{
+  size_t nfull, nrk, rmax, ranksum, bytes, fullbytes;
+  levelstat() : nfull(0), nrk(0), rmax(0), ranksum(0), bytes(0), fullbytes(0) {}
+};
+
+//  statistics of H-matrix
+class hstats
+{
+public:
+  std::vector<blockstat> blocks;
+  std::vector<levelstat> levels;
+  //  bytes of stored values and of full matrix, compression
+  size_t bytes, fullbytes;
+  double compression;
+
+  hstats() : bytes(0), fullbytes(0), compression(0) {}
+  template<class H>
+  hstats(const H& A) : bytes(0), fullbytes(0), compression(0) { add(A); }
+
+  //  reset statistics
+  void clear() { blocks.clear();  levels.clear();  bytes=0;  fullbytes=0;  compression=0; }
+  //  add blocks of H-matrix, e.g. for several symmetry sectors
+  template<class H>
+  void add(const H& A)
+    {
+      //  levels of clusters, sons are numbered after their parents
+      std::vector<size_t> lev(tree.sons.nrows(),0);
+      for (size_t i=0; i<tree.sons.nrows(); i++)
+        if (!tree.leaf(i)) lev[tree.sons(i,0)]=lev[tree.sons(i,1)]=lev[i]+1;
+
+      for (typename H::const_iterator it=A.begin(); it!=A.end(); it++)
+      {
+        const size_t esize=sizeof(it->second.mat.val[0]);
+        size_t m=it->second.nrows(), n=it->second.ncols();
+        blockstat b;
+        b.row=it->first.first;  b.col=it->first.second;  b.level=lev[b.row];
+        b.flag=it->second.flag();
+        b.rank=(b.flag==flagFull || it->second.lhs.empty()) ? 0 : it->second.lhs.ncols();
+        b.bytes=esize*((b.flag==flagFull) ? m*n : b.rank*(m+n));
+        blocks.push_back(b);
+
+        if (levels.size()<=b.level) levels.resize(b.level+1);
+        levelstat& l=levels[b.level];
+        if (b.flag==flagFull) l.nfull++; else l.nrk++;
+        l.rmax=std::max(l.rmax,b.rank);  l.ranksum+=b.rank;
+        l.bytes+=b.bytes;  l.fullbytes+=esize*m*n;
+        bytes+=b.bytes;  fullbytes+=esize*m*n;
+      }
+      compression=fullbytes ? bytes/(double)fullbytes : 0;
+    }
+};
+
+#ifdef MEX
+//  Matlab structure with block statistics of H-matrix and ACA statistics,
+//    block and cluster indices start with 1
+inline mxArray* setmex(const hstats& s)
+{
+  const char* fields[]={ "bytes", "compression", "blocks", "levels", "aca", "truncate" };
+  mxArray* lhs=mxCreateStructMatrix(1,1,6,fields);
+  mxSetField(lhs,0,"bytes",mxCreateDoubleScalar((double)s.bytes));
+  mxSetField(lhs,0,"compression",mxCreateDoubleScalar(s.compression));
+
+  //  blocks, full is 1 for full matrices and 0 for low-rank matrices
+  const char* bfields[]={ "row", "col", "level", "full", "rank", "bytes" };
+  mxArray* b=mxCreateStructMatrix(1,1,6,bfields);
+  size_t nb=s.blocks.size();
+  for (size_t k=0; k<6; k++) mxSetFieldByNumber(b,0,(int)k,mxCreateDoubleMatrix(nb,1,mxREAL));
+  for (size_t i=0; i<nb; i++)
+  {
+    const blockstat& t=s.blocks[i];
+    mxGetPr(mxGetFieldByNumber(b,0,0))[i]=(double)(t.row+1);
+    mxGetPr(mxGetFieldByNumber(b,0,1))[i]=(double)(t.col+1);
+    mxGetPr(mxGetFieldByNumber(b,0,2))[i]=(double)t.level;
+    mxGetPr(mxGetFieldByNumber(b,0,3))[i]=(t.flag==flagFull) ? 1 : 0;
+    mxGetPr(mxGetFieldByNumber(b,0,4))[i]=(double)t.rank;
+    mxGetPr(mxGetFieldByNumber(b,0,5))[i]=(double)t.bytes;
+  }
+  mxSetField(lhs,0,"blocks",b);
+
+  //  levels, mean rank of low-rank blocks and compression of level
+  const char* lfields[]={ "nfull", "nrk", "rmax", "rmean", "bytes", "compression" };
+  mxArray* l=mxCreateStructMatrix(1,1,6,lfields);
+  size_t nl=s.levels.size();
+  for (size_t k=0; k<6; k++) mxSetFieldByNumber(l,0,(int)k,mxCreateDoubleMatrix(nl,1,mxREAL));
+  for (size_t i=0; i<nl; i++)
+  {
+    const levelstat& t=s.levels[i];
+    mxGetPr(mxGetFieldByNumber(l,0,0))[i]=(double)t.nfull;
+    mxGetPr(mxGetFieldByNumber(l,0,1))[i]=(double)t.nrk;
+    mxGetPr(mxGetFieldByNumber(l,0,2))[i]=(double)t.rmax;
+    mxGetPr(mxGetFieldByNumber(l,0,3))[i]=t.nrk ? t.ranksum/(double)t.nrk : 0;
+    mxGetPr(mxGetFieldByNumber(l,0,4))[i]=(double)t.bytes;
+    mxGetPr(mxGetFieldByNumber(l,0,5))[i]=t.fullbytes ? t.bytes/(double)t.fullbytes : 0;
+  }
+  mxSetField(lhs,0,"levels",l);
+
+  //  ACA calls, mean iterations and convergence history
+  const acastats& a=acastat;
+  const char* afields[]={ "calls", "iter", "maxiter", "kmaxhits", "history" };
+  mxArray* c=mxCreateStructMatrix(1,1,5,afields);
+  mxSetField(c,0,"calls",mxCreateDoubleScalar((double)a.calls));
+  mxSetField(c,0,"iter",mxCreateDoubleScalar(a.calls ? a.iter/(double)a.calls : 0));
+  mxSetField(c,0,"maxiter",mxCreateDoubleScalar((double)a.maxiter));
+  mxSetField(c,0,"kmaxhits",mxCreateDoubleScalar((double)a.kmaxhits));
+  mxArray* h=mxCreateDoubleMatrix(a.hsum.size(),1,mxREAL);
+  for (size_t k=0; k<a.hsum.size(); k++) mxGetPr(h)[k]=a.history(k);
+  mxSetField(c,0,"history",h);
+  mxSetField(lhs,0,"aca",c);
+
+  //  truncations, mean and maximal ranks before and after truncation
+  const char* tfields[]={ "calls", "rank1", "rank2", "rmax1", "rmax2" };
+  mxArray* t=mxCreateStructMatrix(1,1,5,tfields);
+  mxSetField(t,0,"calls",mxCreateDoubleScalar((double)a.trunc));
+  mxSetField(t,0,"rank1",mxCreateDoubleScalar(a.trunc ? a.rank1/(double)a.trunc : 0));
+  mxSetField(t,0,"rank2",mxCreateDoubleScalar(a.trunc ? a.rank2/(double)a.trunc : 0));
+  mxSetField(t,0,"rmax1",mxCreateDoubleScalar((double)a.rmax1));
+  mxSetField(t,0,"rmax2",mxCreateDoubleScalar((double)a.rmax2));
+  mxSetField(lhs,0,"truncate",t);
+
+  return lhs;
+}
+#endif  //  MEX
+
+#endif  //  hstats_h
@@ -0,0 +1,98 @@
+#include <string>
+#include <sstream>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+#include "hstore.h"
+
+//  name of scratch file
+std::string hstore::filename() const
+{
+  //  counter for files of same process
+  static size_t num=0;
+  std::ostringstream file;
+  file<<dir<<"/hstore."<<getpid()<<"."<<++num<<".hm";
+  return file.str();
+}
+
+//  map scratch file and set up index
+bool hstore::init(const std::string& file)
+{
+  bool ok=f.open(file);
+  //  file remains accessible through mapping
+  std::remove(file.c_str());
+  if (!ok) return false;
+
+  ind.clear();
+  for (size_t i=0; i<f.index.size(); i++) ind[pair_t(f.index[i].row,f.index[i].col)]=i;
+  used.assign(f.index.size(),0);
+  lru.clear();
+  bytes=0;
+  for (int i=0; i<3; i++) order[i].clear();
+  //  pages are not resident after writing the file
+  for (size_t i=0; i<f.index.size(); i++) f.advise(i,false);
+
+  return true;
+}
+
+//  start operation
+void hstore::begin(int o)
+{
+  op=o;
+  cur=0;
+  record=order[op].empty();
+}
+
+//  mark block as used and prefetch next blocks
+void hstore::touch(const pair_t& p)
+{
+  std::map<pair_t,size_t>::const_iterator it=ind.find(p);
+  if (it==ind.end()) return;
+  size_t i=it->second;
+
+  //  record traversal order, or prefetch next blocks in recorded order
+  if (record)
+    order[op].push_back(i);
+  else
+  {
+    for (size_t j=cur+1; j<=cur+ahead && j<order[op].size(); j++)
+      if (!used[order[op][j]]) f.advise(order[op][j],true);
+    cur++;
+  }
+
+  //  update least recently used list
+  if (used[i])
+    lru.erase(pair_t(used[i],i));
+  else
+    bytes+=f.bytes(i);
+  used[i]=++count;
+  lru.insert(pair_t(used[i],i));
+
+  //  release least recently used blocks, keep current block
+  while (bytes>maxbytes && lru.size()>1)
+  {
+    size_t j=lru.begin()->second;
+    lru.erase(lru.begin());
+    f.advise(j,false);
+    bytes-=f.bytes(j);
+    used[j]=0;
+  }
+}
+
+//  release all resident blocks
+void hstore::release()
+{
+  for (std::set<pair_t>::iterator it=lru.begin(); it!=lru.end(); it++)
+  {
+    f.advise(it->second,false);
+    used[it->second]=0;
+  }
+  lru.clear();
+  bytes=0;
+}
@@ -0,0 +1,149 @@
+//  hstore.h - Out-of-core storage of H-matrices with memory budget.
+//
+//  The blocks of an H-matrix are moved to a scratch file (hfile.h), and the H-matrix
+//  keeps views of the memory-mapped file.  Blocks used by multiplication or solution are
+//  tracked in least-recently-used order, when their size exceeds the memory budget the
+//  pages of the least recently used blocks are released and read again from disk when
+//  needed.  The order in which blocks are traversed is recorded in the first call, later
+//  calls prefetch the next blocks in this order.  The scratch file is removed right after
+//  it has been mapped, such that no files are left behind.  Without memory mapping
+//  (Windows) the blocks stay in memory and the budget has no effect.
+
+/* hstore store(dir,maxbytes);    //  scratch directory and memory budget in bytes
+ * store.ahead=8;                 //  number of blocks prefetched ahead
+ * store.spill(H,info);           //  move H-matrix to disk, H becomes view of mapped file
+ * y=store.mul(H,x);              //  multiplication with matrix
+ * store.solve(H,b,uplo);         //  solve using LU decomposition, override b
+ * store.nbytes();                //  size of resident blocks
+ * store.release();               //  release all resident blocks
+ */
+
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+
+#ifndef hstore_h
+#define hstore_h
+
+#include "hoptions.h"
+#include "basemat.h"
+#include "clustertree.h"
+#include "hmatrix.h"
+#include "hfile.h"
+#include "lu.h"
+
+class hstore
+{
+public:
+  //  memory budget in bytes, number of blocks prefetched ahead
+  size_t maxbytes, ahead;
+
+  hstore(const std::string& d, size_t m=(size_t)1<<30)
+    : maxbytes(m), ahead(8), dir(d), bytes(0), count(0), op(0), cur(0), record(false) {}
+
+  //  move H-matrix with global cluster tree to disk, H becomes view of mapped file
+  template<class T> bool spill(hmatrix<T>& H, const hfileinfo& info);
+  //  multiplication with matrix
+  template<class T> matrix<T> mul(const hmatrix<T>& A, const matrix<T>& x);
+  //  solve A*x = b using LU decomposition, override b
+  template<class T> void solve(const hmatrix<T>& A, matrix<T>& b, char uplo);
+
+  //  size of resident blocks
+  size_t nbytes() const { return bytes; }
+  //  release all resident blocks
+  void release();
+
+private:
+  std::string dir;
+  hfile f;
+  //  index of cluster pairs in file
+  std::map<pair_t,size_t> ind;
+  //  last use of resident blocks (0 if not resident), resident blocks ordered by use
+  std::vector<size_t> used;
+  std::set<pair_t> lru;
+  //  size of resident blocks, counter for use
+  size_t bytes, count;
+  //  traversal orders of operations (multiplication, lower and upper solve),
+  //    current operation and position, record traversal order in first call
+  std::vector<size_t> order[3];
+  int op;
+  size_t cur;
+  bool record;
+
+  //  no copies of stores
+  hstore(const hstore&);
+  hstore& operator= (const hstore&);
+
+  //  name of scratch file
+  std::string filename() const;
+  //  map scratch file and set up index
+  bool init(const std::string& file);
+  //  start operation, mark block as used and prefetch next blocks
+  void begin(int o);
+  void touch(const pair_t& p);
+  //  solve using tree, see lu.h
+  template<class T> void solve(const hmatrix<T>& A, matrix<T>& b, size_t i, char uplo);
+};
+
+
+//  move H-matrix to disk
+template<class T>
+bool hstore::spill(hmatrix<T>& H, const hfileinfo& info)
+{
+  std::string file=filename();
+  if (!hfile::write(file,H,info) || !init(file)) return false;
+  return f.get(H);
+}
+
+//  multiplication with matrix, y = A*x
+template<class T>
+matrix<T> hstore::mul(const hmatrix<T>& A, const matrix<T>& x)
+{
+  matrix<T> y=matrix<T>(tree.size(0).second,x.ncols(),(T)0);
+
+  begin(0);
+  for (typename hmatrix<T>::const_iterator it=A.begin(); it!=A.end(); it++)
+  {
+    touch(it->first);
+    add_mul(it->second,x,y);
+  }
+  return y;
+}
+
+//  solve A*x = b, override b
+template<class T>
+void hstore::solve(const hmatrix<T>& A, matrix<T>& b, char uplo)
+{
+  begin(uplo=='L' ? 1 : 2);
+  solve(A,b,0,uplo);
+}
+
+//  solve using tree, same traversal as solve in lu.h
+template<class T>
+void hstore::solve(const hmatrix<T>& A, matrix<T>& b, size_t i, char uplo)
+{
+  if (tree.admiss(i,i))
+  {
+    touch(pair_t(i,i));
+    ::solve(A.find(i,i)->mat,b,mask_t(tree.size(i),pair_t(0,b.ncols())),uplo);
+  }
+  else
+  {
+    //  subdivide matrix
+    size_t i0=(uplo=='L') ? tree.sons(i,0) : tree.sons(i,1);
+    size_t i1=(uplo=='L') ? tree.sons(i,1) : tree.sons(i,0);
+
+    //  A00*x0 = b0
+    solve(A,b,i0,uplo);
+    //  A11*y1 = b1 - A10*y0
+    for (pairiterator it=tree.pair_begin(i1,i0); it!=tree.pair_end(); it++)
+    {
+      touch(*it);
+      sub_mul(*A.find(it->first,it->second),b,b);
+    }
+    solve(A,b,i1,uplo);
+  }
+}
+
+#endif  //  hstore_h
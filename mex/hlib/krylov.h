@@ -0,0 +1,381 @@
+//  krylov.h - Iterative solvers (restarted GMRES, BiCGSTAB, CGS) for H-matrix equations.
+//
+//  The operators are functors y=afun(x) and y=mfun(x) for the matrix A and the
+//  preconditioner inv(M), which are applied to all columns of a block right-hand side at
+//  once, e.g. with a single pass through the blocks of an H-matrix or its LU decomposition.
+//  Each column has its own recurrence and convergence test, converged columns are no longer
+//  updated.  Convergence is checked with the true residual norm(b-A*x)/norm(b).
+//  GMRES uses right preconditioning, BiCGSTAB and CGS follow the Matlab functions.
+//
+//  Statistics for each column as for the Matlab functions gmres, bicgstab, cgs
+//    flag     0 converged, 1 maximal number of iterations, 4 breakdown of recurrence
+//    relres   relative residual norm(b-A*x)/norm(b)
+//    iter     outer and inner iterations for GMRES, (half) iterations otherwise
+
+/* krylovopt op;                       //  options, tol, maxit, restart (0 for no restarts)
+ * std::vector<krylovstat> stat;       //  statistics for columns of b
+ * gmres(afun,mfun,b,x,op,stat);       //  x is initial guess (or empty) on input
+ * bicgstab(afun,mfun,b,x,op,stat);
+ * cgs(afun,mfun,b,x,op,stat);
+ * noprecond<T> mfun;                  //  solution without preconditioner
+ */
+
+#include <vector>
+#include <cmath>
+#include <complex>
+#include <algorithm>
+
+#ifndef krylov_h
+#define krylov_h
+
+#include "hoptions.h"
+#include "basemat.h"
+
+//  options for iterative solvers
+struct krylovopt
+{
+  //  tolerance, maximal number of (outer) iterations, restart for GMRES (0 for none)
+  double tol;
+  size_t maxit, restart;
+
+  krylovopt() : tol(1e-6), maxit(100), restart(0) {}
+};
+
+//  statistics for column of right-hand side
+struct krylovstat
+{
+  int flag;
+  double relres, iter[2];
+
+  krylovstat() : flag(1), relres(0) { iter[0]=iter[1]=0; }
+};
+
+//  identity for solution without preconditioner
+template<class T>
+struct noprecond
+  { const matrix<T>& operator() (const matrix<T>& x) const { return x; } };
+
+
+//  complex conjugate
+inline double conjg(double a) { return a; }
+inline dcmplx conjg(const dcmplx& a) { return std::conj(a); }
+
+//  inner product a(:,j)'*b(:,j)
+template<class T>
+T coldot(const matrix<T>& a, const matrix<T>& b, size_t j)
+{
+  const T *pa=&a(0,j), *pb=&b(0,j);
+  T s=0;
+  for (size_t i=0; i<a.nrows(); i++) s+=conjg(pa[i])*pb[i];
+  return s;
+}
+
+//  norm of column j
+template<class T>
+double colnorm(const matrix<T>& a, size_t j)
+  { return std::sqrt(std::abs(coldot(a,a,j))); }
+
+//  a(:,j) = a(:,j) + s*b(:,j)
+template<class T>
+void colaxpy(const T& s, const matrix<T>& b, matrix<T>& a, size_t j)
+{
+  const T* pb=&b(0,j);
+  T* pa=&a(0,j);
+  for (size_t i=0; i<a.nrows(); i++) pa[i]+=s*pb[i];
+}
+
+//  norms of right-hand sides and initial residual, returns columns still to be solved
+template<class T, class Afun>
+std::vector<char> krylovinit(Afun& afun, const matrix<T>& b, matrix<T>& x, matrix<T>& r,
+    const krylovopt& op, std::vector<double>& nb, std::vector<krylovstat>& stat)
+{
+  size_t nc=b.ncols();
+  if (x.empty()) x=matrix<T>(b.nrows(),nc,(T)0);
+  r=b-afun(x);
+
+  std::vector<char> active(nc,1);
+  nb.resize(nc);  stat.assign(nc,krylovstat());
+  for (size_t j=0; j<nc; j++)
+  {
+    nb[j]=colnorm(b,j);
+    //  zero right-hand side
+    if (nb[j]==0)
+    {
+      std::fill(&x(0,j),&x(0,j)+x.nrows(),(T)0);
+      std::fill(&r(0,j),&r(0,j)+r.nrows(),(T)0);
+      nb[j]=1;
+    }
+    stat[j].relres=colnorm(r,j)/nb[j];
+    if (stat[j].relres<=op.tol) active[j]=0, stat[j].flag=0;
+  }
+  return active;
+}
+
+//  true residuals of candidate columns, converged columns become inactive
+template<class T, class Afun>
+void krylovcheck(Afun& afun, const matrix<T>& b, const matrix<T>& x, const krylovopt& op,
+    const std::vector<double>& nb, std::vector<char>& cand, std::vector<char>& active,
+    std::vector<krylovstat>& stat, double it0, double it1)
+{
+  if (std::find(cand.begin(),cand.end(),1)==cand.end()) return;
+  matrix<T> r=b-afun(x);
+
+  for (size_t j=0; j<cand.size(); j++)
+    if (cand[j])
+    {
+      double relres=colnorm(r,j)/nb[j];
+      if (relres<=op.tol)
+      {
+        active[j]=0;
+        stat[j].flag=0;  stat[j].relres=relres;  stat[j].iter[0]=it0;  stat[j].iter[1]=it1;
+      }
+      cand[j]=0;
+    }
+}
+
+//  relative residuals of columns that did not converge
+template<class T, class Afun>
+void krylovfinish(Afun& afun, const matrix<T>& b, const matrix<T>& x,
+    const std::vector<double>& nb, std::vector<krylovstat>& stat)
+{
+  bool any=false;
+  for (size_t j=0; j<stat.size(); j++) any=any || stat[j].flag;
+  if (!any) return;
+
+  matrix<T> r=b-afun(x);
+  for (size_t j=0; j<stat.size(); j++)
+    if (stat[j].flag) stat[j].relres=colnorm(r,j)/nb[j];
+}
+
+
+//  restarted GMRES with right preconditioning
+template<class T, class Afun, class Mfun>
+void gmres(Afun& afun, Mfun& mfun, const matrix<T>& b, matrix<T>& x,
+           const krylovopt& op, std::vector<krylovstat>& stat)
+{
+  size_t n=b.nrows(), nc=b.ncols();
+  std::vector<double> nb;
+  matrix<T> r;
+  std::vector<char> active=krylovinit(afun,b,x,r,op,nb,stat), cand(nc,0);
+
+  //  length of cycles and maximal number of inner iterations
+  size_t m=std::min(op.restart ? op.restart : op.maxit,n);
+  size_t maxtot=op.restart ? op.maxit*m : m;
+  //  inner iterations of columns in total and in current cycle
+  std::vector<size_t> used(nc,0), k1(nc,0);
+
+  //  Krylov basis, Hessenberg matrices, Givens rotations, rhs of least-squares problems
+  std::vector<matrix<T> > V(m+1);
+  std::vector<matrix<T> > H(nc,matrix<T>(m+1,m,(T)0));
+  matrix<T> c(m,nc), s(m,nc), g(m+1,nc);
+
+  for (size_t it=1; std::find(active.begin(),active.end(),1)!=active.end(); it++)
+  {
+    //  columns iterated in this cycle
+    std::vector<char> inner(nc,0);
+    for (size_t k=0; k<=m; k++) V[k]=matrix<T>(n,nc,(T)0);
+    for (size_t j=0; j<nc; j++)
+      if (active[j] && used[j]<maxtot)
+      {
+        inner[j]=1;  k1[j]=0;
+        double beta=colnorm(r,j);
+        colaxpy((T)(1/beta),r,V[0],j);
+        for (size_t k=0; k<=m; k++) g(k,j)=0;
+        g(0,j)=beta;
+      }
+    if (std::find(inner.begin(),inner.end(),1)==inner.end()) break;
+
+    for (size_t k=0; k<m && std::find(inner.begin(),inner.end(),1)!=inner.end(); k++)
+    {
+      matrix<T> w=afun(mfun(V[k]));
+
+      for (size_t j=0; j<nc; j++)
+        if (inner[j])
+        {
+          matrix<T>& h=H[j];
+          //  Arnoldi process with modified Gram-Schmidt
+          for (size_t i=0; i<=k; i++)
+          {
+            h(i,k)=coldot(V[i],w,j);
+            colaxpy(-h(i,k),V[i],w,j);
+          }
+          double hn=colnorm(w,j);
+          h(k+1,k)=hn;
+          if (hn>0) colaxpy((T)(1/hn),w,V[k+1],j);
+
+          //  apply previous Givens rotations
+          for (size_t i=0; i<k; i++)
+          {
+            T t=c(i,j)*h(i,k)+s(i,j)*h(i+1,k);
+            h(i+1,k)=-conjg(s(i,j))*h(i,k)+c(i,j)*h(i+1,k);
+            h(i,k)=t;
+          }
+          //  new rotation eliminates h(k+1,k)
+          double a=std::abs(h(k,k)), rho=std::sqrt(a*a+hn*hn);
+          if (a==0)
+            c(k,j)=0, s(k,j)=1;
+          else
+            c(k,j)=a/rho, s(k,j)=h(k,k)/a*hn/rho;
+          h(k,k)=c(k,j)*h(k,k)+s(k,j)*hn;
+          h(k+1,k)=0;
+          g(k+1,j)=-conjg(s(k,j))*g(k,j);
+          g(k,j)=c(k,j)*g(k,j);
+
+          k1[j]=k+1;  used[j]++;
+          //  estimated residual, end of cycle for column
+          if (std::abs(g(k+1,j))<=op.tol*nb[j] || hn==0 || used[j]==maxtot) inner[j]=0;
+        }
+    }
+
+    //  update of solution, x = x + inv(M)*V*y with H*y = g
+    matrix<T> z(n,nc,(T)0);
+    for (size_t j=0; j<nc; j++)
+      if (active[j] && k1[j])
+      {
+        const matrix<T>& h=H[j];
+        std::vector<T> y(k1[j]);
+        for (size_t i=k1[j]; i-->0;)
+        {
+          T t=g(i,j);
+          for (size_t l=i+1; l<k1[j]; l++) t-=h(i,l)*y[l];
+          y[i]=t/h(i,i);
+        }
+        for (size_t i=0; i<k1[j]; i++) colaxpy(y[i],V[i],z,j);
+      }
+    x+=mfun(z);
+
+    //  true residual
+    r=b-afun(x);
+    for (size_t j=0; j<nc; j++)
+      if (active[j] && k1[j])
+      {
+        stat[j].relres=colnorm(r,j)/nb[j];
+        stat[j].iter[0]=op.restart ? it : 1;
+        stat[j].iter[1]=op.restart ? k1[j] : used[j];
+        if (stat[j].relres<=op.tol) active[j]=0, stat[j].flag=0;
+        k1[j]=0;
+      }
+  }
+}
+
+//  biconjugate gradients stabilized method
+template<class T, class Afun, class Mfun>
+void bicgstab(Afun& afun, Mfun& mfun, const matrix<T>& b, matrix<T>& x,
+              const krylovopt& op, std::vector<krylovstat>& stat)
+{
+  size_t n=b.nrows(), nc=b.ncols();
+  std::vector<double> nb;
+  matrix<T> r;
+  std::vector<char> active=krylovinit(afun,b,x,r,op,nb,stat), cand(nc,0);
+
+  //  shadow residual, search directions
+  matrix<T> rt=r, p(n,nc,(T)0), v(n,nc,(T)0), s(n,nc,(T)0);
+  std::vector<T> rho(nc,(T)1), alpha(nc,(T)1), omega(nc,(T)1);
+
+  for (size_t it=1; it<=op.maxit && std::find(active.begin(),active.end(),1)!=active.end(); it++)
+  {
+    for (size_t j=0; j<nc; j++)
+      if (active[j])
+      {
+        T rho1=rho[j];
+        rho[j]=coldot(rt,r,j);
+        if (rho[j]==(T)0 || omega[j]==(T)0) { active[j]=0;  stat[j].flag=4;  continue; }
+        //  p = r + beta*(p - omega*v)
+        T beta=(rho[j]/rho1)*(alpha[j]/omega[j]);
+        T *pp=&p(0,j), *pv=&v(0,j), *pr=&r(0,j);
+        for (size_t i=0; i<n; i++) pp[i]=(it==1) ? pr[i] : pr[i]+beta*(pp[i]-omega[j]*pv[i]);
+      }
+    matrix<T> ph=mfun(p);
+    v=afun(ph);
+
+    //  half step
+    for (size_t j=0; j<nc; j++)
+      if (active[j])
+      {
+        T d=coldot(rt,v,j);
+        if (d==(T)0) { active[j]=0;  stat[j].flag=4;  continue; }
+        alpha[j]=rho[j]/d;
+        std::copy(&r(0,j),&r(0,j)+n,&s(0,j));
+        colaxpy(-alpha[j],v,s,j);
+        colaxpy(alpha[j],ph,x,j);
+        if (colnorm(s,j)<=op.tol*nb[j]) cand[j]=1;
+      }
+    krylovcheck(afun,b,x,op,nb,cand,active,stat,it-0.5,0);
+
+    matrix<T> sh=mfun(s), t=afun(sh);
+    //  full step
+    for (size_t j=0; j<nc; j++)
+      if (active[j])
+      {
+        T tt=coldot(t,t,j);
+        if (tt==(T)0) { active[j]=0;  stat[j].flag=4;  continue; }
+        omega[j]=coldot(t,s,j)/tt;
+        colaxpy(omega[j],sh,x,j);
+        std::copy(&s(0,j),&s(0,j)+n,&r(0,j));
+        colaxpy(-omega[j],t,r,j);
+        if (colnorm(r,j)<=op.tol*nb[j]) cand[j]=1;
+      }
+    krylovcheck(afun,b,x,op,nb,cand,active,stat,it,0);
+
+    for (size_t j=0; j<nc; j++) if (active[j]) stat[j].iter[0]=it;
+  }
+  krylovfinish(afun,b,x,nb,stat);
+}
+
+//  conjugate gradients squared method
+template<class T, class Afun, class Mfun>
+void cgs(Afun& afun, Mfun& mfun, const matrix<T>& b, matrix<T>& x,
+         const krylovopt& op, std::vector<krylovstat>& stat)
+{
+  size_t n=b.nrows(), nc=b.ncols();
+  std::vector<double> nb;
+  matrix<T> r;
+  std::vector<char> active=krylovinit(afun,b,x,r,op,nb,stat), cand(nc,0);
+
+  //  shadow residual, search directions
+  matrix<T> rt=r, p(n,nc,(T)0), q(n,nc,(T)0), u(n,nc,(T)0), uq(n,nc,(T)0);
+  std::vector<T> rho(nc,(T)1), alpha(nc,(T)0);
+
+  for (size_t it=1; it<=op.maxit && std::find(active.begin(),active.end(),1)!=active.end(); it++)
+  {
+    for (size_t j=0; j<nc; j++)
+      if (active[j])
+      {
+        T rho1=rho[j];
+        rho[j]=coldot(rt,r,j);
+        if (rho[j]==(T)0) { active[j]=0;  stat[j].flag=4;  continue; }
+        //  u = r + beta*q,  p = u + beta*(q + beta*p)
+        T beta=(it==1) ? (T)0 : rho[j]/rho1;
+        T *pp=&p(0,j), *pq=&q(0,j), *pu=&u(0,j), *pr=&r(0,j);
+        for (size_t i=0; i<n; i++)
+          pu[i]=pr[i]+beta*pq[i], pp[i]=pu[i]+beta*(pq[i]+beta*pp[i]);
+      }
+    matrix<T> vh=afun(mfun(p));
+
+    for (size_t j=0; j<nc; j++)
+      if (active[j])
+      {
+        T d=coldot(rt,vh,j);
+        if (d==(T)0) { active[j]=0;  stat[j].flag=4;  continue; }
+        alpha[j]=rho[j]/d;
+        //  q = u - alpha*vh
+        T *pq=&q(0,j), *pu=&u(0,j), *puq=&uq(0,j), *pv=&vh(0,j);
+        for (size_t i=0; i<n; i++) pq[i]=pu[i]-alpha[j]*pv[i], puq[i]=pu[i]+pq[i];
+      }
+    matrix<T> uh=mfun(uq), qh=afun(uh);
+
+    for (size_t j=0; j<nc; j++)
+      if (active[j])
+      {
+        colaxpy(alpha[j],uh,x,j);
+        colaxpy(-alpha[j],qh,r,j);
+        if (colnorm(r,j)<=op.tol*nb[j]) cand[j]=1;
+      }
+    krylovcheck(afun,b,x,op,nb,cand,active,stat,it,0);
+
+    for (size_t j=0; j<nc; j++) if (active[j]) stat[j].iter[0]=it;
+  }
+  krylovfinish(afun,b,x,nb,stat);
+}
+
+#endif  //  krylov_h
@@ -0,0 +1,186 @@
+//  ldl.h - LDL' decomposition of symmetric hierarchical matrices.
+//
+//  For symmetric storage only the lower block tree, tree.lower(i,j), is kept and the
+//  upper blocks are obtained from A(j,i) = transp(A(i,j)).  The area-weighted Green
+//  functions G(i,j) = g(r_i,r_j)*area(j) are symmetric up to a diagonal scaling with
+//  the boundary element areas, G = S*diag(area) with S = transp(S).  The upper blocks
+//  of G are G(j,i) = diag(1/area)*transp(G(i,j))*diag(area).
+//
+//  For the symmetric matrix S the Crout decomposition S = L*U with a unit upper matrix
+//  U gives U = inv(D)*transp(L), with D = diag(L).  The off-diagonal blocks of U are
+//  obtained anyway during the decomposition and are kept in the upper blocks of the
+//  factor, such that the solution needs no transposes, the diagonal leaves hold the
+//  full LU decomposition.
+
+/* y=mul_sym(G,area,x);             //  multiply G with matrix, lower blocks only
+ * ldl(G,area,A);                   //  LDL' decomposition of G*diag(1/area), L and U blocks
+ * solve_sym(A,area,b);             //  solve G*x = b using LDL' decomposition
+ *
+ * A=transpose(B,i,j);              //  transpose of H-matrix B(i,j) -> A(j,i)
+ * A=subtract_lower(B,C,i,j);       //  B(i,j) - C(i,j) for lower blocks only
+ * diag_ldl(A,d,i);                 //  diagonal D of LDL' decomposition for cluster i
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <utility>
+#include <stdexcept>
+#include <map>
+#include <string>
+#include <fstream>
+#include <cstdlib>
+
+#ifndef ldl_h
+#define ldl_h
+
+#include "hoptions.h"
+#include "clustertree.h"
+#include "basemat.h"
+#include "submatrix.h"
+#include "hmatrix.h"
+#include "lu.h"
+
+/*
+ * Symmetric storage of H-matrices
+ */
+
+//  transpose of H-matrix using tree, B(j,i) = transp(A(i,j))
+template<class T>
+hmatrix<T> transpose(const hmatrix<T>& A, size_t i, size_t j)
+{
+  hmatrix<T> B;
+  //  start at cluster pair (i,j) and move down the tree
+  for (pairiterator it=tree.pair_begin(i,j); it!=tree.pair_end(); it++)
+    B[pair_t(it->second,it->first)]=transpose(*A.find(it->first,it->second));
+
+  return B;
+}
+
+//  subtract two H-matrices for lower blocks only, A(H) - B(H)
+template<class T>
+hmatrix<T> subtract_lower(const hmatrix<T>& A, const hmatrix<T>& B, size_t i, size_t j)
+{
+  hmatrix<T> C;
+  //  start at cluster pair (i,j) and move down the tree
+  for (pairiterator it=tree.pair_begin(i,j); it!=tree.pair_end(); it++)
+    if (tree.lower(it->first,it->second))
+      C[*it]=*A.find(it->first,it->second)-*B.find(it->first,it->second);
+
+  return C;
+}
+
+//  multiplication with matrix for symmetric storage, y = G*x with
+//    G(j,i) = diag(1/area)*transp(G(i,j))*diag(area)
+template<class T>
+matrix<T> mul_sym(const hmatrix<T>& G, const matrix<double>& area, const matrix<T>& x)
+{
+  typedef typename std::map<pair_t,submatrix<T> >::const_iterator const_iterator;
+  matrix<T> y=matrix<T>(tree.size(0).second,x.ncols(),(T)0);
+  //  inverse areas
+  matrix<double> ainv(area.nrows(),area.ncols());
+  for (size_t i=0; i<area.nrows()*area.ncols(); i++) ainv[i]=1/area[i];
+
+  //  loop over lower sub-matrices
+  for (const_iterator it=G.begin(); it!=G.end(); it++)
+    if (tree.lower(it->first.first,it->first.second))
+    {
+      //  y(i) = y(i) + G(i,j)*x(j)
+      add_mul(it->second,x,y);
+      //  y(j) = y(j) + G(j,i)*x(i) using partner of off-diagonal block
+      if (it->first.first!=it->first.second)
+        add_mul(scale(transpose(it->second),ainv,area),x,y);
+    }
+  return y;
+}
+
+/*
+ * LDL' decomposition
+ */
+
+//  diagonal of LDL' decomposition for cluster i, d = diag(L(i,i))
+template<class T>
+void diag_ldl(const hmatrix<T>& A, matrix<T>& d, size_t i)
+{
+  //  loop over diagonal leaves
+  for (pairiterator it=tree.pair_begin(i,i); it!=tree.pair_end(); it++)
+    if (it->first==it->second)
+    {
+      const matrix<T>& mat=A.find(it->first,it->second)->mat;
+      size_t first=tree.size(it->first).first;
+
+      for (size_t k=0; k<mat.nrows(); k++) d[first+k]=mat(k,k);
+    }
+}
+
+//  LDL' decomposition of symmetric H-matrix with lower blocks only
+template<class T>
+void ldl(const hmatrix<T>& B, hmatrix<T>& A, matrix<T>& d, size_t i=0)
+{
+  //  sons of cluster
+  size_t i0=tree.sons(i,0), i1=tree.sons(i,1);
+
+  //  full matrix ?
+  if (i0==0 && i1==0)
+  {
+    A[pair_t(i,i)]=submatrix<T>(i,i,lu(B.find(i,i)->mat));
+    diag_ldl(A,d,i);
+  }
+  else
+  {
+    //  L00*U00 = B00
+    ldl(B,A,d,i0);
+    //  L00*U01 = B01,  with B01 = transp(B10)
+    hmatrix<T> U;
+    lsolve(transpose(B,i1,i0),A,U,i0,i1,'L');
+    //  L10 = transp(U01)*D00
+    matrix<T> empty;
+    for (pairiterator it=tree.pair_begin(i1,i0); it!=tree.pair_end(); it++)
+      A[*it]=scale(transpose(*U.find(it->second,it->first)),empty,d);
+    //  L11*U11 = B11 - L10*U01,  lower blocks only
+    hmatrix<T> C;
+    add_mul(A,U,C,i1,i1,i0,true);
+    //  keep U01 = inv(D00)*transp(L10) for solution
+    for (pairiterator it=tree.pair_begin(i0,i1); it!=tree.pair_end(); it++)
+      A[*it]=*U.find(it->first,it->second);
+    ldl(subtract_lower(B,C,i1,i1),A,d,i1);
+  }
+}
+
+//  LDL' decomposition of G*diag(1/area), with G(i,j) = g(r_i,r_j)*area(j)
+template<class T>
+void ldl(const hmatrix<T>& G, const matrix<double>& area, hmatrix<T>& A)
+{
+  typedef typename std::map<pair_t,submatrix<T> >::const_iterator const_iterator;
+  hmatrix<T> S;
+  //  inverse areas
+  matrix<double> ainv(area.nrows(),area.ncols()), empty;
+  for (size_t i=0; i<area.nrows()*area.ncols(); i++) ainv[i]=1/area[i];
+
+  //  symmetric matrix S = G*diag(1/area), lower blocks only
+  for (const_iterator it=G.begin(); it!=G.end(); it++)
+    if (tree.lower(it->first.first,it->first.second))
+      S[it->first]=scale(it->second,empty,ainv);
+
+  //  diagonal of LDL' decomposition
+  matrix<T> d(tree.size(0).second,1);
+  ldl(S,A,d);
+}
+
+/*
+ * Solve system of linear equations using LDL' decomposition
+ */
+
+//  solve G*x = b using LDL' decomposition of G*diag(1/area), override b
+template<class T>
+void solve_sym(const hmatrix<T>& A, const matrix<double>& area, matrix<T>& b, char key='N')
+{
+  //  solve L*U*y = b, with upper blocks U = inv(D)*transp(L) stored by ldl
+  if (key=='L' || key=='N') solve(A,b,0,'L');
+  if (key=='U' || key=='N') solve(A,b,0,'U');
+  //  x = inv(diag(area))*y
+  if (key=='U' || key=='N')
+    for (size_t j=0; j<b.ncols(); j++)
+    for (size_t i=0; i<b.nrows(); i++) b(i,j)/=area[i];
+}
+
+#endif  //  ldl_h
@@ -4,7 +4,6 @@
 
 #include "hoptions.h"
 #include "basemat.h"
-#include "lapack.h"
 
 /*
  * Double precision matrix specializations
@@ -135,3 +134,31 @@ void solve(const matrix<dcmplx>& A, matrix<dcmplx>& b, mask_t maskb, char uplo)
   F77_NAME(ztrsm)
     (&side, &uplo, &transA, &diag, &m, &n, (const double*)&pone, (const double*)A.val, &m, pb, &ldb);
 }
+
+
+/*
+ * Single precision specializations, LU decompositions stored in single precision (mixed.h)
+ */
+
+//  solve for x,  A*x = b
+void solve(const matrix<float>& A, matrix<float>& b, mask_t maskb, char uplo)
+{  
+  ptrdiff_t m=A.nrows(), n=b.ncols(), ldb=b.nrows();
+  float pone=1;
+  char side='L', transA='N', diag=(uplo=='L') ? 'N' : 'U';
+  float *pb=&b(maskb.rbegin,maskb.cbegin);
+  //  solve op( A )*x = alpha*b
+  F77_NAME(strsm)(&side, &uplo, &transA, &diag, &m, &n, &pone, A.val, &m, pb, &ldb);
+}
+
+//  solve for x,  A*x = b
+void solve(const matrix<fcmplx>& A, matrix<fcmplx>& b, mask_t maskb, char uplo)
+{  
+  ptrdiff_t m=A.nrows(), n=b.ncols(), ldb=b.nrows();
+  fcmplx pone=1;
+  char side='L', transA='N', diag=(uplo=='L') ? 'N' : 'U';
+  float *pb=(float*)&b(maskb.rbegin,maskb.cbegin);
+  //  solve op( A )*x = alpha*b
+  F77_NAME(ctrsm)
+    (&side, &uplo, &transA, &diag, &m, &n, (const float*)&pone, (const float*)A.val, &m, pb, &ldb);
+}
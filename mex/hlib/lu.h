@@ -8,6 +8,7 @@
 #include <string>
 #include <fstream>
 #include <cstdlib>
+#include <vector>
 
 #ifndef lu_h
 #define lu_h
@@ -29,6 +30,9 @@ matrix<dcmplx> solve(char, const matrix<dcmplx>&, const mask_t&, char,
 
 void solve(const matrix<double>&, matrix<double>&, mask_t, char);
 void solve(const matrix<dcmplx>&, matrix<dcmplx>&, mask_t, char);
+//  single precision LU decompositions (mixed.h)
+void solve(const matrix<float>&,  matrix<float>&,  mask_t, char);
+void solve(const matrix<fcmplx>&, matrix<fcmplx>&, mask_t, char);
 
 /*
  * LU decomposition for sub-matrices
@@ -47,6 +51,8 @@ submatrix<T> rsolve(const submatrix<T>& B, const submatrix<T>& A, size_t i, size
     
     return submatrix<T>(i,j,lhs,rhs);
   }
+  //  empty submatrix
+  return submatrix<T>();
 }
 
 //  solve for X, A*X = B
@@ -62,6 +68,8 @@ submatrix<T> lsolve(const submatrix<T>& B, const submatrix<T>& A, size_t i, size
     
     return submatrix<T>(i,j,lhs,rhs);
   }
+  //  empty submatrix
+  return submatrix<T>();
 }
 
 /*
@@ -198,12 +206,52 @@ void lu(const hmatrix<T>& B, hmatrix<T>& A, size_t i=0)
  * Solve system of linear equations using L and U matrices
  */
 
+//  b(i1) = b(i1) - A(i1,i0)*b(i0), override b
+//    blocks are multiplied in parallel, rows of different blocks may overlap such that
+//    the results are subtracted one after the other
+template<class T>
+void sub_mul(const hmatrix<T>& A, matrix<T>& b, size_t i1, size_t i0)
+{
+  //  start at cluster pair (i1,i0) and move down the tree
+  std::vector<pair_t> ind=tree.pair_begin(i1,i0).ind;
+  
+  if (nthreads()==1 || inparallel() || ind.size()==1)
+    for (size_t k=0; k<ind.size(); k++) sub_mul(*A.find(ind[k].first,ind[k].second),b,b);
+  else
+  {
+    #pragma omp parallel for schedule(dynamic)
+    for (ptrdiff_t k=0; k<(ptrdiff_t)ind.size(); k++)
+    {
+      const submatrix<T>& sub=*A.find(ind[k].first,ind[k].second);
+      matrix<T> y=mul(sub,b);
+      #pragma omp critical(sub_mul)
+      sub_rows(y,b,sub.row);
+    }
+  }
+}
+
 //  solve A*x = b, override b
+//    for many right-hand sides the columns of b are solved in parallel (each thread
+//    passes through all blocks, thus panels must be wide enough to pay off),
+//    otherwise the blocks of the off-diagonal updates are multiplied in parallel
 template<class T>
 void solve(const hmatrix<T>& A, matrix<T>& b, size_t i, char uplo)
 {
-  if (tree.admiss(i,i))
-    solve(A.find(i,i)->mat,b,mask_t(tree.size(i),pair_t(0,b.ncols())),uplo);
+  size_t m=b.nrows(), n=b.ncols(), nt=nthreads();
+  
+  if (i==0 && nt>1 && n>=32*nt && !inparallel())
+  {
+    #pragma omp parallel for
+    for (ptrdiff_t t=0; t<(ptrdiff_t)nt; t++)
+    {
+      //  view of columns of b
+      matrix<T> x;
+      x.view(m,(t+1)*n/nt-t*n/nt,&b(0,t*n/nt));
+      solve(A,x,0,uplo);
+    }
+  }
+  else if (tree.admiss(i,i))
+    solve(A.find(i,i)->mat,b,mask_t(tree.size(i),pair_t(0,n)),uplo);
   else
   { 
     //  subdivide matrix
@@ -213,9 +261,7 @@ void solve(const hmatrix<T>& A, matrix<T>& b, size_t i, char uplo)
     //  A00*x0 = b0
     solve(A,b,i0,uplo);
     //  A11*y1 = b1 - A10*y0
-    //    start at cluster pair (i1,i0) and move down the tree
-    for (pairiterator it=tree.pair_begin(i1,i0); it!=tree.pair_end(); it++) 
-      add_mul(-*A.find(it->first,it->second),b,b);
+    sub_mul(A,b,i1,i0);
     solve(A,b,i1,uplo);
   }  
 }
@@ -0,0 +1,156 @@
+//  mixed.h - H-matrices stored in single precision, accumulation in double precision.
+//
+//  A preconditioner needs only a few digits, storing the blocks of its LU decomposition
+//  in single precision halves memory and bandwidth of multiplications and solutions.
+//  Blocks of hmatrix<float> or hmatrix<fcmplx> are multiplied with single precision
+//  copies of the vectors, the results of the blocks are added to double precision
+//  vectors.  The triangular solutions keep the right-hand side in double precision and
+//  maintain a single precision copy of the rows already solved.  Iterative refinement
+//  computes the residual with the double precision H-matrix and corrects the solution
+//  until the tolerance is reached.
+
+/* Z=recast<fcmplx>(A);                 //  H-matrix (or submatrix) in other precision
+ * y=mixed_mul(Z,x);                    //  multiplication, x and y in double precision
+ * mixed_solve(LU,b,key);               //  solve using LU decomposition in single precision
+ * n=refine(afun,LU,b,tol,maxit);       //  same with iterative refinement, afun(x) returns
+ *                                      //    A*x, returns number of refinement steps
+ */
+
+#include <cmath>
+
+#ifndef mixed_h
+#define mixed_h
+
+#include "hoptions.h"
+#include "basemat.h"
+#include "clustertree.h"
+#include "hmatrix.h"
+#include "lu.h"
+
+//  convert submatrix to other precision
+template<class S, class T>
+submatrix<S> recast(const submatrix<T>& A)
+{
+  submatrix<S> B;
+  B.row=A.row;  B.col=A.col;
+  B.mat=recast<S>(A.mat);  B.lhs=recast<S>(A.lhs);  B.rhs=recast<S>(A.rhs);
+
+  return B;
+}
+
+//  convert H-matrix to other precision
+template<class S, class T>
+hmatrix<S> recast(const hmatrix<T>& A)
+{
+  hmatrix<S> B;
+  for (typename hmatrix<T>::const_iterator it=A.begin(); it!=A.end(); it++)
+    B[it->first]=recast<S>(it->second);
+
+  return B;
+}
+
+//  add rows of single precision matrix z to rows of cluster i, y = y + s*z
+template<class S, class T>
+void add_rows(const matrix<S>& z, matrix<T>& y, size_t i, double s)
+{
+  size_t r0=tree.size(i).first;
+  for (size_t c=0; c<z.ncols(); c++)
+  for (size_t r=0; r<z.nrows(); r++) y(r0+r,c)+=s*(T)z(r,c);
+}
+
+//  multiplication of single precision H-matrix with matrix, y = A*x
+template<class S, class T>
+matrix<T> mixed_mul(const hmatrix<S>& A, const matrix<T>& x)
+{
+  matrix<S> xs=recast<S>(x);
+  matrix<T> y(tree.size(0).second,x.ncols(),(T)0);
+
+  tic;
+  //  products of blocks in single precision, sum in double precision
+  for (typename hmatrix<S>::const_iterator it=A.begin(); it!=A.end(); it++)
+    add_rows(mul(it->second,xs),y,it->second.row,+1);
+  toc("mixed_mul");
+
+  return y;
+}
+
+//  solve A*x = b using tree, override b, xs is single precision copy of solved rows
+template<class S, class T>
+void mixed_solve(const hmatrix<S>& A, matrix<T>& b, matrix<S>& xs, size_t i, char uplo)
+{
+  if (tree.admiss(i,i))
+  {
+    //  diagonal block in single precision
+    mask_t m(tree.size(i),pair_t(0,b.ncols()));
+    matrix<S> x=recast<S>(mask(b,m));
+    solve(A.find(i,i)->mat,x,x.size(),uplo);
+    //  save solution in double and single precision
+    copy(recast<T>(x),x.size(),b,m);
+    copy(x,x.size(),xs,m);
+  }
+  else
+  {
+    //  subdivide matrix
+    size_t i0=(uplo=='L') ? tree.sons(i,0) : tree.sons(i,1);
+    size_t i1=(uplo=='L') ? tree.sons(i,1) : tree.sons(i,0);
+
+    //  A00*x0 = b0
+    mixed_solve(A,b,xs,i0,uplo);
+    //  A11*y1 = b1 - A10*y0
+    for (pairiterator it=tree.pair_begin(i1,i0); it!=tree.pair_end(); it++)
+    {
+      const submatrix<S>& sub=*A.find(it->first,it->second);
+      add_rows(mul(sub,xs),b,sub.row,-1);
+    }
+    mixed_solve(A,b,xs,i1,uplo);
+  }
+}
+
+//  solve using single precision LU decomposition, override b
+//    key 'L' for lower, 'U' for upper matrix, 'N' for both
+template<class S, class T>
+void mixed_solve(const hmatrix<S>& A, matrix<T>& b, char key)
+{
+  matrix<S> xs(b.nrows(),b.ncols());
+
+  tic;
+  if (key=='L' || key=='N') mixed_solve(A,b,xs,0,'L');
+  if (key=='U' || key=='N') mixed_solve(A,b,xs,0,'U');
+  toc("mixed_solve");
+}
+
+//  Frobenius norm of matrix
+template<class T>
+double frobnorm(const matrix<T>& a)
+{
+  double s=0;
+  for (const T* p=a.begin(); p!=a.end(); p++) { double t=std::abs(*p);  s+=t*t; }
+  return std::sqrt(s);
+}
+
+//  solve A*x = b with iterative refinement, override b
+//    afun(x) returns A*x in double precision, LU is single precision decomposition of A,
+//    returns number of refinement steps
+template<class F, class S, class T>
+size_t refine(const F& afun, const hmatrix<S>& LU, matrix<T>& b, double tol, size_t maxit)
+{
+  matrix<T> x=b;
+  double nb=frobnorm(b);
+  mixed_solve(LU,x,'N');
+
+  size_t it;
+  for (it=0; it<maxit; it++)
+  {
+    //  residual in double precision
+    matrix<T> r=b-afun(x);
+    if (frobnorm(r)<=tol*nb) break;
+    //  correction
+    mixed_solve(LU,r,'N');
+    x+=r;
+  }
+  b.swap(x);
+
+  return it;
+}
+
+#endif  //  mixed_h
@@ -16,10 +16,14 @@
  * 
  * C=A+B; C=A-B;        //  basic arithmetic operations
  * add_mul(A,x,y);      //  y = y + A*x
+ * sub_mul(A,x,y);      //  y = y - A*x
+ * y=mul(A,x);          //  y = A*x, rows of cluster A.row only
  * C=add(A,B);          //  summation of sub-matrices
  * A+=B;                //  add sub-matrices and compress low-rank matrices using ACA 
  * C=mul(A,B,i,j,k);    //  multiplication C(i,j) = A(i,k)*B(k,j), with i,j,k being sub-indices
  * A=cat(Amatrix,i,j);  //  concatenate matrix with sub-matrices to larger sub-matrix
+ * At=transpose(A);     //  transpose of submatrix, At(j,i)
+ * B=scale(A,dr,dc);    //  diag(dr)*A*diag(dc), vectors with full size (cluster ordering)
  */
 
 #include <iostream>
@@ -37,6 +41,7 @@
 #include "basemat.h"
 #include "clustertree.h"
 #include "aca.h"
+#include "hstats.h"
 
 template<class T>
 class submatrix 
@@ -64,15 +69,15 @@ public:
     
   //  number of rows and columns
   size_t nrows() const { pair_t siz=tree.size(row); return siz.second-siz.first; }
-  size_t ncols() const { pair_t siz=tree.size(col); return siz.second-siz.first; }      
+  size_t ncols() const { pair_t siz=tree.csize(col); return siz.second-siz.first; }      
   //  size of submatrix 
   mask_t  size() const { return mask_t(0,nrows(),0,ncols()); }
   mask_t lsize() const { return mask_t(0,nrows(),0,lhs.ncols()); }
   mask_t rsize() const { return mask_t(0,ncols(),0,rhs.ncols()); }
   //  size of matrix wrt second cluster (r,c)
-  mask_t  size(size_t r, size_t c) const { return mask_t(tree.size(r,row),tree.size(c,col)); }
+  mask_t  size(size_t r, size_t c) const { return mask_t(tree.size(r,row),tree.csize(c,col)); }
   mask_t lsize(size_t r, size_t c) const { return mask_t(tree.size(r,row),pair_t(0,lhs.ncols())); }
-  mask_t rsize(size_t r, size_t c) const { return mask_t(tree.size(c,col),pair_t(0,rhs.ncols())); }
+  mask_t rsize(size_t r, size_t c) const { return mask_t(tree.csize(c,col),pair_t(0,rhs.ncols())); }
  
   //  rank of submatrix
   size_t rank() const { ASSERT(flag()==flagRk); return lhs.ncols(); }
@@ -117,8 +122,13 @@ submatrix<T> convert(const submatrix<T>& A, short cflag)
 template<class T>
 submatrix<T> truncate(submatrix<T>& A)
 {
-  //  truncation using aca
-  if (A.flag()==flagRk) aca(A.lhs,A.rhs,hopts.tol);
+  //  truncation using aca, record rank before and after truncation
+  if (A.flag()==flagRk)
+  {
+    size_t k=A.lhs.ncols();
+    aca(A.lhs,A.rhs,hopts.tol);
+    acastat.truncate(k,A.lhs.ncols());
+  }
     
   return A;
 }
@@ -133,12 +143,49 @@ submatrix<T> mask(const submatrix<T>& A, size_t r, size_t c)
     return submatrix<T>(r,c,mask(A.lhs,A.lsize(r,c)),mask(A.rhs,A.rsize(r,c)));
 }
 
+//  transpose of submatrix
+template<class T>
+submatrix<T> transpose(const submatrix<T>& A)
+{
+  if (A.flag()==flagFull)
+    return submatrix<T>(A.col,A.row,transpose(A.mat));
+  else
+    return submatrix<T>(A.col,A.row,A.rhs,A.lhs);
+}
+
+//  scale submatrix with diagonal matrices, diag(dr)*A*diag(dc)
+//    dr and dc are vectors for all rows or columns, empty vectors are ignored
+template<class T, class D>
+submatrix<T> scale(const submatrix<T>& A, const matrix<D>& dr, const matrix<D>& dc)
+{
+  submatrix<T> B(A);
+  //  offsets for rows and columns
+  size_t r=tree.size(A.row).first, c=tree.csize(A.col).first;
+  
+  if (B.flag()==flagFull)
+  {
+    if (!dr.empty()) for (size_t j=0; j<B.mat.ncols(); j++)
+                     for (size_t i=0; i<B.mat.nrows(); i++) B.mat(i,j)*=dr[r+i];
+    if (!dc.empty()) for (size_t j=0; j<B.mat.ncols(); j++)
+                     for (size_t i=0; i<B.mat.nrows(); i++) B.mat(i,j)*=dc[c+j];
+  }
+  else
+  {
+    if (!dr.empty()) for (size_t k=0; k<B.lhs.ncols(); k++)
+                     for (size_t i=0; i<B.lhs.nrows(); i++) B.lhs(i,k)*=dr[r+i];
+    if (!dc.empty()) for (size_t k=0; k<B.rhs.ncols(); k++)
+                     for (size_t j=0; j<B.rhs.nrows(); j++) B.rhs(j,k)*=dc[c+j];
+  }
+  
+  return B;
+}
+
 // submatrix-matrix multiplication, y = y + A*x
 template<class T>
 void add_mul(const submatrix<T>& A, const matrix<T>& x, matrix<T>& y)
 {
   //  mask for vectors
-  mask_t xmask=mask_t(tree.size(A.col),pair_t(0,x.ncols()));
+  mask_t xmask=mask_t(tree.csize(A.col),pair_t(0,x.ncols()));
   mask_t ymask=mask_t(tree.size(A.row),pair_t(0,y.ncols()));
   
   if (A.flag()==flagFull)
@@ -153,6 +200,51 @@ void add_mul(const submatrix<T>& A, const matrix<T>& x, matrix<T>& y)
   }
 }
 
+// submatrix-matrix multiplication, y = A*x with rows of cluster A.row only
+template<class T>
+matrix<T> mul(const submatrix<T>& A, const matrix<T>& x)
+{
+  //  mask for vector
+  mask_t xmask=mask_t(tree.csize(A.col),pair_t(0,x.ncols()));
+  
+  if (A.flag()==flagFull)
+    return mul(A.mat,A.size(),'N',x,xmask,'N');
+  else
+  {
+    //  S = transp(A.R)*x
+    matrix<T> S=mul(A.rhs,A.rsize(),'T',x,xmask,'N');
+    return mul(A.lhs,A.lsize(),'N',S,S.size(),'N');
+  }
+}
+
+//  subtract matrix z from rows of cluster i, y = y - z
+template<class T>
+void sub_rows(const matrix<T>& z, matrix<T>& y, size_t i)
+{
+  size_t r0=tree.size(i).first;
+  for (size_t c=0; c<z.ncols(); c++)
+  for (size_t r=0; r<z.nrows(); r++) y(r0+r,c)-=z(r,c);
+}
+
+// submatrix-matrix multiplication, y = y - A*x, without negating A
+template<class T>
+void sub_mul(const submatrix<T>& A, const matrix<T>& x, matrix<T>& y)
+{
+  if (A.flag()==flagFull)
+    sub_rows(mul(A,x),y,A.row);
+  else 
+  {
+    //  mask for vectors
+    mask_t xmask=mask_t(tree.csize(A.col),pair_t(0,x.ncols()));
+    mask_t ymask=mask_t(tree.size(A.row),pair_t(0,y.ncols()));
+    //  S = -transp(A.R)*x
+    matrix<T> S=mul(A.rhs,A.rsize(),'T',x,xmask,'N');
+    S=-S;
+    //  y = y + A.L*S
+    add_mul(A.lhs,A.lsize(),'N',S,S.size(),'N',y,ymask);
+  }
+}
+
 //  submatrix summation, A += B
 template<class T>
 const submatrix<T>& submatrix<T>::operator+= (const submatrix<T>& A)
@@ -4,6 +4,7 @@
 #include "hoptions.h"
 #include "clustertree.h"
 #include "hmatrix.h"
+#include "hrecord.h"
 
 using namespace std;
 
@@ -16,9 +17,14 @@ struct hoptions hopts = { 1e-6, 500 };
 map<string,double> timer;
 
 
-//  add two H-matrices, deal with calling sequence: tree, A1, L1, R1, A1, L1, R1, [op]
-void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+//  add two H-matrices, deal with calling sequence: tree, A1, L1, R1, A1, L1, R1, [op],
+//    optional fourth output with memory statistics
+static void mexbody(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
 {
+  //  record inputs for replay (hrecord.h)
+  record("hmatadd",nlhs,nrhs,prhs);
+  //  peak memory and budget of this call (hmemory.h)
+  memstat.reset();
   //  cluster tree
   tree.getmex(prhs[0],ind1,ind2);
   //  options
@@ -26,6 +32,7 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
   {
     if (mxGetField(prhs[7],0,"htol")) hopts.tol=mxGetScalar(mxGetField(prhs[7],0,"htol"));
     if (mxGetField(prhs[7],0,"kmax")) hopts.kmax=(size_t)mxGetScalar(mxGetField(prhs[7],0,"kmax"));
+    memstat.getmex(prhs[7]);
   }
   
   //  real input ?
@@ -33,8 +40,8 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
   {  
     hmatrix<double> A,B;
     //  get input
-    A=hmatrix<double>::getmex(&prhs[1]);
-    B=hmatrix<double>::getmex(&prhs[4]);  
+    A.mexview(&prhs[1]);
+    B.mexview(&prhs[4]);  
     //  set output
     setmex<double>(A+B,plhs);
   }
@@ -42,12 +49,24 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
   {
     hmatrix<dcmplx> A,B;
     //  get input
-    A=hmatrix<dcmplx>::getmex(&prhs[1]);
-    B=hmatrix<dcmplx>::getmex(&prhs[4]);  
+    A.mexview(&prhs[1]);
+    B.mexview(&prhs[4]);  
     //  set output
     setmex<dcmplx>(A+B,plhs);    
   }
   
-  //  clear globals
-  tree.clear(); ind1.clear(); ind2.clear(); timer.clear();  
+  //  memory statistics
+  if (nlhs>3) plhs[3]=setmex(memstat);
+}
+
+//  clear globals, also after errors (see mexcall in hoptions.h)
+static void clearglobals()
+{
+  tree.clear(); ind1.clear(); ind2.clear(); timer.clear();
+}
+
+//  MEX function, errors such as exceeded memory budget raised after clean-up (hoptions.h)
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  mexcall(mexbody,clearglobals,nlhs,plhs,nrhs,prhs);
 }
@@ -4,6 +4,7 @@
 #include "hoptions.h"
 #include "clustertree.h"
 #include "hmatrix.h"
+#include "hrecord.h"
 
 using namespace std;
 
@@ -16,25 +17,44 @@ struct hoptions hopts = { 1e-6, 500 };
 map<string,double> timer;
 
 
-//  convert H-matrix to full matrix, deal with calling sequence: tree, A, L, R
-void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+//  convert H-matrix to full matrix, deal with calling sequence: tree, A, L, R,
+//    optional second output with memory statistics
+static void mexbody(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
 {
+  //  record inputs for replay (hrecord.h)
+  record("hmatfull",nlhs,nrhs,prhs);
+  //  peak memory and budget of this call (hmemory.h)
+  memstat.reset();
   tree.getmex(prhs[0],ind1,ind2);
   
   //  real input ?
   if (!mxIsComplex(mxGetCell(prhs[1],0)))
   {
-    hmatrix<double> A=hmatrix<double>::getmex(&prhs[1]);
+    hmatrix<double> A;
+    A.mexview(&prhs[1]);
     //  expand matrix to full size
     plhs[0]=setmex(full(A));
   }
   else  //  complex input
   {
-    hmatrix<dcmplx> A=hmatrix<dcmplx>::getmex(&prhs[1]);
+    hmatrix<dcmplx> A;
+    A.mexview(&prhs[1]);
     //  expand matrix to full size
     plhs[0]=setmex(full(A));    
   }
   
-  //  clear globals
+  //  memory statistics
+  if (nlhs>1) plhs[1]=setmex(memstat);
+}
+
+//  clear globals, also after errors (see mexcall in hoptions.h)
+static void clearglobals()
+{
   tree.clear(); ind1.clear(); ind2.clear(); timer.clear();
 }
+
+//  MEX function, errors such as exceeded memory budget raised after clean-up (hoptions.h)
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  mexcall(mexbody,clearglobals,nlhs,plhs,nrhs,prhs);
+}
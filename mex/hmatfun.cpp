@@ -46,7 +46,7 @@ public:
   hmatrix<T> eval(size_t i, size_t j, double tol);
   //  initialize cluster
   void init(size_t r, size_t c) 
-    { siz=mask_t(tree.size(row=r),tree.size(col=c)); }
+    { siz=mask_t(tree.size(row=r),tree.csize(col=c)); }
   
 private:
   //  get values from Matlab function
@@ -85,23 +85,30 @@ hmatrix<T> acamex<T>::eval(size_t i, size_t j, double tol)
   return H;
 }
 
-//  fill Green function using aca, deal with calling sequence: tree, fun, zflag, i, j, [op]
-void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+//  fill Green function using aca, deal with calling sequence: tree, fun, zflag, i, j, [op],
+//    optional third output with memory statistics (see hmemory.h)
+static void mexbody(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
 {
+  //  peak memory and budget of this call (hmemory.h)
+  memstat.reset();
   //  cluster tree
   tree.getmex(prhs[0],ind1,ind2);
   //  complex flag
-  bool zflag=*(const bool*)mxGetPr(prhs[2]);
+  bool zflag=*(const bool*)mxGetData(prhs[2]);
   //  starting clusters
-  size_t i=*(const size_t*)mxGetPr(prhs[3]);
-  size_t j=*(const size_t*)mxGetPr(prhs[4]);
+  size_t i=*(const size_t*)mxGetData(prhs[3]);
+  size_t j=*(const size_t*)mxGetData(prhs[4]);
   //  set tolerance and maximum rank for low-rank matrix
   if (nrhs==6)
   {
     if (mxGetField(prhs[5],0,"htol")) hopts.tol=mxGetScalar(mxGetField(prhs[5],0,"htol"));
     if (mxGetField(prhs[5],0,"kmax")) hopts.kmax=(size_t)mxGetScalar(mxGetField(prhs[5],0,"kmax"));
+    memstat.getmex(prhs[5]);
   }  
   
+  //  allocations tagged for memory statistics
+  memscope scope(memFill);
+  
   //  create cell arrays for low-rank matrices
   plhs[0]=mxCreateCellMatrix((mwSize)ind2.nrows(),1);
   plhs[1]=mxCreateCellMatrix((mwSize)ind2.nrows(),1);  
@@ -136,8 +143,8 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
     }              
   }
   
-  //  clear globals
-  tree.clear(); ind1.clear(); ind2.clear(); timer.clear();  
+  //  memory statistics
+  if (nlhs>2) plhs[2]=setmex(memstat);
 }
 
 
@@ -156,13 +163,13 @@ void acamex<double>::getmex(const matrix<size_t>& r, const matrix<size_t>& c, do
   rhs[1]=mxCreateNumericMatrix(r.nrows(),1,mxUINT64_CLASS,mxREAL);
   rhs[2]=mxCreateNumericMatrix(c.nrows(),1,mxUINT64_CLASS,mxREAL);
   //  copy requested rows and columns to Matlab arrays
-  std::copy(r.begin(),r.end(),(size_t*)mxGetPr(rhs[1]));
-  std::copy(c.begin(),c.end(),(size_t*)mxGetPr(rhs[2]));
+  std::copy(r.begin(),r.end(),(size_t*)mxGetData(rhs[1]));
+  std::copy(c.begin(),c.end(),(size_t*)mxGetData(rhs[2]));
   
   //  call Matlab function
   mexCallMATLAB(1,&lhs,3,rhs,"feval");
   //  copy return values
-  p=(const double*)mxGetPr(lhs);
+  p=(const double*)mxGetData(lhs);
   std::copy(p,p+r.nrows(),val);
   
   //  clean up
@@ -181,19 +188,30 @@ void acamex<dcmplx>::getmex(const matrix<size_t>& r, const matrix<size_t>& c, dc
   rhs[1]=mxCreateNumericMatrix(r.nrows(),1,mxUINT64_CLASS,mxREAL);
   rhs[2]=mxCreateNumericMatrix(c.nrows(),1,mxUINT64_CLASS,mxREAL);
   //  copy requested rows and columns to Matlab arrays
-  std::copy(r.begin(),r.end(),(size_t*)mxGetPr(rhs[1]));
-  std::copy(c.begin(),c.end(),(size_t*)mxGetPr(rhs[2]));
+  std::copy(r.begin(),r.end(),(size_t*)mxGetData(rhs[1]));
+  std::copy(c.begin(),c.end(),(size_t*)mxGetData(rhs[2]));
   
   //  call Matlab function
   mexCallMATLAB(1,&lhs,3,rhs,"feval");
-  //  copy return values
-  ptrdiff_t n=r.nrows(), ione=1, itwo=2;
-  //  copy real and imaginary parts
-  F77_NAME(dcopy)(&n, mxGetPr(lhs), &ione, (double*)val,   &itwo);
-  F77_NAME(dcopy)(&n, mxGetPi(lhs), &ione, (double*)val+1, &itwo);
+  //  copy return values, no conversion for interleaved complex API
+  matrix<dcmplx> a;
+  a.mexview(lhs);
+  std::copy(a.begin(),a.begin()+r.nrows(),val);
   
   //  clean up
   mxDestroyArray(lhs);
   mxDestroyArray(rhs[1]);
   mxDestroyArray(rhs[2]);
 }
+
+//  clear globals, also after errors (see mexcall in hoptions.h)
+static void clearglobals()
+{
+  tree.clear(); ind1.clear(); ind2.clear(); timer.clear();
+}
+
+//  MEX function, errors such as exceeded memory budget raised after clean-up (hoptions.h)
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  mexcall(mexbody,clearglobals,nlhs,plhs,nrhs,prhs);
+}
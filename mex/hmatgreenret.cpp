@@ -4,8 +4,10 @@
 #include "hoptions.h"
 #include "clustertree.h"
 #include "hmatrix.h"
+#include "hstats.h"
 #include "particle.h"
 #include "acagreen.h"
+#include "hrecord.h"
 
 using namespace std;
 
@@ -18,44 +20,74 @@ struct hoptions hopts = { 1e-6, 500 };
 map<string,double> timer;
 
 //  fill Green function using aca, deal with calling sequence: p, tree, flag, i, j, wav, [op]
-void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+//    for rectangular matrices p is a structure array with particles for rows and columns,
+//    with op.hsym only the lower block tree of G is filled (symmetric storage, see ldl.h)
+//    optional third output with block, ACA and memory statistics (see hstats.h, hmemory.h),
+//    op.maxmem is the memory budget in bytes
+static void mexbody(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
 {
-  //  particle
-  particle p=particle::getmex(prhs[0]);
+  //  record inputs for replay (hrecord.h)
+  record("hmatgreenret",nlhs,nrhs,prhs);
+  //  peak memory and budget of this call (hmemory.h)
+  memstat.reset();
+  //  particles for rows and columns
+  particle p1=particle::getmex(prhs[0],0);
+  particle p2=particle::getmex(prhs[0],mxGetNumberOfElements(prhs[0])-1);
   //  cluster tree
   tree.getmex(prhs[1],ind1,ind2);
   //  flag
   char str[10];
   mxGetString(prhs[2],str,mxGetM(prhs[2])*mxGetN(prhs[2])+1);
   std::string flag(str);
+  //  surface derivative needs normal vectors of rows (missing for evaluation points)
+  if (flag!="G" && !p1.nvec) throw std::invalid_argument("hmatgreenret: surface derivative requires normal vectors of rows");
+  if (!p2.area) throw std::invalid_argument("hmatgreenret: boundary element areas of columns missing");
   //  starting clusters
-  size_t i=*(const size_t*)mxGetPr(prhs[3]);
-  size_t j=*(const size_t*)mxGetPr(prhs[4]);
+  size_t i=*(const size_t*)mxGetData(prhs[3]);
+  size_t j=*(const size_t*)mxGetData(prhs[4]);
  //  wavenumber
-  dcmplx wav(*mxGetPr(prhs[5]),*mxGetPi(prhs[5]));
+  dcmplx wav=matrix<dcmplx>::getmex(prhs[5])[0];
   //  set tolerance and maximum rank for low-rank matrix
   if (nrhs==7)
   {
     if (mxGetField(prhs[6],0,"htol")) hopts.tol=mxGetScalar(mxGetField(prhs[6],0,"htol"));
     if (mxGetField(prhs[6],0,"kmax")) hopts.kmax=(size_t)mxGetScalar(mxGetField(prhs[6],0,"kmax"));
-  }    
+    memstat.getmex(prhs[6]);
+  }
+  //  symmetric storage, only for square Green function matrices G
+  bool sym=nrhs==7 && mxGetField(prhs[6],0,"hsym") && mxGetScalar(mxGetField(prhs[6],0,"hsym")) &&
+           flag=="G" && !tree.rect();
   
   //  set up Green function object
-  greenret g(p,flag,wav);
+  greenret g(p1,p2,flag,wav);
+  
+  //  allocations tagged for memory statistics
+  memscope scope(memFill);
   //  low-rank approximation for Green function
-  hmatrix<dcmplx> H=g.eval(i,j,hopts.tol);
+  hmatrix<dcmplx> H=g.eval(i,j,hopts.tol,sym);
   
   //  create cell arrays for low-rank matrices
   plhs[0]=mxCreateCellMatrix((mwSize)ind2.nrows(),1);
   plhs[1]=mxCreateCellMatrix((mwSize)ind2.nrows(),1);  
   //  loop over low-rank matrices
-  for (size_t i=0; i<ind2.nrows(); i++)
-    if (H.find(ind2(i,0),ind2(i,1)))
+  for (size_t l=0; l<ind2.nrows(); l++)
+    if (H.find(ind2(l,0),ind2(l,1)))
     {
-      mxSetCell(plhs[0],i,setmex(H.find(ind2(i,0),ind2(i,1))->lhs));
-      mxSetCell(plhs[1],i,setmex(H.find(ind2(i,0),ind2(i,1))->rhs));
-    }          
-  
-  //  clear globals
-  tree.clear(); ind1.clear(); ind2.clear(); timer.clear();  
+      mxSetCell(plhs[0],l,setmex(H.find(ind2(l,0),ind2(l,1))->lhs));
+      mxSetCell(plhs[1],l,setmex(H.find(ind2(l,0),ind2(l,1))->rhs));
+    }
+  //  block statistics
+  if (nlhs>2) plhs[2]=addmex(setmex(hstats(H)),memstat);
+}
+
+//  clear globals, also after errors (see mexcall in hoptions.h)
+static void clearglobals()
+{
+  tree.clear(); ind1.clear(); ind2.clear(); timer.clear(); acastat.clear();
+}
+
+//  MEX function, errors such as exceeded memory budget raised after clean-up (hoptions.h)
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  mexcall(mexbody,clearglobals,nlhs,plhs,nrhs,prhs);
 }
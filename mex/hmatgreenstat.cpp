@@ -4,8 +4,10 @@
 #include "hoptions.h"
 #include "clustertree.h"
 #include "hmatrix.h"
+#include "hstats.h"
 #include "particle.h"
 #include "acagreen.h"
+#include "hrecord.h"
 
 using namespace std;
 
@@ -18,38 +20,88 @@ struct hoptions hopts = { 1e-6, 500 };
 map<string,double> timer;
 
 //  fill Green function using aca, deal with calling sequence: p, tree, flag, [op]
-void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+//    for rectangular matrices p is a structure array with particles for rows and columns,
+//    for mirror symmetry p has fields mirror and symtable and L, R have one column per symmetry sector,
+//    with op.hsym only the lower block tree of G is filled (symmetric storage, see ldl.h)
+//    optional third output with block, ACA and memory statistics (see hstats.h, hmemory.h),
+//    op.maxmem is the memory budget in bytes
+static void mexbody(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
 {
-  //  particle
-  particle p=particle::getmex(prhs[0]);
+  //  record inputs for replay (hrecord.h)
+  record("hmatgreenstat",nlhs,nrhs,prhs);
+  //  peak memory and budget of this call (hmemory.h)
+  memstat.reset();
+  //  particles for rows and columns
+  particle p1=particle::getmex(prhs[0],0);
+  particle p2=particle::getmex(prhs[0],mxGetNumberOfElements(prhs[0])-1);
   //  cluster tree
   tree.getmex(prhs[1],ind1,ind2);
   //  flag
   char str[10];
   mxGetString(prhs[2],str,mxGetM(prhs[2])*mxGetN(prhs[2])+1);
   std::string flag(str);
+  //  surface derivative needs normal vectors of rows (missing for evaluation points)
+  if (flag!="G" && !p1.nvec) throw std::invalid_argument("hmatgreenstat: surface derivative requires normal vectors of rows");
+  if (!p2.area) throw std::invalid_argument("hmatgreenstat: boundary element areas of columns missing");
   //  set tolerance and maximum rank for low-rank matrix
   if (nrhs==4)
   {
     if (mxGetField(prhs[3],0,"htol")) hopts.tol=mxGetScalar(mxGetField(prhs[3],0,"htol"));
     if (mxGetField(prhs[3],0,"kmax")) hopts.kmax=(size_t)mxGetScalar(mxGetField(prhs[3],0,"kmax"));
-  }      
+    memstat.getmex(prhs[3]);
+  }
+  //  symmetric storage, only for square Green function matrices G
+  bool sym=nrhs==4 && mxGetField(prhs[3],0,"hsym") && mxGetScalar(mxGetField(prhs[3],0,"hsym")) &&
+           flag=="G" && !tree.rect();
   
   //  set up Green function object
-  greenstat g(p,flag);
-  //  low-rank approximation for Green function
-  hmatrix<double> H=g.eval(hopts.tol);
+  greenstat g(p1,p2,flag);
+  //  mirror operations and symmetry table
+  matrix<double> symtab;
+  if (mxGetField(prhs[0],0,"mirror"))
+  {
+    g.mirror=matrix<double>::getmex(mxGetField(prhs[0],0,"mirror"  ));
+    symtab  =matrix<double>::getmex(mxGetField(prhs[0],0,"symtable"));
+  }
+  //  number of symmetry sectors
+  size_t nsec=symtab.empty() ? 1 : symtab.nrows();
+  
+  //  allocations tagged for memory statistics
+  memscope scope(memFill);
   
   //  create cell arrays for low-rank matrices
-  plhs[0]=mxCreateCellMatrix((mwSize)ind2.nrows(),1);
-  plhs[1]=mxCreateCellMatrix((mwSize)ind2.nrows(),1);  
-  //  loop over low-rank matrices
-  for (size_t i=0; i<ind2.nrows(); i++)
+  plhs[0]=mxCreateCellMatrix((mwSize)ind2.nrows(),(mwSize)nsec);
+  plhs[1]=mxCreateCellMatrix((mwSize)ind2.nrows(),(mwSize)nsec);  
+  //  block statistics of all symmetry sectors
+  hstats hs;
+  //  loop over symmetry sectors
+  for (size_t k=0; k<nsec; k++)
   {
-    mxSetCell(plhs[0],i,setmex(H.find(ind2(i,0),ind2(i,1))->lhs));
-    mxSetCell(plhs[1],i,setmex(H.find(ind2(i,0),ind2(i,1))->rhs));
-  }          
+    //  symmetry values of sector
+    if (!symtab.empty()) g.symval=mask(symtab,mask_t(k,k+1,0,symtab.ncols()));
+    //  low-rank approximation for Green function
+    hmatrix<double> H=g.eval(hopts.tol,sym);
+    if (nlhs>2) hs.add(H);
     
-  //  clear globals
-  tree.clear(); ind1.clear(); ind2.clear(); timer.clear();  
+    //  loop over low-rank matrices
+    for (size_t i=0; i<ind2.nrows(); i++)
+      if (H.find(ind2(i,0),ind2(i,1)))
+      {
+        mxSetCell(plhs[0],i+k*ind2.nrows(),setmex(H.find(ind2(i,0),ind2(i,1))->lhs));
+        mxSetCell(plhs[1],i+k*ind2.nrows(),setmex(H.find(ind2(i,0),ind2(i,1))->rhs));
+      }
+  }          
+  if (nlhs>2) plhs[2]=addmex(setmex(hs),memstat);
+}
+
+//  clear globals, also after errors (see mexcall in hoptions.h)
+static void clearglobals()
+{
+  tree.clear(); ind1.clear(); ind2.clear(); timer.clear(); acastat.clear();
+}
+
+//  MEX function, errors such as exceeded memory budget raised after clean-up (hoptions.h)
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  mexcall(mexbody,clearglobals,nlhs,plhs,nrhs,prhs);
 }
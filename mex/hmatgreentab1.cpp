@@ -7,6 +7,8 @@
 #include "particle.h"
 #include "interp.h"
 #include "greentab.h"
+#include "hstats.h"
+#include "hrecord.h"
 
 using namespace std;
 
@@ -20,23 +22,35 @@ map<string,double> timer;
 
 
 //  interpolation, deal with calling sequence: particle, tree, row, col, tab, ind1, ind2, op );  
-void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+//    optional third output with block, ACA and memory statistics (see hstats.h, hmemory.h),
+//    op.maxmem is the memory budget in bytes,
+//    incache = hmatgreentab1( tab ) checks whether table with key is in table cache
+static void mexbody(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
 { 
+  //  query table cache
+  if (nrhs==1) { plhs[0]=mxCreateLogicalScalar(incache(prhs[0],"G"));  return; }
+  //  record inputs for replay (hrecord.h)
+  record("hmatgreentab1",nlhs,nrhs,prhs);
+  //  peak memory and budget of this call (hmemory.h)
+  memstat.reset();
   //  particle
   particle p=particle::getmex(prhs[0]);
   //  cluster tree
   tree.getmex(prhs[1],ind1,ind2);
  //  starting clusters
-  size_t i=*(const size_t*)mxGetPr(prhs[2]);
-  size_t j=*(const size_t*)mxGetPr(prhs[3]);  
+  size_t i=*(const size_t*)mxGetData(prhs[2]);
+  size_t j=*(const size_t*)mxGetData(prhs[3]);  
 
   //  options
   if (nrhs==8)
   {
     if (mxGetField(prhs[7],0,"htol")) hopts.tol=mxGetScalar(mxGetField(prhs[7],0,"htol"));
     if (mxGetField(prhs[7],0,"kmax")) hopts.kmax=(size_t)mxGetScalar(mxGetField(prhs[7],0,"kmax"));
+    memstat.getmex(prhs[7]);
   }    
   
+  //  allocations tagged for memory statistics
+  memscope scope(memFill);
   //  Green function matrix
   hmatrix<dcmplx> G;
   
@@ -52,6 +66,8 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
     G=gtab.eval(i,j,hopts.tol);    
   }
   
+  //  block, ACA and memory statistics
+  if (nlhs>2) plhs[2]=addmex(setmex(hstats(G)),memstat);
   //  create cell arrays for low-rank matrices
   plhs[0]=mxCreateCellMatrix((mwSize)ind2.nrows(),1);
   plhs[1]=mxCreateCellMatrix((mwSize)ind2.nrows(),1);  
@@ -60,8 +76,17 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
   {
     mxSetCell(plhs[0],i,setmex(G.find(ind2(i,0),ind2(i,1))->lhs));
     mxSetCell(plhs[1],i,setmex(G.find(ind2(i,0),ind2(i,1))->rhs));
-  }          
- 
-  //  clear globals
-  tree.clear(); ind1.clear(); ind2.clear(); timer.clear();  
+  }
+}
+
+//  clear globals, also after errors (see mexcall in hoptions.h)
+static void clearglobals()
+{
+  tree.clear(); ind1.clear(); ind2.clear(); timer.clear(); acastat.clear();
+}
+
+//  MEX function, errors such as exceeded memory budget raised after clean-up (hoptions.h)
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  mexcall(mexbody,clearglobals,nlhs,plhs,nrhs,prhs);
 }
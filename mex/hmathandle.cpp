@@ -0,0 +1,599 @@
+#include "mex.h"
+#include "matrix.h"
+
+#include <string>
+#include <stdexcept>
+
+#include "hoptions.h"
+#include "clustertree.h"
+#include "hmatrix.h"
+#include "hregistry.h"
+#include "hfile.h"
+#include "hstore.h"
+#include "lu.h"
+#include "ldl.h"
+#include "krylov.h"
+#include "bemop.h"
+#include "mixed.h"
+#include "hstats.h"
+
+using namespace std;
+
+//  cluster tree
+clustertree tree;
+//  indices for full and low-rank matrices
+matrix<size_t> ind1,ind2;
+
+struct hoptions hopts = { 1e-6, 100 };
+map<string,double> timer;
+
+//  registered H-matrices, kept between MEX calls
+static hregistry reg;
+
+
+//  real or complex H-matrix of entry
+template<class T> hmatrix<T>& getmat(hentry& e);
+template<> hmatrix<double>& getmat(hentry& e) { return e.A; }
+template<> hmatrix<dcmplx>& getmat(hentry& e) { return e.Z; }
+
+//  single precision H-matrix of entry
+template<class T> hmatrix<typename single<T>::type>& getsingle(hentry& e);
+template<> hmatrix<float>&  getsingle<double>(hentry& e) { return e.As; }
+template<> hmatrix<fcmplx>& getsingle<dcmplx>(hentry& e) { return e.Zs; }
+
+//  registered H-matrix for handle
+static hentry& gethandle(const mxArray* rhs)
+{
+  hentry* e=reg.find((size_t)mxGetScalar(rhs));
+  if (!e) throw std::invalid_argument("hmathandle: invalid handle");
+  return *e;
+}
+
+//  registered H-matrix in double precision
+static hentry& getdouble(const mxArray* rhs)
+{
+  hentry& e=gethandle(rhs);
+  if (e.issingle) throw std::invalid_argument("hmathandle: operation requires double precision H-matrix");
+  return e;
+}
+
+//  H-matrix with separate row and column cluster trees ?
+static bool isrect(const hentry& e) { return reg.trees[e.tree].tree.rect(); }
+
+//  new H-matrix with same cluster tree and options as e
+static size_t newhandle(const hentry& e, bool iscomplex, bool islu)
+{
+  size_t h=reg.add(e.tree);
+  hentry& r=*reg.find(h);
+  r.iscomplex=iscomplex;  r.islu=islu;  r.area=e.area;  r.htol=e.htol;  r.kmax=e.kmax;
+  return h;
+}
+
+//  lock MEX file as long as H-matrices are registered
+static void lock()
+{
+  if (reg.size() && !mexIsLocked()) mexLock();
+  if (!reg.size() &&  mexIsLocked()) mexUnlock();
+}
+
+//  multiplication of H-matrix with matrix
+template<class T>
+matrix<T> mul(hentry& e, const matrix<T>& x)
+{
+  if (e.issingle) return mixed_mul(getsingle<T>(e),x);
+  hmatrix<T>& A=getmat<T>(e);
+  if (!e.area.empty()) return mul_sym(A,e.area,x);
+  return e.store ? e.store->mul(A,x) : A*x;
+}
+
+//  multiplication functor for iterative refinement
+template<class T>
+struct hmul
+{
+  hentry& e;
+  hmul(hentry& e0) : e(e0) {}
+  matrix<T> operator() (const matrix<T>& x) const { return mul(e,x); }
+};
+
+//  solve matrix equation using LU or LDL' decomposition
+template<class T>
+void solve(hentry& e, matrix<T>& b, char key)
+{
+  hmatrix<T>& A=getmat<T>(e);
+  //  single precision LU decomposition, iterative refinement with H-matrix of same tree
+  hentry* r=(e.issingle && e.refine && key=='N') ? reg.find(e.refine) : 0;
+  if (r && r->tree==e.tree && !r->islu)
+    refine(hmul<T>(*r),getsingle<T>(e),b,e.rtol,e.rmaxit);
+  else if (e.issingle)
+    mixed_solve(getsingle<T>(e),b,key);
+  else if (!e.area.empty())
+    solve_sym(A,e.area,b,key);
+  else if (e.store)
+  {
+    if (key=='L' || key=='N') e.store->solve(A,b,'L');
+    if (key=='U' || key=='N') e.store->solve(A,b,'U');
+  }
+  else
+  {
+    if (key=='L' || key=='N') solve(A,b,0,'L');
+    if (key=='U' || key=='N') solve(A,b,0,'U');
+  }
+}
+
+//  real H-matrix applied to complex matrix
+template<class F>
+matrix<dcmplx> split(hentry& e, const matrix<dcmplx>& x, F fun)
+{
+  size_t n=x.nrows()*x.ncols();
+  matrix<double> xr(x.nrows(),x.ncols()), xi(x.nrows(),x.ncols());
+  for (size_t i=0; i<n; i++) xr[i]=real(x[i]), xi[i]=imag(x[i]);
+  //  apply function to real and imaginary part
+  xr=fun(e,xr);  xi=fun(e,xi);
+
+  matrix<dcmplx> y(xr.nrows(),xr.ncols());
+  for (size_t i=0; i<y.nrows()*y.ncols(); i++) y[i]=dcmplx(xr[i],xi[i]);
+  return y;
+}
+
+//  string from Matlab array
+static string getstring(const mxArray* rhs)
+{
+  char* str=mxArrayToString(rhs);
+  string s(str);
+  mxFree(str);
+  return s;
+}
+
+//  compare cluster tree of file with cluster tree structure
+static bool sametree(const htree& t, const mxArray* rhs)
+{
+  htree r;
+  r.tree.getmex(rhs,r.ind1,r.ind2);
+  const matrix<size_t> *a[]={ &t.tree.sons, &t.tree.ind, &t.ind1, &t.ind2 },
+                       *b[]={ &r.tree.sons, &r.tree.ind, &r.ind1, &r.ind2 };
+  for (int i=0; i<4; i++)
+    if (a[i]->empty()!=b[i]->empty() || (!a[i]->empty() &&
+       (a[i]->nrows()!=b[i]->nrows() || a[i]->ncols()!=b[i]->ncols() ||
+        !std::equal(a[i]->begin(),a[i]->end(),b[i]->begin())))) return false;
+  return true;
+}
+
+//  functors for multiplication and solution of real H-matrices
+struct mulfun
+  { matrix<double> operator() (hentry& e, const matrix<double>& x) const { return mul(e,x); } };
+struct solvefun
+{
+  char key;
+  solvefun(char k) : key(k) {}
+  matrix<double> operator() (hentry& e, matrix<double> b) const { solve(e,b,key);  return b; }
+};
+
+//  H-matrix applied to real or complex matrix
+static matrix<double> mulx(hentry& e, const matrix<double>& x) { return mul(e,x); }
+static matrix<dcmplx> mulx(hentry& e, const matrix<dcmplx>& x)
+  { return e.iscomplex ? mul(e,x) : split(e,x,mulfun()); }
+//  solution using LU decomposition for real or complex matrix
+static void solvex(hentry& e, matrix<double>& b) { solve(e,b,'N'); }
+static void solvex(hentry& e, matrix<dcmplx>& b)
+  { if (e.iscomplex) solve(e,b,'N'); else b=split(e,b,solvefun('N')); }
+
+//  operator scale*(A+diag(d)) for iterative solvers
+template<class T>
+struct hoperator
+{
+  hentry& e;
+  matrix<T> d;
+  T scale;
+
+  hoperator(hentry& e0) : e(e0), scale(1) {}
+  matrix<T> operator() (const matrix<T>& x) const
+  {
+    matrix<T> y=mulx(e,x);
+    for (size_t j=0; j<y.ncols(); j++)
+    for (size_t i=0; i<y.nrows(); i++) y(i,j)=scale*(y(i,j)+(d.empty() ? (T)0 : d[i]*x(i,j)));
+    return y;
+  }
+};
+
+//  preconditioner using LU decomposition, identity if no LU decomposition is given
+template<class T>
+struct hprecond
+{
+  hentry* e;
+
+  hprecond(hentry* e0) : e(e0) {}
+  matrix<T> operator() (const matrix<T>& x) const
+    { matrix<T> b=x;  if (e) solvex(*e,b);  return b; }
+};
+
+//  iterative solution with restarted GMRES, BiCGSTAB or CGS, see krylov.h
+template<class T>
+void iter(hentry& e, hentry* ep, int nrhs, const mxArray* prhs[], mxArray* plhs[])
+{
+  hoperator<T> afun(e);
+  hprecond<T> mfun(ep);
+  krylovopt op;
+  string solver="gmres";
+
+  //  options
+  const mxArray* opt=(nrhs>5) ? prhs[5] : 0;
+  if (opt && mxIsStruct(opt))
+  {
+    const mxArray* f;
+    if ((f=mxGetField(opt,0,"solver"))  && !mxIsEmpty(f)) solver=getstring(f);
+    if ((f=mxGetField(opt,0,"tol"))     && !mxIsEmpty(f)) op.tol=mxGetScalar(f);
+    if ((f=mxGetField(opt,0,"maxit"))   && !mxIsEmpty(f)) op.maxit=(size_t)mxGetScalar(f);
+    if ((f=mxGetField(opt,0,"restart")) && !mxIsEmpty(f)) op.restart=(size_t)mxGetScalar(f);
+    if ((f=mxGetField(opt,0,"diag"))    && !mxIsEmpty(f)) afun.d=matrix<T>::getmex(f);
+    if ((f=mxGetField(opt,0,"scale"))   && !mxIsEmpty(f)) afun.scale=matrix<T>::getmex(f)[0];
+  }
+  //  right-hand side and initial guess
+  matrix<T> b=matrix<T>::getmex(prhs[3]), x;
+  if (nrhs>4 && !mxIsEmpty(prhs[4])) x=matrix<T>::getmex(prhs[4]);
+
+  std::vector<krylovstat> stat;
+  if      (solver=="gmres")    gmres(afun,mfun,b,x,op,stat);
+  else if (solver=="bicgstab") bicgstab(afun,mfun,b,x,op,stat);
+  else if (solver=="cgs")      cgs(afun,mfun,b,x,op,stat);
+  else throw std::invalid_argument("hmathandle: iterative solver not known");
+
+  //  solution and statistics for columns of b
+  size_t nc=stat.size(), ni=(solver=="gmres") ? 2 : 1;
+  plhs[0]=setmex(x);
+  plhs[1]=mxCreateDoubleMatrix(nc,1,mxREAL);
+  plhs[2]=mxCreateDoubleMatrix(nc,1,mxREAL);
+  plhs[3]=mxCreateDoubleMatrix(nc,ni,mxREAL);
+  for (size_t j=0; j<nc; j++)
+  {
+    mxGetPr(plhs[1])[j]=stat[j].flag;
+    mxGetPr(plhs[2])[j]=stat[j].relres;
+    for (size_t k=0; k<ni; k++) mxGetPr(plhs[3])[j+k*nc]=stat[j].iter[k];
+  }
+}
+
+//  complex array or structure field
+static bool iscomplex(const mxArray* rhs, const char* name=0)
+{
+  if (rhs && name) rhs=mxIsStruct(rhs) ? mxGetField(rhs,0,name) : 0;
+  return rhs && mxIsComplex(rhs);
+}
+
+
+//  retarded BEM operator for handles of G1, G2, H1, H2 and options k, nvec, eps1, eps2
+static bemretop getbemret(const mxArray* rhs, const mxArray* opt, hentry* e[4])
+{
+  if (mxGetNumberOfElements(rhs)!=4) throw std::invalid_argument("hmathandle: BEM operator requires four H-matrices");
+  for (int i=0; i<4; i++)
+  {
+    e[i]=reg.find((size_t)mxGetPr(rhs)[i]);
+    if (!e[i]) throw std::invalid_argument("hmathandle: invalid handle");
+    if (e[i]->tree!=e[0]->tree || !e[i]->iscomplex || e[i]->islu || e[i]->issingle ||
+        !e[i]->area.empty() || e[i]->store || isrect(*e[i]))
+      throw std::invalid_argument("hmathandle: BEM operator requires complex square H-matrices with same cluster tree and full storage");
+  }
+  bemretop op(e[0]->Z,e[1]->Z,e[2]->Z,e[3]->Z);
+  op.k=mxGetScalar(mxGetField(opt,0,"k"));
+  op.nvec=matrix<double>::getmex(mxGetField(opt,0,"nvec"));
+  op.eps1=matrix<dcmplx>::getmex(mxGetField(opt,0,"eps1"));
+  op.eps2=matrix<dcmplx>::getmex(mxGetField(opt,0,"eps2"));
+  return op;
+}
+
+//  H-matrices kept in C++ memory, deal with calling sequences:
+//    h=hmathandle('create',tree,A,L,R,[op])  import H-matrix, op with htol, kmax, area, complex
+//    h=hmathandle('create',h0,A,L,R)         import H-matrix, share cluster tree of h0
+//    [A,L,R]=hmathandle('get',h)             export H-matrix
+//    B=hmathandle('full',h)                  full matrix (cluster ordering)
+//    y=hmathandle('mul',h,x)                 multiplication with matrix
+//    h=hmathandle('add',h1,h2)               sum of H-matrices with same cluster tree
+//    h=hmathandle('lu',h)                    LU (or LDL') decomposition
+//    x=hmathandle('solve',h,b,key)           solve using LU decomposition
+//    hmathandle('save',h,file)               save H-matrix and cluster tree to file (hfile.h)
+//    h=hmathandle('load',file,[tree],[check])  map H-matrix file, compare with cluster tree,
+//                                              verify checksums of blocks
+//    hmathandle('spill',h,dir,maxbytes)      move H-matrix to disk, keep at most maxbytes
+//                                              of blocks resident (hstore.h)
+//    [x,flag,relres,iter]=hmathandle('iter',h,hp,b,x0,op)
+//                                            iterative solution of scale*(A+diag(d))*x = b
+//                                              with preconditioner hp (LU decomposition or []),
+//                                              op with solver, tol, maxit, restart, diag, scale
+//    y=hmathandle('bemret',[hG1,hG2,hH1,hH2],x,op)
+//                                            retarded BEM operator (bemop.h), op with
+//                                              k, nvec, eps1, eps2 in cluster ordering
+//    h=hmathandle('bemretprecond',[hG1,hG2,hH1,hH2],op)
+//                                            preconditioner of retarded BEM solver, op as for
+//                                              bemret with htol, kmax, returns handles of
+//                                              G1i, G2i, Sigma1, Deltai, Sigmai
+//    hmathandle('single',h,[hA],[op])        store H-matrix in single precision (mixed.h),
+//                                              solutions with LU decomposition are refined
+//                                              with H-matrix hA, op with tol and maxit
+//    s=hmathandle('stat',h)                  block statistics of H-matrix and statistics of ACA
+//                                              calls and truncations since last call (hstats.h)
+//    s=hmathandle('memory',[maxmem])         memory of registered H-matrices and peak memory
+//                                              since last call, set memory budget maxmem in
+//                                              bytes, 0 for no limit (hmemory.h)
+//    b=hmathandle('islu',h)                  LU decomposition ?
+//    hmathandle('delete',h), hmathandle('clear'), h=hmathandle('list')
+static void mexbody(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  string cmd=getstring(prhs[0]);
+
+  if (cmd=="create")
+  {
+    //  share cluster tree of registered H-matrix or new cluster tree,
+    //    H-matrix is registered after successful import
+    hentry* e0=mxIsNumeric(prhs[1]) ? &gethandle(prhs[1]) : 0;
+    htree t;
+    if (!e0) t.tree.getmex(prhs[1],t.ind1,t.ind2);
+    hentry e;
+    if (e0) { e.area=e0->area;  e.htol=e0->htol;  e.kmax=e0->kmax; }
+    e.iscomplex=mxGetNumberOfElements(prhs[2]) && mxIsComplex(mxGetCell(prhs[2],0));
+    //  options
+    if (nrhs==6)
+    {
+      if (mxGetField(prhs[5],0,"complex")) e.iscomplex=mxGetScalar(mxGetField(prhs[5],0,"complex"))!=0;
+      if (mxGetField(prhs[5],0,"htol")) e.htol=mxGetScalar(mxGetField(prhs[5],0,"htol"));
+      if (mxGetField(prhs[5],0,"kmax")) e.kmax=(size_t)mxGetScalar(mxGetField(prhs[5],0,"kmax"));
+      if (mxGetField(prhs[5],0,"area")) e.area=matrix<double>::getmex(mxGetField(prhs[5],0,"area"));
+      if (mxGetField(prhs[5],0,"lu"))   e.islu=mxGetScalar(mxGetField(prhs[5],0,"lu"))!=0;
+    }
+    //  import H-matrix
+    {
+      hbind bind(e0 ? reg.trees[e0->tree] : t,e);
+      memscope scope(memFill);
+      if (e.iscomplex) e.Z=hmatrix<dcmplx>::getmex(&prhs[2]);
+      else             e.A=hmatrix<double>::getmex(&prhs[2]);
+    }
+    //  register H-matrix
+    size_t h=e0 ? newhandle(*e0,e.iscomplex,e.islu) : reg.add(reg.addtree(t));
+    hentry& r=*reg.find(h);
+    r.iscomplex=e.iscomplex;  r.islu=e.islu;  r.area.swap(e.area);  r.htol=e.htol;  r.kmax=e.kmax;
+    r.A.mat.swap(e.A.mat);  r.Z.mat.swap(e.Z.mat);
+    plhs[0]=mxCreateDoubleScalar((double)h);
+  }
+  else if (cmd=="get")
+  {
+    hentry& e=gethandle(prhs[1]);
+    hbind bind(reg,e);
+    if (e.issingle)
+      { if (e.iscomplex) setmex<dcmplx>(recast<dcmplx>(e.Zs),plhs); else setmex<double>(recast<double>(e.As),plhs); }
+    else
+      { if (e.iscomplex) setmex<dcmplx>(e.Z,plhs); else setmex<double>(e.A,plhs); }
+  }
+  else if (cmd=="full")
+  {
+    hentry& e=gethandle(prhs[1]);
+    hbind bind(reg,e);
+    if (e.issingle)
+      plhs[0]=e.iscomplex ? setmex(full(recast<dcmplx>(e.Zs))) : setmex(full(recast<double>(e.As)));
+    else
+      plhs[0]=e.iscomplex ? setmex(full(e.Z)) : setmex(full(e.A));
+  }
+  else if (cmd=="mul")
+  {
+    hentry& e=gethandle(prhs[1]);
+    hbind bind(reg,e);
+    if (e.iscomplex)
+      { matrix<dcmplx> x;  x.mexview(prhs[2]);  plhs[0]=setmex(mul(e,x)); }
+    else if (!mxIsComplex(prhs[2]))
+      { matrix<double> x;  x.mexview(prhs[2]);  plhs[0]=setmex(mul(e,x)); }
+    else
+      plhs[0]=setmex(split(e,matrix<dcmplx>::getmex(prhs[2]),mulfun()));
+  }
+  else if (cmd=="add")
+  {
+    hentry &e1=getdouble(prhs[1]), &e2=getdouble(prhs[2]);
+    if (e1.tree!=e2.tree || e1.iscomplex!=e2.iscomplex)
+      throw std::invalid_argument("hmathandle: H-matrices must share cluster tree and type");
+    hentry e;
+    {
+      hbind bind(reg,e1);
+      if (e1.iscomplex) e.Z=e1.Z+e2.Z; else e.A=e1.A+e2.A;
+    }
+    //  register sum
+    size_t h=newhandle(e1,e1.iscomplex,false);
+    hentry& r=*reg.find(h);
+    r.A.mat.swap(e.A.mat);  r.Z.mat.swap(e.Z.mat);
+    plhs[0]=mxCreateDoubleScalar((double)h);
+  }
+  else if (cmd=="lu")
+  {
+    hentry& e0=getdouble(prhs[1]);
+    if (isrect(e0)) throw std::invalid_argument("hmathandle: LU decomposition requires square H-matrix");
+    hentry e;
+    {
+      hbind bind(reg,e0);
+      memscope scope(memLU);
+      //  LU or LDL' decomposition
+      if (e0.iscomplex)
+        { if (e0.area.empty()) lu(e0.Z,e.Z); else ldl(e0.Z,e0.area,e.Z); }
+      else
+        { if (e0.area.empty()) lu(e0.A,e.A); else ldl(e0.A,e0.area,e.A); }
+    }
+    //  register decomposition
+    size_t h=newhandle(e0,e0.iscomplex,true);
+    hentry& r=*reg.find(h);
+    r.A.mat.swap(e.A.mat);  r.Z.mat.swap(e.Z.mat);
+    plhs[0]=mxCreateDoubleScalar((double)h);
+  }
+  else if (cmd=="solve")
+  {
+    hentry& e=gethandle(prhs[1]);
+    char key=(nrhs>3) ? *mxGetChars(prhs[3]) : 'N';
+    if (!e.islu) throw std::invalid_argument("hmathandle: solve requires LU decomposition");
+    hbind bind(reg,e);
+    memscope scope(memSolve);
+    //  solution is computed in place in output array
+    if (e.iscomplex)
+    {
+      matrix<dcmplx> b;
+      mxArray* lhs=mexalloc(prhs[2],b);
+      solve(e,b,key);
+      plhs[0]=setmex(b,lhs);
+    }
+    else if (!mxIsComplex(prhs[2]))
+    {
+      matrix<double> b;
+      mxArray* lhs=mexalloc(prhs[2],b);
+      solve(e,b,key);
+      plhs[0]=setmex(b,lhs);
+    }
+    else
+      plhs[0]=setmex(split(e,matrix<dcmplx>::getmex(prhs[2]),solvefun(key)));
+  }
+  else if (cmd=="save")
+  {
+    hentry& e=getdouble(prhs[1]);
+    hbind bind(reg,e);
+    hfileinfo info;
+    info.islu=e.islu;  info.htol=e.htol;  info.kmax=e.kmax;  info.area=e.area;
+    bool ok=e.iscomplex ? hfile::write(getstring(prhs[2]),e.Z,info) : 
+                          hfile::write(getstring(prhs[2]),e.A,info);
+    if (!ok) throw std::runtime_error("hmathandle: cannot write H-matrix file");
+  }
+  else if (cmd=="load")
+  {
+    hfile* f=new hfile;
+    if (!f->open(getstring(prhs[1])))
+      { delete f;  throw std::runtime_error("hmathandle: cannot read H-matrix file"); }
+    htree t;
+    f->gettree(t.tree,t.ind1,t.ind2);
+    //  compare with cluster tree and verify block checksums
+    if ((nrhs>2 && !mxIsEmpty(prhs[2]) && !sametree(t,prhs[2])) ||
+        (nrhs>3 && mxGetScalar(prhs[3]) && !f->verify()))
+      { delete f;  throw std::runtime_error("hmathandle: H-matrix file does not match cluster tree or is corrupt"); }
+    //  register H-matrix with views of mapped blocks
+    size_t h=reg.add(reg.addtree(t));
+    hentry& e=*reg.find(h);
+    e.file=f;  e.iscomplex=f->iscomplex();  e.islu=f->info.islu;
+    e.htol=f->info.htol;  e.kmax=f->info.kmax;  e.area=f->info.area;
+    if (e.iscomplex) f->get(e.Z); else f->get(e.A);
+    plhs[0]=mxCreateDoubleScalar((double)h);
+  }
+  else if (cmd=="spill")
+  {
+    hentry& e=getdouble(prhs[1]);
+    if (e.file || e.store) throw std::invalid_argument("hmathandle: H-matrix is already stored on disk");
+    hbind bind(reg,e);
+    hfileinfo info;
+    info.islu=e.islu;  info.htol=e.htol;  info.kmax=e.kmax;  info.area=e.area;
+    e.store=new hstore(getstring(prhs[2]));
+    if (nrhs>3) e.store->maxbytes=(size_t)mxGetScalar(prhs[3]);
+    bool ok=e.iscomplex ? e.store->spill(e.Z,info) : e.store->spill(e.A,info);
+    if (!ok) { delete e.store;  e.store=0;  throw std::runtime_error("hmathandle: cannot write scratch file"); }
+  }
+  else if (cmd=="iter")
+  {
+    hentry& e=gethandle(prhs[1]);
+    hentry* ep=mxIsEmpty(prhs[2]) ? 0 : &gethandle(prhs[2]);
+    if (ep && (!ep->islu || ep->tree!=e.tree))
+      throw std::invalid_argument("hmathandle: preconditioner must be LU decomposition with same cluster tree");
+    const mxArray* op=(nrhs>5) ? prhs[5] : 0;
+    bool cplx=e.iscomplex || (ep && ep->iscomplex) || iscomplex(prhs[3]) || 
+              (nrhs>4 && iscomplex(prhs[4])) || iscomplex(op,"diag") || iscomplex(op,"scale");
+    hbind bind(reg,e);
+    memscope scope(memSolve);
+    if (cplx) iter<dcmplx>(e,ep,nrhs,prhs,plhs); else iter<double>(e,ep,nrhs,prhs,plhs);
+  }
+  else if (cmd=="bemret")
+  {
+    hentry* e[4];
+    bemretop op=getbemret(prhs[1],prhs[3],e);
+    //  check sizes before cluster tree is bound
+    if (mxGetN(prhs[2])%8 || op.nvec.nrows()!=mxGetM(prhs[2])) throw std::invalid_argument("hmathandle: bemret size mismatch");
+    matrix<dcmplx> x=matrix<dcmplx>::getmex(prhs[2]);
+    hbind bind(reg,*e[0]);
+    plhs[0]=setmex(op(x));
+  }
+  else if (cmd=="bemretprecond")
+  {
+    hentry* e[4];
+    bemretop op=getbemret(prhs[1],prhs[2],e);
+    hbind bind(reg,*e[0]);
+    //  tolerance and maximal rank of preconditioner
+    const mxArray* f;
+    if ((f=mxGetField(prhs[2],0,"htol")) && !mxIsEmpty(f)) hopts.tol=mxGetScalar(f);
+    if ((f=mxGetField(prhs[2],0,"kmax")) && !mxIsEmpty(f)) hopts.kmax=(size_t)mxGetScalar(f);
+    bemretprec P;
+    memscope scope(memInv);
+    op.precond(P);
+    //  register matrices of preconditioner
+    hmatrix<dcmplx>* mat[5]={ &P.G1i, &P.G2i, &P.Sigma1, &P.Deltai, &P.Sigmai };
+    bool islu[5]={ true, true, false, false, true };
+    plhs[0]=mxCreateDoubleMatrix(1,5,mxREAL);
+    for (int i=0; i<5; i++)
+    {
+      size_t h=newhandle(*e[0],true,islu[i]);
+      hentry& r=*reg.find(h);
+      r.htol=hopts.tol;  r.kmax=hopts.kmax;
+      r.Z.mat.swap(mat[i]->mat);
+      mxGetPr(plhs[0])[i]=(double)h;
+    }
+  }
+  else if (cmd=="single")
+  {
+    hentry& e=getdouble(prhs[1]);
+    if (e.file || e.store || !e.area.empty())
+      throw std::invalid_argument("hmathandle: single precision storage not possible for this H-matrix");
+    //  double precision H-matrix for iterative refinement
+    if (nrhs>2 && !mxIsEmpty(prhs[2]))
+    {
+      hentry& r=getdouble(prhs[2]);
+      if (r.tree!=e.tree || r.islu || r.iscomplex!=e.iscomplex)
+        throw std::invalid_argument("hmathandle: refinement requires H-matrix of same cluster tree and type");
+      e.refine=(size_t)mxGetScalar(prhs[2]);
+    }
+    const mxArray* f;
+    if (nrhs>3 && (f=mxGetField(prhs[3],0,"tol"))   && !mxIsEmpty(f)) e.rtol=mxGetScalar(f);
+    if (nrhs>3 && (f=mxGetField(prhs[3],0,"maxit")) && !mxIsEmpty(f)) e.rmaxit=(size_t)mxGetScalar(f);
+    //  convert blocks and release double precision storage
+    hbind bind(reg,e);
+    if (e.iscomplex) { e.Zs=recast<fcmplx>(e.Z);  e.Z.clear(); }
+    else             { e.As=recast<float>(e.A);   e.A.clear(); }
+    e.issingle=true;
+  }
+  else if (cmd=="stat")
+  {
+    hentry& e=gethandle(prhs[1]);
+    hbind bind(reg,e);
+    hstats hs;
+    if (e.issingle) { if (e.iscomplex) hs.add(e.Zs); else hs.add(e.As); }
+    else            { if (e.iscomplex) hs.add(e.Z);  else hs.add(e.A);  }
+    plhs[0]=addmex(setmex(hs),memstat);
+    acastat.clear();
+  }
+  else if (cmd=="memory")
+  {
+    //  statistics since last call, keep budget if not given
+    plhs[0]=setmex(memstat);
+    memstat.reset(nrhs>1 ? (size_t)mxGetScalar(prhs[1]) : memstat.budget);
+  }
+  else if (cmd=="islu")
+    plhs[0]=mxCreateLogicalScalar(gethandle(prhs[1]).islu);
+  else if (cmd=="delete")
+    reg.remove((size_t)mxGetScalar(prhs[1]));
+  else if (cmd=="clear")
+    reg.clear();
+  else if (cmd=="list")
+  {
+    vector<size_t> h=reg.handles();
+    plhs[0]=mxCreateDoubleMatrix(h.size(),1,mxREAL);
+    for (size_t i=0; i<h.size(); i++) mxGetPr(plhs[0])[i]=(double)h[i];
+  }
+  else
+    throw std::invalid_argument("hmathandle: unknown command");
+}
+
+//  lock MEX file while H-matrices are registered, clear globals (cluster trees of
+//    H-matrices are restored by hbind), also after errors (see mexcall in hoptions.h)
+static void clearglobals()
+{
+  lock();
+  tree.clear(); ind1.clear(); ind2.clear(); timer.clear();
+}
+
+//  MEX function, errors such as exceeded memory budget raised after clean-up (hoptions.h)
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  mexcall(mexbody,clearglobals,nlhs,plhs,nrhs,prhs);
+}
@@ -4,6 +4,8 @@
 #include "hoptions.h"
 #include "clustertree.h"
 #include "hmatrix.h"
+#include "hstats.h"
+#include "hrecord.h"
 
 using namespace std;
 
@@ -16,26 +18,37 @@ struct hoptions hopts = { 1e-6, 500 };
 map<string,double> timer;
 
 //  invert H-matrix, deal with calling sequence: tree, A, L, R, [op]
-void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+static void mexbody(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
 {
+  //  record inputs for replay (hrecord.h)
+  record("hmatinv",nlhs,nrhs,prhs);
+  //  peak memory and budget of this call (hmemory.h)
+  memstat.reset();
   tree.getmex(prhs[0],ind1,ind2);
+  if (tree.rect()) throw std::invalid_argument("hmatinv: H-matrix must be square");
   //  set tolerance and maximum rank for low-rank matrix
   if (nrhs==5)
   {
     if (mxGetField(prhs[4],0,"htol")) hopts.tol=mxGetScalar(mxGetField(prhs[4],0,"htol"));
     if (mxGetField(prhs[4],0,"kmax")) hopts.kmax=(size_t)mxGetScalar(mxGetField(prhs[4],0,"kmax"));
+    memstat.getmex(prhs[4]);
   }    
   
+  //  block statistics of result, allocations tagged for memory statistics
+  hstats hs;
+  memscope scope(memInv);
+
   //  real input ?
   if (!mxIsComplex(mxGetCell(prhs[1],0)))
   {
     hmatrix<double> A,Ai;
-    A=hmatrix<double>::getmex(&prhs[1]);
+    A.mexview(&prhs[1]);
   
-    timer.clear(); tic;
+    timer.clear(); acastat.clear(); tic;
     //  inversion of H-matrix
     Ai=inv(A);
     toc("main");
+    if (nlhs==4) hs.add(Ai);
     
     //  set output
     setmex<double>(Ai,plhs);
@@ -43,19 +56,20 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
   else  //  complex input
   {
     hmatrix<dcmplx> A,Ai;
-    A=hmatrix<dcmplx>::getmex(&prhs[1]);
+    A.mexview(&prhs[1]);
   
-    timer.clear(); tic;
+    timer.clear(); acastat.clear(); tic;
     //  inversion of H-matrix
     Ai=inv(A);
     toc("main");    
+    if (nlhs==4) hs.add(Ai);
     
     //  set output
     setmex<dcmplx>(Ai,plhs);
   }
 
 
-  //  timer statistics
+  //  timer and H-matrix statistics
   if (nlhs==4)
   {
     plhs[3]=mxCreateStructMatrix(1,1,0,NULL);
@@ -65,7 +79,22 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
       mxAddField(plhs[3],&it->first[0]);
       mxSetField(plhs[3],0,&it->first[0],mxCreateDoubleScalar(it->second));
     }
+    //  H-matrix and ACA statistics
+    mxAddField(plhs[3],"hstat");
+    mxSetField(plhs[3],0,"hstat",setmex(hs));
+    //  memory statistics
+    addmex(plhs[3],memstat);
   } 
-  //  clear globals
-  tree.clear(); ind1.clear(); ind2.clear(); timer.clear();  
+}
+
+//  clear globals, also after errors (see mexcall in hoptions.h)
+static void clearglobals()
+{
+  tree.clear(); ind1.clear(); ind2.clear(); timer.clear(); acastat.clear();
+}
+
+//  MEX function, errors such as exceeded memory budget raised after clean-up (hoptions.h)
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  mexcall(mexbody,clearglobals,nlhs,plhs,nrhs,prhs);
 }
@@ -5,6 +5,7 @@
 #include "clustertree.h"
 #include "hmatrix.h"
 #include "lu.h"
+#include "hrecord.h"
 
 using namespace std;
 
@@ -17,8 +18,12 @@ struct hoptions hopts = { 1e-6, 100 };
 map<string,double> timer;
 
 //  compute (L*U)*X = B, deal with calling sequence: tree, A1, L1, R1, A2, L2, R2, key, [op]
-void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+static void mexbody(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
 {
+  //  record inputs for replay (hrecord.h)
+  record("hmatlsolve",nlhs,nrhs,prhs);
+  //  peak memory and budget of this call (hmemory.h)
+  memstat.reset();
   tree.getmex(prhs[0],ind1,ind2);  
   char key=*mxGetChars(prhs[7]);
   //  set tolerance and maximum rank for low-rank matrix
@@ -26,12 +31,17 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
   {
     if (mxGetField(prhs[8],0,"htol")) hopts.tol=mxGetScalar(mxGetField(prhs[8],0,"htol"));
     if (mxGetField(prhs[8],0,"kmax")) hopts.kmax=(size_t)mxGetScalar(mxGetField(prhs[8],0,"kmax"));
+    memstat.getmex(prhs[8]);
   }      
  
+  //  allocations tagged for memory statistics
+  memscope scope(memSolve);
+
   //  real input ?
   if (!mxIsComplex(mxGetCell(prhs[1],0)))
   {  
-    hmatrix<double> B=hmatrix<double>::getmex(&prhs[1]), A=hmatrix<double>::getmex(&prhs[4]), X;
+    hmatrix<double> B, A, X;
+    B.mexview(&prhs[1]);  A.mexview(&prhs[4]);
   
     timer.clear(); tic;
     //  solve matrix equation using LU decomposition
@@ -44,7 +54,8 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
   }
   else  //  complex input
   {  
-    hmatrix<dcmplx> B=hmatrix<dcmplx>::getmex(&prhs[1]), A=hmatrix<dcmplx>::getmex(&prhs[4]), X;
+    hmatrix<dcmplx> B, A, X;
+    B.mexview(&prhs[1]);  A.mexview(&prhs[4]);
   
     timer.clear(); tic;
     //  solve matrix equation using LU decomposition
@@ -56,7 +67,7 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
     setmex<dcmplx>(X,&plhs[0]);
   }
   
-  //  timer statistics
+  //  timer and memory statistics
   if (nlhs==4)
   {
     plhs[3]=mxCreateStructMatrix(1,1,0,NULL);
@@ -65,8 +76,19 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
     {
       mxAddField(plhs[3],&it->first[0]);
       mxSetField(plhs[3],0,&it->first[0],mxCreateDoubleScalar(it->second));
-    }  
+    }
+    addmex(plhs[3],memstat);  
   }
-  //  clear globals
-  tree.clear(); ind1.clear(); ind2.clear(); timer.clear();    
+}
+
+//  clear globals, also after errors (see mexcall in hoptions.h)
+static void clearglobals()
+{
+  tree.clear(); ind1.clear(); ind2.clear(); timer.clear();
+}
+
+//  MEX function, errors such as exceeded memory budget raised after clean-up (hoptions.h)
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  mexcall(mexbody,clearglobals,nlhs,plhs,nrhs,prhs);
 }
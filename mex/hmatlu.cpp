@@ -4,7 +4,10 @@
 #include "hoptions.h"
 #include "clustertree.h"
 #include "hmatrix.h"
+#include "hstats.h"
 #include "lu.h"
+#include "ldl.h"
+#include "hrecord.h"
 
 using namespace std;
 
@@ -17,26 +20,43 @@ struct hoptions hopts = { 1e-6, 100 };
 map<string,double> timer;
 
 //  LU decomposition of H-matrix, deal with calling sequence: tree, A, L, R, [op]
-void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+//    for symmetric storage op.area gives the boundary element areas and we compute
+//    the LDL' decomposition of A*diag(1/area) (see ldl.h), op.maxmem is the memory
+//    budget in bytes (see hmemory.h)
+static void mexbody(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
 {
+  //  record inputs for replay (hrecord.h)
+  record("hmatlu",nlhs,nrhs,prhs);
+  //  peak memory and budget of this call (hmemory.h)
+  memstat.reset();
   tree.getmex(prhs[0],ind1,ind2);
+  if (tree.rect()) throw std::invalid_argument("hmatlu: H-matrix must be square");
+  //  areas for symmetric storage
+  matrix<double> area;
   //  set tolerance and maximum rank for low-rank matrix
   if (nrhs==5)
   {
     if (mxGetField(prhs[4],0,"htol")) hopts.tol=mxGetScalar(mxGetField(prhs[4],0,"htol"));
     if (mxGetField(prhs[4],0,"kmax")) hopts.kmax=(size_t)mxGetScalar(mxGetField(prhs[4],0,"kmax"));
+    memstat.getmex(prhs[4]);
+    if (mxGetField(prhs[4],0,"area")) area=matrix<double>::getmex(mxGetField(prhs[4],0,"area"));
   }    
   
+  //  block statistics of result, allocations tagged for memory statistics
+  hstats hs;
+  memscope scope(memLU);
+
   //  real input ?
   if (!mxIsComplex(mxGetCell(prhs[1],0)))
   {
     hmatrix<double> A, B;
-    B=hmatrix<double>::getmex(&prhs[1]);
+    B.mexview(&prhs[1]);
   
-    timer.clear(); tic;
-    //  LU decomposition
-    lu(B,A);  
+    timer.clear(); acastat.clear(); tic;
+    //  LU or LDL' decomposition
+    if (area.empty()) lu(B,A); else ldl(B,area,A);
     toc("main");
+    if (nlhs==4) hs.add(A);
   
     //  set output
     setmex<double>(A,&plhs[0]);
@@ -44,18 +64,19 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
   else  //  complex input
   {
     hmatrix<dcmplx> A, B;
-    B=hmatrix<dcmplx>::getmex(&prhs[1]);
+    B.mexview(&prhs[1]);
   
-    timer.clear(); tic;
-    //  LU decomposition
-    lu(B,A);  
+    timer.clear(); acastat.clear(); tic;
+    //  LU or LDL' decomposition
+    if (area.empty()) lu(B,A); else ldl(B,area,A);
     toc("main");
+    if (nlhs==4) hs.add(A);
   
     //  set output
     setmex<dcmplx>(A,&plhs[0]);
   }
   
-  //  timer statistics
+  //  timer and H-matrix statistics
   if (nlhs==4)
   {
     plhs[3]=mxCreateStructMatrix(1,1,0,NULL);
@@ -65,7 +86,22 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
       mxAddField(plhs[3],&it->first[0]);
       mxSetField(plhs[3],0,&it->first[0],mxCreateDoubleScalar(it->second));
     }  
+    //  H-matrix and ACA statistics
+    mxAddField(plhs[3],"hstat");
+    mxSetField(plhs[3],0,"hstat",setmex(hs));
+    //  memory statistics
+    addmex(plhs[3],memstat);
   }  
-  //  clear globals
-  tree.clear(); ind1.clear(); ind2.clear(); timer.clear();  
+}
+
+//  clear globals, also after errors (see mexcall in hoptions.h)
+static void clearglobals()
+{
+  tree.clear(); ind1.clear(); ind2.clear(); timer.clear(); acastat.clear();
+}
+
+//  MEX function, errors such as exceeded memory budget raised after clean-up (hoptions.h)
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  mexcall(mexbody,clearglobals,nlhs,plhs,nrhs,prhs);
 }
@@ -4,6 +4,9 @@
 #include "hoptions.h"
 #include "clustertree.h"
 #include "hmatrix.h"
+#include "ldl.h"
+#include "mixed.h"
+#include "hrecord.h"
 
 using namespace std;
 
@@ -17,33 +20,77 @@ map<string,double> timer;
 
 
 
-//  multiply H-matrix with matrix, deal with calling sequence: tree, A, L, R, x
-void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+//  multiply H-matrix with matrix, deal with calling sequence: tree, A, L, R, x, [op]
+//    works also for rectangular H-matrices with separate row and column trees,
+//    for symmetric storage op.area gives the boundary element areas (see ldl.h),
+//    op.maxmem the memory budget, optional second output with memory statistics
+static void mexbody(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
 {
+  //  record inputs for replay (hrecord.h)
+  record("hmatmul1",nlhs,nrhs,prhs);
+  //  peak memory and budget of this call (hmemory.h)
+  memstat.reset();
   tree.getmex(prhs[0],ind1,ind2);
+  //  areas for symmetric storage
+  matrix<double> area;
+  if (nrhs==6 && mxGetField(prhs[5],0,"area")) area=matrix<double>::getmex(mxGetField(prhs[5],0,"area"));
+  if (nrhs==6) memstat.getmex(prhs[5]);
    
+  //  H-matrix stored in single precision (mixed.h), x and y in double precision
+  if (mxIsSingle(mxGetCell(prhs[1],0)))
+  {
+    if (!area.empty()) throw std::invalid_argument("hmatmul1: single precision requires unsymmetric storage");
+    if (!mxIsComplex(mxGetCell(prhs[1],0)))
+    {
+      hmatrix<float> A;
+      matrix<double> x;
+      A.mexview(&prhs[1]);  x.mexview(prhs[4]);
+      plhs[0]=setmex(mixed_mul(A,x));
+    }
+    else
+    {
+      hmatrix<fcmplx> A;
+      matrix<dcmplx> x;
+      A.mexview(&prhs[1]);  x.mexview(prhs[4]);
+      plhs[0]=setmex(mixed_mul(A,x));
+    }
+  }
   //  real input ?
-  if (!mxIsComplex(mxGetCell(prhs[1],0)))
+  else if (!mxIsComplex(mxGetCell(prhs[1],0)))
   {
-    hmatrix<double> A=hmatrix<double>::getmex(&prhs[1]);
-    matrix<double> x=matrix<double>::getmex(prhs[4]),y;
+    hmatrix<double> A;
+    matrix<double> x,y;
+    A.mexview(&prhs[1]);  x.mexview(prhs[4]);
   
     //  multiplication of H-matrix with matrix
-    y=A*x;
+    y=area.empty() ? A*x : mul_sym(A,area,x);
     //  set output
     plhs[0]=setmex(y);
   }
   else  //  complex input
   {
-    hmatrix<dcmplx> A=hmatrix<dcmplx>::getmex(&prhs[1]);
-    matrix<dcmplx> x=matrix<dcmplx>::getmex(prhs[4]),y;
+    hmatrix<dcmplx> A;
+    matrix<dcmplx> x,y;
+    A.mexview(&prhs[1]);  x.mexview(prhs[4]);
   
     //  multiplication of H-matrix with matrix
-    y=A*x;
+    y=area.empty() ? A*x : mul_sym(A,area,x);
     //  set output
     plhs[0]=setmex(y);      
   }
   
-  //  clear globals
-  tree.clear(); ind1.clear(); ind2.clear(); timer.clear();  
+  //  memory statistics
+  if (nlhs>1) plhs[1]=setmex(memstat);
+}
+
+//  clear globals, also after errors (see mexcall in hoptions.h)
+static void clearglobals()
+{
+  tree.clear(); ind1.clear(); ind2.clear(); timer.clear();
+}
+
+//  MEX function, errors such as exceeded memory budget raised after clean-up (hoptions.h)
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  mexcall(mexbody,clearglobals,nlhs,plhs,nrhs,prhs);
 }
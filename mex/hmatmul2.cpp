@@ -4,6 +4,8 @@
 #include "hoptions.h"
 #include "clustertree.h"
 #include "hmatrix.h"
+#include "hstats.h"
+#include "hrecord.h"
 
 using namespace std;
 
@@ -17,29 +19,38 @@ map<string,double> timer;
 
 
 //  multiply two H-matrices, deal with calling sequence: tree, A1, L1, R1, A1, L1, R1, [op]
-void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+static void mexbody(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
 {
+  //  record inputs for replay (hrecord.h)
+  record("hmatmul2",nlhs,nrhs,prhs);
+  //  peak memory and budget of this call (hmemory.h)
+  memstat.reset();
   tree.getmex(prhs[0],ind1,ind2);
   //  set tolerance and maximum rank for low-rank matrix
   if (nrhs==8)
   {
     if (mxGetField(prhs[7],0,"htol")) hopts.tol=mxGetScalar(mxGetField(prhs[7],0,"htol"));
     if (mxGetField(prhs[7],0,"kmax")) hopts.kmax=(size_t)mxGetScalar(mxGetField(prhs[7],0,"kmax"));
+    memstat.getmex(prhs[7]);
   }    
   
+  //  block statistics of result
+  hstats hs;
+
   //  real input ?
   if (!mxIsComplex(mxGetCell(prhs[1],0)))
   {
     hmatrix<double> A,B,C;
  
     //  get input
-    A=hmatrix<double>::getmex(&prhs[1]);
-    B=hmatrix<double>::getmex(&prhs[4]);
+    A.mexview(&prhs[1]);
+    B.mexview(&prhs[4]);
  
-    timer.clear(); tic;
+    timer.clear(); acastat.clear(); tic;
     //  multiplication of H-matrices
     C=A*B;
     toc("main");
+    if (nlhs==4) hs.add(C);
   
     //  set output
     setmex<double>(C,plhs);
@@ -49,19 +60,20 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
     hmatrix<dcmplx> A,B,C;
  
     //  get input
-    A=hmatrix<dcmplx>::getmex(&prhs[1]);
-    B=hmatrix<dcmplx>::getmex(&prhs[4]);
+    A.mexview(&prhs[1]);
+    B.mexview(&prhs[4]);
  
-    timer.clear(); tic;
+    timer.clear(); acastat.clear(); tic;
     //  multiplication of H-matrices
     C=A*B;
     toc("main");
+    if (nlhs==4) hs.add(C);
   
     //  set output
     setmex<dcmplx>(C,plhs); 
   }
     
-  //  timer statistics
+  //  timer and H-matrix statistics
   if (nlhs==4)
   {
     plhs[3]=mxCreateStructMatrix(1,1,0,NULL);
@@ -71,7 +83,22 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
       mxAddField(plhs[3],&it->first[0]);
       mxSetField(plhs[3],0,&it->first[0],mxCreateDoubleScalar(it->second));
     }
+    //  H-matrix and ACA statistics
+    mxAddField(plhs[3],"hstat");
+    mxSetField(plhs[3],0,"hstat",setmex(hs));
+    //  memory statistics
+    addmex(plhs[3],memstat);
   }
-  //  clear globals
-  tree.clear(); ind1.clear(); ind2.clear(); timer.clear();
+}
+
+//  clear globals, also after errors (see mexcall in hoptions.h)
+static void clearglobals()
+{
+  tree.clear(); ind1.clear(); ind2.clear(); timer.clear(); acastat.clear();
+}
+
+//  MEX function, errors such as exceeded memory budget raised after clean-up (hoptions.h)
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  mexcall(mexbody,clearglobals,nlhs,plhs,nrhs,prhs);
 }
@@ -5,6 +5,9 @@
 #include "clustertree.h"
 #include "hmatrix.h"
 #include "lu.h"
+#include "ldl.h"
+#include "mixed.h"
+#include "hrecord.h"
 
 using namespace std;
 
@@ -16,38 +19,101 @@ matrix<size_t> ind1,ind2;
 struct hoptions hopts = { 1e-6, 100 };
 map<string,double> timer;
 
-//  matrix inversion using LU decomposition, deal with calling sequence: tree, A, L, R, b, key
-void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+//  matrix inversion using LU decomposition, deal with calling sequence: tree, A, L, R, b, key, [op]
+//    for symmetric storage op.area gives the boundary element areas (see ldl.h),
+//    op.maxmem the memory budget, optional second output with memory statistics
+static void mexbody(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
 {
+  //  record inputs for replay (hrecord.h)
+  record("hmatsolve",nlhs,nrhs,prhs);
+  //  peak memory and budget of this call (hmemory.h)
+  memstat.reset();
   tree.getmex(prhs[0],ind1,ind2); 
   char key=*mxGetChars(prhs[5]);
+  //  areas for symmetric storage
+  matrix<double> area;
+  if (nrhs==7 && mxGetField(prhs[6],0,"area")) area=matrix<double>::getmex(mxGetField(prhs[6],0,"area"));
+  if (nrhs==7) memstat.getmex(prhs[6]);
+  //  allocations tagged for memory statistics
+  memscope scope(memSolve);
   
+  //  LU decomposition stored in single precision (mixed.h), solution in double precision
+  if (mxIsSingle(mxGetCell(prhs[1],0)))
+  {
+    if (!area.empty()) throw std::invalid_argument("hmatsolve: single precision requires unsymmetric storage");
+    if (!mxIsComplex(mxGetCell(prhs[1],0)))
+    {
+      hmatrix<float> A;
+      A.mexview(&prhs[1]);
+      matrix<double> b;
+      mxArray* lhs=mexalloc(prhs[4],b);
+      mixed_solve(A,b,key);
+      plhs[0]=setmex(b,lhs);
+    }
+    else
+    {
+      hmatrix<fcmplx> A;
+      A.mexview(&prhs[1]);
+      matrix<dcmplx> b;
+      mxArray* lhs=mexalloc(prhs[4],b);
+      mixed_solve(A,b,key);
+      plhs[0]=setmex(b,lhs);
+    }
+  }
   //  real input ?
-  if (!mxIsComplex(mxGetCell(prhs[1],0)))
+  else if (!mxIsComplex(mxGetCell(prhs[1],0)))
   {
-    hmatrix<double> A=hmatrix<double>::getmex(&prhs[1]);
-    matrix<double> b=matrix<double>::getmex(prhs[4]);
+    hmatrix<double> A;
+    A.mexview(&prhs[1]);
+    //  solution is computed in place in output array
+    matrix<double> b;
+    mxArray* lhs=mexalloc(prhs[4],b);
   
-    //  solve matrix equation using LU decomposition
-    if (key=='L' || key=='N') solve(A,b,0,'L');
-    if (key=='U' || key=='N') solve(A,b,0,'U');
+    //  solve matrix equation using LU or LDL' decomposition
+    if (!area.empty())
+      solve_sym(A,area,b,key);
+    else
+    {
+      if (key=='L' || key=='N') solve(A,b,0,'L');
+      if (key=='U' || key=='N') solve(A,b,0,'U');
+    }
   
     //  set output
-    plhs[0]=setmex(b);   
+    plhs[0]=setmex(b,lhs);
   }
   else  //  complex input
   {
-    hmatrix<dcmplx> A=hmatrix<dcmplx>::getmex(&prhs[1]);
-    matrix<dcmplx> b=matrix<dcmplx>::getmex(prhs[4]);
+    hmatrix<dcmplx> A;
+    A.mexview(&prhs[1]);
+    //  solution is computed in place in output array
+    matrix<dcmplx> b;
+    mxArray* lhs=mexalloc(prhs[4],b);
   
-    //  solve matrix equation using LU decomposition
-    if (key=='L' || key=='N') solve(A,b,0,'L');
-    if (key=='U' || key=='N') solve(A,b,0,'U');
+    //  solve matrix equation using LU or LDL' decomposition
+    if (!area.empty())
+      solve_sym(A,area,b,key);
+    else
+    {
+      if (key=='L' || key=='N') solve(A,b,0,'L');
+      if (key=='U' || key=='N') solve(A,b,0,'U');
+    }
     
     //  set output
-    plhs[0]=setmex(b);       
+    plhs[0]=setmex(b,lhs);
   }
   
-  //  clear globals
-  tree.clear(); ind1.clear(); ind2.clear(); timer.clear();  
+  //  memory statistics
+  if (nlhs>1) plhs[1]=setmex(memstat);
+}
+
+//  clear globals, also after errors (see mexcall in hoptions.h)
+static void clearglobals()
+{
+  tree.clear(); ind1.clear(); ind2.clear(); timer.clear();
+}
+
+//  MEX function, errors such as exceeded memory budget raised after clean-up (hoptions.h)
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  mexcall(mexbody,clearglobals,nlhs,plhs,nrhs,prhs);
 }
@@ -0,0 +1,146 @@
+#include "mex.h"
+#include "matrix.h"
+
+#include <cstring>
+
+#include "hoptions.h"
+#include "clustertree.h"
+#include "hrecord.h"
+
+using namespace std;
+
+//  cluster tree
+clustertree tree;
+//  indices for full and low-rank matrices
+matrix<size_t> ind1,ind2;
+
+struct hoptions hopts = { 1e-6, 500 };
+map<string,double> timer;
+
+
+//  index matrix from Matlab array, Matlab arrays start with 1
+matrix<size_t> getindex(const mxArray* rhs)
+{
+  matrix<size_t> ind(mxGetM(rhs),mxGetN(rhs));
+  const double* p=mxGetPr(rhs);
+  for (size_t i=0; i<mxGetNumberOfElements(rhs); i++) ind[i]=p[i] ? (size_t)p[i]-1 : 0;
+  return ind;
+}
+
+//  Matlab array from index matrix, shift for conversion to Matlab indexing
+mxArray* setindex(const matrix<size_t>& ind, size_t shift=1)
+{
+  matrix<double> mat;
+  mxArray* lhs=mexalloc(ind.empty() ? 0 : ind.nrows(),ind.empty() ? 0 : ind.ncols(),mat);
+  for (size_t i=0; !ind.empty() && i<ind.nrows()*ind.ncols(); i++) mat[i]=(double)(ind[i]+shift);
+  return lhs;
+}
+
+//  cluster tree from structure with fields son, mid, rad, ipart of @clustertree
+void gettree(const mxArray* rhs, treebuilder& t)
+{
+  t.sons=getindex(mxGetField(rhs,0,"son"));
+  t.mid =matrix<double>::getmex(mxGetField(rhs,0,"mid"));
+  t.rad =matrix<double>::getmex(mxGetField(rhs,0,"rad"));
+  //  particle index, zero for composite clusters
+  const mxArray* ip=mxGetField(rhs,0,"ipart");
+  t.ipart=matrix<size_t>(mxGetNumberOfElements(ip),1);
+  for (size_t i=0; i<t.ipart.nrows(); i++) t.ipart[i]=(size_t)mxGetPr(ip)[i];
+}
+
+//  cluster tree and block tree, see @clustertree/clustertree.m and admissibility.m
+//    [son,cind,ind,mid,rad,ipart]=hmattree('tree',pos,ip,cleaf)
+//                                  cluster tree through bisection, ip particle index of
+//                                    positions, output same as properties of clustertree
+//    [row1,col1,row2,col2]=hmattree('admiss',tree1,tree2,op)
+//                                  full and low-rank matrices of block tree, tree1 and
+//                                    tree2 structures with son, mid, rad, ipart, op with
+//                                    admiss ('min' or 'max') and eta for the admissibility
+//                                    condition eta*min(rad1,rad2)<dist (default 2.5)
+//                                    and memory budget maxmem
+//    optional last output with memory statistics (see hmemory.h)
+static void mexbody(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  //  record inputs for replay (hrecord.h)
+  record("hmattree",nlhs,nrhs,prhs);
+  //  peak memory and budget of this call (hmemory.h)
+  memstat.reset();
+  char cmd[32];
+  if (nrhs<1 || mxGetString(prhs[0],cmd,sizeof(cmd))) throw std::invalid_argument("hmattree: command expected");
+
+  if (!strcmp(cmd,"tree"))
+  {
+    //  positions and particle index
+    matrix<double> pos=matrix<double>::getmex(prhs[1]);
+    matrix<size_t> ip(mxGetNumberOfElements(prhs[2]),1);
+    for (size_t i=0; i<ip.nrows(); i++) ip[i]=(size_t)mxGetPr(prhs[2])[i];
+    if (pos.ncols()!=3 || ip.nrows()!=pos.nrows())
+      throw std::invalid_argument("hmattree: positions must be n x 3 array with particle index for each row");
+    size_t cleaf=(nrhs>3) ? (size_t)mxGetScalar(prhs[3]) : 32;
+
+    treebuilder t;
+    t.build(pos,ip,cleaf);
+
+    //  sons, zero for leaves
+    matrix<double> son;
+    plhs[0]=mexalloc(t.sons.nrows(),2,son);
+    for (size_t i=0; i<son.nrows()*2; i++) son[i]=t.sons[i] ? (double)(t.sons[i]+1) : 0;
+    //  cluster indices (first and last element)
+    matrix<double> cind;
+    plhs[1]=mexalloc(t.ind.nrows(),2,cind);
+    for (size_t i=0; i<cind.nrows(); i++) { cind(i,0)=t.ind(i,0)+1;  cind(i,1)=(double)t.ind(i,1); }
+    //  conversion between particle index and cluster index
+    matrix<double> ind;
+    plhs[2]=mexalloc(t.perm.nrows(),2,ind);
+    for (size_t i=0; i<ind.nrows(); i++)
+      { ind(i,0)=t.perm[i]+1;  ind(t.perm[i],1)=i+1; }
+    //  bounding spheres and particle index
+    plhs[3]=setmex(t.mid);
+    plhs[4]=setmex(t.rad);
+    plhs[5]=setindex(t.ipart,0);
+    if (nlhs>6) plhs[6]=setmex(memstat);
+  }
+  else if (!strcmp(cmd,"admiss"))
+  {
+    treebuilder t1, t2;
+    gettree(prhs[1],t1);
+    gettree(prhs[2],t2);
+
+    //  admissibility condition
+    char name[8]="min";
+    double eta=2.5;
+    const mxArray* f;
+    if (nrhs>3 && (f=mxGetField(prhs[3],0,"admiss")) && !mxIsEmpty(f)) mxGetString(f,name,sizeof(name));
+    if (nrhs>3 && (f=mxGetField(prhs[3],0,"eta"))    && !mxIsEmpty(f)) eta=mxGetScalar(f);
+    if (nrhs>3) memstat.getmex(prhs[3]);
+
+    if (!strcmp(name,"min"))
+      t1.blocktree(t2,admiss_min(eta),ind1,ind2);
+    else if (!strcmp(name,"max"))
+      t1.blocktree(t2,admiss_max(eta),ind1,ind2);
+    else
+      throw std::invalid_argument("hmattree: unknown admissibility condition");
+
+    //  rows and columns of full and low-rank matrices
+    matrix<size_t> r1, c1, r2, c2;
+    if (!ind1.empty()) { r1=matrix<size_t>(ind1.nrows(),1,&ind1(0,0));  c1=matrix<size_t>(ind1.nrows(),1,&ind1(0,1)); }
+    if (!ind2.empty()) { r2=matrix<size_t>(ind2.nrows(),1,&ind2(0,0));  c2=matrix<size_t>(ind2.nrows(),1,&ind2(0,1)); }
+    plhs[0]=setindex(r1);  plhs[1]=setindex(c1);
+    plhs[2]=setindex(r2);  plhs[3]=setindex(c2);
+    if (nlhs>4) plhs[4]=setmex(memstat);
+  }
+  else
+    throw std::invalid_argument("hmattree: unknown command");
+}
+
+//  clear globals, also after errors (see mexcall in hoptions.h)
+static void clearglobals()
+{
+  tree.clear(); ind1.clear(); ind2.clear(); timer.clear();
+}
+
+//  MEX function, errors such as exceeded memory budget raised after clean-up (hoptions.h)
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  mexcall(mexbody,clearglobals,nlhs,plhs,nrhs,prhs);
+}
@@ -4,7 +4,7 @@ function makemex( finp )
 if ~exist( 'finp', 'var' )
   finp = { 'hmatfull', 'hmatadd', 'hmatinv', 'hmatmul1', 'hmatmul2',      ...
            'hmatfun', 'hmatlu', 'hmatsolve', 'hmatlsolve', 'hmatrsolve',  ...
-           'hmatgreenstat', 'hmatgreenret', 'hmatgreentab1', 'hmatgreentab2' };
+           'hmatgreenstat', 'hmatgreenret', 'hmatgreentab1', 'hmatgreentab2', 'greenlayertab', 'hmathandle', 'hmattree' };
 elseif ~iscell( finp )
   finp = { finp };
 end
@@ -17,6 +17,8 @@ switch computer( 'arch' )
     %  BLAS and LAPACK library
     blaslib = fullfile( matlabroot, 'extern', 'lib', computer( 'arch' ), 'microsoft', 'libmwblas.lib' );
     lapacklib = fullfile( matlabroot, 'extern', 'lib', computer( 'arch' ), 'microsoft', 'libmwlapack.lib' );
+    %  OpenMP compiler flags
+    ompflags = { 'COMPFLAGS="$COMPFLAGS /openmp"' };
  
   %  Building on Linux Platforms
   case 'glnxa64'
@@ -25,6 +27,8 @@ switch computer( 'arch' )
     %  BLAS and LAPACK library
     blaslib = '-lmwblas';
     lapacklib = '-lmwlapack';   
+    %  OpenMP compiler flags
+    ompflags = { 'CXXFLAGS="$CXXFLAGS -fopenmp"', 'LDFLAGS="$LDFLAGS -fopenmp"' };
     
   %  Building on Apple Mac Platforms
   case 'maci64'
@@ -33,6 +37,8 @@ switch computer( 'arch' )
     %  BLAS and LAPACK library
     blaslib = '-lmwblas';
     lapacklib = '-lmwlapack';       
+    %  no OpenMP support with default compiler
+    ompflags = {};
 end
     
 %  directory of header files for hierarchical matrices and ACA
@@ -45,9 +51,22 @@ lu = fullfile( 'hlib', 'lu.cpp' );
 acagreen = fullfile( 'acagreen', 'acagreen.cpp' );
 greentab = fullfile( 'acagreen', 'greentab.cpp' );
 interp = fullfile( 'acagreen', 'interp.cpp' );
+tabcache = fullfile( 'acagreen', 'tabcache.cpp' );
+greenlayer = fullfile( 'acagreen', 'greenlayer.cpp' );
+hfile = fullfile( 'hlib', 'hfile.cpp' );
+hstore = fullfile( 'hlib', 'hstore.cpp' );
+bemop = fullfile( 'hlib', 'bemop.cpp' );
+clustertree = fullfile( 'hlib', 'clustertree.cpp' );
 
+%  interleaved complex API (Matlab R2018a and later), complex arrays are
+%    passed between Matlab and C++ without conversion
+if verLessThan( 'matlab', '9.4' )
+  api = '-largeArrayDims';
+else
+  api = '-R2018a';
+end
 %  default parameters and libraries
-param = { '-v', '-largeArrayDims', '-O',  ...
+param = { '-v', api, '-O',  ...
   ['-I' hlibdir ], [ '-I', acadir ], '-outdir', outdir };
 libs = { blaslib, lapacklib };
 
@@ -57,11 +76,17 @@ for name = finp
     case { 'hmatfull', 'hmatadd', 'hmatinv', 'hmatmul1', 'hmatmul2', 'hmatfun', }
       mex( param{ : }, [ name{ : }, '.cpp' ], basemat, aca, libs{ : } );
     case { 'hmatlu', 'hmatsolve', 'hmatlsolve', 'hmatrsolve' }
-      mex( param{ : }, [ name{ : }, '.cpp' ], basemat, aca, lu, libs{ : } );
+      mex( param{ : }, ompflags{ : }, [ name{ : }, '.cpp' ], basemat, aca, lu, libs{ : } );
+    case 'hmathandle'
+      mex( param{ : }, ompflags{ : }, [ name{ : }, '.cpp' ], basemat, aca, lu, hfile, hstore, bemop, libs{ : } );
+    case 'hmattree'
+      mex( param{ : }, [ name{ : }, '.cpp' ], basemat, clustertree, libs{ : } );
     case { 'hmatgreenstat', 'hmatgreenret' }
       mex( param{ : }, [ name{ : }, '.cpp' ], basemat, aca, acagreen, libs{ : } );
     case { 'hmatgreentab1', 'hmatgreentab2' }
-      mex( param{ : }, [ name{ : }, '.cpp' ], basemat, aca, greentab, interp, libs{ : } );
+      mex( param{ : }, [ name{ : }, '.cpp' ], basemat, aca, greentab, interp, tabcache, libs{ : } );
+    case 'greenlayertab'
+      mex( param{ : }, ompflags{ : }, [ name{ : }, '.cpp' ], basemat, greenlayer, libs{ : } );
   end
 end
   
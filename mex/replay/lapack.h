@@ -0,0 +1,20 @@
+//  lapack.h - LAPACK routines for replay of MEX functions, as declared by Matlab.
+
+#include <cstddef>
+
+#ifndef replay_lapack_h
+#define replay_lapack_h
+
+#include "hoptions.h"
+
+extern "C"
+{
+  void F77_NAME(dgetrf)(const ptrdiff_t*, const ptrdiff_t*, double*, const ptrdiff_t*, ptrdiff_t*, ptrdiff_t*);
+  void F77_NAME(dgetri)(const ptrdiff_t*, double*, const ptrdiff_t*, const ptrdiff_t*, double*,
+                        const ptrdiff_t*, ptrdiff_t*);
+  void F77_NAME(zgetrf)(const ptrdiff_t*, const ptrdiff_t*, double*, const ptrdiff_t*, ptrdiff_t*, ptrdiff_t*);
+  void F77_NAME(zgetri)(const ptrdiff_t*, double*, const ptrdiff_t*, const ptrdiff_t*, double*,
+                        const ptrdiff_t*, ptrdiff_t*);
+}
+
+#endif  //  replay_lapack_h
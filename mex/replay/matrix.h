@@ -0,0 +1,105 @@
+//  matrix.h - Matlab array API for replay of MEX functions without Matlab.
+//
+//  Subset of the Matlab array API used by the MEX functions, arrays are kept in C++
+//  memory (mxarray.cpp).  Complex arrays use the interleaved complex API of Matlab
+//  R2018a, such that the MEX functions compile as with mex -R2018a.
+
+#include <cstddef>
+#include <stdint.h>
+
+#ifndef replay_matrix_h
+#define replay_matrix_h
+
+#define MX_HAS_INTERLEAVED_COMPLEX 1
+
+typedef struct mxArray_tag mxArray;
+typedef size_t mwSize;
+typedef size_t mwIndex;
+typedef uint16_t mxChar;
+typedef bool mxLogical;
+typedef double mxDouble;
+typedef float mxSingle;
+typedef struct { double real, imag; } mxComplexDouble;
+typedef struct { float real, imag; } mxComplexSingle;
+
+//  class IDs with the same values as in Matlab
+typedef enum
+{
+  mxUNKNOWN_CLASS, mxCELL_CLASS, mxSTRUCT_CLASS, mxLOGICAL_CLASS, mxCHAR_CLASS, mxVOID_CLASS,
+  mxDOUBLE_CLASS, mxSINGLE_CLASS, mxINT8_CLASS, mxUINT8_CLASS, mxINT16_CLASS, mxUINT16_CLASS,
+  mxINT32_CLASS, mxUINT32_CLASS, mxINT64_CLASS, mxUINT64_CLASS, mxFUNCTION_CLASS
+} mxClassID;
+typedef enum { mxREAL, mxCOMPLEX } mxComplexity;
+
+extern "C"
+{
+  //  create and destroy arrays
+  mxArray* mxCreateNumericArray(mwSize ndim, const mwSize* dims, mxClassID id, mxComplexity flag);
+  mxArray* mxCreateNumericMatrix(mwSize m, mwSize n, mxClassID id, mxComplexity flag);
+  mxArray* mxCreateUninitNumericMatrix(mwSize m, mwSize n, mxClassID id, mxComplexity flag);
+  mxArray* mxCreateDoubleMatrix(mwSize m, mwSize n, mxComplexity flag);
+  mxArray* mxCreateDoubleScalar(double x);
+  mxArray* mxCreateLogicalArray(mwSize ndim, const mwSize* dims);
+  mxArray* mxCreateLogicalScalar(bool x);
+  mxArray* mxCreateCharArray(mwSize ndim, const mwSize* dims);
+  mxArray* mxCreateString(const char* str);
+  mxArray* mxCreateCellArray(mwSize ndim, const mwSize* dims);
+  mxArray* mxCreateCellMatrix(mwSize m, mwSize n);
+  mxArray* mxCreateStructArray(mwSize ndim, const mwSize* dims, int nfields, const char** names);
+  mxArray* mxCreateStructMatrix(mwSize m, mwSize n, int nfields, const char** names);
+  void mxDestroyArray(mxArray* x);
+
+  //  class and size
+  mxClassID mxGetClassID(const mxArray* x);
+  size_t mxGetM(const mxArray* x);
+  size_t mxGetN(const mxArray* x);
+  size_t mxGetNumberOfElements(const mxArray* x);
+  size_t mxGetNumberOfDimensions(const mxArray* x);
+  const mwSize* mxGetDimensions(const mxArray* x);
+  size_t mxGetElementSize(const mxArray* x);
+  bool mxIsComplex(const mxArray* x);
+  bool mxIsEmpty(const mxArray* x);
+  bool mxIsScalar(const mxArray* x);
+  bool mxIsNumeric(const mxArray* x);
+  bool mxIsDouble(const mxArray* x);
+  bool mxIsSingle(const mxArray* x);
+  bool mxIsUint64(const mxArray* x);
+  bool mxIsLogical(const mxArray* x);
+  bool mxIsChar(const mxArray* x);
+  bool mxIsCell(const mxArray* x);
+  bool mxIsStruct(const mxArray* x);
+
+  //  data of numeric, char and logical arrays
+  void* mxGetData(const mxArray* x);
+  void* mxGetImagData(const mxArray* x);
+  double* mxGetPr(const mxArray* x);
+  double* mxGetPi(const mxArray* x);
+  mxDouble* mxGetDoubles(const mxArray* x);
+  mxSingle* mxGetSingles(const mxArray* x);
+  mxComplexDouble* mxGetComplexDoubles(const mxArray* x);
+  mxComplexSingle* mxGetComplexSingles(const mxArray* x);
+  mxLogical* mxGetLogicals(const mxArray* x);
+  mxChar* mxGetChars(const mxArray* x);
+  double mxGetScalar(const mxArray* x);
+  int mxGetString(const mxArray* x, char* str, mwSize len);
+  char* mxArrayToString(const mxArray* x);
+
+  //  cells and structures
+  mxArray* mxGetCell(const mxArray* x, mwIndex i);
+  void mxSetCell(mxArray* x, mwIndex i, mxArray* val);
+  int mxGetNumberOfFields(const mxArray* x);
+  const char* mxGetFieldNameByNumber(const mxArray* x, int k);
+  int mxGetFieldNumber(const mxArray* x, const char* name);
+  int mxAddField(mxArray* x, const char* name);
+  mxArray* mxGetField(const mxArray* x, mwIndex i, const char* name);
+  void mxSetField(mxArray* x, mwIndex i, const char* name, mxArray* val);
+  mxArray* mxGetFieldByNumber(const mxArray* x, mwIndex i, int k);
+  void mxSetFieldByNumber(mxArray* x, mwIndex i, int k, mxArray* val);
+
+  //  memory
+  void* mxMalloc(size_t n);
+  void* mxCalloc(size_t n, size_t size);
+  void mxFree(void* ptr);
+}
+
+#endif  //  replay_matrix_h
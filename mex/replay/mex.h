@@ -0,0 +1,29 @@
+//  mex.h - MEX API for replay of MEX functions without Matlab.
+//
+//  Errors print the message and end the program, Matlab functions cannot be called.
+
+#ifndef replay_mex_h
+#define replay_mex_h
+
+#include "matrix.h"
+
+extern "C"
+{
+  //  entry point of MEX function
+  void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]);
+
+  int mexPrintf(const char* fmt, ...);
+  void mexErrMsgTxt(const char* msg);
+  void mexErrMsgIdAndTxt(const char* id, const char* fmt, ...);
+  void mexWarnMsgTxt(const char* msg);
+  int mexCallMATLAB(int nlhs, mxArray* plhs[], int nrhs, mxArray* prhs[], const char* name);
+
+  void mexLock(void);
+  void mexUnlock(void);
+  bool mexIsLocked(void);
+  int mexAtExit(void (*fun)(void));
+  void mexMakeArrayPersistent(mxArray* x);
+  void mexMakeMemoryPersistent(void* ptr);
+}
+
+#endif  //  replay_mex_h
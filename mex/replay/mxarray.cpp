@@ -0,0 +1,332 @@
+//  mxarray.cpp - Matlab arrays in C++ memory for replay of MEX functions.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdarg>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include "mex.h"
+
+//  Matlab array
+struct mxArray_tag
+{
+  mxClassID id;
+  bool complex;
+  std::vector<mwSize> dims;
+  //  values of numeric, char and logical arrays, complex values interleaved
+  std::vector<char> data;
+  //  field names, elements of cell arrays or structures (field index runs fastest)
+  std::vector<std::string> fields;
+  std::vector<mxArray*> elems;
+
+  size_t numel() const
+    {
+      size_t n=1;
+      for (size_t i=0; i<dims.size(); i++) n*=dims[i];
+      return n;
+    }
+};
+
+//  size of real elements of class
+static size_t classsize(mxClassID id)
+{
+  switch (id)
+  {
+    case mxLOGICAL_CLASS: return sizeof(mxLogical);
+    case mxCHAR_CLASS:    return sizeof(mxChar);
+    case mxDOUBLE_CLASS:  return sizeof(double);
+    case mxSINGLE_CLASS:  return sizeof(float);
+    case mxINT8_CLASS:  case mxUINT8_CLASS:  return 1;
+    case mxINT16_CLASS: case mxUINT16_CLASS: return 2;
+    case mxINT32_CLASS: case mxUINT32_CLASS: return 4;
+    case mxINT64_CLASS: case mxUINT64_CLASS: return 8;
+    default: return sizeof(mxArray*);
+  }
+}
+
+//  new array, at least two dimensions
+static mxArray* create(mxClassID id, mxComplexity flag, mwSize ndim, const mwSize* dims, size_t nfields=0)
+{
+  mxArray* x=new mxArray;
+  x->id=id;  x->complex=flag==mxCOMPLEX;
+  x->dims.assign(dims,dims+ndim);
+  while (x->dims.size()<2) x->dims.push_back(x->dims.empty() ? 0 : 1);
+  if (id==mxCELL_CLASS)
+    x->elems.assign(x->numel(),(mxArray*)0);
+  else if (id==mxSTRUCT_CLASS)
+    x->elems.assign(x->numel()*nfields,(mxArray*)0);
+  else
+    x->data.assign(x->numel()*classsize(id)*(x->complex ? 2 : 1),0);
+  return x;
+}
+
+static mwSize dims2[2];
+static const mwSize* matsize(mwSize m, mwSize n) { dims2[0]=m;  dims2[1]=n;  return dims2; }
+
+
+/*
+ *  create and destroy arrays
+ */
+
+mxArray* mxCreateNumericArray(mwSize ndim, const mwSize* dims, mxClassID id, mxComplexity flag)
+  { return create(id,flag,ndim,dims); }
+mxArray* mxCreateNumericMatrix(mwSize m, mwSize n, mxClassID id, mxComplexity flag)
+  { return create(id,flag,2,matsize(m,n)); }
+mxArray* mxCreateUninitNumericMatrix(mwSize m, mwSize n, mxClassID id, mxComplexity flag)
+  { return create(id,flag,2,matsize(m,n)); }
+mxArray* mxCreateDoubleMatrix(mwSize m, mwSize n, mxComplexity flag)
+  { return create(mxDOUBLE_CLASS,flag,2,matsize(m,n)); }
+mxArray* mxCreateLogicalArray(mwSize ndim, const mwSize* dims)
+  { return create(mxLOGICAL_CLASS,mxREAL,ndim,dims); }
+mxArray* mxCreateCharArray(mwSize ndim, const mwSize* dims)
+  { return create(mxCHAR_CLASS,mxREAL,ndim,dims); }
+mxArray* mxCreateCellArray(mwSize ndim, const mwSize* dims)
+  { return create(mxCELL_CLASS,mxREAL,ndim,dims); }
+mxArray* mxCreateCellMatrix(mwSize m, mwSize n)
+  { return create(mxCELL_CLASS,mxREAL,2,matsize(m,n)); }
+
+mxArray* mxCreateDoubleScalar(double val)
+{
+  mxArray* x=mxCreateDoubleMatrix(1,1,mxREAL);
+  *mxGetPr(x)=val;
+  return x;
+}
+
+mxArray* mxCreateLogicalScalar(bool val)
+{
+  mxArray* x=mxCreateLogicalArray(2,matsize(1,1));
+  *mxGetLogicals(x)=val;
+  return x;
+}
+
+mxArray* mxCreateString(const char* str)
+{
+  size_t n=std::strlen(str);
+  mxArray* x=mxCreateCharArray(2,matsize(1,n));
+  std::copy(str,str+n,mxGetChars(x));
+  return x;
+}
+
+mxArray* mxCreateStructArray(mwSize ndim, const mwSize* dims, int nfields, const char** names)
+{
+  mxArray* x=create(mxSTRUCT_CLASS,mxREAL,ndim,dims,nfields);
+  for (int k=0; k<nfields; k++) x->fields.push_back(names[k]);
+  return x;
+}
+
+mxArray* mxCreateStructMatrix(mwSize m, mwSize n, int nfields, const char** names)
+  { return mxCreateStructArray(2,matsize(m,n),nfields,names); }
+
+void mxDestroyArray(mxArray* x)
+{
+  if (!x) return;
+  for (size_t i=0; i<x->elems.size(); i++) mxDestroyArray(x->elems[i]);
+  delete x;
+}
+
+
+/*
+ *  class and size
+ */
+
+mxClassID mxGetClassID(const mxArray* x) { return x->id; }
+size_t mxGetM(const mxArray* x) { return x->dims[0]; }
+size_t mxGetN(const mxArray* x)
+{
+  size_t n=1;
+  for (size_t i=1; i<x->dims.size(); i++) n*=x->dims[i];
+  return n;
+}
+size_t mxGetNumberOfElements(const mxArray* x) { return x->numel(); }
+size_t mxGetNumberOfDimensions(const mxArray* x) { return x->dims.size(); }
+const mwSize* mxGetDimensions(const mxArray* x) { return &x->dims[0]; }
+size_t mxGetElementSize(const mxArray* x) { return classsize(x->id)*(x->complex ? 2 : 1); }
+
+bool mxIsComplex(const mxArray* x) { return x->complex; }
+bool mxIsEmpty(const mxArray* x)   { return x->numel()==0; }
+bool mxIsScalar(const mxArray* x)  { return x->numel()==1; }
+bool mxIsNumeric(const mxArray* x) { return x->id>=mxDOUBLE_CLASS && x->id<=mxUINT64_CLASS; }
+bool mxIsDouble(const mxArray* x)  { return x->id==mxDOUBLE_CLASS; }
+bool mxIsSingle(const mxArray* x)  { return x->id==mxSINGLE_CLASS; }
+bool mxIsUint64(const mxArray* x)  { return x->id==mxUINT64_CLASS; }
+bool mxIsLogical(const mxArray* x) { return x->id==mxLOGICAL_CLASS; }
+bool mxIsChar(const mxArray* x)    { return x->id==mxCHAR_CLASS; }
+bool mxIsCell(const mxArray* x)    { return x->id==mxCELL_CLASS; }
+bool mxIsStruct(const mxArray* x)  { return x->id==mxSTRUCT_CLASS; }
+
+
+/*
+ *  data of numeric, char and logical arrays
+ */
+
+void* mxGetData(const mxArray* x) { return x->data.empty() ? 0 : (void*)&x->data[0]; }
+//  only for separate storage of real and imaginary parts
+void* mxGetImagData(const mxArray*) { return 0; }
+double* mxGetPr(const mxArray* x) { return (double*)mxGetData(x); }
+double* mxGetPi(const mxArray*)   { return 0; }
+
+mxDouble* mxGetDoubles(const mxArray* x)
+  { return (x->id==mxDOUBLE_CLASS && !x->complex) ? (mxDouble*)mxGetData(x) : 0; }
+mxSingle* mxGetSingles(const mxArray* x)
+  { return (x->id==mxSINGLE_CLASS && !x->complex) ? (mxSingle*)mxGetData(x) : 0; }
+mxComplexDouble* mxGetComplexDoubles(const mxArray* x)
+  { return (x->id==mxDOUBLE_CLASS && x->complex) ? (mxComplexDouble*)mxGetData(x) : 0; }
+mxComplexSingle* mxGetComplexSingles(const mxArray* x)
+  { return (x->id==mxSINGLE_CLASS && x->complex) ? (mxComplexSingle*)mxGetData(x) : 0; }
+mxLogical* mxGetLogicals(const mxArray* x)
+  { return x->id==mxLOGICAL_CLASS ? (mxLogical*)mxGetData(x) : 0; }
+mxChar* mxGetChars(const mxArray* x)
+  { return x->id==mxCHAR_CLASS ? (mxChar*)mxGetData(x) : 0; }
+
+//  value of first element (real part)
+double mxGetScalar(const mxArray* x)
+{
+  const void* p=mxGetData(x);
+  if (!p) return 0;
+  switch (x->id)
+  {
+    case mxLOGICAL_CLASS: return *(const mxLogical*)p;
+    case mxCHAR_CLASS:    return *(const mxChar*)p;
+    case mxDOUBLE_CLASS:  return *(const double*)p;
+    case mxSINGLE_CLASS:  return *(const float*)p;
+    case mxINT8_CLASS:    return *(const int8_t*)p;
+    case mxUINT8_CLASS:   return *(const uint8_t*)p;
+    case mxINT16_CLASS:   return *(const int16_t*)p;
+    case mxUINT16_CLASS:  return *(const uint16_t*)p;
+    case mxINT32_CLASS:   return *(const int32_t*)p;
+    case mxUINT32_CLASS:  return *(const uint32_t*)p;
+    case mxINT64_CLASS:   return (double)*(const int64_t*)p;
+    case mxUINT64_CLASS:  return (double)*(const uint64_t*)p;
+    default: return 0;
+  }
+}
+
+//  copy char array to string of length len (including terminating zero),
+//    returns 1 if array is no char array or string is truncated
+int mxGetString(const mxArray* x, char* str, mwSize len)
+{
+  if (!len) return 1;
+  size_t n=(x->id==mxCHAR_CLASS) ? x->numel() : 0, m=std::min<size_t>(n,len-1);
+  const mxChar* c=mxGetChars(x);
+  for (size_t i=0; i<m; i++) str[i]=(char)c[i];
+  str[m]=0;
+  return (x->id!=mxCHAR_CLASS || n>m) ? 1 : 0;
+}
+
+char* mxArrayToString(const mxArray* x)
+{
+  if (x->id!=mxCHAR_CLASS) return 0;
+  char* str=(char*)mxMalloc(x->numel()+1);
+  mxGetString(x,str,x->numel()+1);
+  return str;
+}
+
+
+/*
+ *  cells and structures
+ */
+
+mxArray* mxGetCell(const mxArray* x, mwIndex i) { return x->elems[i]; }
+void mxSetCell(mxArray* x, mwIndex i, mxArray* val) { x->elems[i]=val; }
+
+int mxGetNumberOfFields(const mxArray* x) { return (int)x->fields.size(); }
+const char* mxGetFieldNameByNumber(const mxArray* x, int k) { return x->fields[k].c_str(); }
+
+int mxGetFieldNumber(const mxArray* x, const char* name)
+{
+  if (x->id!=mxSTRUCT_CLASS) return -1;
+  for (size_t k=0; k<x->fields.size(); k++) if (x->fields[k]==name) return (int)k;
+  return -1;
+}
+
+//  add field to structure, existing fields keep their number
+int mxAddField(mxArray* x, const char* name)
+{
+  int k=mxGetFieldNumber(x,name);
+  if (k>=0) return k;
+  size_t n=x->numel(), nf=x->fields.size();
+  std::vector<mxArray*> elems(n*(nf+1),(mxArray*)0);
+  for (size_t i=0; i<n; i++)
+  for (size_t k=0; k<nf; k++) elems[i*(nf+1)+k]=x->elems[i*nf+k];
+  x->elems.swap(elems);
+  x->fields.push_back(name);
+  return (int)nf;
+}
+
+mxArray* mxGetFieldByNumber(const mxArray* x, mwIndex i, int k)
+  { return x->elems[i*x->fields.size()+k]; }
+void mxSetFieldByNumber(mxArray* x, mwIndex i, int k, mxArray* val)
+  { x->elems[i*x->fields.size()+k]=val; }
+
+mxArray* mxGetField(const mxArray* x, mwIndex i, const char* name)
+{
+  int k=mxGetFieldNumber(x,name);
+  return (k<0 || i>=x->numel()) ? 0 : mxGetFieldByNumber(x,i,k);
+}
+
+void mxSetField(mxArray* x, mwIndex i, const char* name, mxArray* val)
+{
+  int k=mxGetFieldNumber(x,name);
+  if (k<0) mexErrMsgTxt("mxSetField: unknown field");
+  mxSetFieldByNumber(x,i,k,val);
+}
+
+
+/*
+ *  memory
+ */
+
+void* mxMalloc(size_t n) { return std::malloc(n); }
+void* mxCalloc(size_t n, size_t size) { return std::calloc(n,size); }
+void mxFree(void* ptr) { std::free(ptr); }
+
+
+/*
+ *  MEX API, errors end the program
+ */
+
+int mexPrintf(const char* fmt, ...)
+{
+  va_list args;
+  va_start(args,fmt);
+  int n=std::vprintf(fmt,args);
+  va_end(args);
+  return n;
+}
+
+void mexErrMsgTxt(const char* msg)
+{
+  std::fprintf(stderr,"Error: %s\n",msg);
+  std::exit(1);
+}
+
+void mexErrMsgIdAndTxt(const char*, const char* fmt, ...)
+{
+  va_list args;
+  va_start(args,fmt);
+  std::fprintf(stderr,"Error: ");
+  std::vfprintf(stderr,fmt,args);
+  std::fprintf(stderr,"\n");
+  va_end(args);
+  std::exit(1);
+}
+
+void mexWarnMsgTxt(const char* msg) { std::fprintf(stderr,"Warning: %s\n",msg); }
+
+int mexCallMATLAB(int, mxArray*[], int, mxArray*[], const char* name)
+{
+  std::fprintf(stderr,"Error: Matlab function %s cannot be called in replay\n",name);
+  std::exit(1);
+  return 1;
+}
+
+static bool locked=false;
+void mexLock(void)   { locked=true;  }
+void mexUnlock(void) { locked=false; }
+bool mexIsLocked(void) { return locked; }
+int mexAtExit(void (*)(void)) { return 0; }
+void mexMakeArrayPersistent(mxArray*) {}
+void mexMakeMemoryPersistent(void*) {}
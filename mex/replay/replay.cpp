@@ -0,0 +1,172 @@
+//  replay.cpp - Replay of MEX calls recorded with hrecord.h.
+//
+//  The program is linked with a single MEX function and the Matlab array API of this
+//  directory.  It reads the inputs of a recorded call and passes them to mexFunction,
+//  e.g. under a profiler such as perf or valgrind.  The wall-clock time of each call is
+//  written to stderr, outputs of the last call are summarized on stdout, in particular
+//  structures with timer, block and memory statistics.
+
+/* hmatlu [options] file.rec      //  replay recorded call of hmatlu
+ *
+ *   --repeat 1                   //  number of calls
+ *   --threads 0                  //  number of OpenMP threads (0 for default)
+ *   --depth 2                    //  depth of output summary (0 for no summary)
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "mex.h"
+#include "hoptions.h"
+#include "hrecord.h"
+
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
+using namespace std;
+
+//  wall-clock time in seconds
+static double walltime()
+{
+#ifdef _OPENMP
+  return omp_get_wtime();
+#else
+  return (double)std::clock()/CLOCKS_PER_SEC;
+#endif
+}
+
+//  read integer or string from record file
+static size_t getsize(FILE* fid)
+{
+  size_t n=0;
+  if (std::fread(&n,sizeof(size_t),1,fid)!=1) mexErrMsgTxt("replay: unexpected end of record file");
+  return n;
+}
+static string getstring(FILE* fid)
+{
+  string str(getsize(fid),' ');
+  if (!str.empty() && std::fread(&str[0],1,str.size(),fid)!=str.size())
+    mexErrMsgTxt("replay: unexpected end of record file");
+  return str;
+}
+
+//  read Matlab array, see hrecord.h for the file format
+static mxArray* getarray(FILE* fid)
+{
+  mxClassID id=(mxClassID)getsize(fid);
+  mxComplexity flag=getsize(fid) ? mxCOMPLEX : mxREAL;
+  vector<mwSize> dims(getsize(fid));
+  for (size_t i=0; i<dims.size(); i++) dims[i]=getsize(fid);
+  if (id==mxUNKNOWN_CLASS) return 0;
+
+  mxArray* x;
+  if (id==mxCELL_CLASS)
+  {
+    x=mxCreateCellArray(dims.size(),&dims[0]);
+    for (size_t i=0; i<mxGetNumberOfElements(x); i++) mxSetCell(x,i,getarray(fid));
+  }
+  else if (id==mxSTRUCT_CLASS)
+  {
+    vector<string> names(getsize(fid));
+    vector<const char*> ptr(names.size());
+    for (size_t k=0; k<names.size(); k++) { names[k]=getstring(fid);  ptr[k]=names[k].c_str(); }
+    x=mxCreateStructArray(dims.size(),&dims[0],(int)names.size(),ptr.empty() ? 0 : &ptr[0]);
+    for (size_t i=0; i<mxGetNumberOfElements(x); i++)
+    for (size_t k=0; k<names.size(); k++) mxSetFieldByNumber(x,i,(int)k,getarray(fid));
+  }
+  else
+  {
+    if      (id==mxCHAR_CLASS)    x=mxCreateCharArray(dims.size(),&dims[0]);
+    else if (id==mxLOGICAL_CLASS) x=mxCreateLogicalArray(dims.size(),&dims[0]);
+    else                          x=mxCreateNumericArray(dims.size(),&dims[0],id,flag);
+    size_t esize=getsize(fid), n=mxGetNumberOfElements(x);
+    if (esize!=mxGetElementSize(x)) mexErrMsgTxt("replay: element size of record file does not match");
+    if (n && std::fread(mxGetData(x),esize,n,fid)!=n) mexErrMsgTxt("replay: unexpected end of record file");
+  }
+  return x;
+}
+
+//  summary of Matlab array, scalars of structures are printed with their values
+static void summary(const string& name, const mxArray* x, size_t depth, size_t indent=0)
+{
+  static const char* classes[]={ "unknown", "cell", "struct", "logical", "char", "void",
+    "double", "single", "int8", "uint8", "int16", "uint16", "int32", "uint32", "int64", "uint64" };
+  cout<<string(indent,' ')<<name<<": ";
+  if (!x) { cout<<"[]"<<endl;  return; }
+  if (mxIsNumeric(x) && mxIsScalar(x) && !mxIsComplex(x)) { cout<<mxGetScalar(x)<<endl;  return; }
+  cout<<"["<<mxGetM(x)<<"x"<<mxGetN(x)<<" "<<(mxIsComplex(x) ? "complex " : "")
+      <<classes[mxGetClassID(x)<=mxUINT64_CLASS ? mxGetClassID(x) : 0]<<"]"<<endl;
+  //  fields of scalar structures
+  if (mxIsStruct(x) && mxIsScalar(x) && depth>1)
+    for (int k=0; k<mxGetNumberOfFields(x); k++)
+      summary(mxGetFieldNameByNumber(x,k),mxGetFieldByNumber(x,0,k),depth-1,indent+2);
+}
+
+int main(int argc, char* argv[])
+{
+  //  name of MEX function from program name
+  string prog=argv[0];
+  if (prog.find_last_of("/\\")!=string::npos) prog=prog.substr(prog.find_last_of("/\\")+1);
+
+  size_t repeat=1, threads=0, depth=2;
+  string file;
+  for (int i=1; i<argc; i++)
+  {
+    string key=argv[i];
+    if      (key=="--repeat"  && i+1<argc) repeat =std::max(atoi(argv[++i]),1);
+    else if (key=="--threads" && i+1<argc) threads=atoi(argv[++i]);
+    else if (key=="--depth"   && i+1<argc) depth  =atoi(argv[++i]);
+    else if (key.substr(0,2)!="--" && file.empty()) file=key;
+    else
+      file.clear(), i=argc;
+  }
+  if (file.empty())
+  {
+    cerr<<"usage: "<<prog<<" [--repeat 1] [--threads 0] [--depth 2] file.rec"<<endl;
+    return 1;
+  }
+  #ifdef _OPENMP
+  if (threads) omp_set_num_threads((int)threads);
+  #endif
+
+  //  header of record file
+  FILE* fid=std::fopen(file.c_str(),"rb");
+  if (!fid) { cerr<<prog<<": cannot open "<<file<<endl;  return 1; }
+  char magic[8];
+  if (std::fread(magic,1,8,fid)!=8 || std::memcmp(magic,hrecord_magic,8) || getsize(fid)!=hrecord_version)
+    { cerr<<prog<<": "<<file<<" is no record file of this version"<<endl;  return 1; }
+  string name=getstring(fid);
+  if (name!=prog)
+    { cerr<<prog<<": "<<file<<" is a record of "<<name<<endl;  return 1; }
+  int nlhs=(int)getsize(fid), nrhs=(int)getsize(fid);
+  //  inputs
+  vector<mxArray*> prhs(nrhs+1,(mxArray*)0);
+  for (int i=0; i<nrhs; i++) prhs[i]=getarray(fid);
+  std::fclose(fid);
+
+  //  replay call, outputs of previous calls are released
+  vector<mxArray*> plhs(nlhs+1,(mxArray*)0);
+  for (size_t rep=0; rep<repeat; rep++)
+  {
+    for (int i=0; i<nlhs; i++) { mxDestroyArray(plhs[i]);  plhs[i]=0; }
+    double t=walltime();
+    mexFunction(nlhs,&plhs[0],nrhs,(const mxArray**)&prhs[0]);
+    cerr<<name<<": call "<<rep+1<<" "<<walltime()-t<<"s"<<endl;
+  }
+  //  summary of outputs
+  for (int i=0; i<nlhs && depth; i++)
+  {
+    char str[32];
+    std::sprintf(str,"plhs[%d]",i);
+    summary(str,plhs[i],depth);
+  }
+
+  for (int i=0; i<nlhs; i++) mxDestroyArray(plhs[i]);
+  for (int i=0; i<nrhs; i++) mxDestroyArray(prhs[i]);
+  return 0;
+}